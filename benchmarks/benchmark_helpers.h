@@ -0,0 +1,68 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <cstdint>
+#include <vector>
+
+namespace dronecore {
+namespace benchmark_helpers {
+
+// A mix of messages roughly matching what PX4 streams by default.
+inline std::vector<mavlink_message_t> telemetry_messages(uint8_t system_id, unsigned count)
+{
+    std::vector<mavlink_message_t> messages(count);
+
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_message_t &message = messages[i];
+        switch (i % 8) {
+            case 0:
+                mavlink_msg_heartbeat_pack(system_id, MAV_COMP_ID_AUTOPILOT1, &message,
+                                           0, 12, MAV_MODE_FLAG_CUSTOM_MODE_ENABLED, 0, 4);
+                break;
+            case 1:
+            case 5:
+                mavlink_msg_attitude_quaternion_pack(system_id, MAV_COMP_ID_AUTOPILOT1, &message,
+                                                     i, 1.0f, 0.0f, 0.0f, 0.0f,
+                                                     0.1f, 0.2f, 0.3f);
+                break;
+            case 2:
+            case 6:
+                mavlink_msg_global_position_int_pack(system_id, MAV_COMP_ID_AUTOPILOT1, &message,
+                                                     i, 473977418, 85455939, 488000, 10000,
+                                                     10, 20, -5, 9000);
+                break;
+            case 3:
+                mavlink_msg_sys_status_pack(system_id, MAV_COMP_ID_AUTOPILOT1, &message,
+                                            0, 0, 0, 500, 12000, 1000, 80, 0, 0, 0, 0, 0, 0);
+                break;
+            case 4:
+                mavlink_msg_gps_raw_int_pack(system_id, MAV_COMP_ID_AUTOPILOT1, &message,
+                                             i, 3, 473977418, 85455939, 488000, 100, 100,
+                                             50, 9000, 10, 0, 0, 0, 0, 0);
+                break;
+            default:
+                mavlink_msg_extended_sys_state_pack(system_id, MAV_COMP_ID_AUTOPILOT1, &message,
+                                                    MAV_VTOL_STATE_UNDEFINED,
+                                                    MAV_LANDED_STATE_IN_AIR);
+                break;
+        }
+    }
+
+    return messages;
+}
+
+inline std::vector<char> to_byte_stream(const std::vector<mavlink_message_t> &messages)
+{
+    std::vector<char> bytes;
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+
+    for (const auto &message : messages) {
+        uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+        bytes.insert(bytes.end(), buffer, buffer + len);
+    }
+
+    return bytes;
+}
+
+} // namespace benchmark_helpers
+} // namespace dronecore
@@ -0,0 +1,108 @@
+#include "delegate.h"
+#include "mavlink_include.h"
+#include <benchmark/benchmark.h>
+#include <functional>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+// Stands in for a plugin with a handler for a message.
+class Handler
+{
+public:
+    void process(const mavlink_message_t &message) { _sum += message.seq; }
+    uint64_t sum() const { return _sum; }
+
+private:
+    uint64_t _sum = 0;
+};
+
+typedef std::function<void(const mavlink_message_t &)> function_t;
+typedef Delegate<void(const mavlink_message_t &)> delegate_t;
+
+// How the plugins register their handlers.
+template<typename Callback>
+Callback make_bind(Handler &handler)
+{
+    return Callback(std::bind(&Handler::process, &handler, std::placeholders::_1));
+}
+
+// A lambda with this and a small capture, like a command result callback.
+template<typename Callback>
+Callback make_lambda(Handler &handler, uint8_t offset)
+{
+    return Callback([&handler, offset](const mavlink_message_t & message) {
+        mavlink_message_t copy = message;
+        copy.seq = uint8_t(copy.seq + offset);
+        handler.process(copy);
+    });
+}
+
+template<typename Callback>
+void register_handlers(benchmark::State &state)
+{
+    Handler handler;
+    std::vector<Callback> callbacks;
+    callbacks.reserve(64);
+
+    for (auto _ : state) {
+        for (unsigned i = 0; i < 32; ++i) {
+            callbacks.push_back(make_bind<Callback>(handler));
+            callbacks.push_back(make_lambda<Callback>(handler, uint8_t(i)));
+        }
+        benchmark::DoNotOptimize(callbacks.data());
+        callbacks.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+
+template<typename Callback>
+void invoke_handlers(benchmark::State &state)
+{
+    Handler handler;
+    std::vector<Callback> callbacks;
+    for (unsigned i = 0; i < 32; ++i) {
+        callbacks.push_back(make_bind<Callback>(handler));
+        callbacks.push_back(make_lambda<Callback>(handler, uint8_t(i)));
+    }
+
+    mavlink_message_t message {};
+    for (auto _ : state) {
+        for (const auto &callback : callbacks) {
+            callback(message);
+        }
+        ++message.seq;
+    }
+
+    benchmark::DoNotOptimize(handler.sum());
+    state.SetItemsProcessed(state.iterations() * int64_t(callbacks.size()));
+}
+
+} // namespace
+
+static void BM_StdFunctionRegister(benchmark::State &state)
+{
+    register_handlers<function_t>(state);
+}
+BENCHMARK(BM_StdFunctionRegister);
+
+static void BM_DelegateRegister(benchmark::State &state)
+{
+    register_handlers<delegate_t>(state);
+}
+BENCHMARK(BM_DelegateRegister);
+
+static void BM_StdFunctionInvoke(benchmark::State &state)
+{
+    invoke_handlers<function_t>(state);
+}
+BENCHMARK(BM_StdFunctionInvoke);
+
+static void BM_DelegateInvoke(benchmark::State &state)
+{
+    invoke_handlers<delegate_t>(state);
+}
+BENCHMARK(BM_DelegateInvoke);
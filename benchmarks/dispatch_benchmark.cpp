@@ -0,0 +1,90 @@
+#include "device_impl.h"
+#include "dronecore_impl.h"
+#include "benchmark_helpers.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+
+using namespace dronecore;
+
+// Message ids handled by the plugins in this repository, used to build a
+// handler table of realistic size and order.
+static const uint16_t plugin_message_ids[] = {
+    MAVLINK_MSG_ID_GLOBAL_POSITION_INT, MAVLINK_MSG_ID_HOME_POSITION,
+    MAVLINK_MSG_ID_ATTITUDE_QUATERNION, MAVLINK_MSG_ID_MOUNT_ORIENTATION,
+    MAVLINK_MSG_ID_GPS_RAW_INT, MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
+    MAVLINK_MSG_ID_SYS_STATUS, MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_RC_CHANNELS,
+    MAVLINK_MSG_ID_MISSION_REQUEST, MAVLINK_MSG_ID_MISSION_REQUEST_INT,
+    MAVLINK_MSG_ID_MISSION_ACK, MAVLINK_MSG_ID_MISSION_CURRENT,
+    MAVLINK_MSG_ID_MISSION_ITEM_REACHED, MAVLINK_MSG_ID_MISSION_COUNT,
+    MAVLINK_MSG_ID_MISSION_ITEM_INT, MAVLINK_MSG_ID_HEARTBEAT,
+    MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_AUTOPILOT_VERSION,
+    MAVLINK_MSG_ID_LOGGING_DATA, MAVLINK_MSG_ID_LOGGING_DATA_ACKED,
+    MAVLINK_MSG_ID_COMMAND_ACK, MAVLINK_MSG_ID_PARAM_VALUE,
+    MAVLINK_MSG_ID_PARAM_EXT_VALUE, MAVLINK_MSG_ID_PARAM_EXT_ACK
+};
+
+static void BM_DeviceImplProcessMavlinkMessage(benchmark::State &state)
+{
+    DroneCoreImpl dronecore_impl;
+    DeviceImpl device_impl(&dronecore_impl, 1);
+
+    // The cookie needs to be unique per plugin, the address of a local does the job.
+    int cookie;
+    unsigned num_handled = 0;
+
+    const unsigned table_copies = unsigned(state.range(0));
+    for (unsigned copy = 0; copy < table_copies; ++copy) {
+        for (uint16_t msg_id : plugin_message_ids) {
+            device_impl.register_mavlink_message_handler(
+                msg_id,
+            [&num_handled](const mavlink_message_t &) { ++num_handled; }, &cookie);
+        }
+    }
+
+    // Heartbeats would connect the device and start plugin activity, so leave them out.
+    auto messages = benchmark_helpers::telemetry_messages(1, 1000);
+    messages.erase(std::remove_if(messages.begin(), messages.end(),
+    [](const mavlink_message_t &message) {
+        return message.msgid == MAVLINK_MSG_ID_HEARTBEAT;
+    }), messages.end());
+
+    for (auto _ : state) {
+        for (const auto &message : messages) {
+            device_impl.process_mavlink_message(message);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(messages.size()));
+    state.counters["handlers_called"] = benchmark::Counter(num_handled,
+                                                           benchmark::Counter::kIsRate);
+
+    device_impl.unregister_all_mavlink_message_handlers(&cookie);
+}
+BENCHMARK(BM_DeviceImplProcessMavlinkMessage)->Arg(1)->Arg(4);
+
+static void BM_DroneCoreImplReceiveMessage(benchmark::State &state)
+{
+    DroneCoreImpl dronecore_impl;
+
+    const unsigned num_systems = unsigned(state.range(0));
+    std::vector<mavlink_message_t> messages;
+
+    for (unsigned i = 0; i < num_systems; ++i) {
+        auto device_messages = benchmark_helpers::telemetry_messages(uint8_t(i + 1), 200);
+        messages.insert(messages.end(), device_messages.begin(), device_messages.end());
+    }
+
+    // Let all devices be created before we measure.
+    for (const auto &message : messages) {
+        dronecore_impl.receive_message(message);
+    }
+
+    for (auto _ : state) {
+        for (const auto &message : messages) {
+            dronecore_impl.receive_message(message);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(messages.size()));
+}
+BENCHMARK(BM_DroneCoreImplReceiveMessage)->Arg(1)->Arg(4)->Arg(16);
@@ -0,0 +1,138 @@
+#include "geodesy.h"
+#include "geodesy_kernels.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+constexpr size_t NUM_POINTS = 1000000;
+
+// A telemetry track of a million points within about 10 km of the reference.
+struct Track {
+    Track() :
+        latitude_deg(NUM_POINTS),
+        longitude_deg(NUM_POINTS),
+        altitude_m(NUM_POINTS),
+        out_0(NUM_POINTS),
+        out_1(NUM_POINTS),
+        out_2(NUM_POINTS)
+    {
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<double> offset(-0.1, 0.1);
+        std::uniform_real_distribution<double> altitude(400.0, 600.0);
+        for (size_t i = 0; i < NUM_POINTS; ++i) {
+            latitude_deg[i] = reference.latitude_deg + offset(generator);
+            longitude_deg[i] = reference.longitude_deg + offset(generator);
+            altitude_m[i] = altitude(generator);
+        }
+    }
+
+    const GeodeticPosition reference {47.3977419, 8.5455938, 488.0};
+    std::vector<double> latitude_deg;
+    std::vector<double> longitude_deg;
+    std::vector<double> altitude_m;
+    std::vector<double> out_0;
+    std::vector<double> out_1;
+    std::vector<double> out_2;
+};
+
+Track &track()
+{
+    static Track instance;
+    return instance;
+}
+
+} // namespace
+
+static void BM_GeodeticToEcefScalar(benchmark::State &state)
+{
+    Track &t = track();
+    for (auto _ : state) {
+        geodesy_kernels::geodetic_to_ecef_scalar(NUM_POINTS, t.latitude_deg.data(),
+                                                 t.longitude_deg.data(), t.altitude_m.data(),
+                                                 t.out_0.data(), t.out_1.data(), t.out_2.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(NUM_POINTS));
+}
+BENCHMARK(BM_GeodeticToEcefScalar)->Unit(benchmark::kMillisecond);
+
+static void BM_GeodeticToEcefAvx2(benchmark::State &state)
+{
+    if (!geodesy_kernels::avx2_supported()) {
+        state.SkipWithError("AVX2 not supported");
+    }
+    Track &t = track();
+    for (auto _ : state) {
+        geodesy_kernels::geodetic_to_ecef_avx2(NUM_POINTS, t.latitude_deg.data(),
+                                               t.longitude_deg.data(), t.altitude_m.data(),
+                                               t.out_0.data(), t.out_1.data(), t.out_2.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(NUM_POINTS));
+}
+BENCHMARK(BM_GeodeticToEcefAvx2)->Unit(benchmark::kMillisecond);
+
+static void BM_GeodeticToNedScalar(benchmark::State &state)
+{
+    Track &t = track();
+    const LocalTangentPlane plane(t.reference);
+    for (auto _ : state) {
+        geodesy_kernels::geodetic_to_ned_scalar(plane.frame(), NUM_POINTS, t.latitude_deg.data(),
+                                                t.longitude_deg.data(), t.altitude_m.data(),
+                                                t.out_0.data(), t.out_1.data(), t.out_2.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(NUM_POINTS));
+}
+BENCHMARK(BM_GeodeticToNedScalar)->Unit(benchmark::kMillisecond);
+
+static void BM_GeodeticToNedAvx2(benchmark::State &state)
+{
+    if (!geodesy_kernels::avx2_supported()) {
+        state.SkipWithError("AVX2 not supported");
+    }
+    Track &t = track();
+    const LocalTangentPlane plane(t.reference);
+    for (auto _ : state) {
+        geodesy_kernels::geodetic_to_ned_avx2(plane.frame(), NUM_POINTS, t.latitude_deg.data(),
+                                              t.longitude_deg.data(), t.altitude_m.data(),
+                                              t.out_0.data(), t.out_1.data(), t.out_2.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(NUM_POINTS));
+}
+BENCHMARK(BM_GeodeticToNedAvx2)->Unit(benchmark::kMillisecond);
+
+static void BM_NedToGeodetic(benchmark::State &state)
+{
+    Track &t = track();
+    const LocalTangentPlane plane(t.reference);
+    std::vector<double> north(NUM_POINTS), east(NUM_POINTS), down(NUM_POINTS);
+    plane.to_ned(NUM_POINTS, t.latitude_deg.data(), t.longitude_deg.data(), t.altitude_m.data(),
+                 north.data(), east.data(), down.data());
+
+    for (auto _ : state) {
+        plane.from_ned(NUM_POINTS, north.data(), east.data(), down.data(),
+                       t.out_0.data(), t.out_1.data(), t.out_2.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(NUM_POINTS));
+}
+BENCHMARK(BM_NedToGeodetic)->Unit(benchmark::kMillisecond);
+
+static void BM_DistancesAndBearings(benchmark::State &state)
+{
+    Track &t = track();
+    for (auto _ : state) {
+        distances_and_bearings(t.reference.latitude_deg, t.reference.longitude_deg, NUM_POINTS,
+                               t.latitude_deg.data(), t.longitude_deg.data(),
+                               t.out_0.data(), t.out_1.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(NUM_POINTS));
+}
+BENCHMARK(BM_DistancesAndBearings)->Unit(benchmark::kMillisecond);
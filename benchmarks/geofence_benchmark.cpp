@@ -0,0 +1,120 @@
+#include "geofence_index.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+constexpr size_t NUM_POSITIONS = 4096;
+
+// Hundreds of zones with about 20 vertices each spread over an area of about
+// 20 by 20 km, like the no-fly zones around a city.
+struct Zones {
+    explicit Zones(unsigned num_polygons)
+    {
+        std::mt19937 generator(2);
+        std::uniform_real_distribution<double> center(0.0, 0.2);
+        std::uniform_real_distribution<double> radius(0.002, 0.01);
+
+        for (unsigned i = 0; i < num_polygons; ++i) {
+            Geofence::Polygon polygon {(i == 0) ? Geofence::FenceType::INCLUSION :
+                                       Geofence::FenceType::EXCLUSION, {}
+                                      };
+            // The first zone is an inclusion zone around all the others.
+            const double center_latitude_deg = (i == 0) ? 47.1 : 47.0 + center(generator);
+            const double center_longitude_deg = (i == 0) ? 8.1 : 8.0 + center(generator);
+            const double size_deg = (i == 0) ? 0.15 : radius(generator);
+            for (unsigned j = 0; j < 20; ++j) {
+                const double angle = 2.0 * M_PI * j / 20;
+                const double r = size_deg * ((j % 2 == 0) ? 1.0 : 0.6);
+                polygon.points.push_back(
+                    Geofence::Point {center_latitude_deg + r * std::sin(angle),
+                                     center_longitude_deg + r * std::cos(angle)});
+            }
+            polygons.push_back(polygon);
+        }
+        index.build(polygons, {});
+
+        std::uniform_real_distribution<double> position(-0.02, 0.22);
+        for (size_t i = 0; i < NUM_POSITIONS; ++i) {
+            latitude_deg.push_back(47.0 + position(generator));
+            longitude_deg.push_back(8.0 + position(generator));
+        }
+    }
+
+    std::vector<Geofence::Polygon> polygons {};
+    GeofenceIndex index {};
+    std::vector<double> latitude_deg {};
+    std::vector<double> longitude_deg {};
+};
+
+// Ray casting over every edge of every zone.
+bool naive_breached(const std::vector<Geofence::Polygon> &polygons, double latitude_deg,
+                    double longitude_deg)
+{
+    bool has_inclusion = false;
+    bool inside_inclusion = false;
+    for (const auto &polygon : polygons) {
+        bool inside = false;
+        const auto &points = polygon.points;
+        for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+            const double y0 = points[j].latitude_deg;
+            const double y1 = points[i].latitude_deg;
+            if ((y0 > latitude_deg) != (y1 > latitude_deg)) {
+                const double x = points[j].longitude_deg + (latitude_deg - y0) *
+                                 (points[i].longitude_deg - points[j].longitude_deg) / (y1 - y0);
+                if (longitude_deg < x) {
+                    inside = !inside;
+                }
+            }
+        }
+        if (polygon.fence_type == Geofence::FenceType::INCLUSION) {
+            has_inclusion = true;
+            inside_inclusion = inside_inclusion || inside;
+        } else if (inside) {
+            return true;
+        }
+    }
+    return has_inclusion && !inside_inclusion;
+}
+
+} // namespace
+
+static void BM_GeofenceCheckNaive(benchmark::State &state)
+{
+    const Zones zones(unsigned(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(naive_breached(zones.polygons, zones.latitude_deg[i],
+                                                zones.longitude_deg[i]));
+        i = (i + 1) % NUM_POSITIONS;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GeofenceCheckNaive)->Arg(10)->Arg(300);
+
+static void BM_GeofenceCheckIndex(benchmark::State &state)
+{
+    const Zones zones(unsigned(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(zones.index.check(zones.latitude_deg[i],
+                                                   zones.longitude_deg[i]));
+        i = (i + 1) % NUM_POSITIONS;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GeofenceCheckIndex)->Arg(10)->Arg(300);
+
+static void BM_GeofenceBuildIndex(benchmark::State &state)
+{
+    const Zones zones(unsigned(state.range(0)));
+    for (auto _ : state) {
+        GeofenceIndex index;
+        benchmark::DoNotOptimize(index.build(zones.polygons, {}));
+    }
+}
+BENCHMARK(BM_GeofenceBuildIndex)->Arg(300);
@@ -0,0 +1,89 @@
+#include "timeout_handler.h"
+#include "call_every_handler.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace dronecore;
+
+static void BM_TimeoutHandlerRunOnce(benchmark::State &state)
+{
+    Time time {};
+    TimeoutHandler timeout_handler(time);
+
+    const int num_timeouts = int(state.range(0));
+    std::vector<void *> cookies(num_timeouts, nullptr);
+    for (int i = 0; i < num_timeouts; ++i) {
+        timeout_handler.add([]() {}, 1000.0, &cookies[i]);
+    }
+
+    for (auto _ : state) {
+        timeout_handler.run_once();
+    }
+
+    for (void *cookie : cookies) {
+        timeout_handler.remove(cookie);
+    }
+}
+BENCHMARK(BM_TimeoutHandlerRunOnce)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void BM_TimeoutHandlerRefresh(benchmark::State &state)
+{
+    Time time {};
+    TimeoutHandler timeout_handler(time);
+
+    const int num_timeouts = int(state.range(0));
+    std::vector<void *> cookies(num_timeouts, nullptr);
+    for (int i = 0; i < num_timeouts; ++i) {
+        timeout_handler.add([]() {}, 1000.0, &cookies[i]);
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        timeout_handler.refresh(cookies[i]);
+        i = (i + 1) % cookies.size();
+    }
+
+    for (void *cookie : cookies) {
+        timeout_handler.remove(cookie);
+    }
+}
+BENCHMARK(BM_TimeoutHandlerRefresh)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void BM_TimeoutHandlerAddRemove(benchmark::State &state)
+{
+    Time time {};
+    TimeoutHandler timeout_handler(time);
+
+    for (auto _ : state) {
+        void *cookie = nullptr;
+        timeout_handler.add([]() {}, 1.0, &cookie);
+        timeout_handler.remove(cookie);
+    }
+}
+BENCHMARK(BM_TimeoutHandlerAddRemove);
+
+static void BM_CallEveryHandlerRunOnce(benchmark::State &state)
+{
+    Time time {};
+    CallEveryHandler call_every_handler(time);
+
+    const int num_entries = int(state.range(0));
+    std::vector<void *> cookies(num_entries, nullptr);
+    unsigned num_called = 0;
+    for (int i = 0; i < num_entries; ++i) {
+        // Spread the intervals so that some entries are due in every run.
+        call_every_handler.add([&num_called]() { ++num_called; },
+                               0.001f * float(1 + i % 100), &cookies[i]);
+    }
+
+    for (auto _ : state) {
+        call_every_handler.run_once();
+    }
+
+    state.counters["callbacks"] = benchmark::Counter(num_called, benchmark::Counter::kIsRate);
+
+    for (void *cookie : cookies) {
+        call_every_handler.remove(cookie);
+    }
+}
+BENCHMARK(BM_CallEveryHandlerRunOnce)->Arg(10)->Arg(1000)->Arg(10000);
@@ -0,0 +1,94 @@
+#include "mavlink_receiver.h"
+#include "mavlink_channels.h"
+#include "message_filter.h"
+#include "flight_recorder.h"
+#include "benchmark_helpers.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+
+using namespace dronecore;
+
+namespace {
+
+// Parses the whole stream, split into datagrams of roughly datagram_len bytes
+// like the UDP connection would hand them over.
+void parse_stream(benchmark::State &state, std::vector<char> &bytes, unsigned datagram_len,
+                  const MessageFilter *filter = nullptr)
+{
+    uint8_t channel;
+    if (!MavlinkChannels::Instance().checkout_free_channel(channel)) {
+        state.SkipWithError("No free channel");
+        return;
+    }
+
+    MavlinkReceiver receiver(channel);
+    receiver.set_message_filter(filter, nullptr, true);
+    unsigned num_messages = 0;
+
+    for (auto _ : state) {
+        for (size_t offset = 0; offset < bytes.size(); offset += datagram_len) {
+            const unsigned len = unsigned(MIN(size_t(datagram_len), bytes.size() - offset));
+            receiver.set_new_datagram(&bytes[offset], len);
+            while (receiver.parse_message()) {
+                benchmark::DoNotOptimize(receiver.get_last_message());
+                ++num_messages;
+            }
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * int64_t(bytes.size()));
+    state.SetItemsProcessed(num_messages);
+
+    MavlinkChannels::Instance().checkin_used_channel(channel);
+}
+
+} // namespace
+
+static void BM_MavlinkReceiverParseSynthetic(benchmark::State &state)
+{
+    auto bytes = benchmark_helpers::to_byte_stream(
+                     benchmark_helpers::telemetry_messages(1, 1000));
+    parse_stream(state, bytes, unsigned(state.range(0)));
+}
+BENCHMARK(BM_MavlinkReceiverParseSynthetic)->Arg(64)->Arg(512)->Arg(1400);
+
+static void BM_MavlinkReceiverParseFiltered(benchmark::State &state)
+{
+    auto bytes = benchmark_helpers::to_byte_stream(
+                     benchmark_helpers::telemetry_messages(1, 1000));
+
+    // Only the heartbeats are handled, everything else is skipped.
+    MessageFilter filter;
+    filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+    parse_stream(state, bytes, 1400, &filter);
+}
+BENCHMARK(BM_MavlinkReceiverParseFiltered);
+
+static void BM_MavlinkReceiverParseRecorded(benchmark::State &state)
+{
+    const char *path = getenv("DRONECORE_BENCHMARK_RECORDING");
+    if (path == nullptr) {
+        state.SkipWithError("DRONECORE_BENCHMARK_RECORDING not set");
+        return;
+    }
+
+    FlightRecordReader reader;
+    if (!reader.open(path)) {
+        state.SkipWithError("Could not open recording");
+        return;
+    }
+
+    std::vector<char> bytes;
+    FlightRecordReader::Record record;
+    while (reader.next(record)) {
+        bytes.insert(bytes.end(), record.data, record.data + record.length);
+    }
+
+    if (bytes.empty()) {
+        state.SkipWithError("Recording is empty");
+        return;
+    }
+
+    parse_stream(state, bytes, 1400);
+}
+BENCHMARK(BM_MavlinkReceiverParseRecorded);
@@ -0,0 +1,238 @@
+#include "mission_impl.h"
+#include "mission_item.h"
+#include "mission_item_impl.h"
+#include "mission_plan.h"
+#include "survey_generator.h"
+#include "dronecore_impl.h"
+#include <benchmark/benchmark.h>
+
+namespace dronecore {
+
+// Gives the benchmarks access to the internals of MissionImpl.
+class MissionImplBenchmark
+{
+public:
+    static void assemble_mavlink_mission_items(MissionImpl &mission_impl,
+                                               const MissionPlan &mission_plan)
+    {
+        mission_impl.assemble_mavlink_mission_items(mission_plan);
+    }
+
+    static unsigned num_mavlink_mission_items(const MissionImpl &mission_impl)
+    {
+        return unsigned(mission_impl._mavlink_mission_items.size());
+    }
+
+    static size_t mavlink_mission_items_bytes(const MissionImpl &mission_impl)
+    {
+        return mission_impl._mavlink_mission_items.capacity() *
+               sizeof(mavlink_mission_item_int_t) +
+               mission_impl._mavlink_mission_item_to_mission_item_indices.capacity() * sizeof(int);
+    }
+
+    static void pack_mission_item(const MissionImpl &mission_impl, uint16_t seq,
+                                  mavlink_message_t &message)
+    {
+        mission_impl.pack_mission_item(seq, message);
+    }
+};
+
+} // namespace dronecore
+
+using namespace dronecore;
+
+static std::vector<std::shared_ptr<MissionItem>> survey_mission_items(unsigned count)
+{
+    std::vector<std::shared_ptr<MissionItem>> items;
+    items.reserve(count);
+
+    for (unsigned i = 0; i < count; ++i) {
+        auto item = std::make_shared<MissionItem>();
+        item->set_position(47.398039859999997 + 1e-5 * double(i % 100),
+                           8.5455725400000002 + 1e-5 * double(i / 100));
+        item->set_relative_altitude(10.0f);
+        if (i % 10 == 0) {
+            item->set_speed(5.0f);
+        }
+        if (i % 5 == 0) {
+            item->set_camera_action(MissionItem::CameraAction::TAKE_PHOTO);
+        }
+        items.push_back(item);
+    }
+
+    return items;
+}
+
+static MissionPlan survey_mission_plan(unsigned count)
+{
+    MissionPlan mission_plan;
+    mission_plan.reserve(count);
+
+    for (unsigned i = 0; i < count; ++i) {
+        const size_t index = mission_plan.add_waypoint(47.398039859999997 + 1e-5 * double(i % 100),
+                                                       8.5455725400000002 + 1e-5 * double(i / 100),
+                                                       10.0f);
+        if (i % 10 == 0) {
+            mission_plan.set_speed(index, 5.0f);
+        }
+        if (i % 5 == 0) {
+            mission_plan.set_camera_action(index, MissionItem::CameraAction::TAKE_PHOTO);
+        }
+    }
+
+    return mission_plan;
+}
+
+// Every item is one allocation for the MissionItem together with the control
+// block of the shared_ptr, and one for its MissionItemImpl.
+static size_t mission_items_bytes(const std::vector<std::shared_ptr<MissionItem>> &items)
+{
+    const size_t control_block_bytes = 2 * sizeof(long) + sizeof(void *);
+    return items.capacity() * sizeof(std::shared_ptr<MissionItem>) +
+           items.size() * (control_block_bytes + sizeof(MissionItem) + sizeof(MissionItemImpl));
+}
+
+static void BM_MissionItemsCreate(benchmark::State &state)
+{
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        auto items = survey_mission_items(unsigned(state.range(0)));
+        bytes = mission_items_bytes(items);
+        benchmark::DoNotOptimize(items.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes_per_item"] = double(bytes) / double(state.range(0));
+    state.counters["allocs_per_item"] = 2.0;
+}
+BENCHMARK(BM_MissionItemsCreate)->Arg(1000)->Arg(20000)->Arg(100000)
+->Unit(benchmark::kMillisecond);
+
+static void BM_MissionPlanCreate(benchmark::State &state)
+{
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        auto mission_plan = survey_mission_plan(unsigned(state.range(0)));
+        bytes = mission_plan.memory_usage_bytes();
+        benchmark::DoNotOptimize(mission_plan.latitudes_e7().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes_per_item"] = double(bytes) / double(state.range(0));
+    // One allocation per column, independent of the number of items.
+    state.counters["allocs_per_item"] = 10.0 / double(state.range(0));
+}
+BENCHMARK(BM_MissionPlanCreate)->Arg(1000)->Arg(20000)->Arg(100000)
+->Unit(benchmark::kMillisecond);
+
+// Cost of the adapter used by the API taking a vector of mission items.
+static void BM_MissionPlanFromMissionItems(benchmark::State &state)
+{
+    auto items = survey_mission_items(unsigned(state.range(0)));
+
+    for (auto _ : state) {
+        auto mission_plan = MissionPlan::from_mission_items(items);
+        benchmark::DoNotOptimize(mission_plan.latitudes_e7().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MissionPlanFromMissionItems)->Arg(1000)->Arg(20000)->Arg(100000)
+->Unit(benchmark::kMillisecond);
+
+static void BM_MissionPlanToMissionItems(benchmark::State &state)
+{
+    auto mission_plan = survey_mission_plan(unsigned(state.range(0)));
+
+    for (auto _ : state) {
+        auto items = mission_plan.to_mission_items();
+        benchmark::DoNotOptimize(items.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MissionPlanToMissionItems)->Arg(1000)->Arg(20000)->Arg(100000)
+->Unit(benchmark::kMillisecond);
+
+// A square of about 1 km with lines 5 m apart and a photo every 2 m, about 100k items.
+// This is more than can be uploaded at once, it only measures the generator.
+// The argument is the number of threads, 0 for all cores.
+static void BM_SurveyGenerator(benchmark::State &state)
+{
+    const SurveyGenerator::Polygon polygon {
+        {47.3900, 8.5400}, {47.3900, 8.5533}, {47.3990, 8.5533}, {47.3990, 8.5400}
+    };
+
+    SurveyGenerator::Settings settings;
+    settings.line_spacing_m = 5.0f;
+    settings.trigger_distance_m = 2.0f;
+    settings.line_angle_deg = 15.0f;
+    settings.num_threads = unsigned(state.range(0));
+
+    MissionPlan mission_plan;
+    for (auto _ : state) {
+        if (SurveyGenerator::generate(polygon, settings, mission_plan) !=
+            SurveyGenerator::Result::SUCCESS) {
+            state.SkipWithError("Could not generate survey");
+            break;
+        }
+        benchmark::DoNotOptimize(mission_plan.latitudes_e7().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(mission_plan.size()));
+}
+BENCHMARK(BM_SurveyGenerator)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+
+static void BM_MissionImplAssembleMavlinkMissionItems(benchmark::State &state)
+{
+    DroneCoreImpl dronecore_impl;
+    DeviceImpl device_impl(&dronecore_impl, 1);
+
+    MissionImpl mission_impl;
+    mission_impl.set_parent(&device_impl);
+
+    auto mission_plan = survey_mission_plan(unsigned(state.range(0)));
+
+    for (auto _ : state) {
+        MissionImplBenchmark::assemble_mavlink_mission_items(mission_impl, mission_plan);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    const size_t bytes = MissionImplBenchmark::mavlink_mission_items_bytes(mission_impl);
+    state.counters["bytes_per_item"] = double(bytes) / double(state.range(0));
+}
+BENCHMARK(BM_MissionImplAssembleMavlinkMissionItems)->Arg(1000)->Arg(10000)->Arg(50000)
+->Unit(benchmark::kMillisecond);
+
+// The whole upload as seen from our side: unpack the items once, then pack
+// every item when it is requested.
+static void BM_MissionImplUpload(benchmark::State &state)
+{
+    DroneCoreImpl dronecore_impl;
+    DeviceImpl device_impl(&dronecore_impl, 1);
+
+    MissionImpl mission_impl;
+    mission_impl.set_parent(&device_impl);
+
+    auto mission_plan = survey_mission_plan(unsigned(state.range(0)));
+    uint64_t bytes = 0;
+
+    for (auto _ : state) {
+        MissionImplBenchmark::assemble_mavlink_mission_items(mission_impl, mission_plan);
+
+        const unsigned num = MissionImplBenchmark::num_mavlink_mission_items(mission_impl);
+        for (unsigned seq = 0; seq < num; ++seq) {
+            mavlink_message_t message;
+            MissionImplBenchmark::pack_mission_item(mission_impl, uint16_t(seq), message);
+            benchmark::DoNotOptimize(message);
+            bytes += message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(int64_t(bytes));
+}
+BENCHMARK(BM_MissionImplUpload)->Arg(1000)->Arg(10000)->Arg(50000)
+->Unit(benchmark::kMillisecond);
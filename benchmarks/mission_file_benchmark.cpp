@@ -0,0 +1,140 @@
+#include "mission_binary_file.h"
+#include "mission_file.h"
+#include "mission_plan.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+using namespace dronecore;
+
+namespace {
+
+// With the photos these are 60000 MAVLink items, close to the 65535 which can be uploaded.
+constexpr unsigned NUM_MISSION_ITEMS = 50000;
+
+// Writes the same survey in all formats once and removes the files at exit.
+class MissionFiles
+{
+public:
+    MissionFiles()
+    {
+        char directory[] = "/tmp/mission_file_benchmark_XXXXXX";
+        if (mkdtemp(directory) == nullptr) {
+            return;
+        }
+        _directory = directory;
+
+        MissionPlan mission_plan;
+        mission_plan.reserve(NUM_MISSION_ITEMS);
+        for (unsigned i = 0; i < NUM_MISSION_ITEMS; ++i) {
+            const double latitude_deg = 47.398039859999997 + 1e-5 * double(i % 100);
+            const double longitude_deg = 8.5455725400000002 + 1e-5 * double(i / 100);
+            const size_t index = mission_plan.add_waypoint(latitude_deg, longitude_deg, 10.0f);
+            if (i % 5 == 0) {
+                mission_plan.set_camera_action(index, MissionItem::CameraAction::TAKE_PHOTO);
+            }
+        }
+
+        plan_path = _directory + "/survey.plan";
+        waypoints_path = _directory + "/survey.waypoints";
+        binary_path = _directory + "/survey" + MissionBinaryFile::FILE_SUFFIX;
+
+        MissionFile::save_plan(mission_plan, plan_path);
+        MissionFile::save_waypoints(mission_plan, waypoints_path);
+        MissionFile::save_binary(mission_plan, binary_path);
+    }
+
+    ~MissionFiles()
+    {
+        remove(plan_path.c_str());
+        remove(waypoints_path.c_str());
+        remove(binary_path.c_str());
+        rmdir(_directory.c_str());
+    }
+
+    static int64_t file_size(const std::string &path)
+    {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return 0;
+        }
+        fseek(file, 0, SEEK_END);
+        const long size = ftell(file);
+        fclose(file);
+        return int64_t(size);
+    }
+
+    std::string plan_path {};
+    std::string waypoints_path {};
+    std::string binary_path {};
+
+private:
+    std::string _directory {};
+};
+
+MissionFiles &mission_files()
+{
+    static MissionFiles files;
+    return files;
+}
+
+void load_mission_file(benchmark::State &state, const std::string &path)
+{
+    MissionPlan mission_plan;
+
+    for (auto _ : state) {
+        if (MissionFile::load(path, mission_plan) != MissionFile::Result::SUCCESS) {
+            state.SkipWithError("Could not load mission file");
+            break;
+        }
+        benchmark::DoNotOptimize(mission_plan.latitudes_e7().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(mission_plan.size()));
+    state.SetBytesProcessed(state.iterations() * MissionFiles::file_size(path));
+}
+
+} // namespace
+
+static void BM_MissionFileLoadPlan(benchmark::State &state)
+{
+    load_mission_file(state, mission_files().plan_path);
+}
+BENCHMARK(BM_MissionFileLoadPlan)->Unit(benchmark::kMillisecond);
+
+static void BM_MissionFileLoadWaypoints(benchmark::State &state)
+{
+    load_mission_file(state, mission_files().waypoints_path);
+}
+BENCHMARK(BM_MissionFileLoadWaypoints)->Unit(benchmark::kMillisecond);
+
+// Converts the MAVLink items of the binary file back into a plan.
+static void BM_MissionFileLoadBinary(benchmark::State &state)
+{
+    load_mission_file(state, mission_files().binary_path);
+}
+BENCHMARK(BM_MissionFileLoadBinary)->Unit(benchmark::kMillisecond);
+
+// What upload_mission_file_async() does before the upload: map the file and
+// take over the MAVLink items as they are.
+static void BM_MissionBinaryFileMap(benchmark::State &state)
+{
+    const std::string &path = mission_files().binary_path;
+    unsigned num_items = 0;
+
+    for (auto _ : state) {
+        MissionBinaryFile binary_file;
+        if (!binary_file.open(path)) {
+            state.SkipWithError("Could not map mission file");
+            break;
+        }
+        num_items = binary_file.num_mission_items();
+        benchmark::DoNotOptimize(binary_file.mavlink_items());
+    }
+
+    state.SetItemsProcessed(state.iterations() * num_items);
+    state.SetBytesProcessed(state.iterations() * MissionFiles::file_size(path));
+}
+BENCHMARK(BM_MissionBinaryFileMap)->Unit(benchmark::kMillisecond);
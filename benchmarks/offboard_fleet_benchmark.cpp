@@ -0,0 +1,133 @@
+#include "dronecore_impl.h"
+#include "udp_connection.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace dronecore;
+
+namespace {
+
+constexpr int FLEET_PORT = 24540;
+
+// A UDP connection which knows its remote, a socket on localhost which
+// receives whatever is sent and the setpoints of every vehicle.
+class Fleet
+{
+public:
+    explicit Fleet(unsigned num_vehicles) :
+        _connection(&_dronecore_impl, FLEET_PORT)
+    {
+        _connection.start();
+
+        _peer_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_peer_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+
+        // Anything received makes the connection send back to us.
+        addr.sin_port = htons(FLEET_PORT);
+        const char hello = 0;
+        sendto(_peer_fd, &hello, sizeof(hello), 0, reinterpret_cast<sockaddr *>(&addr),
+               sizeof(addr));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        for (unsigned i = 0; i < num_vehicles; ++i) {
+            mavlink_set_position_target_local_ned_t setpoint {};
+            setpoint.target_system = uint8_t(i + 1);
+            setpoint.coordinate_frame = MAV_FRAME_LOCAL_NED;
+            setpoint.vx = 1.0f;
+            mavlink_message_t message;
+            mavlink_msg_set_position_target_local_ned_encode(255, 190, &message, &setpoint);
+            _templates.push_back(message);
+        }
+    }
+
+    ~Fleet()
+    {
+        close(_peer_fd);
+        _connection.stop();
+    }
+
+    // What OffboardImpl does for every setpoint: patch the time and finalize.
+    void update(mavlink_message_t &message, uint32_t time_boot_ms)
+    {
+        std::memcpy(_MAV_PAYLOAD_NON_CONST(&message) +
+                    offsetof(mavlink_set_position_target_local_ned_t, time_boot_ms),
+                    &time_boot_ms, sizeof(time_boot_ms));
+        mavlink_finalize_message(&message, 255, 190,
+                                 MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_MIN_LEN,
+                                 MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_LEN,
+                                 MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_CRC);
+    }
+
+    DroneCoreImpl _dronecore_impl {};
+    UdpConnection _connection;
+    int _peer_fd = -1;
+    std::vector<mavlink_message_t> _templates {};
+};
+
+int64_t since_ns(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// Every vehicle sends its setpoint on its own, one sendto each, like with a
+// sender per vehicle that happens to tick at the same time.
+static void BM_FleetTickSeparate(benchmark::State &state)
+{
+    Fleet fleet(unsigned(state.range(0)));
+
+    double skew_sum_ns = 0.0;
+    double max_skew_sum_ns = 0.0;
+    uint32_t time_boot_ms = 0;
+    for (auto _ : state) {
+        const auto tick_start = std::chrono::steady_clock::now();
+        int64_t skew_ns = 0;
+        for (auto &message : fleet._templates) {
+            fleet.update(message, ++time_boot_ms);
+            fleet._connection.send_message(message);
+            skew_ns = since_ns(tick_start);
+            skew_sum_ns += double(skew_ns);
+        }
+        max_skew_sum_ns += double(skew_ns);
+    }
+
+    const double num_setpoints = double(state.iterations()) * double(fleet._templates.size());
+    state.counters["skew_us"] = skew_sum_ns * 1e-3 / num_setpoints;
+    state.counters["max_skew_us"] = max_skew_sum_ns * 1e-3 / double(state.iterations());
+}
+BENCHMARK(BM_FleetTickSeparate)->Arg(10)->Arg(50)->Arg(200)->UseRealTime();
+
+// The fleet tick: all setpoints are updated first and sent in one batch.
+static void BM_FleetTickBatched(benchmark::State &state)
+{
+    Fleet fleet(unsigned(state.range(0)));
+
+    double skew_sum_ns = 0.0;
+    uint32_t time_boot_ms = 0;
+    for (auto _ : state) {
+        const auto tick_start = std::chrono::steady_clock::now();
+        for (auto &message : fleet._templates) {
+            fleet.update(message, ++time_boot_ms);
+        }
+        fleet._connection.send_messages(fleet._templates.data(), fleet._templates.size());
+        skew_sum_ns += double(since_ns(tick_start));
+    }
+
+    // All setpoints of a tick leave together.
+    state.counters["skew_us"] = skew_sum_ns * 1e-3 / double(state.iterations());
+    state.counters["max_skew_us"] = state.counters["skew_us"];
+}
+BENCHMARK(BM_FleetTickBatched)->Arg(10)->Arg(50)->Arg(200)->UseRealTime();
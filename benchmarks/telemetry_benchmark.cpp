@@ -0,0 +1,70 @@
+#include "dronecore_impl.h"
+#include "telemetry.h"
+#include "benchmark_helpers.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace dronecore;
+
+namespace {
+
+// Keeps feeding telemetry into DroneCore while the getters are measured.
+class TelemetryFeeder
+{
+public:
+    TelemetryFeeder() :
+        _messages(benchmark_helpers::telemetry_messages(1, 1000))
+    {
+        for (const auto &message : _messages) {
+            _dronecore_impl.receive_message(message);
+        }
+        _thread = std::thread([this]() {
+            while (!_should_exit) {
+                for (const auto &message : _messages) {
+                    _dronecore_impl.receive_message(message);
+                }
+            }
+        });
+    }
+
+    ~TelemetryFeeder()
+    {
+        _should_exit = true;
+        _thread.join();
+    }
+
+    Telemetry &telemetry() { return _dronecore_impl.get_device().telemetry(); }
+
+private:
+    DroneCoreImpl _dronecore_impl {};
+    std::vector<mavlink_message_t> _messages;
+    std::atomic<bool> _should_exit {false};
+    std::thread _thread {};
+};
+
+std::unique_ptr<TelemetryFeeder> feeder;
+
+} // namespace
+
+static void BM_TelemetryGettersContended(benchmark::State &state)
+{
+    if (state.thread_index() == 0) {
+        feeder.reset(new TelemetryFeeder());
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(feeder->telemetry().position());
+        benchmark::DoNotOptimize(feeder->telemetry().attitude_quaternion());
+        benchmark::DoNotOptimize(feeder->telemetry().gps_info());
+        benchmark::DoNotOptimize(feeder->telemetry().battery());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 4);
+
+    if (state.thread_index() == 0) {
+        feeder.reset();
+    }
+}
+BENCHMARK(BM_TelemetryGettersContended)->ThreadRange(1, 8)->UseRealTime();
@@ -11,10 +11,10 @@ CallEveryHandler::~CallEveryHandler()
 {
 }
 
-void CallEveryHandler::add(std::function<void()> callback, float interval_s, void **cookie)
+void CallEveryHandler::add(Delegate<void()> callback, float interval_s, void **cookie)
 {
     auto new_entry = std::make_shared<Entry>();
-    new_entry->callback = callback;
+    new_entry->callback = std::move(callback);
     new_entry->last_time = _time.steady_time();
     new_entry->interval_s = interval_s;
 
@@ -72,12 +72,12 @@ void CallEveryHandler::run_once()
 
             if (it->second->callback) {
 
-                // Get a copy for the callback because we unlock.
-                std::function<void()> callback = it->second->callback;
+                // Keep the entry alive because we unlock.
+                std::shared_ptr<Entry> entry = it->second;
 
                 // Unlock while we callback because it might in turn want to add timeouts.
                 _entries_mutex.unlock();
-                callback();
+                entry->callback();
                 _entries_mutex.lock();
             }
         }
@@ -2,9 +2,9 @@
 
 #include <mutex>
 #include <memory>
-#include <functional>
 #include <map>
 #include "global_include.h"
+#include "delegate.h"
 
 namespace dronecore {
 
@@ -20,7 +20,7 @@ public:
     CallEveryHandler &operator=(CallEveryHandler const &) = delete; // Copy assign
     CallEveryHandler &operator=(CallEveryHandler &&) = delete;      // Move assign
 
-    void add(std::function<void()> callback, float interval_s, void **cookie);
+    void add(Delegate<void()> callback, float interval_s, void **cookie);
     void change(float interval_s, const void *cookie);
     void reset(const void *cookie);
     void remove(const void *cookie);
@@ -29,7 +29,7 @@ public:
 
 private:
     struct Entry {
-        std::function<void()> callback;
+        Delegate<void()> callback;
         dl_time_t last_time;
         float interval_s;
     };
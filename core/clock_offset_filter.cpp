@@ -0,0 +1,103 @@
+#include "clock_offset_filter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace dronecore {
+
+constexpr unsigned ClockOffsetFilter::CONVERGENCE_SAMPLES;
+constexpr double ClockOffsetFilter::ALPHA;
+constexpr double ClockOffsetFilter::BETA;
+constexpr double ClockOffsetFilter::MAX_DRIFT;
+constexpr int64_t ClockOffsetFilter::MAX_RTT_NS;
+constexpr double ClockOffsetFilter::RTT_OUTLIER_FACTOR;
+constexpr int64_t ClockOffsetFilter::RTT_OUTLIER_MARGIN_NS;
+constexpr int64_t ClockOffsetFilter::JUMP_NS;
+constexpr unsigned ClockOffsetFilter::JUMP_SAMPLES;
+
+bool ClockOffsetFilter::add_sample(int64_t request_host_ns, int64_t vehicle_ns,
+                                   int64_t response_host_ns)
+{
+    const int64_t rtt_ns = response_host_ns - request_host_ns;
+    if (rtt_ns < 0 || rtt_ns > MAX_RTT_NS) {
+        return false;
+    }
+
+    if (is_converged() &&
+        double(rtt_ns) > _rtt_ns * RTT_OUTLIER_FACTOR + double(RTT_OUTLIER_MARGIN_NS)) {
+        // Follow slowly anyway, in case the link got slower for good.
+        _rtt_ns += ALPHA * (double(rtt_ns) - _rtt_ns);
+        return false;
+    }
+
+    const int64_t host_ns = request_host_ns + rtt_ns / 2;
+    const double measured_ns = double(vehicle_ns - host_ns);
+
+    if (_num_samples == 0) {
+        _offset_ns = measured_ns;
+        _drift = 0.0;
+        _rtt_ns = double(rtt_ns);
+        _last_host_ns = host_ns;
+        _num_samples = 1;
+        _num_jumped = 0;
+        return true;
+    }
+
+    const double dt_ns = double(host_ns - _last_host_ns);
+    const double predicted_ns = _offset_ns + _drift * dt_ns;
+    const double residual_ns = measured_ns - predicted_ns;
+
+    if (std::fabs(residual_ns) > double(JUMP_NS)) {
+        if (++_num_jumped < JUMP_SAMPLES) {
+            return false;
+        }
+        reset();
+        return add_sample(request_host_ns, vehicle_ns, response_host_ns);
+    }
+    _num_jumped = 0;
+
+    if (_num_samples < CONVERGENCE_SAMPLES) {
+        // Average the first measurements, there is no drift to tell yet.
+        const double gain = 1.0 / double(_num_samples + 1);
+        _offset_ns = predicted_ns + gain * residual_ns;
+        _rtt_ns += gain * (double(rtt_ns) - _rtt_ns);
+        ++_num_samples;
+    } else {
+        _offset_ns = predicted_ns + ALPHA * residual_ns;
+        if (dt_ns > 0.0) {
+            _drift += BETA * residual_ns / dt_ns;
+            _drift = std::max(-MAX_DRIFT, std::min(MAX_DRIFT, _drift));
+        }
+        _rtt_ns += ALPHA * (double(rtt_ns) - _rtt_ns);
+    }
+    _last_host_ns = host_ns;
+    return true;
+}
+
+void ClockOffsetFilter::reset()
+{
+    _num_samples = 0;
+    _num_jumped = 0;
+    _last_host_ns = 0;
+    _offset_ns = 0.0;
+    _drift = 0.0;
+    _rtt_ns = 0.0;
+}
+
+double ClockOffsetFilter::get_offset_ns(int64_t host_ns) const
+{
+    return _offset_ns + _drift * double(host_ns - _last_host_ns);
+}
+
+int64_t ClockOffsetFilter::to_vehicle_ns(int64_t host_ns) const
+{
+    return host_ns + int64_t(std::llround(get_offset_ns(host_ns)));
+}
+
+int64_t ClockOffsetFilter::to_host_ns(int64_t vehicle_ns) const
+{
+    // Solves vehicle = host + offset + drift * (host - last) for the host time.
+    const double since_last_ns = (double(vehicle_ns - _last_host_ns) - _offset_ns) / (1.0 + _drift);
+    return _last_host_ns + int64_t(std::llround(since_last_ns));
+}
+
+} // namespace dronecore
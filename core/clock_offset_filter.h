@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dronecore {
+
+// Estimates the clock of the vehicle from TIMESYNC round trips.
+//
+// Every round trip gives the time of the vehicle when it answered and the host
+// times when the request was sent and the answer received. Assuming both ways
+// take as long, the vehicle answered in the middle, which gives a measurement
+// of the offset between the clocks. The offset and its drift, the difference
+// in the rate of the clocks, are then tracked by an alpha-beta filter.
+//
+// Round trips taking much longer than usual were held up on one way more than
+// on the other and are not used. If the measurements keep disagreeing with the
+// estimate, the vehicle clock jumped, e.g. because it rebooted, and the filter
+// starts over.
+//
+// All times are in nanoseconds. The filter is not thread-safe.
+class ClockOffsetFilter
+{
+public:
+    ClockOffsetFilter() = default;
+    ~ClockOffsetFilter() = default;
+
+    // delete copy and move constructors and assign operators
+    ClockOffsetFilter(ClockOffsetFilter const &) = delete;            // Copy construct
+    ClockOffsetFilter(ClockOffsetFilter &&) = delete;                 // Move construct
+    ClockOffsetFilter &operator=(ClockOffsetFilter const &) = delete; // Copy assign
+    ClockOffsetFilter &operator=(ClockOffsetFilter &&) = delete;      // Move assign
+
+    // Returns false if the round trip is not used.
+    bool add_sample(int64_t request_host_ns, int64_t vehicle_ns, int64_t response_host_ns);
+
+    void reset();
+
+    // Whether enough round trips were used to trust the estimate.
+    bool is_converged() const { return _num_samples >= CONVERGENCE_SAMPLES; }
+
+    // Vehicle clock minus host clock at the given host time.
+    double get_offset_ns(int64_t host_ns) const;
+    double get_drift() const { return _drift; }
+    // Smoothed time of the round trips used.
+    double get_rtt_ns() const { return _rtt_ns; }
+
+    int64_t to_vehicle_ns(int64_t host_ns) const;
+    int64_t to_host_ns(int64_t vehicle_ns) const;
+
+    // Up to then, the measurements are averaged.
+    static constexpr unsigned CONVERGENCE_SAMPLES = 10;
+    // Gains once converged, BETA is about critically damped for ALPHA.
+    static constexpr double ALPHA = 0.05;
+    static constexpr double BETA = 0.0013;
+    // Crystals are off by less than 100 ppm, so more is a bad estimate.
+    static constexpr double MAX_DRIFT = 500e-6;
+    // Round trips taking longer are too uncertain to use at all.
+    static constexpr int64_t MAX_RTT_NS = 1000000000;
+    // A round trip taking longer than this factor of the usual one plus the
+    // margin is not used.
+    static constexpr double RTT_OUTLIER_FACTOR = 2.0;
+    static constexpr int64_t RTT_OUTLIER_MARGIN_NS = 10000000;
+    // Measurements off by more are taken as a jump of the clock once there
+    // are enough of them in a row.
+    static constexpr int64_t JUMP_NS = 100000000;
+    static constexpr unsigned JUMP_SAMPLES = 5;
+
+private:
+    unsigned _num_samples = 0;
+    unsigned _num_jumped = 0;
+    // Host time of the last measurement used, which the offset is at.
+    int64_t _last_host_ns = 0;
+    double _offset_ns = 0.0;
+    double _drift = 0.0;
+    double _rtt_ns = 0.0;
+};
+
+} // namespace dronecore
@@ -0,0 +1,136 @@
+#include "clock_offset_filter.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+using namespace dronecore;
+
+namespace {
+
+const int64_t S_NS = 1000000000;
+const int64_t MS_NS = 1000000;
+
+// A vehicle whose clock started offset_ns after the host clock and runs
+// drift faster, answering once a second over a link with jitter.
+struct Vehicle {
+    int64_t offset_ns;
+    double drift;
+    int64_t one_way_ns;
+    int64_t jitter_ns;
+    int64_t host_ns;
+    std::mt19937 random;
+
+    int64_t clock_ns(int64_t at_host_ns) const
+    {
+        return at_host_ns + offset_ns + int64_t(drift * double(at_host_ns));
+    }
+
+    int64_t delay_ns()
+    {
+        std::uniform_int_distribution<int64_t> jitter(0, jitter_ns);
+        return one_way_ns + jitter(random);
+    }
+
+    unsigned run(ClockOffsetFilter &filter, double duration_s)
+    {
+        unsigned used = 0;
+        for (int64_t end_ns = host_ns + int64_t(duration_s * 1e9); host_ns < end_ns;
+             host_ns += S_NS) {
+            const int64_t answered_ns = host_ns + delay_ns();
+            const int64_t received_ns = answered_ns + delay_ns();
+            if (filter.add_sample(host_ns, clock_ns(answered_ns), received_ns)) {
+                ++used;
+            }
+        }
+        return used;
+    }
+
+    double error_ns(const ClockOffsetFilter &filter) const
+    {
+        return double(filter.to_vehicle_ns(host_ns) - clock_ns(host_ns));
+    }
+};
+
+Vehicle vehicle()
+{
+    Vehicle vehicle {};
+    vehicle.offset_ns = -3600 * S_NS;
+    vehicle.drift = 50e-6;
+    vehicle.one_way_ns = 20 * MS_NS;
+    vehicle.jitter_ns = 4 * MS_NS;
+    vehicle.host_ns = 10000 * S_NS;
+    return vehicle;
+}
+
+} // namespace
+
+TEST(ClockOffsetFilter, FirstSampleGivesOffset)
+{
+    ClockOffsetFilter filter;
+    EXPECT_FALSE(filter.is_converged());
+
+    // Answered in the middle of the round trip.
+    EXPECT_TRUE(filter.add_sample(1000 * MS_NS, 5000 * MS_NS, 1100 * MS_NS));
+    EXPECT_DOUBLE_EQ(filter.get_offset_ns(1050 * MS_NS), double(3950 * MS_NS));
+    EXPECT_DOUBLE_EQ(filter.get_rtt_ns(), double(100 * MS_NS));
+    EXPECT_EQ(filter.to_vehicle_ns(2000 * MS_NS), 5950 * MS_NS);
+    EXPECT_EQ(filter.to_host_ns(5950 * MS_NS), 2000 * MS_NS);
+    EXPECT_FALSE(filter.is_converged());
+}
+
+TEST(ClockOffsetFilter, TracksOffsetAndDrift)
+{
+    ClockOffsetFilter filter;
+    Vehicle sim = vehicle();
+
+    EXPECT_EQ(sim.run(filter, 10.0), 10u);
+    EXPECT_TRUE(filter.is_converged());
+    EXPECT_LT(std::fabs(sim.error_ns(filter)), double(3 * MS_NS));
+
+    sim.run(filter, 300.0);
+    EXPECT_LT(std::fabs(sim.error_ns(filter)), double(MS_NS));
+    EXPECT_NEAR(filter.get_drift(), 50e-6, 10e-6);
+    EXPECT_NEAR(filter.get_rtt_ns(), double(44 * MS_NS), double(2 * MS_NS));
+
+    // Converting back and forth ends up where it started.
+    const int64_t vehicle_ns = filter.to_vehicle_ns(sim.host_ns);
+    EXPECT_LE(std::llabs(filter.to_host_ns(vehicle_ns) - sim.host_ns), 1);
+}
+
+TEST(ClockOffsetFilter, IgnoresSlowRoundTrips)
+{
+    ClockOffsetFilter filter;
+    Vehicle sim = vehicle();
+    sim.drift = 0.0;
+    sim.run(filter, 30.0);
+    const double offset_ns = filter.get_offset_ns(sim.host_ns);
+
+    // The answer was held up on the way back, so it looks much earlier.
+    const int64_t answered_ns = sim.host_ns + 20 * MS_NS;
+    const int64_t received_ns = answered_ns + 400 * MS_NS;
+    EXPECT_FALSE(filter.add_sample(sim.host_ns, sim.clock_ns(answered_ns), received_ns));
+    EXPECT_DOUBLE_EQ(filter.get_offset_ns(sim.host_ns), offset_ns);
+
+    EXPECT_FALSE(filter.add_sample(sim.host_ns, sim.clock_ns(sim.host_ns),
+                                   sim.host_ns + 2 * S_NS));
+    EXPECT_FALSE(filter.add_sample(sim.host_ns, sim.clock_ns(sim.host_ns),
+                                   sim.host_ns - MS_NS));
+}
+
+TEST(ClockOffsetFilter, StartsOverWhenVehicleReboots)
+{
+    ClockOffsetFilter filter;
+    Vehicle sim = vehicle();
+    sim.run(filter, 30.0);
+
+    sim.offset_ns -= 100 * S_NS;
+    // A few measurements could just be bad ones.
+    EXPECT_EQ(sim.run(filter, double(ClockOffsetFilter::JUMP_SAMPLES - 1)), 0u);
+    EXPECT_TRUE(filter.is_converged());
+
+    sim.run(filter, 1.0);
+    EXPECT_FALSE(filter.is_converged());
+    sim.run(filter, 30.0);
+    EXPECT_TRUE(filter.is_converged());
+    EXPECT_LT(std::fabs(sim.error_ns(filter)), double(3 * MS_NS));
+}
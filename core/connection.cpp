@@ -2,14 +2,38 @@
 #include "dronecore_impl.h"
 #include "mavlink_channels.h"
 #include "global_include.h"
+#include "mavlink_message_view.h"
+#include <atomic>
+#include <functional>
 
 namespace dronecore {
 
 Connection::Connection(DroneCoreImpl *parent) :
     _parent(parent),
-    _mavlink_receiver()
+    _mavlink_receiver(),
+    _id(next_id()),
+    _record_messages(true),
+    _trusted_transport(false),
+    _time(),
+    _link_statistics(_id, _time)
+{
+}
 
+bool Connection::send_messages(const mavlink_message_t *messages, size_t count)
 {
+    for (size_t i = 0; i < count; ++i) {
+        if (!send_message(messages[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t Connection::next_id()
+{
+    // Only used to tell connections apart, so wrapping around is fine.
+    static std::atomic<unsigned> id_counter {0};
+    return uint8_t(id_counter++);
 }
 
 Connection::~Connection()
@@ -26,6 +50,10 @@ bool Connection::start_mavlink_receiver()
     }
 
     _mavlink_receiver.reset(new MavlinkReceiver(channel));
+    _mavlink_receiver->set_message_filter(
+        &_parent->message_filter(),
+        std::bind(&Connection::receive_dropped_frame, this, std::placeholders::_1),
+        _trusted_transport);
     return true;
 }
 
@@ -41,9 +69,84 @@ void Connection::stop_mavlink_receiver()
 }
 
 
+DroneCore::ConnectionStats Connection::get_stats() const
+{
+    DroneCore::ConnectionStats stats {};
+    stats.connection_id = _id;
+    if (_mavlink_receiver) {
+        stats.bytes_received = _mavlink_receiver->get_bytes_received();
+        stats.messages_received = _mavlink_receiver->get_messages_received();
+        stats.parse_errors = _mavlink_receiver->get_parse_errors();
+        stats.crc_errors = _mavlink_receiver->get_crc_errors();
+        stats.messages_dropped = _mavlink_receiver->get_messages_dropped();
+        stats.bytes_dropped = _mavlink_receiver->get_bytes_dropped();
+    }
+    return stats;
+}
+
 void Connection::receive_message(const mavlink_message_t &message)
 {
+    const unsigned frame_len = MavlinkReceiver::frame_length(message);
+
+    _parent->message_statistics().record_message(_id, message.sysid, message.msgid, frame_len);
+
+    if (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
+        process_radio_status(message);
+    }
+
+    DroneCore::LinkStats link_stats;
+    if (_link_statistics.record(message.sysid, message.compid, message.seq, frame_len,
+                                link_stats)) {
+        _parent->notify_on_link_stats(link_stats);
+    }
+
+    FlightRecorder &recorder = _parent->flight_recorder();
+    if (_record_messages && recorder.is_recording()) {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+        recorder.record(_id, buffer, buffer_len);
+    }
+
     _parent->receive_message(message);
 }
 
+void Connection::process_radio_status(const mavlink_message_t &message)
+{
+    const MavlinkMessageView view(message);
+
+    std::lock_guard<std::mutex> lock(_radio_status_mutex);
+    _radio_status.txbuf_percent = view.get(&mavlink_radio_status_t::txbuf);
+    _radio_status.rssi = view.get(&mavlink_radio_status_t::rssi);
+    _radio_status.remrssi = view.get(&mavlink_radio_status_t::remrssi);
+    _radio_status.rxerrors = view.get(&mavlink_radio_status_t::rxerrors);
+    _radio_status_time = _time.steady_time();
+    _has_radio_status = true;
+}
+
+bool Connection::get_radio_status(RadioStatus &radio_status) const
+{
+    std::lock_guard<std::mutex> lock(_radio_status_mutex);
+    if (!_has_radio_status) {
+        return false;
+    }
+    radio_status = _radio_status;
+    radio_status.age_s = _time.elapsed_since_s(_radio_status_time);
+    return true;
+}
+
+void Connection::receive_dropped_frame(const mavlink_message_t &header)
+{
+    // Nothing handles the message but it still counts for the statistics and
+    // should not show up as a gap in the sequence.
+    const unsigned frame_len = MavlinkReceiver::frame_length(header);
+
+    _parent->message_statistics().record_message(_id, header.sysid, header.msgid, frame_len);
+
+    DroneCore::LinkStats link_stats;
+    if (_link_statistics.record(header.sysid, header.compid, header.seq, frame_len,
+                                link_stats)) {
+        _parent->notify_on_link_stats(link_stats);
+    }
+}
+
 } // namespace dronecore
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "dronecore.h"
+#include "link_statistics.h"
 #include "mavlink_receiver.h"
 #include <memory>
+#include <mutex>
 
 namespace dronecore {
 
@@ -20,6 +22,30 @@ public:
 
     virtual bool send_message(const mavlink_message_t &message) = 0;
 
+    // Sends several messages at once. By default they are sent one by one,
+    // connections which can batch them override this.
+    virtual bool send_messages(const mavlink_message_t *messages, size_t count);
+
+    uint8_t get_id() const { return _id; }
+
+    DroneCore::ConnectionStats get_stats() const;
+    std::vector<DroneCore::LinkStats> get_link_stats() const
+    {
+        return _link_statistics.get_stats();
+    }
+
+    // What the telemetry radio on either end of the connection last reported.
+    struct RadioStatus {
+        uint8_t txbuf_percent; // Free space in the transmit buffer.
+        uint8_t rssi;
+        uint8_t remrssi;
+        uint16_t rxerrors;
+        double age_s;
+    };
+
+    // Returns false as long as no RADIO_STATUS was received.
+    bool get_radio_status(RadioStatus &radio_status) const;
+
     // Non-copyable
     Connection(const Connection &) = delete;
     const Connection &operator=(const Connection &) = delete;
@@ -28,10 +54,29 @@ protected:
     bool start_mavlink_receiver();
     void stop_mavlink_receiver();
     void receive_message(const mavlink_message_t &message);
+    void receive_dropped_frame(const mavlink_message_t &header);
     DroneCoreImpl *_parent;
     std::unique_ptr<MavlinkReceiver> _mavlink_receiver;
+    uint8_t _id;
+    // Whether received messages go to the flight recorder.
+    bool _record_messages;
+    // Whether the transport already detects corrupted data, so that frames
+    // nothing handles can be skipped without verifying their checksum.
+    bool _trusted_transport;
 
     //void received_mavlink_message(mavlink_message_t &);
+
+private:
+    static uint8_t next_id();
+    void process_radio_status(const mavlink_message_t &message);
+
+    mutable Time _time;
+    LinkStatistics _link_statistics;
+
+    mutable std::mutex _radio_status_mutex {};
+    bool _has_radio_status = false;
+    RadioStatus _radio_status {};
+    dl_time_t _radio_status_time {};
 };
 
 } // namespace dronecore
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dronecore {
+
+template<typename Signature>
+class Delegate;
+
+// A callback like std::function, used for the internal plumbing.
+//
+// Unlike std::function it can only be moved, not copied, and has enough
+// inline storage for a std::bind of a member function with this and a small
+// capture, or a lambda capturing a few pointers, so that creating one for
+// that does not allocate. Bigger callables still work but are put on the heap.
+template<typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+    static constexpr size_t INLINE_SIZE = 6 * sizeof(void *);
+
+    // Whether a callable of type F is stored without allocating.
+    template<typename F>
+    struct fits_inline : std::integral_constant < bool,
+        sizeof(F) <= INLINE_SIZE &&
+        alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible<F>::value > {};
+
+    Delegate() {}
+
+    Delegate(std::nullptr_t) {}
+
+    template < typename F, typename = typename std::enable_if <
+                   !std::is_same<typename std::decay<F>::type, Delegate>::value >::type >
+    Delegate(F &&f)
+    {
+        typedef typename std::decay<F>::type Callable;
+
+        if (is_null(f)) {
+            return;
+        }
+        construct<Callable>(std::forward<F>(f), fits_inline<Callable>());
+    }
+
+    Delegate(Delegate &&other) noexcept
+    {
+        move_from(other);
+    }
+
+    Delegate &operator=(Delegate &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    Delegate &operator=(std::nullptr_t)
+    {
+        reset();
+        return *this;
+    }
+
+    ~Delegate()
+    {
+        reset();
+    }
+
+    // delete copy constructor and assign operator
+    Delegate(Delegate const &) = delete;            // Copy construct
+    Delegate &operator=(Delegate const &) = delete; // Copy assign
+
+    explicit operator bool() const { return _invoke != nullptr; }
+
+    R operator()(Args... args) const
+    {
+        assert(_invoke != nullptr);
+        return _invoke(&_storage, std::forward<Args>(args)...);
+    }
+
+private:
+    enum class Operation {
+        MOVE,
+        DESTROY
+    };
+
+    typedef R(*invoke_t)(void *storage, Args... args);
+    typedef void (*manage_t)(Operation operation, void *storage, void *other_storage);
+
+    // Empty std::functions and null function pointers give an empty delegate.
+    template<typename F>
+    static bool is_null(const F &) { return false; }
+    template<typename Signature>
+    static bool is_null(const std::function<Signature> &f) { return !f; }
+    template<typename T>
+    static bool is_null(T *f) { return f == nullptr; }
+
+    template<typename Callable, typename F>
+    void construct(F &&f, std::true_type /* inline */)
+    {
+        new (&_storage) Callable(std::forward<F>(f));
+        _invoke = &invoke<Callable, true>;
+        _manage = &manage_inline<Callable>;
+    }
+
+    template<typename Callable, typename F>
+    void construct(F &&f, std::false_type /* inline */)
+    {
+        new (&_storage) Callable *(new Callable(std::forward<F>(f)));
+        _invoke = &invoke<Callable, false>;
+        _manage = &manage_heap<Callable>;
+    }
+
+    template<typename Callable>
+    static Callable &get(void *storage, std::true_type /* inline */)
+    {
+        return *static_cast<Callable *>(storage);
+    }
+
+    template<typename Callable>
+    static Callable &get(void *storage, std::false_type /* inline */)
+    {
+        return **static_cast<Callable **>(storage);
+    }
+
+    template<typename Callable, bool is_inline>
+    static R invoke(void *storage, Args... args)
+    {
+        return call(std::is_void<R>(),
+                    get<Callable>(storage, std::integral_constant<bool, is_inline>()),
+                    std::forward<Args>(args)...);
+    }
+
+    // Callables returning something can be used where nothing is returned.
+    template<typename Callable>
+    static void call(std::true_type /* void */, Callable &callable, Args... args)
+    {
+        callable(std::forward<Args>(args)...);
+    }
+
+    template<typename Callable>
+    static R call(std::false_type /* void */, Callable &callable, Args... args)
+    {
+        return callable(std::forward<Args>(args)...);
+    }
+
+    template<typename Callable>
+    static void manage_inline(Operation operation, void *storage, void *other_storage)
+    {
+        if (operation == Operation::MOVE) {
+            Callable &other = *static_cast<Callable *>(other_storage);
+            new (storage) Callable(std::move(other));
+            other.~Callable();
+        } else {
+            static_cast<Callable *>(storage)->~Callable();
+        }
+    }
+
+    template<typename Callable>
+    static void manage_heap(Operation operation, void *storage, void *other_storage)
+    {
+        if (operation == Operation::MOVE) {
+            new (storage) Callable *(*static_cast<Callable **>(other_storage));
+        } else {
+            delete *static_cast<Callable **>(storage);
+        }
+    }
+
+    void move_from(Delegate &other)
+    {
+        if (other._manage != nullptr) {
+            other._manage(Operation::MOVE, &_storage, &other._storage);
+        }
+        _invoke = other._invoke;
+        _manage = other._manage;
+        other._invoke = nullptr;
+        other._manage = nullptr;
+    }
+
+    void reset()
+    {
+        if (_manage != nullptr) {
+            _manage(Operation::DESTROY, &_storage, nullptr);
+        }
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+    // Mutable like the callable inside a std::function, which can be called
+    // even if the std::function is const.
+    mutable typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type
+    _storage {};
+    invoke_t _invoke = nullptr;
+    manage_t _manage = nullptr;
+};
+
+template<typename R, typename... Args>
+constexpr size_t Delegate<R(Args...)>::INLINE_SIZE;
+
+} // namespace dronecore
@@ -0,0 +1,119 @@
+#include "delegate.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <functional>
+#include <memory>
+
+using namespace dronecore;
+
+namespace {
+
+class Counter
+{
+public:
+    void add(int value) { _sum += value; }
+    int sum() const { return _sum; }
+
+private:
+    int _sum = 0;
+};
+
+int twice(int value)
+{
+    return 2 * value;
+}
+
+} // namespace
+
+TEST(Delegate, CallsMemberFunctionsInline)
+{
+    Counter counter;
+    auto bound = std::bind(&Counter::add, &counter, std::placeholders::_1);
+    EXPECT_TRUE(Delegate<void(int)>::fits_inline<decltype(bound)>::value);
+
+    Delegate<void(int)> delegate(bound);
+    ASSERT_TRUE(bool(delegate));
+    delegate(3);
+    delegate(4);
+    EXPECT_EQ(counter.sum(), 7);
+
+    // A lambda with this and a small capture fits too.
+    const int offset = 10;
+    auto lambda = [&counter, offset](int value) { counter.add(value + offset); };
+    EXPECT_TRUE(Delegate<void(int)>::fits_inline<decltype(lambda)>::value);
+    Delegate<void(int)> lambda_delegate(lambda);
+    lambda_delegate(1);
+    EXPECT_EQ(counter.sum(), 18);
+}
+
+TEST(Delegate, EmptyAndNull)
+{
+    Delegate<void()> empty;
+    EXPECT_FALSE(bool(empty));
+
+    Delegate<void()> from_nullptr(nullptr);
+    EXPECT_FALSE(bool(from_nullptr));
+
+    std::function<void()> empty_function;
+    Delegate<void()> from_empty_function(empty_function);
+    EXPECT_FALSE(bool(from_empty_function));
+
+    void (*null_pointer)() = nullptr;
+    Delegate<void()> from_null_pointer(null_pointer);
+    EXPECT_FALSE(bool(from_null_pointer));
+
+    Delegate<int(int)> from_function(twice);
+    ASSERT_TRUE(bool(from_function));
+    EXPECT_EQ(from_function(21), 42);
+
+    from_function = nullptr;
+    EXPECT_FALSE(bool(from_function));
+}
+
+TEST(Delegate, MovesAndDestroysCallable)
+{
+    auto token = std::make_shared<int>(5);
+    {
+        Delegate<int()> delegate([token]() { return *token; });
+        EXPECT_EQ(token.use_count(), 2);
+
+        Delegate<int()> moved(std::move(delegate));
+        EXPECT_FALSE(bool(delegate));
+        ASSERT_TRUE(bool(moved));
+        EXPECT_EQ(moved(), 5);
+        EXPECT_EQ(token.use_count(), 2);
+
+        Delegate<int()> assigned;
+        assigned = std::move(moved);
+        EXPECT_EQ(assigned(), 5);
+        EXPECT_EQ(token.use_count(), 2);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(Delegate, BigCallablesGoOnTheHeap)
+{
+    std::array<int, 32> values {};
+    values[31] = 7;
+    auto token = std::make_shared<int>(0);
+
+    auto big = [values, token]() { return values[31]; };
+    EXPECT_FALSE(Delegate<int()>::fits_inline<decltype(big)>::value);
+    {
+        Delegate<int()> delegate(big);
+        EXPECT_EQ(token.use_count(), 3);
+
+        Delegate<int()> moved(std::move(delegate));
+        EXPECT_EQ(moved(), 7);
+        EXPECT_EQ(token.use_count(), 3);
+    }
+    EXPECT_EQ(token.use_count(), 2);
+}
+
+TEST(Delegate, IgnoresReturnValueForVoid)
+{
+    int calls = 0;
+    Delegate<void()> delegate([&calls]() { return ++calls; });
+    delegate();
+    EXPECT_EQ(calls, 1);
+}
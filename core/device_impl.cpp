@@ -2,6 +2,7 @@
 #include "global_include.h"
 #include "dronecore_impl.h"
 #include "mavlink_include.h"
+#include <chrono>
 #include <functional>
 
 // Set to 1 to log incoming/outgoing mavlink messages.
@@ -17,12 +18,13 @@ DeviceImpl::DeviceImpl(DroneCoreImpl *parent,
     _parent(parent),
     _params(this),
     _commands(this),
+    _timesync(this),
     _timeout_handler(_time),
     _call_every_handler(_time)
 {
     _device_thread = new std::thread(device_thread, this);
 
-    register_mavlink_message_handler(
+    register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_HEARTBEAT,
         std::bind(&DeviceImpl::process_heartbeat, this, _1), this);
 
@@ -59,10 +61,24 @@ void DeviceImpl::register_mavlink_message_handler(uint16_t msg_id,
                                                   mavlink_message_handler_t callback,
                                                   const void *cookie)
 {
+    _parent->message_filter().add(msg_id);
+
+    std::lock_guard<std::mutex> lock(_mavlink_handler_table_mutex);
+
+    MavlinkHandlerTableEntry entry = {msg_id, nullptr, std::move(callback), cookie};
+    _mavlink_handler_table.push_back(std::move(entry));
+}
+
+void DeviceImpl::register_mavlink_message_view_handler(uint16_t msg_id,
+                                                       mavlink_message_view_handler_t callback,
+                                                       const void *cookie)
+{
+    _parent->message_filter().add(msg_id);
+
     std::lock_guard<std::mutex> lock(_mavlink_handler_table_mutex);
 
-    MavlinkHandlerTableEntry entry = {msg_id, callback, cookie};
-    _mavlink_handler_table.push_back(entry);
+    MavlinkHandlerTableEntry entry = {msg_id, std::move(callback), nullptr, cookie};
+    _mavlink_handler_table.push_back(std::move(entry));
 }
 
 void DeviceImpl::unregister_all_mavlink_message_handlers(const void *cookie)
@@ -82,11 +98,23 @@ void DeviceImpl::unregister_all_mavlink_message_handlers(const void *cookie)
     _mavlink_handler_table.clear();
 }
 
-void DeviceImpl::register_timeout_handler(std::function<void()> callback,
+bool DeviceImpl::has_mavlink_message_handler(uint16_t msg_id, const void *ignored_cookie)
+{
+    std::lock_guard<std::mutex> lock(_mavlink_handler_table_mutex);
+
+    for (const auto &entry : _mavlink_handler_table) {
+        if (entry.msg_id == msg_id && entry.cookie != ignored_cookie) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DeviceImpl::register_timeout_handler(Delegate<void()> callback,
                                           double duration_s,
                                           void **cookie)
 {
-    _timeout_handler.add(callback, duration_s, cookie);
+    _timeout_handler.add(std::move(callback), duration_s, cookie);
 }
 
 void DeviceImpl::refresh_timeout_handler(const void *cookie)
@@ -107,28 +135,41 @@ void DeviceImpl::process_mavlink_message(const mavlink_message_t &message)
 
     std::lock_guard<std::mutex> lock(_mavlink_handler_table_mutex);
 
-#if MESSAGE_DEBUGGING==1
+    const auto dispatch_start = std::chrono::steady_clock::now();
+    const MavlinkMessageView view(message);
     bool forwarded = false;
-#endif
+
     for (auto it = _mavlink_handler_table.begin(); it != _mavlink_handler_table.end(); ++it) {
         if (it->msg_id == message.msgid) {
 #if MESSAGE_DEBUGGING==1
             LogDebug() << "Forwarding msg " << int(message.msgid) << " to " << size_t(it->cookie);
-            forwarded = true;
 #endif
-            it->callback(message);
+            forwarded = true;
+            if (it->view_callback) {
+                it->view_callback(view);
+            } else {
+                it->callback(message);
+            }
         }
     }
+
+    if (forwarded) {
+        const auto dispatch_duration = std::chrono::steady_clock::now() - dispatch_start;
+        _parent->message_statistics().record_dispatch(
+            message.sysid, message.msgid,
+            uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         dispatch_duration).count()));
+    }
 #if MESSAGE_DEBUGGING==1
-    if (!forwarded) {
+    else {
         LogDebug() << "Ignoring msg " << int(message.msgid);
     }
 #endif
 }
 
-void DeviceImpl::add_call_every(std::function<void()> callback, float interval_s, void **cookie)
+void DeviceImpl::add_call_every(Delegate<void()> callback, float interval_s, void **cookie)
 {
-    _call_every_handler.add(callback, interval_s, cookie);
+    _call_every_handler.add(std::move(callback), interval_s, cookie);
 }
 
 void DeviceImpl::change_call_every(float interval_s, const void *cookie)
@@ -146,12 +187,11 @@ void DeviceImpl::remove_call_every(const void *cookie)
     _call_every_handler.remove(cookie);
 }
 
-void DeviceImpl::process_heartbeat(const mavlink_message_t &message)
+void DeviceImpl::process_heartbeat(const MavlinkMessageView &view)
 {
-    mavlink_heartbeat_t heartbeat;
-    mavlink_msg_heartbeat_decode(&message, &heartbeat);
+    const uint8_t base_mode = view.get(&mavlink_heartbeat_t::base_mode);
 
-    _armed = ((heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false);
+    _armed = ((base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false);
 
     // We do not call on_discovery here but wait with the notification until we know the UUID.
 
@@ -205,32 +245,32 @@ void DeviceImpl::process_statustext(const mavlink_message_t &message)
     mavlink_statustext_t statustext;
     mavlink_msg_statustext_decode(&message, &statustext);
 
-    std::string debug_str = "MAVLink: ";
+    const char *severity_str = "";
 
     switch (statustext.severity) {
         case MAV_SEVERITY_EMERGENCY:
-            debug_str += "emergency";
+            severity_str = "emergency";
             break;
         case MAV_SEVERITY_ALERT:
-            debug_str += "alert";
+            severity_str = "alert";
             break;
         case MAV_SEVERITY_CRITICAL:
-            debug_str += "critical";
+            severity_str = "critical";
             break;
         case MAV_SEVERITY_ERROR:
-            debug_str += "error";
+            severity_str = "error";
             break;
         case MAV_SEVERITY_WARNING:
-            debug_str += "warning";
+            severity_str = "warning";
             break;
         case MAV_SEVERITY_NOTICE:
-            debug_str += "notice";
+            severity_str = "notice";
             break;
         case MAV_SEVERITY_INFO:
-            debug_str += "info";
+            severity_str = "info";
             break;
         case MAV_SEVERITY_DEBUG:
-            debug_str += "debug";
+            severity_str = "debug";
             break;
         default:
             break;
@@ -241,7 +281,7 @@ void DeviceImpl::process_statustext(const mavlink_message_t &message)
     char text_with_null[sizeof(statustext.text) + 1] {};
     memcpy(text_with_null, statustext.text, sizeof(statustext.text));
 
-    LogDebug() << debug_str << ": " << text_with_null;
+    LogDebug() << "MAVLink: " << severity_str << ": " << text_with_null;
 }
 
 void DeviceImpl::heartbeats_timed_out()
@@ -265,6 +305,7 @@ void DeviceImpl::device_thread(DeviceImpl *self)
         self->_timeout_handler.run_once();
         self->_params.do_work();
         self->_commands.do_work();
+        self->_timesync.do_work();
 
         if (self->_connected) {
             // Work fairly fast if we're connected.
@@ -296,6 +337,15 @@ bool DeviceImpl::send_message(const mavlink_message_t &message)
     return _parent->send_message(message);
 }
 
+bool DeviceImpl::send_messages(const mavlink_message_t *messages, size_t count)
+{
+    if (_communication_locked) {
+        return false;
+    }
+
+    return _parent->send_messages(messages, count);
+}
+
 void DeviceImpl::request_autopilot_version()
 {
     if (_target_uuid_initialized) {
@@ -387,6 +437,33 @@ void DeviceImpl::set_disconnected()
     _target_uuid_initialized = 0;
 }
 
+std::vector<DroneCore::MessageStats> DeviceImpl::get_message_stats() const
+{
+    std::vector<DroneCore::MessageStats> stats;
+    for (const auto &message_stats : _parent->message_statistics().get_message_stats()) {
+        if (message_stats.system_id == _target_system_id) {
+            stats.push_back(message_stats);
+        }
+    }
+    return stats;
+}
+
+std::vector<DroneCore::LinkStats> DeviceImpl::get_link_stats() const
+{
+    std::vector<DroneCore::LinkStats> stats;
+    for (const auto &link_stats : _parent->get_link_stats()) {
+        if (link_stats.system_id == _target_system_id) {
+            stats.push_back(link_stats);
+        }
+    }
+    return stats;
+}
+
+std::vector<Connection::RadioStatus> DeviceImpl::get_radio_statuses() const
+{
+    return _parent->get_radio_statuses();
+}
+
 uint64_t DeviceImpl::get_target_uuid() const
 {
     // We want to support UUIDs if the autopilot tells us.
@@ -509,17 +586,13 @@ void DeviceImpl::send_command_with_ack_async(uint16_t command,
         ((component_id != 0) ? component_id : _target_component_id);
 
     _commands.queue_command_async(command, params, _target_system_id, component_id_to_use,
-                                  callback);
+                                  std::move(callback));
 }
 
 MavlinkCommands::Result DeviceImpl::set_msg_rate(uint16_t message_id, double rate_hz,
                                                  uint8_t component_id)
 {
-    // If left at -1 it will stop the message stream.
-    float interval_us = -1.0f;
-    if (rate_hz > 0) {
-        interval_us = 1e6f / static_cast<float>(rate_hz);
-    }
+    const float interval_us = msg_interval_us(rate_hz);
 
     if (component_id != 0) {
         return send_command_with_ack(
@@ -536,24 +609,51 @@ MavlinkCommands::Result DeviceImpl::set_msg_rate(uint16_t message_id, double rat
 void DeviceImpl::set_msg_rate_async(uint16_t message_id, double rate_hz,
                                     command_result_callback_t callback, uint8_t component_id)
 {
-    // If left at -1 it will stop the message stream.
-    float interval_us = -1.0f;
-    if (rate_hz > 0) {
-        interval_us = 1e6f / static_cast<float>(rate_hz);
-    }
+    const float interval_us = msg_interval_us(rate_hz);
 
     if (component_id != 0) {
         send_command_with_ack_async(
             MAV_CMD_SET_MESSAGE_INTERVAL,
             MavlinkCommands::Params {float(message_id), interval_us, NAN, NAN, NAN, NAN, NAN},
-            callback,
+            std::move(callback),
             component_id);
     } else {
         send_command_with_ack_async(
             MAV_CMD_SET_MESSAGE_INTERVAL,
             MavlinkCommands::Params {float(message_id), interval_us, NAN, NAN, NAN, NAN, NAN},
-            callback);
+            std::move(callback));
+    }
+}
+
+void DeviceImpl::set_msg_rates_async(const std::vector<std::pair<uint16_t, double>> &rates,
+                                     command_result_callback_t callback)
+{
+    if (_target_system_id == 0 && _target_component_id == 0) {
+        if (callback) {
+            callback(MavlinkCommands::Result::NO_DEVICE, NAN);
+        }
+        return;
+    }
+
+    std::vector<MavlinkCommands::Params> params(rates.size());
+    for (size_t i = 0; i < rates.size(); ++i) {
+        params[i] = MavlinkCommands::Params {float(rates[i].first),
+                                             msg_interval_us(rates[i].second),
+                                             NAN, NAN, NAN, NAN, NAN
+                                            };
+    }
+
+    // Queued like single commands so that their acks can't be mixed up.
+    _commands.queue_command_batch_async(MAV_CMD_SET_MESSAGE_INTERVAL, params, _target_system_id,
+                                        _target_component_id, std::move(callback));
+}
+
+float DeviceImpl::msg_interval_us(double rate_hz)
+{
+    if (rate_hz > 0) {
+        return 1e6f / static_cast<float>(rate_hz);
     }
+    return -1.0f;
 }
 
 void DeviceImpl::lock_communication()
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "connection.h"
+#include "dronecore.h"
 #include "global_include.h"
 #include "mavlink_include.h"
+#include "mavlink_message_view.h"
+#include "delegate.h"
 #include "mavlink_parameters.h"
 #include "mavlink_commands.h"
+#include "timesync.h"
 #include "timeout_handler.h"
 #include "call_every_handler.h"
 #include <cstdint>
@@ -11,6 +16,7 @@
 #include <atomic>
 #include <vector>
 #include <map>
+#include <utility>
 #include <thread>
 #include <mutex>
 
@@ -28,31 +34,49 @@ public:
 
     void process_mavlink_message(const mavlink_message_t &message);
 
-    typedef std::function<void(const mavlink_message_t &)> mavlink_message_handler_t;
+    typedef Delegate<void(const MavlinkMessageView &)> mavlink_message_view_handler_t;
 
+    // View handlers read the fields they need in place without copying or
+    // decoding the whole message.
+    void register_mavlink_message_view_handler(uint16_t msg_id,
+                                               mavlink_message_view_handler_t callback,
+                                               const void *cookie);
+
+    typedef Delegate<void(const mavlink_message_t &)> mavlink_message_handler_t;
+
+    // Handlers taking the message itself are still supported.
     void register_mavlink_message_handler(uint16_t msg_id, mavlink_message_handler_t callback,
                                           const void *cookie);
 
     void unregister_all_mavlink_message_handlers(const void *cookie);
 
-    void register_timeout_handler(std::function<void()> callback,
+    // Whether anyone but the owner of the cookie handles the message.
+    bool has_mavlink_message_handler(uint16_t msg_id, const void *ignored_cookie);
+
+    void register_timeout_handler(Delegate<void()> callback,
                                   double duration_s,
                                   void **cookie);
     void refresh_timeout_handler(const void *cookie);
     void unregister_timeout_handler(const void *cookie);
 
-    void add_call_every(std::function<void()> callback, float interval_s, void **cookie);
+    void add_call_every(Delegate<void()> callback, float interval_s, void **cookie);
     void change_call_every(float interval_s, const void *cookie);
     void reset_call_every(const void *cookie);
     void remove_call_every(const void *cookie);
 
     bool send_message(const mavlink_message_t &message);
 
+    // Sends messages, possibly of other devices, in one batch per connection.
+    bool send_messages(const mavlink_message_t *messages, size_t count);
+
+    // Whether messages of the other device go out over the same connections.
+    bool shares_connections_with(const DeviceImpl &other) const { return _parent == other._parent; }
+
     MavlinkCommands::Result send_command_with_ack(uint16_t command,
                                                   const MavlinkCommands::Params &params,
                                                   uint8_t component_id = 0);
 
-    typedef std::function<void(MavlinkCommands::Result, float)> command_result_callback_t;
+    typedef MavlinkCommands::command_result_callback_t command_result_callback_t;
     void send_command_with_ack_async(uint16_t command, const MavlinkCommands::Params &params,
                                      command_result_callback_t callback,
                                      uint8_t component_id = 0);
@@ -62,8 +86,21 @@ public:
     void set_msg_rate_async(uint16_t message_id, double rate_hz,
                             command_result_callback_t callback, uint8_t component_id = 0);
 
+    // Sets the rates of several messages at once instead of one command after the other.
+    // The acks only tell which command they are for, not which message, so the callback
+    // only tells whether all of them were accepted.
+    void set_msg_rates_async(const std::vector<std::pair<uint16_t, double>> &rates,
+                             command_result_callback_t callback);
+
     void request_autopilot_version();
 
+    // What has been received from the target so far, per connection and message.
+    std::vector<DroneCore::MessageStats> get_message_stats() const;
+    // Quality of the links to the target, per connection and component.
+    std::vector<DroneCore::LinkStats> get_link_stats() const;
+    // Of all connections, the radios do not belong to a device.
+    std::vector<Connection::RadioStatus> get_radio_statuses() const;
+
     uint64_t get_target_uuid() const;
     uint8_t get_target_system_id() const;
     uint8_t get_target_component_id() const;
@@ -97,6 +134,9 @@ public:
 
     Time &get_time() { return _time; };
 
+    // Clock of the target as estimated with TIMESYNC.
+    Timesync &get_timesync() { return _timesync; }
+
     // This allows a plugin to lock and unlock all mavlink communication.
     // The functionality is currently not used by a plugin included here
     // but nevertheless there for other plugins that can be added from external.
@@ -109,7 +149,7 @@ public:
 
 private:
 
-    void process_heartbeat(const mavlink_message_t &message);
+    void process_heartbeat(const MavlinkMessageView &view);
     void process_autopilot_version(const mavlink_message_t &message);
     void process_statustext(const mavlink_message_t &message);
     void heartbeats_timed_out();
@@ -119,6 +159,9 @@ private:
     static void device_thread(DeviceImpl *self);
     static void send_heartbeat(DeviceImpl *self);
 
+    // If left at -1 it will stop the message stream.
+    static float msg_interval_us(double rate_hz);
+
     static void receive_float_param(bool success, MavlinkParameters::ParamValue value,
                                     get_param_float_callback_t callback);
     static void receive_int_param(bool success, MavlinkParameters::ParamValue value,
@@ -126,6 +169,8 @@ private:
 
     struct MavlinkHandlerTableEntry {
         uint16_t msg_id;
+        // Only one of the two is set.
+        mavlink_message_view_handler_t view_callback;
         mavlink_message_handler_t callback;
         const void *cookie; // This is the identification to unregister.
     };
@@ -174,6 +219,8 @@ private:
 
     MavlinkCommands _commands;
 
+    Timesync _timesync;
+
     TimeoutHandler _timeout_handler;
     CallEveryHandler _call_every_handler;
 
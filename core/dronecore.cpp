@@ -4,6 +4,7 @@
 #include "connection.h"
 #include "udp_connection.h"
 #include "tcp_connection.h"
+#include "replay_connection.h"
 #ifndef WINDOWS
 #include "serial_connection.h"
 #endif
@@ -92,6 +93,59 @@ DroneCore::ConnectionResult DroneCore::add_serial_connection(std::string dev_pat
 #endif
 }
 
+DroneCore::ConnectionResult DroneCore::add_replay_connection(const std::string &path)
+{
+    return add_replay_connection(path, 1.0f);
+}
+
+DroneCore::ConnectionResult DroneCore::add_replay_connection(const std::string &path,
+                                                             float speed_factor)
+{
+    Connection *new_connection = new ReplayConnection(_impl, path, speed_factor);
+    DroneCore::ConnectionResult ret = new_connection->start();
+
+    if (ret != DroneCore::ConnectionResult::SUCCESS) {
+        delete new_connection;
+        return ret;
+    }
+
+    _impl->add_connection(new_connection);
+    return DroneCore::ConnectionResult::SUCCESS;
+}
+
+bool DroneCore::start_recording(const std::string &directory)
+{
+    return start_recording(directory, FlightRecorder::DEFAULT_SEGMENT_SIZE,
+                           FlightRecorder::DEFAULT_MAX_SEGMENTS);
+}
+
+bool DroneCore::start_recording(const std::string &directory, uint64_t segment_size_bytes,
+                                unsigned max_segments)
+{
+    if (!_impl->flight_recorder().start(directory, segment_size_bytes, max_segments)) {
+        return false;
+    }
+    // Everything that is received is recorded, not just what is handled.
+    _impl->message_filter().set_pass_all(true);
+    return true;
+}
+
+void DroneCore::stop_recording()
+{
+    _impl->message_filter().set_pass_all(false);
+    _impl->flight_recorder().stop();
+}
+
+DroneCore::Statistics DroneCore::statistics() const
+{
+    return _impl->get_statistics();
+}
+
+void DroneCore::register_on_link_stats(link_stats_callback_t callback)
+{
+    _impl->register_on_link_stats(callback);
+}
+
 const std::vector<uint64_t> &DroneCore::device_uuids() const
 {
     return _impl->get_device_uuids();
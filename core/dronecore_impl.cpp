@@ -11,8 +11,15 @@ DroneCoreImpl::DroneCoreImpl() :
     _devices(),
     _device_impls(),
     _on_discover_callback(nullptr),
-    _on_timeout_callback(nullptr)
-{}
+    _on_timeout_callback(nullptr),
+    _on_link_stats_callback(nullptr)
+{
+    // Devices are only created once something is received from them, so their
+    // heartbeats have to come through before anyone registered a handler.
+    _message_filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+    // Sent by the telemetry radios, the connections keep track of them.
+    _message_filter.add(MAVLINK_MSG_ID_RADIO_STATUS);
+}
 
 DroneCoreImpl::~DroneCoreImpl()
 {
@@ -86,10 +93,6 @@ void DroneCoreImpl::receive_message(const mavlink_message_t &message)
         return;
     }
 
-    if (message.sysid != 1) {
-        LogDebug() << "sysid: " << int(message.sysid);
-    }
-
     if (_device_impls.find(message.sysid) != _device_impls.end()) {
         _device_impls.at(message.sysid)->process_mavlink_message(message);
     }
@@ -109,12 +112,69 @@ bool DroneCoreImpl::send_message(const mavlink_message_t &message)
     return true;
 }
 
+bool DroneCoreImpl::send_messages(const mavlink_message_t *messages, size_t count)
+{
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+
+    for (auto it = _connections.begin(); it != _connections.end(); ++it) {
+        if (!(**it).send_messages(messages, count)) {
+            LogErr() << "send fail";
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void DroneCoreImpl::add_connection(Connection *new_connection)
 {
     std::lock_guard<std::mutex> lock(_connections_mutex);
     _connections.push_back(new_connection);
 }
 
+DroneCore::Statistics DroneCoreImpl::get_statistics() const
+{
+    DroneCore::Statistics statistics {};
+    statistics.messages = _message_statistics.get_message_stats();
+    statistics.dispatch = _message_statistics.get_dispatch_stats();
+
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+    for (auto connection : _connections) {
+        statistics.connections.push_back(connection->get_stats());
+
+        auto link_stats = connection->get_link_stats();
+        statistics.links.insert(statistics.links.end(), link_stats.begin(), link_stats.end());
+    }
+
+    return statistics;
+}
+
+std::vector<DroneCore::LinkStats> DroneCoreImpl::get_link_stats() const
+{
+    std::vector<DroneCore::LinkStats> links;
+
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+    for (auto connection : _connections) {
+        auto link_stats = connection->get_link_stats();
+        links.insert(links.end(), link_stats.begin(), link_stats.end());
+    }
+    return links;
+}
+
+std::vector<Connection::RadioStatus> DroneCoreImpl::get_radio_statuses() const
+{
+    std::vector<Connection::RadioStatus> radio_statuses;
+
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+    for (auto connection : _connections) {
+        Connection::RadioStatus radio_status;
+        if (connection->get_radio_status(radio_status)) {
+            radio_statuses.push_back(radio_status);
+        }
+    }
+    return radio_statuses;
+}
+
 const std::vector<uint64_t> &DroneCoreImpl::get_device_uuids() const
 {
     // This needs to survive the scope but we need to clean it up.
@@ -255,4 +315,16 @@ void DroneCoreImpl::register_on_timeout(DroneCore::event_callback_t callback)
     _on_timeout_callback = callback;
 }
 
+void DroneCoreImpl::register_on_link_stats(DroneCore::link_stats_callback_t callback)
+{
+    _on_link_stats_callback = callback;
+}
+
+void DroneCoreImpl::notify_on_link_stats(const DroneCore::LinkStats &link_stats)
+{
+    if (_on_link_stats_callback != nullptr) {
+        _on_link_stats_callback(link_stats);
+    }
+}
+
 } // namespace dronecore
@@ -4,6 +4,9 @@
 #include "connection.h"
 #include "device.h"
 #include "device_impl.h"
+#include "flight_recorder.h"
+#include "message_filter.h"
+#include "message_statistics.h"
 #include "mavlink_include.h"
 #include <vector>
 #include <map>
@@ -20,6 +23,7 @@ public:
 
     void receive_message(const mavlink_message_t &message);
     bool send_message(const mavlink_message_t &message);
+    bool send_messages(const mavlink_message_t *messages, size_t count);
     void add_connection(Connection *connection);
 
     const std::vector<uint64_t> &get_device_uuids() const;
@@ -35,10 +39,21 @@ public:
     void notify_on_discover(uint64_t uuid);
     void notify_on_timeout(uint64_t uuid);
 
+    void register_on_link_stats(DroneCore::link_stats_callback_t callback);
+    void notify_on_link_stats(const DroneCore::LinkStats &link_stats);
+
+    FlightRecorder &flight_recorder() { return _flight_recorder; }
+    MessageStatistics &message_statistics() { return _message_statistics; }
+    MessageFilter &message_filter() { return _message_filter; }
+
+    DroneCore::Statistics get_statistics() const;
+    std::vector<DroneCore::LinkStats> get_link_stats() const;
+    std::vector<Connection::RadioStatus> get_radio_statuses() const;
+
 private:
     void create_device_if_not_existing(uint8_t system_id);
 
-    std::mutex _connections_mutex;
+    mutable std::mutex _connections_mutex;
     std::vector<Connection *> _connections;
 
     mutable std::recursive_mutex _devices_mutex;
@@ -47,6 +62,11 @@ private:
 
     DroneCore::event_callback_t _on_discover_callback;
     DroneCore::event_callback_t _on_timeout_callback;
+    DroneCore::link_stats_callback_t _on_link_stats_callback;
+
+    FlightRecorder _flight_recorder {};
+    MessageStatistics _message_statistics {};
+    MessageFilter _message_filter {};
 
     std::atomic<bool> _should_exit = {false};
 };
@@ -0,0 +1,516 @@
+#include "flight_recorder.h"
+#include "global_include.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifndef WINDOWS
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dronecore {
+
+constexpr uint32_t FlightRecordFormat::VERSION;
+constexpr uint32_t FlightRecordFormat::INDEX_CAPACITY;
+constexpr uint64_t FlightRecordFormat::DATA_OFFSET;
+constexpr uint32_t FlightRecordFormat::MAX_FRAME_LEN;
+const char FlightRecordFormat::MAGIC[8] = {'D', 'C', 'R', 'E', 'C', 'O', 'R', 'D'};
+const char FlightRecordFormat::FILE_SUFFIX[] = ".dcrec";
+
+constexpr uint64_t FlightRecorder::DEFAULT_SEGMENT_SIZE;
+constexpr unsigned FlightRecorder::DEFAULT_MAX_SEGMENTS;
+
+static_assert(sizeof(FlightRecordFormat::SegmentHeader) +
+              FlightRecordFormat::INDEX_CAPACITY * sizeof(FlightRecordFormat::IndexEntry)
+              <= FlightRecordFormat::DATA_OFFSET, "Index does not fit in front of data");
+static_assert(sizeof(FlightRecordFormat::RecordHeader) == 16, "Unexpected record header size");
+
+namespace {
+
+uint64_t padded_record_size(unsigned frame_len)
+{
+    const uint64_t size = sizeof(FlightRecordFormat::RecordHeader) + frame_len;
+    return (size + 7) & ~uint64_t(7);
+}
+
+bool ends_with(const std::string &str, const char *suffix)
+{
+    const size_t suffix_len = strlen(suffix);
+    return str.size() >= suffix_len &&
+           str.compare(str.size() - suffix_len, suffix_len, suffix) == 0;
+}
+
+} // namespace
+
+FlightRecorder::FlightRecorder() {}
+
+FlightRecorder::~FlightRecorder()
+{
+    stop();
+}
+
+uint64_t FlightRecorder::now_us()
+{
+    // Wall clock time so that recordings can be matched with other logs.
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+#ifndef WINDOWS
+
+bool FlightRecorder::start(const std::string &directory, uint64_t segment_size,
+                           unsigned max_segments)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_recording) {
+        LogWarn() << "Flight recorder already running";
+        return false;
+    }
+
+    if (segment_size < FlightRecordFormat::DATA_OFFSET + 16 * 1024 || max_segments == 0) {
+        LogErr() << "Invalid flight recorder settings";
+        return false;
+    }
+
+    _directory = directory;
+    _segment_size = segment_size;
+    _max_segments = max_segments;
+    _segment_counter = 0;
+    _session_id = now_us();
+    _segment_paths.clear();
+
+    if (!open_segment()) {
+        return false;
+    }
+
+    _recording = true;
+    return true;
+}
+
+void FlightRecorder::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _recording = false;
+    close_segment();
+}
+
+void FlightRecorder::record(uint8_t connection_id, const uint8_t *frame, unsigned frame_len)
+{
+    if (!_recording) {
+        return;
+    }
+
+    if (frame_len > FlightRecordFormat::MAX_FRAME_LEN) {
+        return;
+    }
+
+    const uint64_t timestamp_us = now_us();
+    const uint64_t record_size = padded_record_size(frame_len);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_mapped == nullptr) {
+        return;
+    }
+
+    if (_write_offset + record_size > _segment_size) {
+        close_segment();
+        if (!open_segment()) {
+            _recording = false;
+            return;
+        }
+    }
+
+    auto *header = reinterpret_cast<FlightRecordFormat::SegmentHeader *>(_mapped);
+
+    if (_write_offset >= _next_index_offset &&
+        header->index_count < FlightRecordFormat::INDEX_CAPACITY) {
+
+        auto *index = reinterpret_cast<FlightRecordFormat::IndexEntry *>(
+                          _mapped + sizeof(FlightRecordFormat::SegmentHeader));
+        index[header->index_count].timestamp_us = timestamp_us;
+        index[header->index_count].offset = _write_offset;
+        ++header->index_count;
+        _next_index_offset = _write_offset + header->index_interval;
+    }
+
+    FlightRecordFormat::RecordHeader record_header {};
+    record_header.timestamp_us = timestamp_us;
+    record_header.length = uint16_t(frame_len);
+    record_header.connection_id = connection_id;
+
+    memcpy(_mapped + _write_offset, &record_header, sizeof(record_header));
+    memcpy(_mapped + _write_offset + sizeof(record_header), frame, frame_len);
+    _write_offset += record_size;
+
+    if (header->first_timestamp_us == 0) {
+        header->first_timestamp_us = timestamp_us;
+    }
+    header->last_timestamp_us = timestamp_us;
+    // Only publish the record once it is completely written.
+    header->data_end = _write_offset;
+}
+
+bool FlightRecorder::open_segment()
+{
+    std::string path;
+    while (true) {
+        char filename[64];
+        snprintf(filename, sizeof(filename), "/flight_%016llu_%06u%s",
+                 static_cast<unsigned long long>(_session_id), _segment_counter,
+                 FlightRecordFormat::FILE_SUFFIX);
+        path = _directory + filename;
+
+        // Existing recordings are never overwritten. A session which starts
+        // with a taken id (another recorder, or the clock went back) moves on
+        // to the next id instead.
+        _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (_fd < 0 && errno == EEXIST && _segment_paths.empty()) {
+            ++_session_id;
+            continue;
+        }
+        break;
+    }
+    ++_segment_counter;
+
+    if (_fd < 0) {
+        LogErr() << "Could not open " << path << ": " << strerror(errno);
+        return false;
+    }
+
+    // Reserve the whole segment up front, so we don't run into SIGBUS when the
+    // disk fills up while writing to the mapping.
+#if defined(APPLE)
+    int ret = ftruncate(_fd, off_t(_segment_size));
+#else
+    int ret = posix_fallocate(_fd, 0, off_t(_segment_size));
+#endif
+    if (ret != 0) {
+        LogErr() << "Could not preallocate " << path;
+        ::close(_fd);
+        _fd = -1;
+        unlink(path.c_str());
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, _segment_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        _fd, 0);
+    if (mapped == MAP_FAILED) {
+        LogErr() << "Could not map " << path << ": " << strerror(errno);
+        ::close(_fd);
+        _fd = -1;
+        unlink(path.c_str());
+        return false;
+    }
+    _mapped = static_cast<uint8_t *>(mapped);
+
+    auto *header = reinterpret_cast<FlightRecordFormat::SegmentHeader *>(_mapped);
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, FlightRecordFormat::MAGIC, sizeof(header->magic));
+    header->version = FlightRecordFormat::VERSION;
+    header->index_capacity = FlightRecordFormat::INDEX_CAPACITY;
+    header->segment_size = _segment_size;
+    header->data_offset = FlightRecordFormat::DATA_OFFSET;
+    header->data_end = FlightRecordFormat::DATA_OFFSET;
+    header->session_id = _session_id;
+    header->index_interval = uint32_t((_segment_size - FlightRecordFormat::DATA_OFFSET) /
+                                      FlightRecordFormat::INDEX_CAPACITY);
+
+    _write_offset = FlightRecordFormat::DATA_OFFSET;
+    _next_index_offset = _write_offset;
+
+    _segment_paths.push_back(path);
+    while (_segment_paths.size() > _max_segments) {
+        unlink(_segment_paths.front().c_str());
+        _segment_paths.pop_front();
+    }
+
+    return true;
+}
+
+void FlightRecorder::close_segment()
+{
+    if (_mapped != nullptr) {
+        msync(_mapped, _segment_size, MS_ASYNC);
+        munmap(_mapped, _segment_size);
+        _mapped = nullptr;
+    }
+
+    if (_fd >= 0) {
+        // Give back the preallocated space that was not used.
+        if (ftruncate(_fd, off_t(_write_offset)) != 0) {
+            LogWarn() << "Could not truncate flight record segment";
+        }
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+FlightRecordReader::FlightRecordReader() {}
+
+FlightRecordReader::~FlightRecordReader()
+{
+    close();
+}
+
+bool FlightRecordReader::open(const std::string &path)
+{
+    close();
+
+    struct stat path_stat {};
+    if (stat(path.c_str(), &path_stat) != 0) {
+        LogErr() << "Could not find recording " << path;
+        return false;
+    }
+
+    if (S_ISDIR(path_stat.st_mode)) {
+        DIR *dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            return false;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string name(entry->d_name);
+            if (ends_with(name, FlightRecordFormat::FILE_SUFFIX)) {
+                _segment_paths.push_back(path + "/" + name);
+            }
+        }
+        closedir(dir);
+        // The file names are zero padded, so sorting them gives the recording order.
+        std::sort(_segment_paths.begin(), _segment_paths.end());
+    } else {
+        _segment_paths.push_back(path);
+    }
+
+    if (_segment_paths.empty()) {
+        LogErr() << "No segments found in " << path;
+        return false;
+    }
+
+    return map_segment(0);
+}
+
+void FlightRecordReader::close()
+{
+    unmap_segment();
+    _segment_paths.clear();
+    _current_segment = 0;
+}
+
+bool FlightRecordReader::map_segment(unsigned segment_index)
+{
+    unmap_segment();
+
+    while (segment_index < _segment_paths.size()) {
+        const std::string &path = _segment_paths[segment_index];
+        _current_segment = segment_index++;
+
+        _fd = ::open(path.c_str(), O_RDONLY);
+        if (_fd < 0) {
+            LogWarn() << "Could not open segment " << path;
+            continue;
+        }
+
+        struct stat file_stat {};
+        if (fstat(_fd, &file_stat) != 0 ||
+            uint64_t(file_stat.st_size) < sizeof(FlightRecordFormat::SegmentHeader)) {
+            ::close(_fd);
+            _fd = -1;
+            continue;
+        }
+
+        _mapped_size = size_t(file_stat.st_size);
+        void *mapped = mmap(nullptr, _mapped_size, PROT_READ, MAP_SHARED, _fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(_fd);
+            _fd = -1;
+            _mapped_size = 0;
+            continue;
+        }
+        _mapped = static_cast<const uint8_t *>(mapped);
+
+        if (memcmp(header()->magic, FlightRecordFormat::MAGIC, sizeof(header()->magic)) != 0 ||
+            header()->version != FlightRecordFormat::VERSION) {
+            LogWarn() << "Ignoring invalid segment " << path;
+            unmap_segment();
+            continue;
+        }
+
+        _read_offset = header()->data_offset;
+        return true;
+    }
+
+    return false;
+}
+
+void FlightRecordReader::unmap_segment()
+{
+    if (_mapped != nullptr) {
+        munmap(const_cast<uint8_t *>(_mapped), _mapped_size);
+        _mapped = nullptr;
+        _mapped_size = 0;
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+const FlightRecordFormat::SegmentHeader *FlightRecordReader::header() const
+{
+    return reinterpret_cast<const FlightRecordFormat::SegmentHeader *>(_mapped);
+}
+
+bool FlightRecordReader::next(Record &record)
+{
+    while (_mapped != nullptr) {
+        // A segment that is still being written might have been truncated
+        // on close, so never read past what is mapped.
+        const uint64_t data_end = MIN(header()->data_end, _mapped_size);
+
+        if (_read_offset + sizeof(FlightRecordFormat::RecordHeader) <= data_end) {
+            FlightRecordFormat::RecordHeader record_header;
+            memcpy(&record_header, _mapped + _read_offset, sizeof(record_header));
+
+            if (_read_offset + padded_record_size(record_header.length) > data_end) {
+                // Corrupt or incomplete record, skip the rest of the segment.
+                _read_offset = data_end;
+                continue;
+            }
+
+            record.timestamp_us = record_header.timestamp_us;
+            record.session_id = header()->session_id;
+            record.connection_id = record_header.connection_id;
+            record.length = record_header.length;
+            record.data = _mapped + _read_offset + sizeof(record_header);
+
+            _read_offset += padded_record_size(record_header.length);
+            return true;
+        }
+
+        if (!map_segment(_current_segment + 1)) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool FlightRecordReader::seek(uint64_t timestamp_us)
+{
+    // Find the first segment that ends after the requested time.
+    unsigned segment_index = 0;
+    for (; segment_index < _segment_paths.size(); ++segment_index) {
+        if (!map_segment(segment_index)) {
+            return false;
+        }
+        // map_segment skips invalid segments.
+        segment_index = _current_segment;
+        if (header()->last_timestamp_us >= timestamp_us) {
+            break;
+        }
+    }
+
+    if (_mapped == nullptr || header()->last_timestamp_us < timestamp_us) {
+        return false;
+    }
+
+    // Use the index to jump close to the requested time.
+    const auto *index = reinterpret_cast<const FlightRecordFormat::IndexEntry *>(
+                            _mapped + sizeof(FlightRecordFormat::SegmentHeader));
+    const uint32_t index_count = MIN(header()->index_count, header()->index_capacity);
+
+    const auto *it = std::upper_bound(index, index + index_count, timestamp_us,
+    [](uint64_t value, const FlightRecordFormat::IndexEntry & entry) {
+        return value < entry.timestamp_us;
+    });
+
+    _read_offset = (it == index) ? header()->data_offset : (it - 1)->offset;
+
+    // And scan linearly from there.
+    const uint64_t data_end = MIN(header()->data_end, _mapped_size);
+    while (_read_offset + sizeof(FlightRecordFormat::RecordHeader) <= data_end) {
+        FlightRecordFormat::RecordHeader record_header;
+        memcpy(&record_header, _mapped + _read_offset, sizeof(record_header));
+        if (record_header.timestamp_us >= timestamp_us) {
+            break;
+        }
+        _read_offset += padded_record_size(record_header.length);
+    }
+
+    return true;
+}
+
+#else
+
+bool FlightRecorder::start(const std::string &directory, uint64_t segment_size,
+                           unsigned max_segments)
+{
+    UNUSED(directory);
+    UNUSED(segment_size);
+    UNUSED(max_segments);
+    LogErr() << "Flight recorder not implemented on Windows";
+    return false;
+}
+
+void FlightRecorder::stop() {}
+
+void FlightRecorder::record(uint8_t connection_id, const uint8_t *frame, unsigned frame_len)
+{
+    UNUSED(connection_id);
+    UNUSED(frame);
+    UNUSED(frame_len);
+}
+
+bool FlightRecorder::open_segment() { return false; }
+void FlightRecorder::close_segment() {}
+
+FlightRecordReader::FlightRecordReader() {}
+FlightRecordReader::~FlightRecordReader() {}
+
+bool FlightRecordReader::open(const std::string &path)
+{
+    UNUSED(path);
+    LogErr() << "Flight record replay not implemented on Windows";
+    return false;
+}
+
+void FlightRecordReader::close() {}
+
+bool FlightRecordReader::next(Record &record)
+{
+    UNUSED(record);
+    return false;
+}
+
+bool FlightRecordReader::seek(uint64_t timestamp_us)
+{
+    UNUSED(timestamp_us);
+    return false;
+}
+
+bool FlightRecordReader::map_segment(unsigned segment_index)
+{
+    UNUSED(segment_index);
+    return false;
+}
+
+void FlightRecordReader::unmap_segment() {}
+
+const FlightRecordFormat::SegmentHeader *FlightRecordReader::header() const
+{
+    return nullptr;
+}
+
+#endif
+
+} // namespace dronecore
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dronecore {
+
+// On-disk layout shared by the FlightRecorder and the FlightRecordReader.
+//
+// Every segment file starts with a SegmentHeader followed by a fixed size index
+// area. The records are appended after that. Each record consists of a
+// RecordHeader and the raw MAVLink frame, padded to 8 bytes.
+struct FlightRecordFormat {
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t INDEX_CAPACITY = 1024;
+    static constexpr uint64_t DATA_OFFSET = 20480;
+    static constexpr uint32_t MAX_FRAME_LEN = 280;
+
+    struct SegmentHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t index_capacity;
+        uint64_t segment_size;
+        uint64_t data_offset;
+        // Offset after the last complete record, updated after every append.
+        uint64_t data_end;
+        uint32_t index_count;
+        uint32_t index_interval;
+        uint64_t first_timestamp_us;
+        uint64_t last_timestamp_us;
+        // Same for all segments written between one start() and stop().
+        uint64_t session_id;
+    };
+
+    struct IndexEntry {
+        uint64_t timestamp_us;
+        uint64_t offset;
+    };
+
+    struct RecordHeader {
+        uint64_t timestamp_us;
+        uint16_t length;
+        uint8_t connection_id;
+        uint8_t reserved[5];
+    };
+
+    static const char MAGIC[8];
+    static const char FILE_SUFFIX[];
+};
+
+class FlightRecorder
+{
+public:
+    FlightRecorder();
+    ~FlightRecorder();
+
+    // delete copy and move constructors and assign operators
+    FlightRecorder(FlightRecorder const &) = delete;            // Copy construct
+    FlightRecorder(FlightRecorder &&) = delete;                 // Move construct
+    FlightRecorder &operator=(FlightRecorder const &) = delete; // Copy assign
+    FlightRecorder &operator=(FlightRecorder &&) = delete;      // Move assign
+
+    // Segments are preallocated with segment_size bytes and the oldest segment
+    // is deleted once more than max_segments exist.
+    bool start(const std::string &directory, uint64_t segment_size, unsigned max_segments);
+    void stop();
+
+    bool is_recording() const { return _recording; }
+
+    // Appends one raw frame. This is called from the receive threads and does
+    // not allocate unless a segment needs to be rotated.
+    void record(uint8_t connection_id, const uint8_t *frame, unsigned frame_len);
+
+    static constexpr uint64_t DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+    static constexpr unsigned DEFAULT_MAX_SEGMENTS = 8;
+
+private:
+    bool open_segment();
+    void close_segment();
+
+    static uint64_t now_us();
+
+    std::mutex _mutex {};
+    std::atomic<bool> _recording {false};
+
+    std::string _directory {};
+    size_t _segment_size = 0;
+    unsigned _max_segments = 0;
+    unsigned _segment_counter = 0;
+    uint64_t _session_id = 0;
+    std::deque<std::string> _segment_paths {};
+
+    int _fd = -1;
+    uint8_t *_mapped = nullptr;
+    uint64_t _write_offset = 0;
+    uint64_t _next_index_offset = 0;
+};
+
+class FlightRecordReader
+{
+public:
+    FlightRecordReader();
+    ~FlightRecordReader();
+
+    // delete copy and move constructors and assign operators
+    FlightRecordReader(FlightRecordReader const &) = delete;            // Copy construct
+    FlightRecordReader(FlightRecordReader &&) = delete;                 // Move construct
+    FlightRecordReader &operator=(FlightRecordReader const &) = delete; // Copy assign
+    FlightRecordReader &operator=(FlightRecordReader &&) = delete;      // Move assign
+
+    struct Record {
+        uint64_t timestamp_us;
+        uint64_t session_id;
+        uint8_t connection_id;
+        uint16_t length;
+        // Points into the mapped segment, valid until the next call.
+        const uint8_t *data;
+    };
+
+    // Opens either a single segment file or a directory containing segments
+    // which are then read in order.
+    bool open(const std::string &path);
+    void close();
+
+    bool next(Record &record);
+
+    // Moves to the first record at or after timestamp_us using the index.
+    bool seek(uint64_t timestamp_us);
+
+    unsigned num_segments() const { return unsigned(_segment_paths.size()); }
+
+private:
+    bool map_segment(unsigned segment_index);
+    void unmap_segment();
+    const FlightRecordFormat::SegmentHeader *header() const;
+
+    std::vector<std::string> _segment_paths {};
+    unsigned _current_segment = 0;
+
+    int _fd = -1;
+    const uint8_t *_mapped = nullptr;
+    size_t _mapped_size = 0;
+    uint64_t _read_offset = 0;
+};
+
+} // namespace dronecore
@@ -0,0 +1,218 @@
+#include "flight_recorder.h"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef WINDOWS
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace dronecore;
+
+namespace {
+
+std::string make_temp_dir()
+{
+    char path[] = "/tmp/flight_recorder_test_XXXXXX";
+    char *result = mkdtemp(path);
+    return (result != nullptr) ? std::string(result) : std::string();
+}
+
+unsigned count_segments(const std::string &dir)
+{
+    unsigned count = 0;
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return 0;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (strstr(entry->d_name, FlightRecordFormat::FILE_SUFFIX) != nullptr) {
+            ++count;
+        }
+    }
+    closedir(d);
+    return count;
+}
+
+void remove_dir(const std::string &dir)
+{
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (entry->d_name[0] != '.') {
+            unlink((dir + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(d);
+    rmdir(dir.c_str());
+}
+
+} // namespace
+
+TEST(FlightRecorder, RecordAndReadBack)
+{
+    const std::string dir = make_temp_dir();
+    ASSERT_FALSE(dir.empty());
+
+    FlightRecorder recorder;
+    ASSERT_TRUE(recorder.start(dir, FlightRecorder::DEFAULT_SEGMENT_SIZE / 16, 2));
+    EXPECT_TRUE(recorder.is_recording());
+
+    for (unsigned i = 0; i < 100; ++i) {
+        uint8_t frame[20];
+        memset(frame, int(i), sizeof(frame));
+        recorder.record(uint8_t(i % 3), frame, 1 + i % sizeof(frame));
+    }
+    recorder.stop();
+    EXPECT_FALSE(recorder.is_recording());
+
+    FlightRecordReader reader;
+    ASSERT_TRUE(reader.open(dir));
+
+    unsigned num_read = 0;
+    uint64_t last_timestamp_us = 0;
+    FlightRecordReader::Record record;
+    while (reader.next(record)) {
+        EXPECT_EQ(record.connection_id, num_read % 3);
+        EXPECT_EQ(record.length, 1 + num_read % 20);
+        EXPECT_EQ(record.data[0], num_read);
+        EXPECT_EQ(record.data[record.length - 1], num_read);
+        EXPECT_GE(record.timestamp_us, last_timestamp_us);
+        last_timestamp_us = record.timestamp_us;
+        ++num_read;
+    }
+    EXPECT_EQ(num_read, 100);
+
+    remove_dir(dir);
+}
+
+TEST(FlightRecorder, SegmentRotationIsBounded)
+{
+    const std::string dir = make_temp_dir();
+    ASSERT_FALSE(dir.empty());
+
+    const uint64_t segment_size = FlightRecordFormat::DATA_OFFSET + 16 * 1024;
+    const unsigned max_segments = 3;
+
+    FlightRecorder recorder;
+    ASSERT_TRUE(recorder.start(dir, segment_size, max_segments));
+
+    uint8_t frame[FlightRecordFormat::MAX_FRAME_LEN] = {};
+    const unsigned num_frames = 1000;
+    for (unsigned i = 0; i < num_frames; ++i) {
+        memcpy(frame, &i, sizeof(i));
+        recorder.record(0, frame, sizeof(frame));
+    }
+    recorder.stop();
+
+    EXPECT_EQ(count_segments(dir), max_segments);
+
+    // Only the newest frames are left and they need to be in order.
+    FlightRecordReader reader;
+    ASSERT_TRUE(reader.open(dir));
+    EXPECT_EQ(reader.num_segments(), max_segments);
+
+    FlightRecordReader::Record record;
+    unsigned last_i = 0;
+    unsigned num_read = 0;
+    while (reader.next(record)) {
+        unsigned i;
+        memcpy(&i, record.data, sizeof(i));
+        if (num_read > 0) {
+            EXPECT_EQ(i, last_i + 1);
+        }
+        last_i = i;
+        ++num_read;
+    }
+    EXPECT_GT(num_read, 0u);
+    EXPECT_LT(num_read, num_frames);
+    EXPECT_EQ(last_i, num_frames - 1);
+
+    remove_dir(dir);
+}
+
+TEST(FlightRecorder, SeekUsesIndex)
+{
+    const std::string dir = make_temp_dir();
+    ASSERT_FALSE(dir.empty());
+
+    FlightRecorder recorder;
+    ASSERT_TRUE(recorder.start(dir, FlightRecorder::DEFAULT_SEGMENT_SIZE / 16, 1));
+
+    uint8_t frame[10] = {};
+    for (unsigned i = 0; i < 2000; ++i) {
+        recorder.record(0, frame, sizeof(frame));
+        if (i % 500 == 0) {
+            usleep(2000);
+        }
+    }
+    recorder.stop();
+
+    FlightRecordReader reader;
+    ASSERT_TRUE(reader.open(dir));
+
+    std::vector<uint64_t> timestamps;
+    FlightRecordReader::Record record;
+    while (reader.next(record)) {
+        timestamps.push_back(record.timestamp_us);
+    }
+    ASSERT_EQ(timestamps.size(), 2000u);
+
+    const uint64_t target = timestamps[1500];
+    ASSERT_TRUE(reader.seek(target));
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.timestamp_us, target);
+
+    // Seeking past the end fails.
+    EXPECT_FALSE(reader.seek(timestamps.back() + 1000000));
+
+    remove_dir(dir);
+}
+
+TEST(FlightRecorder, SessionsDoNotOverwriteEachOther)
+{
+    const std::string dir = make_temp_dir();
+    ASSERT_FALSE(dir.empty());
+
+    // Restarted right away, the second session must get its own segments.
+    FlightRecorder recorder;
+    uint8_t frame[10] = {};
+    for (uint8_t session = 0; session < 2; ++session) {
+        ASSERT_TRUE(recorder.start(dir, FlightRecorder::DEFAULT_SEGMENT_SIZE / 16, 1));
+        frame[0] = session;
+        recorder.record(0, frame, sizeof(frame));
+        recorder.stop();
+    }
+    EXPECT_EQ(count_segments(dir), 2u);
+
+    FlightRecordReader reader;
+    ASSERT_TRUE(reader.open(dir));
+
+    std::vector<uint64_t> session_ids;
+    FlightRecordReader::Record record;
+    while (reader.next(record)) {
+        EXPECT_EQ(record.data[0], session_ids.size());
+        session_ids.push_back(record.session_id);
+    }
+    ASSERT_EQ(session_ids.size(), 2u);
+    EXPECT_LT(session_ids[0], session_ids[1]);
+
+    remove_dir(dir);
+}
+
+TEST(FlightRecorder, RejectsInvalidSettings)
+{
+    FlightRecorder recorder;
+    EXPECT_FALSE(recorder.start("/tmp", 1024, 1));
+    EXPECT_FALSE(recorder.start("/tmp", FlightRecorder::DEFAULT_SEGMENT_SIZE, 0));
+    EXPECT_FALSE(recorder.start("/nonexistent/directory", FlightRecorder::DEFAULT_SEGMENT_SIZE, 1));
+    EXPECT_FALSE(recorder.is_recording());
+}
+
+#endif
@@ -0,0 +1,513 @@
+#include "geodesy.h"
+#include "geodesy_kernels.h"
+#include "global_include.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(WINDOWS)
+#define GEODESY_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace dronecore {
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+inline void rotate(const LocalTangentPlane::Frame &frame, double x_m, double y_m, double z_m,
+                   double &north_m, double &east_m, double &down_m)
+{
+    const double dx = x_m - frame.origin[0];
+    const double dy = y_m - frame.origin[1];
+    const double dz = z_m - frame.origin[2];
+    north_m = frame.rotation[0][0] * dx + frame.rotation[0][1] * dy + frame.rotation[0][2] * dz;
+    east_m = frame.rotation[1][0] * dx + frame.rotation[1][1] * dy + frame.rotation[1][2] * dz;
+    down_m = frame.rotation[2][0] * dx + frame.rotation[2][1] * dy + frame.rotation[2][2] * dz;
+}
+
+inline EcefPosition rotate_back(const LocalTangentPlane::Frame &frame, const NedPosition &ned)
+{
+    // The rotation is orthonormal, so its inverse is the transpose.
+    EcefPosition ecef;
+    ecef.x_m = frame.origin[0] + frame.rotation[0][0] * ned.north_m +
+               frame.rotation[1][0] * ned.east_m + frame.rotation[2][0] * ned.down_m;
+    ecef.y_m = frame.origin[1] + frame.rotation[0][1] * ned.north_m +
+               frame.rotation[1][1] * ned.east_m + frame.rotation[2][1] * ned.down_m;
+    ecef.z_m = frame.origin[2] + frame.rotation[0][2] * ned.north_m +
+               frame.rotation[1][2] * ned.east_m + frame.rotation[2][2] * ned.down_m;
+    return ecef;
+}
+
+#ifdef GEODESY_AVX2
+
+// sin and cos of four angles within +-2 pi, using the fdlibm kernels after
+// reducing the angle to +-pi/4 around a multiple of pi/2.
+__attribute__((target("avx2,fma")))
+inline void sincos_avx2(__m256d x, __m256d &sin_x, __m256d &cos_x)
+{
+    const __m256d quadrant = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(2.0 / M_PI)),
+                                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+    // pi/2 split into a part which can be multiplied exactly and the rest.
+    __m256d z = _mm256_fnmadd_pd(quadrant, _mm256_set1_pd(1.57079632673412561417e+00), x);
+    z = _mm256_fnmadd_pd(quadrant, _mm256_set1_pd(6.07710050650619224932e-11), z);
+    const __m256d zz = _mm256_mul_pd(z, z);
+
+    __m256d sin_poly = _mm256_set1_pd(1.58969099521155010221e-10);
+    sin_poly = _mm256_fmadd_pd(sin_poly, zz, _mm256_set1_pd(-2.50507602534068634195e-08));
+    sin_poly = _mm256_fmadd_pd(sin_poly, zz, _mm256_set1_pd(2.75573137070700676789e-06));
+    sin_poly = _mm256_fmadd_pd(sin_poly, zz, _mm256_set1_pd(-1.98412698298579493134e-04));
+    sin_poly = _mm256_fmadd_pd(sin_poly, zz, _mm256_set1_pd(8.33333333332248946124e-03));
+    sin_poly = _mm256_fmadd_pd(sin_poly, zz, _mm256_set1_pd(-1.66666666666666324348e-01));
+    const __m256d sin_z = _mm256_fmadd_pd(_mm256_mul_pd(sin_poly, zz), z, z);
+
+    __m256d cos_poly = _mm256_set1_pd(-1.13596475577881948265e-11);
+    cos_poly = _mm256_fmadd_pd(cos_poly, zz, _mm256_set1_pd(2.08757232129817482790e-09));
+    cos_poly = _mm256_fmadd_pd(cos_poly, zz, _mm256_set1_pd(-2.75573143513906633035e-07));
+    cos_poly = _mm256_fmadd_pd(cos_poly, zz, _mm256_set1_pd(2.48015872894767294178e-05));
+    cos_poly = _mm256_fmadd_pd(cos_poly, zz, _mm256_set1_pd(-1.38888888888741095749e-03));
+    cos_poly = _mm256_fmadd_pd(cos_poly, zz, _mm256_set1_pd(4.16666666666666019037e-02));
+    const __m256d cos_z = _mm256_fmadd_pd(_mm256_mul_pd(cos_poly, zz), zz,
+                                          _mm256_fnmadd_pd(_mm256_set1_pd(0.5), zz,
+                                                           _mm256_set1_pd(1.0)));
+
+    // Odd quadrants swap sin and cos, the sign follows the quadrant.
+    const __m256i q = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(quadrant));
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i two = _mm256_set1_epi64x(2);
+    const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(q, one), one));
+    const __m256d sin_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(q, two), 62));
+    const __m256d cos_sign = _mm256_castsi256_pd(
+                                 _mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(q, one), two),
+                                                   62));
+
+    sin_x = _mm256_xor_pd(_mm256_blendv_pd(sin_z, cos_z, swap), sin_sign);
+    cos_x = _mm256_xor_pd(_mm256_blendv_pd(cos_z, sin_z, swap), cos_sign);
+}
+
+__attribute__((target("avx2,fma")))
+inline void geodetic_to_ecef_4(const double *latitude_deg, const double *longitude_deg,
+                               const double *altitude_m, __m256d &x, __m256d &y, __m256d &z)
+{
+    const __m256d deg_to_rad = _mm256_set1_pd(DEG_TO_RAD);
+    const __m256d latitude = _mm256_mul_pd(_mm256_loadu_pd(latitude_deg), deg_to_rad);
+    const __m256d longitude = _mm256_mul_pd(_mm256_loadu_pd(longitude_deg), deg_to_rad);
+    const __m256d altitude = _mm256_loadu_pd(altitude_m);
+
+    __m256d sin_latitude, cos_latitude, sin_longitude, cos_longitude;
+    sincos_avx2(latitude, sin_latitude, cos_latitude);
+    sincos_avx2(longitude, sin_longitude, cos_longitude);
+
+    // Prime vertical radius of curvature.
+    const __m256d e2 = _mm256_set1_pd(WGS84_ECCENTRICITY_SQUARED);
+    const __m256d n = _mm256_div_pd(
+                          _mm256_set1_pd(WGS84_SEMI_MAJOR_AXIS_M),
+                          _mm256_sqrt_pd(_mm256_fnmadd_pd(_mm256_mul_pd(e2, sin_latitude),
+                                                          sin_latitude, _mm256_set1_pd(1.0))));
+
+    const __m256d horizontal = _mm256_mul_pd(_mm256_add_pd(n, altitude), cos_latitude);
+    x = _mm256_mul_pd(horizontal, cos_longitude);
+    y = _mm256_mul_pd(horizontal, sin_longitude);
+    z = _mm256_mul_pd(_mm256_fmadd_pd(n, _mm256_set1_pd(1.0 - WGS84_ECCENTRICITY_SQUARED),
+                                      altitude),
+                      sin_latitude);
+}
+
+// Calls process(inputs, outputs) for blocks of four points, the last block is
+// padded so that every point goes through the same SIMD code.
+template<typename Process>
+inline void for_blocks_of_4(size_t count, const double *in_0, const double *in_1,
+                            const double *in_2, double *out_0, double *out_1, double *out_2,
+                            Process process)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        process(in_0 + i, in_1 + i, in_2 + i, out_0 + i, out_1 + i, out_2 + i);
+    }
+
+    if (i < count) {
+        const size_t rest = count - i;
+        double in[3][4] = {};
+        double out[3][4];
+        memcpy(in[0], in_0 + i, rest * sizeof(double));
+        memcpy(in[1], in_1 + i, rest * sizeof(double));
+        memcpy(in[2], in_2 + i, rest * sizeof(double));
+        process(in[0], in[1], in[2], out[0], out[1], out[2]);
+        memcpy(out_0 + i, out[0], rest * sizeof(double));
+        memcpy(out_1 + i, out[1], rest * sizeof(double));
+        memcpy(out_2 + i, out[2], rest * sizeof(double));
+    }
+}
+
+#endif
+
+} // namespace
+
+namespace geodesy_kernels {
+
+bool avx2_supported()
+{
+#ifdef GEODESY_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void geodetic_to_ecef_scalar(size_t count,
+                             const double *latitude_deg, const double *longitude_deg,
+                             const double *altitude_m,
+                             double *x_m, double *y_m, double *z_m)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const double sin_latitude = std::sin(latitude_deg[i] * DEG_TO_RAD);
+        const double cos_latitude = std::cos(latitude_deg[i] * DEG_TO_RAD);
+        const double sin_longitude = std::sin(longitude_deg[i] * DEG_TO_RAD);
+        const double cos_longitude = std::cos(longitude_deg[i] * DEG_TO_RAD);
+
+        // Prime vertical radius of curvature.
+        const double n = WGS84_SEMI_MAJOR_AXIS_M /
+                         std::sqrt(1.0 - WGS84_ECCENTRICITY_SQUARED * sin_latitude * sin_latitude);
+
+        x_m[i] = (n + altitude_m[i]) * cos_latitude * cos_longitude;
+        y_m[i] = (n + altitude_m[i]) * cos_latitude * sin_longitude;
+        z_m[i] = (n * (1.0 - WGS84_ECCENTRICITY_SQUARED) + altitude_m[i]) * sin_latitude;
+    }
+}
+
+void geodetic_to_ned_scalar(const LocalTangentPlane::Frame &frame, size_t count,
+                            const double *latitude_deg, const double *longitude_deg,
+                            const double *altitude_m,
+                            double *north_m, double *east_m, double *down_m)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double x_m, y_m, z_m;
+        geodetic_to_ecef_scalar(1, latitude_deg + i, longitude_deg + i, altitude_m + i,
+                                &x_m, &y_m, &z_m);
+        rotate(frame, x_m, y_m, z_m, north_m[i], east_m[i], down_m[i]);
+    }
+}
+
+#ifdef GEODESY_AVX2
+
+__attribute__((target("avx2,fma")))
+void geodetic_to_ecef_avx2(size_t count,
+                           const double *latitude_deg, const double *longitude_deg,
+                           const double *altitude_m,
+                           double *x_m, double *y_m, double *z_m)
+{
+    if (!avx2_supported()) {
+        geodetic_to_ecef_scalar(count, latitude_deg, longitude_deg, altitude_m, x_m, y_m, z_m);
+        return;
+    }
+
+    for_blocks_of_4(count, latitude_deg, longitude_deg, altitude_m, x_m, y_m, z_m,
+                    [](const double * lat, const double * lon, const double * alt,
+                       double * x_out, double * y_out, double * z_out)
+                    __attribute__((target("avx2,fma"))) {
+        __m256d x, y, z;
+        geodetic_to_ecef_4(lat, lon, alt, x, y, z);
+        _mm256_storeu_pd(x_out, x);
+        _mm256_storeu_pd(y_out, y);
+        _mm256_storeu_pd(z_out, z);
+    });
+}
+
+__attribute__((target("avx2,fma")))
+void geodetic_to_ned_avx2(const LocalTangentPlane::Frame &frame, size_t count,
+                          const double *latitude_deg, const double *longitude_deg,
+                          const double *altitude_m,
+                          double *north_m, double *east_m, double *down_m)
+{
+    if (!avx2_supported()) {
+        geodetic_to_ned_scalar(frame, count, latitude_deg, longitude_deg, altitude_m,
+                               north_m, east_m, down_m);
+        return;
+    }
+
+    const __m256d origin_x = _mm256_set1_pd(frame.origin[0]);
+    const __m256d origin_y = _mm256_set1_pd(frame.origin[1]);
+    const __m256d origin_z = _mm256_set1_pd(frame.origin[2]);
+    __m256d rotation[3][3];
+    for (unsigned row = 0; row < 3; ++row) {
+        for (unsigned column = 0; column < 3; ++column) {
+            rotation[row][column] = _mm256_set1_pd(frame.rotation[row][column]);
+        }
+    }
+
+    for_blocks_of_4(count, latitude_deg, longitude_deg, altitude_m, north_m, east_m, down_m,
+                    [&](const double * lat, const double * lon, const double * alt,
+                        double * north_out, double * east_out, double * down_out)
+                    __attribute__((target("avx2,fma"))) {
+        __m256d x, y, z;
+        geodetic_to_ecef_4(lat, lon, alt, x, y, z);
+        x = _mm256_sub_pd(x, origin_x);
+        y = _mm256_sub_pd(y, origin_y);
+        z = _mm256_sub_pd(z, origin_z);
+
+        double *out[3] = {north_out, east_out, down_out};
+        for (unsigned row = 0; row < 3; ++row) {
+            const __m256d value = _mm256_fmadd_pd(
+                                      rotation[row][0], x,
+                                      _mm256_fmadd_pd(rotation[row][1], y,
+                                                      _mm256_mul_pd(rotation[row][2], z)));
+            _mm256_storeu_pd(out[row], value);
+        }
+    });
+}
+
+#else
+
+void geodetic_to_ecef_avx2(size_t count,
+                           const double *latitude_deg, const double *longitude_deg,
+                           const double *altitude_m,
+                           double *x_m, double *y_m, double *z_m)
+{
+    geodetic_to_ecef_scalar(count, latitude_deg, longitude_deg, altitude_m, x_m, y_m, z_m);
+}
+
+void geodetic_to_ned_avx2(const LocalTangentPlane::Frame &frame, size_t count,
+                          const double *latitude_deg, const double *longitude_deg,
+                          const double *altitude_m,
+                          double *north_m, double *east_m, double *down_m)
+{
+    geodetic_to_ned_scalar(frame, count, latitude_deg, longitude_deg, altitude_m,
+                           north_m, east_m, down_m);
+}
+
+#endif
+
+} // namespace geodesy_kernels
+
+EcefPosition geodetic_to_ecef(const GeodeticPosition &geodetic)
+{
+    EcefPosition ecef;
+    geodesy_kernels::geodetic_to_ecef_scalar(1, &geodetic.latitude_deg, &geodetic.longitude_deg,
+                                             &geodetic.altitude_m,
+                                             &ecef.x_m, &ecef.y_m, &ecef.z_m);
+    return ecef;
+}
+
+GeodeticPosition ecef_to_geodetic(const EcefPosition &ecef)
+{
+    // Closed form solution by Heikkinen (1982), exact for all positions
+    // except very close to the center of the earth.
+    const double a = WGS84_SEMI_MAJOR_AXIS_M;
+    const double b = WGS84_SEMI_MINOR_AXIS_M;
+    const double e2 = WGS84_ECCENTRICITY_SQUARED;
+    const double ep2 = (a * a - b * b) / (b * b);
+
+    const double z = ecef.z_m;
+    const double p2 = ecef.x_m * ecef.x_m + ecef.y_m * ecef.y_m;
+    const double p = std::sqrt(p2);
+
+    const double f = 54.0 * b * b * z * z;
+    const double g = p2 + (1.0 - e2) * z * z - e2 * (a * a - b * b);
+    const double c = e2 * e2 * f * p2 / (g * g * g);
+    const double s = std::cbrt(1.0 + c + std::sqrt(c * c + 2.0 * c));
+    const double k = s + 1.0 + 1.0 / s;
+    const double big_p = f / (3.0 * k * k * g * g);
+    const double q = std::sqrt(1.0 + 2.0 * e2 * e2 * big_p);
+    const double r0 = -(big_p * e2 * p) / (1.0 + q) +
+                      std::sqrt(0.5 * a * a * (1.0 + 1.0 / q) -
+                                big_p * (1.0 - e2) * z * z / (q * (1.0 + q)) -
+                                0.5 * big_p * p2);
+    const double t = p - e2 * r0;
+    const double u = std::sqrt(t * t + z * z);
+    const double v = std::sqrt(t * t + (1.0 - e2) * z * z);
+    const double z0 = b * b * z / (a * v);
+
+    GeodeticPosition geodetic;
+    geodetic.latitude_deg = std::atan2(z + ep2 * z0, p) * RAD_TO_DEG;
+    geodetic.longitude_deg = std::atan2(ecef.y_m, ecef.x_m) * RAD_TO_DEG;
+    geodetic.altitude_m = u * (1.0 - b * b / (a * v));
+    return geodetic;
+}
+
+void geodetic_to_ecef(size_t count,
+                      const double *latitude_deg, const double *longitude_deg,
+                      const double *altitude_m,
+                      double *x_m, double *y_m, double *z_m)
+{
+    if (geodesy_kernels::avx2_supported()) {
+        geodesy_kernels::geodetic_to_ecef_avx2(count, latitude_deg, longitude_deg, altitude_m,
+                                               x_m, y_m, z_m);
+    } else {
+        geodesy_kernels::geodetic_to_ecef_scalar(count, latitude_deg, longitude_deg, altitude_m,
+                                                 x_m, y_m, z_m);
+    }
+}
+
+void ecef_to_geodetic(size_t count,
+                      const double *x_m, const double *y_m, const double *z_m,
+                      double *latitude_deg, double *longitude_deg, double *altitude_m)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const GeodeticPosition geodetic = ecef_to_geodetic(EcefPosition {x_m[i], y_m[i], z_m[i]});
+        latitude_deg[i] = geodetic.latitude_deg;
+        longitude_deg[i] = geodetic.longitude_deg;
+        altitude_m[i] = geodetic.altitude_m;
+    }
+}
+
+double distance_m(double latitude_1_deg, double longitude_1_deg,
+                  double latitude_2_deg, double longitude_2_deg)
+{
+    double distance;
+    distances_and_bearings(latitude_1_deg, longitude_1_deg, 1, &latitude_2_deg,
+                           &longitude_2_deg, &distance, nullptr);
+    return distance;
+}
+
+double bearing_deg(double latitude_1_deg, double longitude_1_deg,
+                   double latitude_2_deg, double longitude_2_deg)
+{
+    double bearing;
+    distances_and_bearings(latitude_1_deg, longitude_1_deg, 1, &latitude_2_deg,
+                           &longitude_2_deg, nullptr, &bearing);
+    return bearing;
+}
+
+void distances_and_bearings(double latitude_deg, double longitude_deg, size_t count,
+                            const double *latitudes_deg, const double *longitudes_deg,
+                            double *distances_m, double *bearings_deg)
+{
+    const double sin_latitude = std::sin(latitude_deg * DEG_TO_RAD);
+    const double cos_latitude = std::cos(latitude_deg * DEG_TO_RAD);
+
+    for (size_t i = 0; i < count; ++i) {
+        const double other_latitude = latitudes_deg[i] * DEG_TO_RAD;
+        const double sin_other_latitude = std::sin(other_latitude);
+        const double cos_other_latitude = std::cos(other_latitude);
+        const double delta_longitude = (longitudes_deg[i] - longitude_deg) * DEG_TO_RAD;
+
+        if (distances_m != nullptr) {
+            // Haversine formula, well-conditioned for small distances.
+            const double sin_half_latitude =
+                std::sin(0.5 * (other_latitude - latitude_deg * DEG_TO_RAD));
+            const double sin_half_longitude = std::sin(0.5 * delta_longitude);
+            const double h = sin_half_latitude * sin_half_latitude +
+                             cos_latitude * cos_other_latitude *
+                             sin_half_longitude * sin_half_longitude;
+            distances_m[i] = 2.0 * MEAN_EARTH_RADIUS_M *
+                             std::atan2(std::sqrt(h), std::sqrt(1.0 - h));
+        }
+
+        if (bearings_deg != nullptr) {
+            const double bearing = std::atan2(std::sin(delta_longitude) * cos_other_latitude,
+                                              cos_latitude * sin_other_latitude -
+                                              sin_latitude * cos_other_latitude *
+                                              std::cos(delta_longitude)) * RAD_TO_DEG;
+            bearings_deg[i] = (bearing < 0.0) ? bearing + 360.0 : bearing;
+        }
+    }
+}
+
+LocalTangentPlane::LocalTangentPlane(const GeodeticPosition &reference) :
+    _reference(reference)
+{
+    const EcefPosition origin = geodetic_to_ecef(reference);
+    _frame.origin[0] = origin.x_m;
+    _frame.origin[1] = origin.y_m;
+    _frame.origin[2] = origin.z_m;
+
+    const double sin_latitude = std::sin(reference.latitude_deg * DEG_TO_RAD);
+    const double cos_latitude = std::cos(reference.latitude_deg * DEG_TO_RAD);
+    const double sin_longitude = std::sin(reference.longitude_deg * DEG_TO_RAD);
+    const double cos_longitude = std::cos(reference.longitude_deg * DEG_TO_RAD);
+
+    // North
+    _frame.rotation[0][0] = -sin_latitude * cos_longitude;
+    _frame.rotation[0][1] = -sin_latitude * sin_longitude;
+    _frame.rotation[0][2] = cos_latitude;
+    // East
+    _frame.rotation[1][0] = -sin_longitude;
+    _frame.rotation[1][1] = cos_longitude;
+    _frame.rotation[1][2] = 0.0;
+    // Down
+    _frame.rotation[2][0] = -cos_latitude * cos_longitude;
+    _frame.rotation[2][1] = -cos_latitude * sin_longitude;
+    _frame.rotation[2][2] = -sin_latitude;
+}
+
+NedPosition LocalTangentPlane::to_ned(const GeodeticPosition &geodetic) const
+{
+    NedPosition ned;
+    geodesy_kernels::geodetic_to_ned_scalar(_frame, 1, &geodetic.latitude_deg,
+                                            &geodetic.longitude_deg, &geodetic.altitude_m,
+                                            &ned.north_m, &ned.east_m, &ned.down_m);
+    return ned;
+}
+
+GeodeticPosition LocalTangentPlane::from_ned(const NedPosition &ned) const
+{
+    return ecef_to_geodetic(rotate_back(_frame, ned));
+}
+
+EnuPosition LocalTangentPlane::to_enu(const GeodeticPosition &geodetic) const
+{
+    const NedPosition ned = to_ned(geodetic);
+    return EnuPosition {ned.east_m, ned.north_m, -ned.down_m};
+}
+
+GeodeticPosition LocalTangentPlane::from_enu(const EnuPosition &enu) const
+{
+    return from_ned(NedPosition {enu.north_m, enu.east_m, -enu.up_m});
+}
+
+void LocalTangentPlane::to_ned(size_t count,
+                               const double *latitude_deg, const double *longitude_deg,
+                               const double *altitude_m,
+                               double *north_m, double *east_m, double *down_m) const
+{
+    if (geodesy_kernels::avx2_supported()) {
+        geodesy_kernels::geodetic_to_ned_avx2(_frame, count, latitude_deg, longitude_deg,
+                                              altitude_m, north_m, east_m, down_m);
+    } else {
+        geodesy_kernels::geodetic_to_ned_scalar(_frame, count, latitude_deg, longitude_deg,
+                                                altitude_m, north_m, east_m, down_m);
+    }
+}
+
+void LocalTangentPlane::from_ned(size_t count,
+                                 const double *north_m, const double *east_m,
+                                 const double *down_m,
+                                 double *latitude_deg, double *longitude_deg,
+                                 double *altitude_m) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        const GeodeticPosition geodetic = from_ned(NedPosition {north_m[i], east_m[i], down_m[i]});
+        latitude_deg[i] = geodetic.latitude_deg;
+        longitude_deg[i] = geodetic.longitude_deg;
+        altitude_m[i] = geodetic.altitude_m;
+    }
+}
+
+void LocalTangentPlane::to_enu(size_t count,
+                               const double *latitude_deg, const double *longitude_deg,
+                               const double *altitude_m,
+                               double *east_m, double *north_m, double *up_m) const
+{
+    to_ned(count, latitude_deg, longitude_deg, altitude_m, north_m, east_m, up_m);
+    for (size_t i = 0; i < count; ++i) {
+        up_m[i] = -up_m[i];
+    }
+}
+
+void LocalTangentPlane::from_enu(size_t count,
+                                 const double *east_m, const double *north_m, const double *up_m,
+                                 double *latitude_deg, double *longitude_deg,
+                                 double *altitude_m) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        const GeodeticPosition geodetic = from_enu(EnuPosition {east_m[i], north_m[i], up_m[i]});
+        latitude_deg[i] = geodetic.latitude_deg;
+        longitude_deg[i] = geodetic.longitude_deg;
+        altitude_m[i] = geodetic.altitude_m;
+    }
+}
+
+} // namespace dronecore
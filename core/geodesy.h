@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dronecore {
+
+// Conversions between geodetic (WGS84 latitude, longitude, altitude above the
+// ellipsoid), earth-centered earth-fixed (ECEF) and local tangent plane (NED
+// and ENU) coordinates.
+//
+// Every conversion exists for a single point and for arrays of points. The
+// array versions take one array per component (structure of arrays) so that
+// they can be processed with SIMD; on x86-64 CPUs with AVX2 and FMA the
+// conversions from geodetic coordinates do four points per instruction.
+
+struct GeodeticPosition {
+    double latitude_deg;
+    double longitude_deg;
+    double altitude_m;
+};
+
+struct EcefPosition {
+    double x_m;
+    double y_m;
+    double z_m;
+};
+
+struct NedPosition {
+    double north_m;
+    double east_m;
+    double down_m;
+};
+
+struct EnuPosition {
+    double east_m;
+    double north_m;
+    double up_m;
+};
+
+// WGS84 ellipsoid.
+constexpr double WGS84_SEMI_MAJOR_AXIS_M = 6378137.0;
+constexpr double WGS84_FLATTENING = 1.0 / 298.257223563;
+constexpr double WGS84_SEMI_MINOR_AXIS_M = WGS84_SEMI_MAJOR_AXIS_M * (1.0 - WGS84_FLATTENING);
+constexpr double WGS84_ECCENTRICITY_SQUARED = WGS84_FLATTENING * (2.0 - WGS84_FLATTENING);
+
+// Radius of the sphere used for great circle distances.
+constexpr double MEAN_EARTH_RADIUS_M = 6371008.8;
+
+EcefPosition geodetic_to_ecef(const GeodeticPosition &geodetic);
+GeodeticPosition ecef_to_geodetic(const EcefPosition &ecef);
+
+void geodetic_to_ecef(size_t count,
+                      const double *latitude_deg, const double *longitude_deg,
+                      const double *altitude_m,
+                      double *x_m, double *y_m, double *z_m);
+void ecef_to_geodetic(size_t count,
+                      const double *x_m, const double *y_m, const double *z_m,
+                      double *latitude_deg, double *longitude_deg, double *altitude_m);
+
+// Great circle distance and initial bearing (0..360 degrees, clockwise from
+// north) from the first to the second position, ignoring the altitude.
+double distance_m(double latitude_1_deg, double longitude_1_deg,
+                  double latitude_2_deg, double longitude_2_deg);
+double bearing_deg(double latitude_1_deg, double longitude_1_deg,
+                   double latitude_2_deg, double longitude_2_deg);
+
+// Great circle distances and bearings from one position to many.
+void distances_and_bearings(double latitude_deg, double longitude_deg, size_t count,
+                            const double *latitudes_deg, const double *longitudes_deg,
+                            double *distances_m, double *bearings_deg);
+
+// Local tangent plane (north, east, down or east, north, up) touching the
+// ellipsoid at a reference position. This is exact, unlike projections on a
+// sphere, so it can also be used far away from the reference.
+class LocalTangentPlane
+{
+public:
+    explicit LocalTangentPlane(const GeodeticPosition &reference);
+    ~LocalTangentPlane() = default;
+
+    const GeodeticPosition &reference() const { return _reference; }
+
+    NedPosition to_ned(const GeodeticPosition &geodetic) const;
+    GeodeticPosition from_ned(const NedPosition &ned) const;
+
+    EnuPosition to_enu(const GeodeticPosition &geodetic) const;
+    GeodeticPosition from_enu(const EnuPosition &enu) const;
+
+    void to_ned(size_t count,
+                const double *latitude_deg, const double *longitude_deg, const double *altitude_m,
+                double *north_m, double *east_m, double *down_m) const;
+    void from_ned(size_t count,
+                  const double *north_m, const double *east_m, const double *down_m,
+                  double *latitude_deg, double *longitude_deg, double *altitude_m) const;
+
+    void to_enu(size_t count,
+                const double *latitude_deg, const double *longitude_deg, const double *altitude_m,
+                double *east_m, double *north_m, double *up_m) const;
+    void from_enu(size_t count,
+                  const double *east_m, const double *north_m, const double *up_m,
+                  double *latitude_deg, double *longitude_deg, double *altitude_m) const;
+
+    // ECEF position of the reference and rotation from ECEF to NED, the rows
+    // of the rotation are the north, east and down axes.
+    struct Frame {
+        double origin[3];
+        double rotation[3][3];
+    };
+
+    const Frame &frame() const { return _frame; }
+
+private:
+    GeodeticPosition _reference;
+    Frame _frame {};
+};
+
+} // namespace dronecore
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "geodesy.h"
+#include <cstddef>
+
+namespace dronecore {
+
+// Array kernels behind the geodesy functions, exposed to compare the SIMD
+// and scalar versions in tests and benchmarks. Use the functions in geodesy.h
+// instead, they pick the fastest kernel the CPU supports.
+namespace geodesy_kernels {
+
+// True if the AVX2 kernels are compiled in and the CPU supports AVX2 and FMA.
+// Without that, the *_avx2 functions fall back to the scalar ones.
+bool avx2_supported();
+
+void geodetic_to_ecef_scalar(size_t count,
+                             const double *latitude_deg, const double *longitude_deg,
+                             const double *altitude_m,
+                             double *x_m, double *y_m, double *z_m);
+void geodetic_to_ecef_avx2(size_t count,
+                           const double *latitude_deg, const double *longitude_deg,
+                           const double *altitude_m,
+                           double *x_m, double *y_m, double *z_m);
+
+void geodetic_to_ned_scalar(const LocalTangentPlane::Frame &frame, size_t count,
+                            const double *latitude_deg, const double *longitude_deg,
+                            const double *altitude_m,
+                            double *north_m, double *east_m, double *down_m);
+void geodetic_to_ned_avx2(const LocalTangentPlane::Frame &frame, size_t count,
+                          const double *latitude_deg, const double *longitude_deg,
+                          const double *altitude_m,
+                          double *north_m, double *east_m, double *down_m);
+
+} // namespace geodesy_kernels
+
+} // namespace dronecore
@@ -0,0 +1,214 @@
+#include "geodesy.h"
+#include "geodesy_kernels.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace dronecore;
+
+TEST(Geodesy, KnownEcefPositions)
+{
+    EcefPosition ecef = geodetic_to_ecef(GeodeticPosition {0.0, 0.0, 0.0});
+    EXPECT_NEAR(ecef.x_m, WGS84_SEMI_MAJOR_AXIS_M, 1e-6);
+    EXPECT_NEAR(ecef.y_m, 0.0, 1e-6);
+    EXPECT_NEAR(ecef.z_m, 0.0, 1e-6);
+
+    ecef = geodetic_to_ecef(GeodeticPosition {90.0, 0.0, 100.0});
+    EXPECT_NEAR(ecef.x_m, 0.0, 1e-6);
+    EXPECT_NEAR(ecef.z_m, WGS84_SEMI_MINOR_AXIS_M + 100.0, 1e-6);
+
+    ecef = geodetic_to_ecef(GeodeticPosition {45.0, 45.0, 0.0});
+    const double n = WGS84_SEMI_MAJOR_AXIS_M / std::sqrt(1.0 - 0.5 * WGS84_ECCENTRICITY_SQUARED);
+    EXPECT_NEAR(ecef.x_m, 0.5 * n, 1e-6);
+    EXPECT_NEAR(ecef.y_m, 0.5 * n, 1e-6);
+    EXPECT_NEAR(ecef.z_m, n * (1.0 - WGS84_ECCENTRICITY_SQUARED) * std::sqrt(0.5), 1e-6);
+}
+
+TEST(Geodesy, EcefRoundTrip)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> latitude(-89.99, 89.99);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::uniform_real_distribution<double> altitude(-500.0, 50000.0);
+
+    for (unsigned i = 0; i < 10000; ++i) {
+        const GeodeticPosition geodetic {latitude(generator), longitude(generator),
+                                         altitude(generator)};
+        const GeodeticPosition result = ecef_to_geodetic(geodetic_to_ecef(geodetic));
+        // 1e-9 degrees are about 0.1 mm.
+        ASSERT_NEAR(result.latitude_deg, geodetic.latitude_deg, 1e-9);
+        ASSERT_NEAR(result.longitude_deg, geodetic.longitude_deg, 1e-9);
+        ASSERT_NEAR(result.altitude_m, geodetic.altitude_m, 1e-6);
+    }
+}
+
+TEST(Geodesy, LocalTangentPlane)
+{
+    const GeodeticPosition reference {47.3977419, 8.5455938, 488.0};
+    const LocalTangentPlane plane(reference);
+
+    NedPosition ned = plane.to_ned(reference);
+    EXPECT_NEAR(ned.north_m, 0.0, 1e-6);
+    EXPECT_NEAR(ned.east_m, 0.0, 1e-6);
+    EXPECT_NEAR(ned.down_m, 0.0, 1e-6);
+
+    ned = plane.to_ned(GeodeticPosition {reference.latitude_deg, reference.longitude_deg, 588.0});
+    EXPECT_NEAR(ned.north_m, 0.0, 1e-6);
+    EXPECT_NEAR(ned.east_m, 0.0, 1e-6);
+    EXPECT_NEAR(ned.down_m, -100.0, 1e-6);
+
+    // About 111 m north and 75 m east, the earth curves away by about 1.4 mm.
+    ned = plane.to_ned(GeodeticPosition {47.3987419, 8.5465938, 488.0});
+    EXPECT_NEAR(ned.north_m, 111.2, 0.1);
+    EXPECT_NEAR(ned.east_m, 75.4, 0.1);
+    EXPECT_NEAR(ned.down_m, 0.0014, 0.001);
+
+    const EnuPosition enu = plane.to_enu(GeodeticPosition {47.3987419, 8.5465938, 488.0});
+    EXPECT_DOUBLE_EQ(enu.east_m, ned.east_m);
+    EXPECT_DOUBLE_EQ(enu.north_m, ned.north_m);
+    EXPECT_DOUBLE_EQ(enu.up_m, -ned.down_m);
+
+    // Also far away from the reference.
+    for (const NedPosition &position : {
+             NedPosition {1000.0, -2000.0, -50.0}, NedPosition {-300000.0, 500000.0, 1000.0}
+         }) {
+        const NedPosition result = plane.to_ned(plane.from_ned(position));
+        EXPECT_NEAR(result.north_m, position.north_m, 1e-6);
+        EXPECT_NEAR(result.east_m, position.east_m, 1e-6);
+        EXPECT_NEAR(result.down_m, position.down_m, 1e-6);
+    }
+}
+
+TEST(Geodesy, BatchMatchesSinglePoint)
+{
+    const LocalTangentPlane plane(GeodeticPosition {-33.8688, 151.2093, 20.0});
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> offset(-0.05, 0.05);
+    std::uniform_real_distribution<double> altitude(0.0, 200.0);
+
+    // Not a multiple of four to cover the padded last block.
+    const size_t count = 1003;
+    std::vector<double> latitude(count), longitude(count), altitude_m(count);
+    for (size_t i = 0; i < count; ++i) {
+        latitude[i] = -33.8688 + offset(generator);
+        longitude[i] = 151.2093 + offset(generator);
+        altitude_m[i] = altitude(generator);
+    }
+
+    std::vector<double> north(count), east(count), down(count);
+    plane.to_ned(count, latitude.data(), longitude.data(), altitude_m.data(),
+                 north.data(), east.data(), down.data());
+
+    std::vector<double> up(count);
+    plane.to_enu(count, latitude.data(), longitude.data(), altitude_m.data(),
+                 east.data(), north.data(), up.data());
+
+    std::vector<double> latitude_back(count), longitude_back(count), altitude_back(count);
+    plane.from_ned(count, north.data(), east.data(), down.data(),
+                   latitude_back.data(), longitude_back.data(), altitude_back.data());
+
+    for (size_t i = 0; i < count; ++i) {
+        const NedPosition ned = plane.to_ned(
+                                    GeodeticPosition {latitude[i], longitude[i], altitude_m[i]});
+        ASSERT_NEAR(north[i], ned.north_m, 1e-6);
+        ASSERT_NEAR(east[i], ned.east_m, 1e-6);
+        ASSERT_NEAR(down[i], ned.down_m, 1e-6);
+        ASSERT_NEAR(up[i], -ned.down_m, 1e-6);
+
+        ASSERT_NEAR(latitude_back[i], latitude[i], 1e-9);
+        ASSERT_NEAR(longitude_back[i], longitude[i], 1e-9);
+        ASSERT_NEAR(altitude_back[i], altitude_m[i], 1e-6);
+    }
+}
+
+TEST(Geodesy, Avx2MatchesScalar)
+{
+    if (!geodesy_kernels::avx2_supported()) {
+        std::cout << "AVX2 not supported, only the scalar kernels are used" << std::endl;
+    }
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> latitude(-90.0, 90.0);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::uniform_real_distribution<double> altitude(-500.0, 10000.0);
+
+    const size_t count = 4097;
+    std::vector<double> latitude_deg(count), longitude_deg(count), altitude_m(count);
+    for (size_t i = 0; i < count; ++i) {
+        latitude_deg[i] = latitude(generator);
+        longitude_deg[i] = longitude(generator);
+        altitude_m[i] = altitude(generator);
+    }
+    // Quadrant boundaries of the argument reduction.
+    latitude_deg[0] = 90.0;
+    latitude_deg[1] = -90.0;
+    longitude_deg[2] = 180.0;
+    longitude_deg[3] = -180.0;
+    longitude_deg[4] = 45.0;
+    longitude_deg[5] = 135.0;
+
+    std::vector<double> scalar[3] = {std::vector<double>(count), std::vector<double>(count),
+                                     std::vector<double>(count)
+                                    };
+    std::vector<double> simd[3] = {std::vector<double>(count), std::vector<double>(count),
+                                   std::vector<double>(count)
+                                  };
+
+    geodesy_kernels::geodetic_to_ecef_scalar(count, latitude_deg.data(), longitude_deg.data(),
+                                             altitude_m.data(), scalar[0].data(),
+                                             scalar[1].data(), scalar[2].data());
+    geodesy_kernels::geodetic_to_ecef_avx2(count, latitude_deg.data(), longitude_deg.data(),
+                                           altitude_m.data(), simd[0].data(), simd[1].data(),
+                                           simd[2].data());
+    for (unsigned axis = 0; axis < 3; ++axis) {
+        for (size_t i = 0; i < count; ++i) {
+            // Sub-millimetre on an earth sized value.
+            ASSERT_NEAR(simd[axis][i], scalar[axis][i], 1e-6) << "axis " << axis << " at " << i;
+        }
+    }
+
+    const LocalTangentPlane plane(GeodeticPosition {47.3977419, 8.5455938, 488.0});
+    geodesy_kernels::geodetic_to_ned_scalar(plane.frame(), count, latitude_deg.data(),
+                                            longitude_deg.data(), altitude_m.data(),
+                                            scalar[0].data(), scalar[1].data(),
+                                            scalar[2].data());
+    geodesy_kernels::geodetic_to_ned_avx2(plane.frame(), count, latitude_deg.data(),
+                                          longitude_deg.data(), altitude_m.data(),
+                                          simd[0].data(), simd[1].data(), simd[2].data());
+    for (unsigned axis = 0; axis < 3; ++axis) {
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_NEAR(simd[axis][i], scalar[axis][i], 1e-6) << "axis " << axis << " at " << i;
+        }
+    }
+}
+
+TEST(Geodesy, DistanceAndBearing)
+{
+    // One degree along a meridian and along the equator.
+    const double one_degree_m = MEAN_EARTH_RADIUS_M * M_PI / 180.0;
+    EXPECT_NEAR(distance_m(0.0, 0.0, 1.0, 0.0), one_degree_m, 1e-6);
+    EXPECT_NEAR(distance_m(0.0, 0.0, 0.0, 1.0), one_degree_m, 1e-6);
+    EXPECT_NEAR(bearing_deg(0.0, 0.0, 1.0, 0.0), 0.0, 1e-9);
+    EXPECT_NEAR(bearing_deg(0.0, 0.0, 0.0, 1.0), 90.0, 1e-9);
+    EXPECT_NEAR(bearing_deg(0.0, 0.0, -1.0, 0.0), 180.0, 1e-9);
+    EXPECT_NEAR(bearing_deg(0.0, 0.0, 0.0, -1.0), 270.0, 1e-9);
+
+    // Short distances agree with the tangent plane to the flattening of the earth.
+    const LocalTangentPlane plane(GeodeticPosition {47.3977419, 8.5455938, 0.0});
+    const NedPosition ned = plane.to_ned(GeodeticPosition {47.3987419, 8.5465938, 0.0});
+    const double distance = distance_m(47.3977419, 8.5455938, 47.3987419, 8.5465938);
+    EXPECT_NEAR(distance, std::hypot(ned.north_m, ned.east_m), 0.005 * distance);
+
+    const double latitudes[] = {47.3987419, 47.3967419};
+    const double longitudes[] = {8.5455938, 8.5455938};
+    double distances[2];
+    double bearings[2];
+    distances_and_bearings(47.3977419, 8.5455938, 2, latitudes, longitudes, distances,
+                           bearings);
+    EXPECT_NEAR(distances[0], distances[1], 1e-3);
+    EXPECT_NEAR(bearings[0], 0.0, 1e-9);
+    EXPECT_NEAR(bearings[1], 180.0, 1e-9);
+}
@@ -0,0 +1,146 @@
+#include "histogram.h"
+#include <cmath>
+
+namespace dronecore {
+
+constexpr unsigned Histogram::SUB_BUCKET_BITS;
+constexpr unsigned Histogram::SUB_BUCKETS;
+constexpr unsigned Histogram::MAX_MAGNITUDE;
+constexpr unsigned Histogram::NUM_BUCKETS;
+
+namespace {
+
+unsigned most_significant_bit(uint64_t value)
+{
+#if defined(WINDOWS)
+    unsigned msb = 0;
+    while (value >>= 1) {
+        ++msb;
+    }
+    return msb;
+#else
+    return 63 - unsigned(__builtin_clzll(value));
+#endif
+}
+
+// There is only ever one writer, so we can save the atomic read-modify-write.
+inline void add_relaxed(std::atomic<uint64_t> &counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+unsigned Histogram::bucket_index(uint64_t value)
+{
+    if (value < SUB_BUCKETS) {
+        return unsigned(value);
+    }
+
+    const unsigned magnitude = most_significant_bit(value);
+    if (magnitude > MAX_MAGNITUDE) {
+        return NUM_BUCKETS - 1;
+    }
+
+    const unsigned sub_bucket = unsigned(value >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+uint64_t Histogram::bucket_lowest_value(unsigned index)
+{
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    const unsigned magnitude = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const unsigned sub_bucket = index % SUB_BUCKETS;
+    return uint64_t(SUB_BUCKETS + sub_bucket) << (magnitude - SUB_BUCKET_BITS);
+}
+
+uint64_t Histogram::bucket_highest_value(unsigned index)
+{
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    const unsigned magnitude = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    return bucket_lowest_value(index) + (uint64_t(1) << (magnitude - SUB_BUCKET_BITS)) - 1;
+}
+
+void Histogram::record(uint64_t value)
+{
+    add_relaxed(_buckets[bucket_index(value)], 1);
+    add_relaxed(_count, 1);
+    add_relaxed(_sum, value);
+    if (value > _max.load(std::memory_order_relaxed)) {
+        _max.store(value, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::add_to(Histogram &other) const
+{
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        const uint64_t bucket = _buckets[i].load(std::memory_order_relaxed);
+        if (bucket > 0) {
+            other._buckets[i].fetch_add(bucket, std::memory_order_relaxed);
+        }
+    }
+    other._count.fetch_add(_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other._sum.fetch_add(_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    const uint64_t max_value = _max.load(std::memory_order_relaxed);
+    uint64_t other_max = other._max.load(std::memory_order_relaxed);
+    while (max_value > other_max &&
+           !other._max.compare_exchange_weak(other_max, max_value, std::memory_order_relaxed)) {}
+}
+
+void Histogram::reset()
+{
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+double Histogram::mean() const
+{
+    const uint64_t num = count();
+    if (num == 0) {
+        return 0.0;
+    }
+    return double(_sum.load(std::memory_order_relaxed)) / double(num);
+}
+
+uint64_t Histogram::percentile(double percent) const
+{
+    const uint64_t num = count();
+    if (num == 0) {
+        return 0;
+    }
+
+    uint64_t target = uint64_t(std::ceil(double(num) * percent / 100.0));
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            const uint64_t highest = bucket_highest_value(i);
+            const uint64_t max_value = max();
+            return (highest < max_value) ? highest : max_value;
+        }
+    }
+
+    return max();
+}
+
+} // namespace dronecore
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace dronecore {
+
+// Log-linear histogram in the spirit of HDR histograms.
+//
+// Values below 8 have their own bucket, above that every power of two is split
+// into 8 buckets, so the relative error of a reported value is at most 12.5 %.
+// Values above 2^40 end up in the last bucket.
+//
+// record() may only be called from one thread at a time but all other methods
+// can be called concurrently.
+class Histogram
+{
+public:
+    Histogram();
+    ~Histogram() = default;
+
+    // delete copy and move constructors and assign operators
+    Histogram(Histogram const &) = delete;            // Copy construct
+    Histogram(Histogram &&) = delete;                 // Move construct
+    Histogram &operator=(Histogram const &) = delete; // Copy assign
+    Histogram &operator=(Histogram &&) = delete;      // Move assign
+
+    void record(uint64_t value);
+
+    // Adds all samples of this histogram to other.
+    void add_to(Histogram &other) const;
+
+    void reset();
+
+    uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return _max.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Returns the highest value equivalent to the requested percentile (0..100).
+    uint64_t percentile(double percent) const;
+
+    static unsigned bucket_index(uint64_t value);
+    static uint64_t bucket_lowest_value(unsigned index);
+    static uint64_t bucket_highest_value(unsigned index);
+
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_MAGNITUDE = 40;
+    static constexpr unsigned NUM_BUCKETS = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+private:
+    std::atomic<uint64_t> _buckets[NUM_BUCKETS];
+    std::atomic<uint64_t> _count {0};
+    std::atomic<uint64_t> _sum {0};
+    std::atomic<uint64_t> _max {0};
+};
+
+} // namespace dronecore
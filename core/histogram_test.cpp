@@ -0,0 +1,68 @@
+#include "histogram.h"
+#include <gtest/gtest.h>
+
+using namespace dronecore;
+
+TEST(Histogram, BucketsCoverAllValues)
+{
+    // Every value needs to lie within the bounds of its bucket.
+    const uint64_t values[] = {0, 1, 7, 8, 9, 15, 16, 17, 100, 1000, 12345, 1000000,
+                               (uint64_t(1) << 40) - 1
+                              };
+
+    for (auto value : values) {
+        const unsigned index = Histogram::bucket_index(value);
+        EXPECT_LT(index, Histogram::NUM_BUCKETS);
+        EXPECT_LE(Histogram::bucket_lowest_value(index), value);
+        EXPECT_GE(Histogram::bucket_highest_value(index), value);
+    }
+
+    EXPECT_EQ(Histogram::bucket_index(uint64_t(1) << 62), Histogram::NUM_BUCKETS - 1);
+}
+
+TEST(Histogram, BucketsAreContiguous)
+{
+    for (unsigned i = 0; i + 1 < Histogram::NUM_BUCKETS; ++i) {
+        EXPECT_EQ(Histogram::bucket_highest_value(i) + 1, Histogram::bucket_lowest_value(i + 1));
+    }
+}
+
+TEST(Histogram, Percentiles)
+{
+    Histogram histogram;
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.percentile(50.0), 0u);
+
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i);
+    }
+
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_EQ(histogram.max(), 1000u);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 500.5);
+
+    // The relative error is bounded by the bucket width.
+    EXPECT_NEAR(double(histogram.percentile(50.0)), 500.0, 500.0 * 0.125);
+    EXPECT_NEAR(double(histogram.percentile(99.0)), 990.0, 990.0 * 0.125);
+    EXPECT_EQ(histogram.percentile(100.0), 1000u);
+}
+
+TEST(Histogram, AddToAndReset)
+{
+    Histogram first;
+    Histogram second;
+    first.record(10);
+    first.record(20);
+    second.record(5000);
+
+    Histogram sum;
+    first.add_to(sum);
+    second.add_to(sum);
+
+    EXPECT_EQ(sum.count(), 3u);
+    EXPECT_EQ(sum.max(), 5000u);
+
+    sum.reset();
+    EXPECT_EQ(sum.count(), 0u);
+    EXPECT_EQ(sum.max(), 0u);
+}
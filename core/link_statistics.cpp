@@ -0,0 +1,117 @@
+#include "link_statistics.h"
+
+namespace dronecore {
+
+constexpr double LinkStatistics::WINDOW_S;
+constexpr unsigned LinkStatistics::HISTORY_LEN;
+
+LinkStatistics::LinkStatistics(uint8_t connection_id, Time &time) :
+    _connection_id(connection_id),
+    _time(time)
+{
+}
+
+LinkStatistics::~LinkStatistics() {}
+
+bool LinkStatistics::record(uint8_t system_id, uint8_t component_id, uint8_t seq,
+                            unsigned frame_len, DroneCore::LinkStats &completed_stats)
+{
+    std::lock_guard<std::mutex> lock(_links_mutex);
+
+    const uint16_t key = uint16_t((system_id << 8) | component_id);
+    auto it = _links.find(key);
+
+    if (it == _links.end()) {
+        Link new_link {};
+        new_link.stats.connection_id = _connection_id;
+        new_link.stats.system_id = system_id;
+        new_link.stats.component_id = component_id;
+        new_link.stats.received = 1;
+        new_link.last_seq = seq;
+        new_link.history = 1;
+        new_link.window_start = _time.steady_time();
+        new_link.window_received = 1;
+        new_link.window_bytes = frame_len;
+        _links.insert(std::make_pair(key, new_link));
+        return false;
+    }
+
+    Link &link = it->second;
+
+    // The sequence number wraps around at 256, so everything less than half of
+    // that ahead is taken as a gap, and everything behind as a late message.
+    const uint8_t ahead = uint8_t(seq - link.last_seq);
+    const uint8_t behind = uint8_t(link.last_seq - seq);
+
+    if (ahead == 0 || (behind > 0 && behind < HISTORY_LEN && (link.history & (1u << behind)))) {
+        ++link.stats.duplicates;
+
+    } else if (behind > 0 && behind < HISTORY_LEN) {
+        // This one was counted as lost when we skipped over it.
+        link.history |= (1u << behind);
+        ++link.stats.reordered;
+        ++link.stats.received;
+        ++link.window_received;
+        if (link.stats.lost > 0) {
+            --link.stats.lost;
+        }
+        if (link.window_lost > 0) {
+            --link.window_lost;
+        }
+        link.window_bytes += frame_len;
+
+    } else if (ahead < 128) {
+        const unsigned gap = ahead - 1u;
+        link.stats.lost += gap;
+        link.window_lost += gap;
+        ++link.stats.received;
+        ++link.window_received;
+        link.window_bytes += frame_len;
+        link.history = (ahead < HISTORY_LEN) ? ((link.history << ahead) | 1u) : 1u;
+        link.last_seq = seq;
+
+    } else {
+        // Too far behind, the sender has probably restarted, so start over
+        // without counting anything as lost.
+        ++link.stats.received;
+        ++link.window_received;
+        link.window_bytes += frame_len;
+        link.history = 1;
+        link.last_seq = seq;
+    }
+
+    const double elapsed_s = _time.elapsed_since_s(link.window_start);
+    if (elapsed_s < WINDOW_S) {
+        return false;
+    }
+
+    complete_window(link, elapsed_s);
+    completed_stats = link.stats;
+    return true;
+}
+
+void LinkStatistics::complete_window(Link &link, double elapsed_s)
+{
+    const uint64_t expected = link.window_received + link.window_lost;
+    link.stats.loss_rate = (expected > 0) ? float(double(link.window_lost) / double(expected)) : 0.0f;
+    link.stats.throughput_bytes_s = double(link.window_bytes) / elapsed_s;
+
+    link.window_start = _time.steady_time();
+    link.window_received = 0;
+    link.window_lost = 0;
+    link.window_bytes = 0;
+}
+
+std::vector<DroneCore::LinkStats> LinkStatistics::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(_links_mutex);
+
+    std::vector<DroneCore::LinkStats> result;
+    result.reserve(_links.size());
+    for (const auto &link : _links) {
+        result.push_back(link.second.stats);
+    }
+    return result;
+}
+
+} // namespace dronecore
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "dronecore.h"
+#include "global_include.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace dronecore {
+
+// Tracks the MAVLink sequence numbers of every sender on one connection to
+// find out how many messages are lost, duplicated or reordered.
+//
+// record() is called from the receive thread, get_stats() from anywhere.
+class LinkStatistics
+{
+public:
+    LinkStatistics(uint8_t connection_id, Time &time);
+    ~LinkStatistics();
+
+    // delete copy and move constructors and assign operators
+    LinkStatistics(LinkStatistics const &) = delete;            // Copy construct
+    LinkStatistics(LinkStatistics &&) = delete;                 // Move construct
+    LinkStatistics &operator=(LinkStatistics const &) = delete; // Copy assign
+    LinkStatistics &operator=(LinkStatistics &&) = delete;      // Move assign
+
+    // Returns true if the window of the link has just been completed, in which
+    // case the stats of the link are copied to completed_stats.
+    bool record(uint8_t system_id, uint8_t component_id, uint8_t seq, unsigned frame_len,
+                DroneCore::LinkStats &completed_stats);
+
+    std::vector<DroneCore::LinkStats> get_stats() const;
+
+    static constexpr double WINDOW_S = 1.0;
+
+    // How far back we remember which sequence numbers were received. A message
+    // older than that is taken as a restart of the sender.
+    static constexpr unsigned HISTORY_LEN = 32;
+
+private:
+    struct Link {
+        DroneCore::LinkStats stats;
+        uint8_t last_seq;
+        // Bit i is set if message last_seq - i has been received.
+        uint32_t history;
+
+        dl_time_t window_start;
+        uint64_t window_received;
+        uint64_t window_lost;
+        uint64_t window_bytes;
+    };
+
+    void complete_window(Link &link, double elapsed_s);
+
+    const uint8_t _connection_id;
+    Time &_time;
+
+    mutable std::mutex _links_mutex {};
+    std::map<uint16_t, Link> _links {};
+};
+
+} // namespace dronecore
@@ -0,0 +1,93 @@
+#include "link_statistics.h"
+#include <gtest/gtest.h>
+
+#ifdef FAKE_TIME
+#define Time FakeTime
+#endif
+
+using namespace dronecore;
+
+namespace {
+
+DroneCore::LinkStats get_link(const LinkStatistics &link_statistics)
+{
+    auto stats = link_statistics.get_stats();
+    EXPECT_EQ(stats.size(), 1u);
+    return stats.empty() ? DroneCore::LinkStats {} : stats[0];
+}
+
+} // namespace
+
+TEST(LinkStatistics, InOrderWithWrapAround)
+{
+    Time time;
+    LinkStatistics link_statistics(3, time);
+    DroneCore::LinkStats completed;
+
+    for (unsigned i = 0; i < 600; ++i) {
+        EXPECT_FALSE(link_statistics.record(1, 1, uint8_t(i + 200), 20, completed));
+    }
+
+    auto stats = get_link(link_statistics);
+    EXPECT_EQ(stats.connection_id, 3u);
+    EXPECT_EQ(stats.received, 600u);
+    EXPECT_EQ(stats.lost, 0u);
+    EXPECT_EQ(stats.duplicates, 0u);
+    EXPECT_EQ(stats.reordered, 0u);
+}
+
+TEST(LinkStatistics, GapsDuplicatesAndReordering)
+{
+    Time time;
+    LinkStatistics link_statistics(0, time);
+    DroneCore::LinkStats completed;
+
+    const uint8_t sequence[] = {0, 1, 2, 5, 6, 6, 4, 7, 150, 151};
+    for (auto seq : sequence) {
+        link_statistics.record(1, 1, seq, 20, completed);
+    }
+
+    auto stats = get_link(link_statistics);
+    // 3 is missing, 4 came late, then 150 is taken as a restart.
+    EXPECT_EQ(stats.received, 9u);
+    EXPECT_EQ(stats.lost, 1u);
+    EXPECT_EQ(stats.duplicates, 1u);
+    EXPECT_EQ(stats.reordered, 1u);
+}
+
+TEST(LinkStatistics, SeparatesComponents)
+{
+    Time time;
+    LinkStatistics link_statistics(0, time);
+    DroneCore::LinkStats completed;
+
+    link_statistics.record(1, 1, 10, 20, completed);
+    link_statistics.record(1, 100, 50, 20, completed);
+    link_statistics.record(1, 1, 11, 20, completed);
+    link_statistics.record(1, 100, 51, 20, completed);
+
+    auto stats = link_statistics.get_stats();
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[0].lost, 0u);
+    EXPECT_EQ(stats[1].lost, 0u);
+}
+
+TEST(LinkStatistics, WindowRates)
+{
+    Time time;
+    LinkStatistics link_statistics(0, time);
+    DroneCore::LinkStats completed;
+
+    // Every 4th message goes missing.
+    bool window_completed = false;
+    for (unsigned i = 0; i < 80 && !window_completed; ++i) {
+        if (i % 4 != 3) {
+            window_completed = link_statistics.record(1, 1, uint8_t(i), 100, completed);
+        }
+        time.sleep_for(std::chrono::milliseconds(20));
+    }
+
+    ASSERT_TRUE(window_completed);
+    EXPECT_NEAR(completed.loss_rate, 0.25f, 0.03f);
+    EXPECT_NEAR(completed.throughput_bytes_s, 3750.0, 200.0);
+}
@@ -3,6 +3,7 @@
 
 #include <queue>
 #include <mutex>
+#include <utility>
 
 namespace dronecore {
 
@@ -20,7 +21,7 @@ public:
     {
         std::lock_guard<std::mutex> lock(_mutex);
 
-        _queue.push_back(item);
+        _queue.push_back(std::move(item));
     }
 
     T &front()
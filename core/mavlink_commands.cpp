@@ -20,7 +20,7 @@ namespace dronecore {
 MavlinkCommands::MavlinkCommands(DeviceImpl *parent) :
     _parent(parent)
 {
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_COMMAND_ACK,
         std::bind(&MavlinkCommands::receive_command_ack,
                   this, std::placeholders::_1), this);
@@ -89,12 +89,55 @@ void MavlinkCommands::queue_command_async(uint16_t command,
                                   0,
                                   params.v[0], params.v[1], params.v[2], params.v[3],
                                   params.v[4], params.v[5], params.v[6]);
-    new_work.callback = callback;
+    new_work.callback = std::move(callback);
     new_work.mavlink_command = command;
-    _work_queue.push_back(new_work);
+    _work_queue.push_back(std::move(new_work));
 }
 
-void MavlinkCommands::receive_command_ack(mavlink_message_t message)
+void MavlinkCommands::queue_command_batch_async(uint16_t command,
+                                                const std::vector<Params> &params,
+                                                uint8_t target_system_id,
+                                                uint8_t target_component_id,
+                                                command_result_callback_t callback)
+{
+    if (params.empty()) {
+        if (callback) {
+            callback(Result::SUCCESS, 1.0f);
+        }
+        return;
+    }
+
+    Work new_work {};
+    new_work.mavlink_messages.resize(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+        mavlink_msg_command_long_pack(_parent->get_own_system_id(),
+                                      _parent->get_own_component_id(),
+                                      &new_work.mavlink_messages[i],
+                                      target_system_id,
+                                      target_component_id,
+                                      command,
+                                      0,
+                                      params[i].v[0], params[i].v[1], params[i].v[2],
+                                      params[i].v[3], params[i].v[4], params[i].v[5],
+                                      params[i].v[6]);
+    }
+    new_work.callback = std::move(callback);
+    new_work.mavlink_command = command;
+    _work_queue.push_back(std::move(new_work));
+}
+
+bool MavlinkCommands::send_work(Work &work)
+{
+    if (work.mavlink_messages.empty()) {
+        return _parent->send_message(work.mavlink_message);
+    }
+
+    // A retransmission is acked all over again.
+    work.acks_missing = work.mavlink_messages.size();
+    return _parent->send_messages(work.mavlink_messages.data(), work.mavlink_messages.size());
+}
+
+void MavlinkCommands::receive_command_ack(const MavlinkMessageView &view)
 {
     // If nothing is in the queue, we ignore the message all together.
     if (_work_queue.size() == 0) {
@@ -103,19 +146,25 @@ void MavlinkCommands::receive_command_ack(mavlink_message_t message)
 
     Work &work = _work_queue.front();
 
-    mavlink_command_ack_t command_ack;
-    mavlink_msg_command_ack_decode(&message, &command_ack);
+    const uint16_t command = view.get(&mavlink_command_ack_t::command);
+    const uint8_t progress = view.get(&mavlink_command_ack_t::progress);
 
-    // LogDebug() << "We got an ack: " << command_ack.command;
+    // LogDebug() << "We got an ack: " << command;
 
-    if (work.mavlink_command != command_ack.command) {
+    if (work.mavlink_command != command) {
         // If the command does not match with our current command, ignore it.
         LogWarn() << "Command ack not matching our current command: " << work.mavlink_command;
         return;
     }
 
     std::lock_guard<std::mutex> lock(_state_mutex);
-    switch (command_ack.result) {
+
+    if (!work.mavlink_messages.empty()) {
+        receive_batch_ack(work, view.get(&mavlink_command_ack_t::result));
+        return;
+    }
+
+    switch (view.get(&mavlink_command_ack_t::result)) {
         case MAV_RESULT_ACCEPTED:
             _state = State::DONE;
             if (work.callback) {
@@ -156,14 +205,14 @@ void MavlinkCommands::receive_command_ack(mavlink_message_t message)
             break;
 
         case MAV_RESULT_IN_PROGRESS:
-            if (static_cast<int>(command_ack.progress) != 255) {
-                LogInfo() << "progress: " << static_cast<int>(command_ack.progress)
+            if (static_cast<int>(progress) != 255) {
+                LogInfo() << "progress: " << static_cast<int>(progress)
                           << " % (" << work.mavlink_command << ").";
             }
             // FIXME: We can only call callbacks with promises once, so let's not do it
             //        on IN_PROGRESS.
             //if (work.callback) {
-            //    work.callback(Result::IN_PROGRESS, command_ack.progress / 100.0f);
+            //    work.callback(Result::IN_PROGRESS, progress / 100.0f);
             //}
             _state = State::IN_PROGRESS;
             // If we get a progress update, we can raise the timeout
@@ -179,6 +228,30 @@ void MavlinkCommands::receive_command_ack(mavlink_message_t message)
     }
 }
 
+void MavlinkCommands::receive_batch_ack(Work &work, uint8_t result)
+{
+    // The final ack of a command in progress is still to come.
+    if (_state != State::WAITING || work.acks_missing == 0 || result == MAV_RESULT_IN_PROGRESS) {
+        return;
+    }
+
+    if (result != MAV_RESULT_ACCEPTED && work.batch_result == Result::SUCCESS) {
+        LogWarn() << "command of batch not accepted (" << work.mavlink_command << ").";
+        work.batch_result = Result::COMMAND_DENIED;
+    }
+
+    // Only done once the acks of all commands are in, so none of them
+    // completes a command queued after the batch.
+    if (--work.acks_missing > 0) {
+        return;
+    }
+
+    _state = (work.batch_result == Result::SUCCESS) ? State::DONE : State::FAILED;
+    if (work.callback) {
+        work.callback(work.batch_result, (_state == State::DONE) ? 1.0f : NAN);
+    }
+}
+
 void MavlinkCommands::receive_timeout()
 {
     // If nothing is in the queue, we ignore the timeout.
@@ -197,7 +270,7 @@ void MavlinkCommands::receive_timeout()
             LogInfo() << "sending again, retries to do: " << work.retries_to_do
                       << "  (" << work.mavlink_command << ").";
             // We're not sure the command arrived, let's retransmit.
-            if (!_parent->send_message(work.mavlink_message)) {
+            if (!send_work(work)) {
                 LogErr() << "connection send error in retransmit (" << work.mavlink_command << ").";
                 if (work.callback) {
                     work.callback(Result::CONNECTION_ERROR, NAN);
@@ -258,7 +331,7 @@ void MavlinkCommands::do_work()
     switch (_state) {
         case State::NONE:
             // LogDebug() << "sending it the first time (" << work.mavlink_command << ")";
-            if (!_parent->send_message(work.mavlink_message)) {
+            if (!send_work(work)) {
                 LogErr() << "connection send error (" << work.mavlink_command << ")";
                 if (work.callback) {
                     work.callback(Result::CONNECTION_ERROR, NAN);
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "mavlink_include.h"
+#include "mavlink_message_view.h"
+#include "delegate.h"
 #include "locked_queue.h"
 #include <cstdint>
 #include <string>
 #include <functional>
 #include <mutex>
+#include <vector>
 
 namespace dronecore {
 
@@ -27,7 +30,7 @@ public:
         IN_PROGRESS
     };
 
-    typedef std::function<void(Result, float)> command_result_callback_t;
+    typedef Delegate<void(Result, float)> command_result_callback_t;
 
     struct Params {
         float v[7];
@@ -44,6 +47,15 @@ public:
                              uint8_t target_component_id,
                              command_result_callback_t callback);
 
+    // Queues several commands with the same id which are sent at once. The acks
+    // only tell which command they are for, so nothing else is in flight until
+    // all of them are in. The callback gets the first failure, if any.
+    void queue_command_batch_async(uint16_t command,
+                                   const std::vector<Params> &params,
+                                   uint8_t target_system_id,
+                                   uint8_t target_component_id,
+                                   command_result_callback_t callback);
+
     void do_work();
 
     static const int DEFAULT_COMPONENT_ID_AUTOPILOT = 1;
@@ -67,10 +79,16 @@ private:
         double timeout_s = 0.5;
         uint16_t mavlink_command = 0;
         mavlink_message_t mavlink_message {};
+        // Instead of mavlink_message for batches, with the acks still to come.
+        std::vector<mavlink_message_t> mavlink_messages {};
+        size_t acks_missing = 0;
+        Result batch_result = Result::SUCCESS;
         command_result_callback_t callback {};
     };
 
-    void receive_command_ack(mavlink_message_t message);
+    bool send_work(Work &work);
+    void receive_command_ack(const MavlinkMessageView &view);
+    void receive_batch_ack(Work &work, uint8_t result);
     void receive_timeout();
 
     DeviceImpl *_parent;
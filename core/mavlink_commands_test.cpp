@@ -0,0 +1,64 @@
+#include "mavlink_commands.h"
+#include "device_impl.h"
+#include "dronecore_impl.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+void ack(DeviceImpl &device_impl, uint16_t command, uint8_t result)
+{
+    mavlink_command_ack_t command_ack {};
+    command_ack.command = command;
+    command_ack.result = result;
+    mavlink_message_t message;
+    mavlink_msg_command_ack_encode(1, MavlinkCommands::DEFAULT_COMPONENT_ID_AUTOPILOT, &message,
+                                   &command_ack);
+    device_impl.process_mavlink_message(message);
+}
+
+} // namespace
+
+TEST(MavlinkCommands, BatchAcksDoNotCompleteOtherCommands)
+{
+    DroneCoreImpl dronecore_impl;
+    DeviceImpl device_impl(&dronecore_impl, 1);
+    MavlinkCommands commands(&device_impl);
+
+    std::vector<MavlinkCommands::Result> single_results;
+    std::vector<MavlinkCommands::Result> batch_results;
+    const MavlinkCommands::Params params {{31.0f, 1000.0f, NAN, NAN, NAN, NAN, NAN}};
+
+    commands.queue_command_async(MAV_CMD_SET_MESSAGE_INTERVAL, params, 1, 1,
+    [&single_results](MavlinkCommands::Result result, float) {
+        single_results.push_back(result);
+    });
+    commands.queue_command_batch_async(MAV_CMD_SET_MESSAGE_INTERVAL, {params, params, params}, 1,
+                                       1, [&batch_results](MavlinkCommands::Result result, float) {
+        batch_results.push_back(result);
+    });
+
+    // Only the single command is in flight, its ack is not taken by the batch.
+    commands.do_work();
+    ack(device_impl, MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(single_results.size(), 1u);
+    EXPECT_EQ(single_results[0], MavlinkCommands::Result::SUCCESS);
+    EXPECT_TRUE(batch_results.empty());
+
+    // The batch is done once all of its commands are acked.
+    commands.do_work();
+    ack(device_impl, MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    ack(device_impl, MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_DENIED);
+    EXPECT_TRUE(batch_results.empty());
+    ack(device_impl, MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(batch_results.size(), 1u);
+    EXPECT_EQ(batch_results[0], MavlinkCommands::Result::COMMAND_DENIED);
+
+    // Nothing is left to be completed by a stray ack.
+    commands.do_work();
+    ack(device_impl, MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    EXPECT_EQ(single_results.size(), 1u);
+    EXPECT_EQ(batch_results.size(), 1u);
+}
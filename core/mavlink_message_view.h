@@ -0,0 +1,86 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace dronecore {
+
+// Read-only view of a received message which stays in the receive buffer.
+//
+// Instead of decoding the whole message into a mavlink_*_t struct, the fields
+// which are needed are read in place using the struct members to find them:
+//
+//     const int32_t lat = view.get(&mavlink_global_position_int_t::lat);
+//
+// The payload of a MAVLink 2 message is truncated after the last non-zero
+// byte, so everything beyond the received length reads as zero, just like
+// the mavlink_msg_*_decode functions do.
+//
+// A view is only valid as long as the message it was created from.
+class MavlinkMessageView
+{
+public:
+    explicit MavlinkMessageView(const mavlink_message_t &message) :
+        _message(message)
+    {}
+
+    uint32_t msgid() const { return _message.msgid; }
+    uint8_t sysid() const { return _message.sysid; }
+    uint8_t compid() const { return _message.compid; }
+    uint8_t seq() const { return _message.seq; }
+
+    const uint8_t *payload() const
+    {
+        return reinterpret_cast<const uint8_t *>(_MAV_PAYLOAD(&_message));
+    }
+    uint8_t payload_len() const { return _message.len; }
+
+    // For handlers which still want the whole message.
+    const mavlink_message_t &message() const { return _message; }
+
+    template<typename Struct, typename Field>
+    Field get(Field Struct::*field) const
+    {
+        Field value;
+        read(offset_of(field), &value, sizeof(value));
+        return value;
+    }
+
+    // For array members such as the text of a STATUSTEXT.
+    template<typename Struct, typename Field, size_t N>
+    void copy(Field(Struct::*field)[N], Field(&values)[N]) const
+    {
+        read(offset_of(field), values, sizeof(values));
+    }
+
+    // Reads len bytes at offset of the payload, zero-extended past its end.
+    void read(size_t offset, void *dest, size_t len) const
+    {
+        size_t available = 0;
+        if (offset < _message.len) {
+            available = size_t(_message.len) - offset;
+            if (available > len) {
+                available = len;
+            }
+            memcpy(dest, payload() + offset, available);
+        }
+        memset(static_cast<uint8_t *>(dest) + available, 0, len - available);
+    }
+
+    // The mavlink_*_t structs are packed in the order of the payload, so the
+    // offset of a member in the struct is its offset in the payload.
+    template<typename Struct, typename Field>
+    static size_t offset_of(Field Struct::*field)
+    {
+        static const Struct layout {};
+        return size_t(reinterpret_cast<const uint8_t *>(&(layout.*field)) -
+                      reinterpret_cast<const uint8_t *>(&layout));
+    }
+
+private:
+    const mavlink_message_t &_message;
+};
+
+} // namespace dronecore
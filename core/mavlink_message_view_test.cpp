@@ -0,0 +1,94 @@
+#include "mavlink_message_view.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+using namespace dronecore;
+
+namespace {
+
+// Puts the struct into the payload like the parser would, with len bytes of it.
+template<typename Struct>
+mavlink_message_t make_message(uint32_t msgid, const Struct &payload, uint8_t len)
+{
+    mavlink_message_t message {};
+    message.msgid = msgid;
+    message.sysid = 1;
+    message.compid = 2;
+    message.seq = 3;
+    message.len = len;
+    memcpy(_MAV_PAYLOAD_NON_CONST(&message), &payload, len);
+    return message;
+}
+
+} // namespace
+
+TEST(MavlinkMessageView, ReadsFieldsInPlace)
+{
+    mavlink_global_position_int_t global_position_int {};
+    global_position_int.lat = 473977418;
+    global_position_int.lon = 85455939;
+    global_position_int.relative_alt = -1234;
+    global_position_int.vz = -5;
+    global_position_int.hdg = 9000;
+
+    const mavlink_message_t message =
+        make_message(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, global_position_int,
+                     sizeof(global_position_int));
+    const MavlinkMessageView view(message);
+
+    EXPECT_EQ(view.msgid(), uint32_t(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+    EXPECT_EQ(view.sysid(), 1);
+    EXPECT_EQ(view.compid(), 2);
+    EXPECT_EQ(view.seq(), 3);
+    EXPECT_EQ(&view.message(), &message);
+
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::lat), 473977418);
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::lon), 85455939);
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::relative_alt), -1234);
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::vz), -5);
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::hdg), 9000);
+}
+
+TEST(MavlinkMessageView, TruncatedPayloadIsZeroExtended)
+{
+    mavlink_global_position_int_t global_position_int {};
+    global_position_int.time_boot_ms = 0xFFFFFFFF;
+    global_position_int.lat = -1;
+    global_position_int.hdg = 9000;
+
+    const size_t lon_offset = MavlinkMessageView::offset_of(&mavlink_global_position_int_t::lon);
+
+    // Cut in the middle of lon, as if its upper bytes were trailing zeros.
+    mavlink_message_t message =
+        make_message(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, global_position_int,
+                     uint8_t(lon_offset + 2));
+    // The parser does not clear what was in the buffer before.
+    memset(_MAV_PAYLOAD_NON_CONST(&message) + lon_offset + 2, 0xAB, 16);
+    const MavlinkMessageView view(message);
+
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::time_boot_ms), 0xFFFFFFFFu);
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::lat), -1);
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::lon), 0);
+    EXPECT_EQ(view.get(&mavlink_global_position_int_t::hdg), 0);
+}
+
+TEST(MavlinkMessageView, CopiesArrays)
+{
+    mavlink_statustext_t statustext {};
+    statustext.severity = MAV_SEVERITY_INFO;
+    strncpy(statustext.text, "Takeoff detected", sizeof(statustext.text));
+
+    // Everything after the text is trailing zeros.
+    const mavlink_message_t message =
+        make_message(MAVLINK_MSG_ID_STATUSTEXT, statustext,
+                     uint8_t(MavlinkMessageView::offset_of(&mavlink_statustext_t::text) + 16));
+    const MavlinkMessageView view(message);
+
+    char text[sizeof(statustext.text)];
+    memset(text, 'x', sizeof(text));
+    view.copy(&mavlink_statustext_t::text, text);
+
+    EXPECT_EQ(view.get(&mavlink_statustext_t::severity), MAV_SEVERITY_INFO);
+    EXPECT_STREQ(text, "Takeoff detected");
+    EXPECT_EQ(text[sizeof(text) - 1], '\0');
+}
@@ -1,48 +1,86 @@
 #include "mavlink_receiver.h"
 #include "global_include.h"
 
-#if DROP_DEBUG ==1
-#include <iomanip>
-#endif
-
 namespace dronecore {
 
 MavlinkReceiver::MavlinkReceiver(uint8_t channel) :
     _channel(channel)
-#if DROP_DEBUG == 1
-    , _last_time()
-#endif
 {
 }
 
+void MavlinkReceiver::set_message_filter(const MessageFilter *filter,
+                                         dropped_callback_t callback,
+                                         bool skip_payload)
+{
+    _message_filter = filter;
+    _dropped_callback = std::move(callback);
+    _skip_payload = skip_payload;
+}
+
 void MavlinkReceiver::set_new_datagram(char *datagram, unsigned datagram_len)
 {
     _datagram = datagram;
     _datagram_len = datagram_len;
 
-#if DROP_DEBUG == 1
-    _bytes_received += _datagram_len;
-#endif
+    _bytes_received += datagram_len;
 }
 
 bool MavlinkReceiver::parse_message()
 {
+    const mavlink_status_t *status = mavlink_get_channel_status(_channel);
+    const mavlink_message_t *rxmsg = mavlink_get_channel_buffer(_channel);
+
     // Note that one datagram can contain multiple mavlink messages.
-    for (unsigned i = 0; i < _datagram_len; ++i) {
-        if (mavlink_parse_char(_channel, _datagram[i], &_last_message, &_status) == 1) {
+    unsigned i = 0;
+    while (i < _datagram_len) {
+
+        const uint8_t c = uint8_t(_datagram[i++]);
+        const mavlink_parse_state_t state_before = status->parse_state;
+        const uint8_t result = mavlink_frame_char(_channel, c, &_last_message, &_status);
+
+        if (result == MAVLINK_FRAMING_OK) {
+
+            if (!is_handled(_last_message)) {
+                drop(_last_message);
+                continue;
+            }
 
             // Move the pointer to the datagram forward by the amount parsed.
-            _datagram += (i + 1);
+            _datagram += i;
             // And decrease the length, so we don't overshoot in the next round.
-            _datagram_len -= (i + 1);
+            _datagram_len -= i;
 
-#if DROP_DEBUG == 1
-            debug_drop_rate();
-#endif
+            ++_messages_received;
 
             // We have parsed one message, let's return so it can be handled.
             return true;
         }
+
+        // The message ID is the last field of the header, for MAVLink 1 it
+        // comes right after the component ID.
+        const bool got_header =
+            (state_before == MAVLINK_PARSE_STATE_GOT_COMPID ||
+             state_before == MAVLINK_PARSE_STATE_GOT_MSGID2) &&
+            (status->parse_state == MAVLINK_PARSE_STATE_GOT_MSGID3 ||
+             status->parse_state == MAVLINK_PARSE_STATE_GOT_PAYLOAD);
+
+        if (result == MAVLINK_FRAMING_BAD_CRC || result == MAVLINK_FRAMING_BAD_SIGNATURE) {
+            ++_crc_errors;
+            reset_after_bad_frame(c);
+
+        } else if (got_header && _skip_payload && !is_handled(*rxmsg) &&
+                   rest_of_frame_length(*rxmsg) <= _datagram_len - i) {
+            // A frame which goes on in the next datagram is parsed as usual
+            // and dropped once it is complete. A datagram transport might
+            // have cut it off, the next datagram is then not skipped blindly.
+            drop(*rxmsg);
+            i += rest_of_frame_length(*rxmsg);
+            skip_rest_of_frame();
+
+        } else if (status->parse_state == MAVLINK_PARSE_STATE_IDLE) {
+            // The byte did not start or continue a frame.
+            ++_parse_errors;
+        }
     }
 
     // No (more) messages, let's give up.
@@ -51,84 +89,68 @@ bool MavlinkReceiver::parse_message()
     return false;
 }
 
-#if DROP_DEBUG == 1
-void MavlinkReceiver::debug_drop_rate()
+bool MavlinkReceiver::is_handled(const mavlink_message_t &message) const
 {
-    if (_last_message.msgid == MAVLINK_MSG_ID_SYS_STATUS) {
-
-        const unsigned msg_len = (_last_message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES);
-
-        _bytes_received -= msg_len;
-
-        mavlink_sys_status_t sys_status;
-        mavlink_msg_sys_status_decode(&_last_message, &sys_status);
-
-
-        if (!_first) {
-
-            LogDebug() << "-------------------------------------------------------------------"
-                       << "-----------";
-
-            if (_bytes_received <= sys_status.errors_comm &&
-                sys_status.errors_count2 <= sys_status.errors_comm) {
-
-                _bytes_sent_overall += sys_status.errors_comm;
-                //_bytes_at_gimbal_overall += sys_status.errors_count1;
-                _bytes_at_camera_overall += sys_status.errors_count2;
-                _bytes_at_sdk_overall += _bytes_received;
+    return _message_filter == nullptr || _message_filter->is_handled(message.msgid);
+}
 
-                _time_elapsed += elapsed_since_s(_last_time);
+void MavlinkReceiver::drop(const mavlink_message_t &header)
+{
+    ++_messages_dropped;
+    _bytes_dropped += frame_length(header);
 
-                print_line("FMU   ", sys_status.errors_comm, sys_status.errors_comm,
-                           _bytes_sent_overall, _bytes_sent_overall);
-                //print_line("Gimbal", sys_status.errors_count1, sys_status.errors_comm,
-                //           _bytes_at_gimbal_overall, _bytes_sent_overall);
-                print_line("Camera", sys_status.errors_count2, sys_status.errors_comm,
-                           _bytes_at_camera_overall, _bytes_sent_overall);
-                print_line("SDK   ", _bytes_received, sys_status.errors_comm,
-                           _bytes_at_sdk_overall, _bytes_sent_overall);
+    if (_dropped_callback) {
+        _dropped_callback(header);
+    }
+}
 
-            } else {
-                LogDebug() << "Missed SYS_STATUS";
-            }
-        }
-        _first = false;
+unsigned MavlinkReceiver::rest_of_frame_length(const mavlink_message_t &header)
+{
+    const unsigned header_len = (header.magic == MAVLINK_STX_MAVLINK1) ?
+                                MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 :
+                                MAVLINK_NUM_HEADER_BYTES;
+    return frame_length(header) - header_len;
+}
 
-        _last_time = steady_time();
+void MavlinkReceiver::skip_rest_of_frame()
+{
+    // A bad frame is also only given up after all of its bytes, so skipping
+    // them does not make it any harder to get back in sync.
+    mavlink_status_t *status = mavlink_get_channel_status(_channel);
+    status->msg_received = MAVLINK_FRAMING_INCOMPLETE;
+    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+}
 
-        // Reset afterwards:
-        _bytes_received = msg_len;
+void MavlinkReceiver::reset_after_bad_frame(uint8_t c)
+{
+    // This is what mavlink_parse_char() does for a bad frame, we only use
+    // mavlink_frame_char() to be able to count the errors.
+    mavlink_status_t *status = mavlink_get_channel_status(_channel);
+    mavlink_message_t *rxmsg = mavlink_get_channel_buffer(_channel);
+
+    ++status->parse_error;
+    status->msg_received = MAVLINK_FRAMING_INCOMPLETE;
+    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+
+    if (c == MAVLINK_STX) {
+        status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+        rxmsg->len = 0;
+        mavlink_start_checksum(rxmsg);
     }
 }
 
-void MavlinkReceiver::print_line(const char *index, unsigned count, unsigned count_total,
-                                 unsigned overall_bytes, unsigned overall_bytes_total)
+unsigned MavlinkReceiver::frame_length(const mavlink_message_t &message)
 {
-    LogDebug() << "count "
-               << index
-               << ": "
-               << std::setw(6)
-               << count
-               << ", loss: "
-               << std::setw(6)
-               << count_total -  count
-               << ",  "
-               << std::setw(6)
-               << std::setprecision(2)
-               << std::fixed
-               << 100.0 * float(count) / float(count_total)
-               << " %, overall: "
-               << std::setw(6)
-               << std::setprecision(2)
-               << std::fixed
-               << (100.0 * double(overall_bytes) / double(overall_bytes_total))
-               << " %, "
-               << std::setw(6)
-               << std::setprecision(2)
-               << std::fixed
-               << (double(overall_bytes) / _time_elapsed / 1024.0)
-               << " KiB/s";
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        // MAVLink 1 has a shorter header.
+        return message.len + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+
+    unsigned length = message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    if (message.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        length += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    return length;
 }
-#endif
 
 } // namespace dronecore
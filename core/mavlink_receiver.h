@@ -2,6 +2,9 @@
 
 #include "mavlink_include.h"
 #include "global_include.h"
+#include "delegate.h"
+#include "message_filter.h"
+#include <atomic>
 #include <cstdint>
 
 namespace dronecore {
@@ -26,36 +29,61 @@ public:
         return _status;
     }
 
+    typedef Delegate<void(const mavlink_message_t &header)> dropped_callback_t;
+
+    // Frames of messages which the filter does not let through are dropped
+    // instead of being returned by parse_message(). The callback still gets
+    // their header, e.g. to keep track of the sequence numbers.
+    //
+    // With skip_payload set, a frame is dropped right after its header and
+    // the rest of it is skipped without being parsed, as long as it is in the
+    // same datagram. The checksum is then never verified, so this is only for
+    // transports which already protect against corruption. Otherwise the
+    // frame is dropped once it is complete.
+    void set_message_filter(const MessageFilter *filter, dropped_callback_t callback,
+                            bool skip_payload);
+
     void set_new_datagram(char *datagram, unsigned datagram_len);
 
     bool parse_message();
 
-#if DROP_DEBUG == 1
-    void debug_drop_rate();
-    void print_line(const char *index, unsigned count, unsigned count_total,
-                    unsigned overall_bytes, unsigned overall_bytes_total);
-#endif
+    // The counters can be read from any thread.
+    uint64_t get_bytes_received() const { return _bytes_received.load(); }
+    uint64_t get_messages_received() const { return _messages_received.load(); }
+    // Bytes which were thrown away because they were not part of a valid frame.
+    uint64_t get_parse_errors() const { return _parse_errors.load(); }
+    // Frames which were dropped because of a wrong checksum or signature.
+    uint64_t get_crc_errors() const { return _crc_errors.load(); }
+    // Frames which were dropped because nothing handles their message.
+    uint64_t get_messages_dropped() const { return _messages_dropped.load(); }
+    uint64_t get_bytes_dropped() const { return _bytes_dropped.load(); }
+
+    // Length of the message on the wire including header, checksum and signature.
+    static unsigned frame_length(const mavlink_message_t &message);
 
 private:
+    void reset_after_bad_frame(uint8_t c);
+    bool is_handled(const mavlink_message_t &message) const;
+    void drop(const mavlink_message_t &header);
+    static unsigned rest_of_frame_length(const mavlink_message_t &header);
+    void skip_rest_of_frame();
+
     uint8_t _channel;
     mavlink_message_t _last_message = {};
     mavlink_status_t _status = {};
     char *_datagram = nullptr;
     unsigned _datagram_len = 0;
 
-#if DROP_DEBUG == 1
-    unsigned _bytes_received = 0;
-
-    unsigned _bytes_sent_overall = 0;
-    //unsigned _bytes_at_gimbal_overall = 0;
-    unsigned _bytes_at_camera_overall = 0;
-    unsigned _bytes_at_sdk_overall = 0;
-
-    bool _first = true;
-    dl_time_t _last_time;
+    const MessageFilter *_message_filter = nullptr;
+    dropped_callback_t _dropped_callback {};
+    bool _skip_payload = false;
 
-    double _time_elapsed = 0.0;
-#endif
+    std::atomic<uint64_t> _bytes_received {0};
+    std::atomic<uint64_t> _messages_received {0};
+    std::atomic<uint64_t> _parse_errors {0};
+    std::atomic<uint64_t> _crc_errors {0};
+    std::atomic<uint64_t> _messages_dropped {0};
+    std::atomic<uint64_t> _bytes_dropped {0};
 };
 
 } // namespace dronecore
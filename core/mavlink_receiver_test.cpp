@@ -0,0 +1,191 @@
+#include "mavlink_receiver.h"
+#include "mavlink_channels.h"
+#include "message_filter.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+void append(std::vector<char> &bytes, const mavlink_message_t &message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+    bytes.insert(bytes.end(), buffer, buffer + len);
+}
+
+// Alternating heartbeats and positions.
+std::vector<char> heartbeats_and_positions(unsigned count, unsigned &position_frame_len)
+{
+    std::vector<char> bytes;
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_message_t message;
+
+        mavlink_heartbeat_t heartbeat {};
+        heartbeat.custom_mode = i;
+        mavlink_msg_heartbeat_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &heartbeat);
+        append(bytes, message);
+
+        mavlink_global_position_int_t global_position_int {};
+        global_position_int.lat = 473977418;
+        global_position_int.lon = 85455939;
+        mavlink_msg_global_position_int_encode(1, MAV_COMP_ID_AUTOPILOT1, &message,
+                                               &global_position_int);
+        append(bytes, message);
+        position_frame_len = MavlinkReceiver::frame_length(message);
+    }
+    return bytes;
+}
+
+class MavlinkReceiverTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(MavlinkChannels::Instance().checkout_free_channel(_channel));
+        _receiver.reset(new MavlinkReceiver(_channel));
+    }
+
+    void TearDown() override
+    {
+        _receiver.reset();
+        MavlinkChannels::Instance().checkin_used_channel(_channel);
+    }
+
+    // Hands the bytes over in datagrams of datagram_len and returns the IDs
+    // of the messages which came out.
+    std::vector<uint32_t> parse(std::vector<char> &bytes, unsigned datagram_len)
+    {
+        std::vector<uint32_t> message_ids;
+        for (size_t offset = 0; offset < bytes.size(); offset += datagram_len) {
+            const unsigned len = unsigned(std::min(size_t(datagram_len), bytes.size() - offset));
+            _receiver->set_new_datagram(&bytes[offset], len);
+            while (_receiver->parse_message()) {
+                message_ids.push_back(_receiver->get_last_message().msgid);
+            }
+        }
+        return message_ids;
+    }
+
+    void set_filter(bool skip_payload)
+    {
+        _receiver->set_message_filter(&_filter, [this](const mavlink_message_t & header) {
+            _dropped_ids.push_back(header.msgid);
+        }, skip_payload);
+    }
+
+    void expect_positions_dropped(unsigned datagram_len)
+    {
+        unsigned position_frame_len;
+        auto bytes = heartbeats_and_positions(10, position_frame_len);
+        const std::vector<uint32_t> message_ids = parse(bytes, datagram_len);
+
+        ASSERT_EQ(message_ids.size(), 10u);
+        for (auto message_id : message_ids) {
+            EXPECT_EQ(message_id, uint32_t(MAVLINK_MSG_ID_HEARTBEAT));
+        }
+        ASSERT_EQ(_dropped_ids.size(), 10u);
+        for (auto message_id : _dropped_ids) {
+            EXPECT_EQ(message_id, uint32_t(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+        }
+
+        EXPECT_EQ(_receiver->get_messages_received(), 10u);
+        EXPECT_EQ(_receiver->get_messages_dropped(), 10u);
+        EXPECT_EQ(_receiver->get_bytes_dropped(), 10u * position_frame_len);
+        EXPECT_EQ(_receiver->get_parse_errors(), 0u);
+        EXPECT_EQ(_receiver->get_crc_errors(), 0u);
+    }
+
+    uint8_t _channel {0};
+    std::unique_ptr<MavlinkReceiver> _receiver {};
+    MessageFilter _filter {};
+    std::vector<uint32_t> _dropped_ids {};
+};
+
+} // namespace
+
+TEST_F(MavlinkReceiverTest, WithoutFilterEverythingComesOut)
+{
+    unsigned position_frame_len;
+    auto bytes = heartbeats_and_positions(10, position_frame_len);
+
+    EXPECT_EQ(parse(bytes, 1400).size(), 20u);
+    EXPECT_EQ(_receiver->get_messages_received(), 20u);
+    EXPECT_EQ(_receiver->get_messages_dropped(), 0u);
+}
+
+TEST_F(MavlinkReceiverTest, DropsUnhandledMessagesAfterChecksum)
+{
+    _filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+    set_filter(false);
+    expect_positions_dropped(1400);
+}
+
+TEST_F(MavlinkReceiverTest, SkipsUnhandledMessagesAfterHeader)
+{
+    _filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+    set_filter(true);
+    expect_positions_dropped(1400);
+}
+
+TEST_F(MavlinkReceiverTest, ParsesSkippedFramesSplitOverDatagrams)
+{
+    _filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+    set_filter(true);
+    // Most frames go on in the next datagram, so they are not skipped.
+    expect_positions_dropped(7);
+}
+
+TEST_F(MavlinkReceiverTest, CutOffFrameIsParsedLikeWithoutSkipping)
+{
+    _filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+
+    unsigned position_frame_len;
+    const auto bytes = heartbeats_and_positions(1, position_frame_len);
+    const size_t heartbeat_frame_len = bytes.size() - position_frame_len;
+
+    // A heartbeat and a position which is cut off after its header, then
+    // datagrams with a heartbeat each.
+    std::vector<std::vector<char>> datagrams {
+        std::vector<char>(bytes.begin(), bytes.begin() + heartbeat_frame_len + 12)
+    };
+    for (unsigned i = 0; i < 5; ++i) {
+        datagrams.emplace_back(bytes.begin(), bytes.begin() + heartbeat_frame_len);
+    }
+
+    std::vector<uint32_t> message_ids[2];
+    uint64_t messages_dropped[2];
+    for (unsigned skip_payload = 0; skip_payload < 2; ++skip_payload) {
+        _receiver.reset(new MavlinkReceiver(_channel));
+        set_filter(skip_payload == 1);
+        for (auto &datagram : datagrams) {
+            const std::vector<uint32_t> ids = parse(datagram, 1400);
+            message_ids[skip_payload].insert(message_ids[skip_payload].end(), ids.begin(),
+                                             ids.end());
+        }
+        messages_dropped[skip_payload] = _receiver->get_messages_dropped();
+    }
+
+    // The rest of the position is not looked for in the next datagram
+    // without being parsed.
+    EXPECT_EQ(message_ids[1], message_ids[0]);
+    EXPECT_EQ(messages_dropped[1], messages_dropped[0]);
+    EXPECT_GE(message_ids[1].size(), 3u);
+}
+
+TEST_F(MavlinkReceiverTest, PassAllKeepsEverything)
+{
+    _filter.add(MAVLINK_MSG_ID_HEARTBEAT);
+    _filter.set_pass_all(true);
+    set_filter(true);
+
+    unsigned position_frame_len;
+    auto bytes = heartbeats_and_positions(10, position_frame_len);
+
+    EXPECT_EQ(parse(bytes, 1400).size(), 20u);
+    EXPECT_EQ(_receiver->get_messages_dropped(), 0u);
+    EXPECT_TRUE(_dropped_ids.empty());
+}
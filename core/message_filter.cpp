@@ -0,0 +1,30 @@
+#include "message_filter.h"
+
+namespace dronecore {
+
+constexpr uint32_t MessageFilter::NUM_IDS;
+
+MessageFilter::MessageFilter()
+{
+    for (auto &word : _words) {
+        word.store(0);
+    }
+}
+
+MessageFilter::~MessageFilter() {}
+
+void MessageFilter::add(uint32_t message_id)
+{
+    if (message_id >= NUM_IDS) {
+        return;
+    }
+    _words[message_id / 64].fetch_or(uint64_t(1) << (message_id % 64),
+                                      std::memory_order_release);
+}
+
+void MessageFilter::set_pass_all(bool pass_all)
+{
+    _pass_all.store(pass_all, std::memory_order_release);
+}
+
+} // namespace dronecore
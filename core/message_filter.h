@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace dronecore {
+
+// The set of message IDs which any device has a handler registered for.
+//
+// The receivers look up every frame here as soon as its header is parsed so
+// that messages nobody handles are dropped before they are copied around and
+// dispatched. It is a plain bitmap, so the lookup is a single load.
+//
+// IDs are only ever added. A handler which goes away leaves its ID behind,
+// which just means that a few more messages are parsed than necessary.
+class MessageFilter
+{
+public:
+    MessageFilter();
+    ~MessageFilter();
+
+    // delete copy and move constructors and assign operators
+    MessageFilter(MessageFilter const &) = delete;            // Copy construct
+    MessageFilter(MessageFilter &&) = delete;                 // Move construct
+    MessageFilter &operator=(MessageFilter const &) = delete; // Copy assign
+    MessageFilter &operator=(MessageFilter &&) = delete;      // Move assign
+
+    void add(uint32_t message_id);
+
+    // While set, every message is let through, e.g. while all of them are
+    // being recorded.
+    void set_pass_all(bool pass_all);
+
+    bool is_handled(uint32_t message_id) const
+    {
+        if (_pass_all.load(std::memory_order_acquire)) {
+            return true;
+        }
+        if (message_id >= NUM_IDS) {
+            return false;
+        }
+        const uint64_t word = _words[message_id / 64].load(std::memory_order_acquire);
+        return ((word >> (message_id % 64)) & 1) != 0;
+    }
+
+    // Handlers are registered with 16 bit IDs, anything above is never handled.
+    static constexpr uint32_t NUM_IDS = 65536;
+
+private:
+    std::atomic<uint64_t> _words[NUM_IDS / 64];
+    std::atomic<bool> _pass_all {false};
+};
+
+} // namespace dronecore
@@ -0,0 +1,49 @@
+#include "message_filter.h"
+#include <gtest/gtest.h>
+
+using namespace dronecore;
+
+TEST(MessageFilter, OnlyAddedIdsAreHandled)
+{
+    MessageFilter filter;
+    EXPECT_FALSE(filter.is_handled(0));
+
+    filter.add(0);
+    filter.add(63);
+    filter.add(64);
+    filter.add(MessageFilter::NUM_IDS - 1);
+
+    EXPECT_TRUE(filter.is_handled(0));
+    EXPECT_TRUE(filter.is_handled(63));
+    EXPECT_TRUE(filter.is_handled(64));
+    EXPECT_TRUE(filter.is_handled(MessageFilter::NUM_IDS - 1));
+
+    EXPECT_FALSE(filter.is_handled(1));
+    EXPECT_FALSE(filter.is_handled(65));
+    EXPECT_FALSE(filter.is_handled(MessageFilter::NUM_IDS - 2));
+}
+
+TEST(MessageFilter, IdsBeyondTheTableAreNeverHandled)
+{
+    MessageFilter filter;
+    filter.add(MessageFilter::NUM_IDS);
+    filter.add(0xFFFFFF);
+
+    EXPECT_FALSE(filter.is_handled(MessageFilter::NUM_IDS));
+    EXPECT_FALSE(filter.is_handled(0xFFFFFF));
+    EXPECT_FALSE(filter.is_handled(0));
+}
+
+TEST(MessageFilter, PassAll)
+{
+    MessageFilter filter;
+    filter.add(30);
+
+    filter.set_pass_all(true);
+    EXPECT_TRUE(filter.is_handled(31));
+    EXPECT_TRUE(filter.is_handled(0xFFFFFF));
+
+    filter.set_pass_all(false);
+    EXPECT_TRUE(filter.is_handled(30));
+    EXPECT_FALSE(filter.is_handled(31));
+}
@@ -0,0 +1,246 @@
+#include "message_statistics.h"
+#include "global_include.h"
+#include <chrono>
+
+namespace dronecore {
+
+constexpr unsigned MessageStatistics::MESSAGE_SLOTS;
+constexpr unsigned MessageStatistics::DISPATCH_SLOTS;
+
+namespace {
+
+constexpr uint64_t KEY_USED_BIT = uint64_t(1) << 63;
+
+uint64_t message_key(uint8_t connection_id, uint8_t system_id, uint32_t message_id)
+{
+    return KEY_USED_BIT | (uint64_t(connection_id) << 40) | (uint64_t(system_id) << 32) |
+           message_id;
+}
+
+uint64_t dispatch_key(uint8_t system_id, uint32_t message_id)
+{
+    return KEY_USED_BIT | (uint64_t(system_id) << 32) | message_id;
+}
+
+inline void add_relaxed(std::atomic<uint64_t> &counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+double to_us(uint64_t ns)
+{
+    return double(ns) * 1e-3;
+}
+
+} // namespace
+
+MessageStatistics::MessageStatistics() :
+    _instance_id([]() {
+    static std::atomic<uint64_t> instance_counter {0};
+    return ++instance_counter;
+}())
+{
+}
+
+MessageStatistics::~MessageStatistics() {}
+
+uint64_t MessageStatistics::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MessageStatistics::Shard &MessageStatistics::get_shard()
+{
+    // Cache the shard of this thread so that we only need to take the lock
+    // the first time a thread records something.
+    static thread_local uint64_t cached_instance_id = 0;
+    static thread_local Shard *cached_shard = nullptr;
+
+    if (cached_instance_id == _instance_id && cached_shard != nullptr) {
+        return *cached_shard;
+    }
+
+    std::lock_guard<std::mutex> lock(_shards_mutex);
+
+    auto &shard = _shards[std::this_thread::get_id()];
+    if (!shard) {
+        shard.reset(new Shard());
+    }
+
+    cached_instance_id = _instance_id;
+    cached_shard = shard.get();
+    return *cached_shard;
+}
+
+template<typename Slot>
+Slot *MessageStatistics::find_or_insert(Slot *slots, unsigned num_slots, uint64_t key)
+{
+    // Fibonacci hashing with linear probing, num_slots is a power of two.
+    unsigned index = unsigned((key * 0x9E3779B97F4A7C15ull) >> 32) & (num_slots - 1);
+
+    for (unsigned probe = 0; probe < num_slots; ++probe) {
+        Slot &slot = slots[index];
+        const uint64_t slot_key = slot.key.load(std::memory_order_relaxed);
+
+        if (slot_key == key) {
+            return &slot;
+        }
+
+        if (slot_key == 0) {
+            // Only the owning thread inserts, readers only look at used slots.
+            slot.key.store(key, std::memory_order_release);
+            return &slot;
+        }
+
+        index = (index + 1) & (num_slots - 1);
+    }
+
+    return nullptr;
+}
+
+void MessageStatistics::record_message(uint8_t connection_id, uint8_t system_id,
+                                       uint32_t message_id, unsigned frame_len)
+{
+    Shard &shard = get_shard();
+
+    MessageCounter *counter = find_or_insert(shard.messages, MESSAGE_SLOTS,
+                                             message_key(connection_id, system_id, message_id));
+    if (counter == nullptr) {
+        add_relaxed(shard.untracked, 1);
+        return;
+    }
+
+    add_relaxed(counter->count, 1);
+    add_relaxed(counter->bytes, frame_len);
+
+    // Keep a moving average of the interval between messages to get the rate.
+    const uint64_t now = now_ns();
+    const uint64_t last_time = counter->last_time_ns.load(std::memory_order_relaxed);
+    if (last_time != 0 && now > last_time) {
+        const uint64_t interval = now - last_time;
+        const uint64_t mean_interval = counter->mean_interval_ns.load(std::memory_order_relaxed);
+        counter->mean_interval_ns.store(
+            (mean_interval == 0) ? interval : (mean_interval * 7 + interval) / 8,
+            std::memory_order_relaxed);
+    }
+    counter->last_time_ns.store(now, std::memory_order_relaxed);
+}
+
+void MessageStatistics::record_dispatch(uint8_t system_id, uint32_t message_id,
+                                        uint64_t duration_ns)
+{
+    Shard &shard = get_shard();
+
+    DispatchCounter *counter = find_or_insert(shard.dispatches, DISPATCH_SLOTS,
+                                              dispatch_key(system_id, message_id));
+    if (counter == nullptr) {
+        add_relaxed(shard.untracked, 1);
+        return;
+    }
+
+    counter->duration_ns.record(duration_ns);
+}
+
+std::vector<DroneCore::MessageStats> MessageStatistics::get_message_stats() const
+{
+    // Sum up the same key of different threads.
+    std::map<uint64_t, DroneCore::MessageStats> aggregated;
+    const uint64_t now = now_ns();
+
+    std::lock_guard<std::mutex> lock(_shards_mutex);
+
+    for (const auto &shard : _shards) {
+        for (unsigned i = 0; i < MESSAGE_SLOTS; ++i) {
+            const MessageCounter &counter = shard.second->messages[i];
+            const uint64_t key = counter.key.load(std::memory_order_acquire);
+            if (key == 0) {
+                continue;
+            }
+
+            auto it = aggregated.find(key);
+            if (it == aggregated.end()) {
+                DroneCore::MessageStats new_stats {};
+                new_stats.connection_id = unsigned((key >> 40) & 0xFF);
+                new_stats.system_id = uint8_t((key >> 32) & 0xFF);
+                new_stats.message_id = uint32_t(key & 0xFFFFFF);
+                it = aggregated.insert(std::make_pair(key, new_stats)).first;
+            }
+
+            DroneCore::MessageStats &stats = it->second;
+            stats.messages += counter.count.load(std::memory_order_relaxed);
+            stats.bytes += counter.bytes.load(std::memory_order_relaxed);
+
+            // If the stream stops, the rate needs to go down even without new messages.
+            const uint64_t mean_interval = counter.mean_interval_ns.load(std::memory_order_relaxed);
+            const uint64_t last_time = counter.last_time_ns.load(std::memory_order_relaxed);
+            const uint64_t since_last = (now > last_time) ? now - last_time : 0;
+            if (mean_interval > 0) {
+                stats.rate_hz += 1e9 / double(MAX(mean_interval, since_last));
+            }
+        }
+    }
+
+    std::vector<DroneCore::MessageStats> result;
+    result.reserve(aggregated.size());
+    for (const auto &entry : aggregated) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+std::vector<DroneCore::DispatchStats> MessageStatistics::get_dispatch_stats() const
+{
+    std::map<uint64_t, std::unique_ptr<Histogram>> aggregated;
+
+    {
+        std::lock_guard<std::mutex> lock(_shards_mutex);
+
+        for (const auto &shard : _shards) {
+            for (unsigned i = 0; i < DISPATCH_SLOTS; ++i) {
+                const DispatchCounter &counter = shard.second->dispatches[i];
+                const uint64_t key = counter.key.load(std::memory_order_acquire);
+                if (key == 0) {
+                    continue;
+                }
+
+                auto &histogram = aggregated[key];
+                if (!histogram) {
+                    histogram.reset(new Histogram());
+                }
+                counter.duration_ns.add_to(*histogram);
+            }
+        }
+    }
+
+    std::vector<DroneCore::DispatchStats> result;
+    result.reserve(aggregated.size());
+    for (const auto &entry : aggregated) {
+        const Histogram &histogram = *entry.second;
+
+        DroneCore::DispatchStats stats {};
+        stats.system_id = uint8_t((entry.first >> 32) & 0xFF);
+        stats.message_id = uint32_t(entry.first & 0xFFFFFF);
+        stats.calls = histogram.count();
+        stats.mean_us = histogram.mean() * 1e-3;
+        stats.p50_us = to_us(histogram.percentile(50.0));
+        stats.p90_us = to_us(histogram.percentile(90.0));
+        stats.p99_us = to_us(histogram.percentile(99.0));
+        stats.max_us = to_us(histogram.max());
+        result.push_back(stats);
+    }
+    return result;
+}
+
+uint64_t MessageStatistics::get_num_untracked() const
+{
+    std::lock_guard<std::mutex> lock(_shards_mutex);
+
+    uint64_t untracked = 0;
+    for (const auto &shard : _shards) {
+        untracked += shard.second->untracked.load(std::memory_order_relaxed);
+    }
+    return untracked;
+}
+
+} // namespace dronecore
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "dronecore.h"
+#include "histogram.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dronecore {
+
+// Always-on counters for received messages and the time spent dispatching
+// them to the plugins.
+//
+// Every thread that records gets its own shard of fixed size tables, so the
+// hot path neither locks nor allocates. The shards are only summed up when
+// the statistics are read.
+class MessageStatistics
+{
+public:
+    MessageStatistics();
+    ~MessageStatistics();
+
+    // delete copy and move constructors and assign operators
+    MessageStatistics(MessageStatistics const &) = delete;            // Copy construct
+    MessageStatistics(MessageStatistics &&) = delete;                 // Move construct
+    MessageStatistics &operator=(MessageStatistics const &) = delete; // Copy assign
+    MessageStatistics &operator=(MessageStatistics &&) = delete;      // Move assign
+
+    void record_message(uint8_t connection_id, uint8_t system_id, uint32_t message_id,
+                        unsigned frame_len);
+
+    void record_dispatch(uint8_t system_id, uint32_t message_id, uint64_t duration_ns);
+
+    std::vector<DroneCore::MessageStats> get_message_stats() const;
+    std::vector<DroneCore::DispatchStats> get_dispatch_stats() const;
+
+    // Messages and dispatches which did not fit into the tables anymore.
+    uint64_t get_num_untracked() const;
+
+    static constexpr unsigned MESSAGE_SLOTS = 1024;
+    static constexpr unsigned DISPATCH_SLOTS = 128;
+
+private:
+    struct MessageCounter {
+        // 0 means the slot is unused.
+        std::atomic<uint64_t> key {0};
+        std::atomic<uint64_t> count {0};
+        std::atomic<uint64_t> bytes {0};
+        std::atomic<uint64_t> last_time_ns {0};
+        std::atomic<uint64_t> mean_interval_ns {0};
+    };
+
+    struct DispatchCounter {
+        std::atomic<uint64_t> key {0};
+        Histogram duration_ns {};
+    };
+
+    struct Shard {
+        MessageCounter messages[MESSAGE_SLOTS];
+        DispatchCounter dispatches[DISPATCH_SLOTS];
+        std::atomic<uint64_t> untracked {0};
+    };
+
+    Shard &get_shard();
+
+    static uint64_t now_ns();
+
+    template<typename Slot>
+    static Slot *find_or_insert(Slot *slots, unsigned num_slots, uint64_t key);
+
+    const uint64_t _instance_id;
+
+    mutable std::mutex _shards_mutex {};
+    std::map<std::thread::id, std::unique_ptr<Shard>> _shards {};
+};
+
+} // namespace dronecore
@@ -0,0 +1,74 @@
+#include "message_statistics.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace dronecore;
+
+TEST(MessageStatistics, CountsPerStream)
+{
+    MessageStatistics statistics;
+
+    for (unsigned i = 0; i < 10; ++i) {
+        statistics.record_message(0, 1, 30, 40);
+    }
+    statistics.record_message(0, 2, 30, 40);
+    statistics.record_message(1, 1, 30, 40);
+
+    auto stats = statistics.get_message_stats();
+    ASSERT_EQ(stats.size(), 3u);
+
+    bool found = false;
+    for (const auto &stream : stats) {
+        if (stream.connection_id == 0 && stream.system_id == 1 && stream.message_id == 30) {
+            EXPECT_EQ(stream.messages, 10u);
+            EXPECT_EQ(stream.bytes, 400u);
+            EXPECT_GT(stream.rate_hz, 0.0);
+            found = true;
+        } else {
+            EXPECT_EQ(stream.messages, 1u);
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(MessageStatistics, AggregatesThreads)
+{
+    MessageStatistics statistics;
+
+    auto record = [&statistics]() {
+        for (unsigned i = 0; i < 1000; ++i) {
+            statistics.record_message(0, 1, 33, 40);
+            statistics.record_dispatch(1, 33, 1000 + i);
+        }
+    };
+
+    std::thread first(record);
+    std::thread second(record);
+    first.join();
+    second.join();
+
+    auto messages = statistics.get_message_stats();
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].messages, 2000u);
+
+    auto dispatch = statistics.get_dispatch_stats();
+    ASSERT_EQ(dispatch.size(), 1u);
+    EXPECT_EQ(dispatch[0].system_id, 1);
+    EXPECT_EQ(dispatch[0].message_id, 33u);
+    EXPECT_EQ(dispatch[0].calls, 2000u);
+    EXPECT_LE(dispatch[0].p50_us, dispatch[0].p99_us);
+    EXPECT_LE(dispatch[0].p99_us, dispatch[0].max_us);
+    EXPECT_NEAR(dispatch[0].max_us, 1.999, 1e-9);
+}
+
+TEST(MessageStatistics, CountsUntracked)
+{
+    MessageStatistics statistics;
+
+    for (unsigned i = 0; i < MessageStatistics::MESSAGE_SLOTS + 5; ++i) {
+        statistics.record_message(0, 1, i, 10);
+    }
+
+    EXPECT_EQ(statistics.get_message_stats().size(), MessageStatistics::MESSAGE_SLOTS);
+    EXPECT_EQ(statistics.get_num_untracked(), 5u);
+}
@@ -0,0 +1,157 @@
+#include "realtime_sender.h"
+#include "log.h"
+#include <cmath>
+
+#ifndef WINDOWS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dronecore {
+
+constexpr double RealtimeSender::MIN_RATE_HZ;
+constexpr double RealtimeSender::MAX_RATE_HZ;
+constexpr int64_t RealtimeSender::SPIN_NS;
+constexpr int RealtimeSender::REALTIME_PRIORITY;
+
+namespace {
+
+int64_t to_ns(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               time.time_since_epoch()).count();
+}
+
+} // namespace
+
+RealtimeSender::RealtimeSender() {}
+
+RealtimeSender::~RealtimeSender()
+{
+    stop();
+}
+
+bool RealtimeSender::start(double rate_hz, tick_callback_t callback)
+{
+    if (!(rate_hz >= MIN_RATE_HZ && rate_hz <= MAX_RATE_HZ)) {
+        LogErr() << "Invalid rate for real-time sender: " << rate_hz;
+        return false;
+    }
+
+    if (!callback) {
+        LogErr() << "No callback for real-time sender";
+        return false;
+    }
+
+    stop();
+
+    _callback = callback;
+    _rate_hz.store(rate_hz, std::memory_order_relaxed);
+    _jitter_ns.reset();
+    _interval_ns.reset();
+    _num_ticks.store(0, std::memory_order_relaxed);
+    _num_missed_ticks.store(0, std::memory_order_relaxed);
+    _first_tick_ns.store(0, std::memory_order_relaxed);
+    _last_tick_ns.store(0, std::memory_order_relaxed);
+    _should_stop = false;
+
+    _running.store(true, std::memory_order_release);
+    _thread = std::thread(&RealtimeSender::run, this, int64_t(std::llround(1e9 / rate_hz)));
+    return true;
+}
+
+void RealtimeSender::stop()
+{
+    if (!_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_stop_mutex);
+        _should_stop = true;
+    }
+    _stop_cv.notify_all();
+
+    _thread.join();
+    _running.store(false, std::memory_order_release);
+}
+
+double RealtimeSender::achieved_rate_hz() const
+{
+    const uint64_t num_ticks = _num_ticks.load(std::memory_order_relaxed);
+    const int64_t duration_ns = _last_tick_ns.load(std::memory_order_relaxed) -
+                                _first_tick_ns.load(std::memory_order_relaxed);
+    if (num_ticks < 2 || duration_ns <= 0) {
+        return 0.0;
+    }
+    return double(num_ticks - 1) * 1e9 / double(duration_ns);
+}
+
+void RealtimeSender::run(int64_t period_ns)
+{
+    raise_priority();
+
+    const std::chrono::nanoseconds period(period_ns);
+    const std::chrono::nanoseconds spin(SPIN_NS);
+
+    auto deadline = std::chrono::steady_clock::now();
+    int64_t last_tick_ns = 0;
+
+    while (true) {
+        // Wait in the kernel until shortly before the deadline, the rest is
+        // spun away because waking up is not precise enough.
+        if (!wait_until(deadline - spin)) {
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        while (now < deadline) {
+            std::this_thread::yield();
+            now = std::chrono::steady_clock::now();
+        }
+
+        const int64_t now_ns = to_ns(now);
+        _jitter_ns.record(uint64_t(now_ns - to_ns(deadline)));
+        if (last_tick_ns != 0) {
+            _interval_ns.record(uint64_t(now_ns - last_tick_ns));
+        } else {
+            _first_tick_ns.store(now_ns, std::memory_order_relaxed);
+        }
+        last_tick_ns = now_ns;
+
+        _callback();
+
+        _last_tick_ns.store(now_ns, std::memory_order_relaxed);
+        _num_ticks.fetch_add(1, std::memory_order_relaxed);
+
+        // Stay on the grid of deadlines, skipping the ones we are too late for.
+        deadline += period;
+        now = std::chrono::steady_clock::now();
+        if (now >= deadline + period) {
+            const auto missed = (now - deadline) / period;
+            _num_missed_ticks.fetch_add(uint64_t(missed), std::memory_order_relaxed);
+            deadline += missed * period;
+        }
+    }
+}
+
+bool RealtimeSender::wait_until(std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(_stop_mutex);
+    _stop_cv.wait_until(lock, deadline, [this]() { return _should_stop; });
+    return !_should_stop;
+}
+
+void RealtimeSender::raise_priority()
+{
+#ifndef WINDOWS
+    // This needs privileges which we usually don't have, it's fine to run
+    // without them.
+    sched_param param {};
+    param.sched_priority = REALTIME_PRIORITY;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+        LogDebug() << "Real-time sender runs without real-time priority";
+    }
+#endif
+}
+
+} // namespace dronecore
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "histogram.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace dronecore {
+
+// Calls a function at a fixed rate from a thread of its own, e.g. to stream
+// setpoints.
+//
+// The thread waits until absolute deadlines on the steady clock, so the rate
+// does not drift with the time the callback takes, and spins for the last
+// SPIN_NS before a deadline to keep the wake-up jitter well below a
+// millisecond. Ticks which are more than a period late are skipped instead of
+// being made up in a burst.
+//
+// How late every tick was and the time between ticks are recorded in
+// histograms which can be read at any time.
+class RealtimeSender
+{
+public:
+    typedef std::function<void()> tick_callback_t;
+
+    RealtimeSender();
+    ~RealtimeSender();
+
+    // delete copy and move constructors and assign operators
+    RealtimeSender(RealtimeSender const &) = delete;            // Copy construct
+    RealtimeSender(RealtimeSender &&) = delete;                 // Move construct
+    RealtimeSender &operator=(RealtimeSender const &) = delete; // Copy assign
+    RealtimeSender &operator=(RealtimeSender &&) = delete;      // Move assign
+
+    // Starts calling callback, the first time right away. A running sender is
+    // restarted. Returns false if the rate is out of range.
+    bool start(double rate_hz, tick_callback_t callback);
+
+    // Must not be called from the callback.
+    void stop();
+
+    bool is_running() const { return _running.load(std::memory_order_acquire); }
+
+    double rate_hz() const { return _rate_hz.load(std::memory_order_relaxed); }
+
+    // Rate of the ticks since the last start.
+    double achieved_rate_hz() const;
+
+    uint64_t num_ticks() const { return _num_ticks.load(std::memory_order_relaxed); }
+    uint64_t num_missed_ticks() const { return _num_missed_ticks.load(std::memory_order_relaxed); }
+
+    // Time from the deadline until the callback was called.
+    const Histogram &jitter_ns() const { return _jitter_ns; }
+
+    // Time between the calls of the callback.
+    const Histogram &interval_ns() const { return _interval_ns; }
+
+    static constexpr double MIN_RATE_HZ = 1.0;
+    static constexpr double MAX_RATE_HZ = 1000.0;
+
+    static constexpr int64_t SPIN_NS = 200000;
+
+    // Used if the thread is allowed to run with a real-time policy.
+    static constexpr int REALTIME_PRIORITY = 20;
+
+private:
+    void run(int64_t period_ns);
+
+    // Returns false if the sender is stopped while waiting.
+    bool wait_until(std::chrono::steady_clock::time_point deadline);
+
+    static void raise_priority();
+
+    tick_callback_t _callback {};
+
+    std::thread _thread {};
+    std::atomic<bool> _running {false};
+    std::atomic<double> _rate_hz {0.0};
+
+    // Wakes the thread up early when stopping.
+    std::mutex _stop_mutex {};
+    std::condition_variable _stop_cv {};
+    bool _should_stop = false;
+
+    // Since the first tick, for the achieved rate.
+    std::atomic<int64_t> _first_tick_ns {0};
+    std::atomic<int64_t> _last_tick_ns {0};
+    std::atomic<uint64_t> _num_ticks {0};
+    std::atomic<uint64_t> _num_missed_ticks {0};
+
+    Histogram _jitter_ns {};
+    Histogram _interval_ns {};
+};
+
+} // namespace dronecore
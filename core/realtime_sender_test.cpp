@@ -0,0 +1,74 @@
+#include "realtime_sender.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace dronecore;
+
+TEST(RealtimeSender, TicksAtRate)
+{
+    RealtimeSender sender;
+    std::atomic<unsigned> num_calls {0};
+
+    ASSERT_TRUE(sender.start(200.0, [&num_calls]() { ++num_calls; }));
+    EXPECT_TRUE(sender.is_running());
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    sender.stop();
+    EXPECT_FALSE(sender.is_running());
+
+    // Loose bounds, the test machine might be busy.
+    EXPECT_GT(num_calls, 80u);
+    EXPECT_LE(num_calls, 102u);
+    EXPECT_EQ(sender.num_ticks(), num_calls);
+    EXPECT_NEAR(sender.achieved_rate_hz(), 200.0, 20.0);
+
+    EXPECT_EQ(sender.jitter_ns().count(), num_calls);
+    EXPECT_EQ(sender.interval_ns().count() + 1, num_calls);
+    // The median interval is the period within the resolution of the histogram.
+    EXPECT_NEAR(double(sender.interval_ns().percentile(50.0)), 5e6, 5e6 * 0.125);
+
+    // No more calls after stopping.
+    const unsigned num_calls_stopped = num_calls;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(num_calls, num_calls_stopped);
+}
+
+TEST(RealtimeSender, SkipsMissedTicks)
+{
+    RealtimeSender sender;
+    std::atomic<unsigned> num_calls {0};
+
+    // Every call takes three periods.
+    ASSERT_TRUE(sender.start(100.0, [&num_calls]() {
+        ++num_calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    sender.stop();
+
+    // Missed ticks are not made up.
+    EXPECT_LE(num_calls, 11u);
+    EXPECT_GT(sender.num_missed_ticks(), 10u);
+}
+
+TEST(RealtimeSender, StopsQuicklyAtLowRate)
+{
+    RealtimeSender sender;
+    ASSERT_TRUE(sender.start(1.0, []() {}));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    const auto before = std::chrono::steady_clock::now();
+    sender.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(100));
+    EXPECT_EQ(sender.num_ticks(), 1u);
+}
+
+TEST(RealtimeSender, RejectsInvalidRate)
+{
+    RealtimeSender sender;
+    EXPECT_FALSE(sender.start(0.0, []() {}));
+    EXPECT_FALSE(sender.start(RealtimeSender::MAX_RATE_HZ * 2.0, []() {}));
+    EXPECT_FALSE(sender.start(100.0, nullptr));
+    EXPECT_FALSE(sender.is_running());
+}
@@ -0,0 +1,269 @@
+#include "dronecore_impl.h"
+#include "connection.h"
+#include "flight_recorder.h"
+#include "global_include.h"
+#include "telemetry.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef WINDOWS
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+
+// The replacements below see every allocation of the test runner but only
+// count those of a thread which asked for it.
+thread_local bool counting_allocations = false;
+thread_local uint64_t num_allocations = 0;
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    if (counting_allocations) {
+        ++num_allocations;
+    }
+
+    void *ptr = std::malloc(size > 0 ? size : 1);
+    if (ptr == nullptr) {
+        // Without exceptions there is no std::bad_alloc to throw.
+        std::abort();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+using namespace dronecore;
+
+namespace {
+
+// Hands datagrams to the receive path like the UdpConnection does, but on
+// the calling thread so that its allocations can be counted.
+class FeedConnection : public Connection
+{
+public:
+    explicit FeedConnection(DroneCoreImpl *parent) : Connection(parent) {}
+    ~FeedConnection() { stop(); }
+
+    DroneCore::ConnectionResult start()
+    {
+        return start_mavlink_receiver() ? DroneCore::ConnectionResult::SUCCESS :
+               DroneCore::ConnectionResult::CONNECTIONS_EXHAUSTED;
+    }
+
+    DroneCore::ConnectionResult stop()
+    {
+        stop_mavlink_receiver();
+        return DroneCore::ConnectionResult::SUCCESS;
+    }
+
+    bool is_ok() const { return true; }
+
+    bool send_message(const mavlink_message_t &message)
+    {
+        UNUSED(message);
+        return true;
+    }
+
+    void feed(const std::vector<uint8_t> &frame)
+    {
+        // The receiver wants a mutable buffer.
+        char buffer[FlightRecordFormat::MAX_FRAME_LEN];
+        memcpy(buffer, frame.data(), frame.size());
+
+        _mavlink_receiver->set_new_datagram(buffer, unsigned(frame.size()));
+        while (_mavlink_receiver->parse_message()) {
+            receive_message(_mavlink_receiver->get_last_message());
+        }
+    }
+};
+
+// What PX4 streams, with every message the built-in plugins handle in flight.
+std::vector<mavlink_message_t> telemetry_messages(unsigned count)
+{
+    const uint8_t system_id = 1;
+    const uint8_t component_id = MAV_COMP_ID_AUTOPILOT1;
+
+    std::vector<mavlink_message_t> messages(count);
+
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_message_t &message = messages[i];
+        switch (i % 10) {
+            case 0: {
+                mavlink_heartbeat_t heartbeat {};
+                heartbeat.base_mode = MAV_MODE_FLAG_CUSTOM_MODE_ENABLED;
+                mavlink_msg_heartbeat_encode(system_id, component_id, &message, &heartbeat);
+                break;
+            }
+            case 1: {
+                mavlink_autopilot_version_t autopilot_version {};
+                autopilot_version.uid = 42;
+                mavlink_msg_autopilot_version_encode(system_id, component_id, &message,
+                                                     &autopilot_version);
+                break;
+            }
+            case 2:
+            case 6: {
+                mavlink_attitude_quaternion_t attitude_quaternion {};
+                attitude_quaternion.q1 = 1.0f;
+                mavlink_msg_attitude_quaternion_encode(system_id, component_id, &message,
+                                                       &attitude_quaternion);
+                break;
+            }
+            case 3:
+            case 7: {
+                mavlink_global_position_int_t global_position_int {};
+                global_position_int.lat = 473977418;
+                global_position_int.lon = 85455939;
+                global_position_int.alt = 488000;
+                mavlink_msg_global_position_int_encode(system_id, component_id, &message,
+                                                       &global_position_int);
+                break;
+            }
+            case 4: {
+                mavlink_gps_raw_int_t gps_raw_int {};
+                gps_raw_int.fix_type = 3;
+                gps_raw_int.satellites_visible = 10;
+                mavlink_msg_gps_raw_int_encode(system_id, component_id, &message, &gps_raw_int);
+                break;
+            }
+            case 5: {
+                mavlink_sys_status_t sys_status {};
+                sys_status.voltage_battery = 12000;
+                sys_status.battery_remaining = 80;
+                mavlink_msg_sys_status_encode(system_id, component_id, &message, &sys_status);
+                break;
+            }
+            case 8: {
+                mavlink_extended_sys_state_t extended_sys_state {};
+                extended_sys_state.landed_state = MAV_LANDED_STATE_IN_AIR;
+                mavlink_msg_extended_sys_state_encode(system_id, component_id, &message,
+                                                      &extended_sys_state);
+                break;
+            }
+            default: {
+                mavlink_rc_channels_t rc_channels {};
+                rc_channels.chancount = 8;
+                mavlink_msg_rc_channels_encode(system_id, component_id, &message, &rc_channels);
+                break;
+            }
+        }
+    }
+
+    return messages;
+}
+
+std::string make_temp_dir()
+{
+    char path[] = "/tmp/receive_path_allocation_test_XXXXXX";
+    char *result = mkdtemp(path);
+    return (result != nullptr) ? std::string(result) : std::string();
+}
+
+void remove_dir(const std::string &dir)
+{
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (entry->d_name[0] != '.') {
+            unlink((dir + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(d);
+    rmdir(dir.c_str());
+}
+
+// Goes through the flight recorder so that the frames are replayed as they
+// would be from a recording of a real flight.
+std::vector<std::vector<uint8_t>> record_and_read_back(
+                                     const std::vector<mavlink_message_t> &messages)
+{
+    std::vector<std::vector<uint8_t>> frames;
+
+    const std::string dir = make_temp_dir();
+    if (dir.empty()) {
+        return frames;
+    }
+
+    FlightRecorder recorder;
+    if (recorder.start(dir, FlightRecorder::DEFAULT_SEGMENT_SIZE / 16, 1)) {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        for (const auto &message : messages) {
+            const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+            recorder.record(0, buffer, buffer_len);
+        }
+        recorder.stop();
+
+        FlightRecordReader reader;
+        FlightRecordReader::Record record;
+        if (reader.open(dir)) {
+            while (reader.next(record)) {
+                frames.emplace_back(record.data, record.data + record.length);
+            }
+        }
+    }
+
+    remove_dir(dir);
+    return frames;
+}
+
+} // namespace
+
+TEST(ReceivePath, SteadyStateDoesNotAllocate)
+{
+    const std::vector<std::vector<uint8_t>> frames =
+        record_and_read_back(telemetry_messages(1000));
+    ASSERT_EQ(frames.size(), 1000u);
+
+    DroneCoreImpl dronecore_impl;
+    FeedConnection connection(&dronecore_impl);
+    ASSERT_EQ(connection.start(), DroneCore::ConnectionResult::SUCCESS);
+
+    // The first pass creates the device and its plugins, connects, and fills
+    // the statistics tables.
+    for (const auto &frame : frames) {
+        connection.feed(frame);
+    }
+    ASSERT_TRUE(dronecore_impl.is_connected());
+
+    unsigned num_callbacks = 0;
+    Telemetry &telemetry = dronecore_impl.get_device().telemetry();
+    telemetry.position_async([&num_callbacks](Telemetry::Position) { ++num_callbacks; });
+    telemetry.attitude_euler_angle_async([&num_callbacks](Telemetry::EulerAngle) {
+        ++num_callbacks;
+    });
+    telemetry.gps_info_async([&num_callbacks](Telemetry::GPSInfo) { ++num_callbacks; });
+    telemetry.battery_async([&num_callbacks](Telemetry::Battery) { ++num_callbacks; });
+    telemetry.in_air_async([&num_callbacks](bool) { ++num_callbacks; });
+    telemetry.health_async([&num_callbacks](Telemetry::Health) { ++num_callbacks; });
+    telemetry.rc_status_async([&num_callbacks](Telemetry::RCStatus) { ++num_callbacks; });
+
+    num_allocations = 0;
+    counting_allocations = true;
+    for (unsigned pass = 0; pass < 3; ++pass) {
+        for (const auto &frame : frames) {
+            connection.feed(frame);
+        }
+    }
+    counting_allocations = false;
+
+    EXPECT_EQ(num_allocations, 0u);
+    EXPECT_GT(num_callbacks, 0u);
+
+    connection.stop();
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include "replay_connection.h"
+#include "dronecore_impl.h"
+#include "global_include.h"
+#include "log.h"
+
+#include <cstring>
+
+namespace dronecore {
+
+ReplayConnection::ReplayConnection(DroneCoreImpl *parent, const std::string &path,
+                                   float speed_factor) :
+    Connection(parent),
+    _path(path),
+    _speed_factor(speed_factor)
+{
+    // We don't want to record the replay again.
+    _record_messages = false;
+    // Only frames which were valid when received are recorded.
+    _trusted_transport = true;
+}
+
+ReplayConnection::~ReplayConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+bool ReplayConnection::is_ok() const
+{
+    return true;
+}
+
+DroneCore::ConnectionResult ReplayConnection::start()
+{
+    if (!_reader.open(_path)) {
+        return DroneCore::ConnectionResult::CONNECTION_ERROR;
+    }
+
+    if (!start_mavlink_receiver()) {
+        return DroneCore::ConnectionResult::CONNECTIONS_EXHAUSTED;
+    }
+
+    _replay_thread = new std::thread(replay, this);
+
+    return DroneCore::ConnectionResult::SUCCESS;
+}
+
+DroneCore::ConnectionResult ReplayConnection::stop()
+{
+    _should_exit = true;
+
+    if (_replay_thread) {
+        _replay_thread->join();
+        delete _replay_thread;
+        _replay_thread = nullptr;
+    }
+
+    // We need to stop this after stopping the replay thread, otherwise
+    // it can happen that we interfere with the parsing of a message.
+    stop_mavlink_receiver();
+
+    _reader.close();
+
+    return DroneCore::ConnectionResult::SUCCESS;
+}
+
+bool ReplayConnection::send_message(const mavlink_message_t &message)
+{
+    UNUSED(message);
+    return true;
+}
+
+void ReplayConnection::wait_until_due(uint64_t timestamp_us)
+{
+    if (_speed_factor <= 0.0f) {
+        return;
+    }
+
+    // The recording uses the wall clock, which might have been stepped back.
+    const uint64_t elapsed_us =
+        (timestamp_us > _first_timestamp_us) ? timestamp_us - _first_timestamp_us : 0;
+    const auto offset = std::chrono::microseconds(
+                            int64_t(double(elapsed_us) / double(_speed_factor)));
+    const dl_time_t due_time = _start_time + offset;
+
+    // Sleep in small steps so that stop() does not need to wait for long gaps
+    // in the recording.
+    while (!_should_exit) {
+        const dl_time_t now = std::chrono::steady_clock::now();
+        if (now >= due_time) {
+            break;
+        }
+        std::this_thread::sleep_until(MIN(due_time, now + std::chrono::milliseconds(100)));
+    }
+}
+
+void ReplayConnection::replay(ReplayConnection *parent)
+{
+    // The frames are copied out of the mapping because the receiver wants a
+    // mutable buffer.
+    char buffer[FlightRecordFormat::MAX_FRAME_LEN];
+
+    bool first = true;
+    FlightRecordReader::Record record;
+
+    while (!parent->_should_exit && parent->_reader.next(record)) {
+
+        // The time between two recording sessions is not replayed, the
+        // pacing starts over with every session.
+        if (first || record.session_id != parent->_session_id) {
+            parent->_session_id = record.session_id;
+            parent->_first_timestamp_us = record.timestamp_us;
+            parent->_start_time = std::chrono::steady_clock::now();
+            first = false;
+        }
+
+        parent->wait_until_due(record.timestamp_us);
+
+        memcpy(buffer, record.data, record.length);
+        parent->_mavlink_receiver->set_new_datagram(buffer, record.length);
+
+        while (parent->_mavlink_receiver->parse_message()) {
+            parent->receive_message(parent->_mavlink_receiver->get_last_message());
+        }
+    }
+
+    LogInfo() << "Replay of " << parent->_path << " done";
+    parent->_finished = true;
+}
+
+} // namespace dronecore
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "dronecore.h"
+#include "connection.h"
+#include "flight_recorder.h"
+#include <string>
+#include <thread>
+#include <atomic>
+
+namespace dronecore {
+
+// Feeds a recording of the FlightRecorder back into DroneCore as if the
+// messages were received live.
+class ReplayConnection : public Connection
+{
+public:
+    // A speed_factor of 1 replays in real time, 2 twice as fast, and 0 (or less)
+    // as fast as possible.
+    explicit ReplayConnection(DroneCoreImpl *parent, const std::string &path, float speed_factor);
+    ~ReplayConnection();
+    bool is_ok() const;
+    DroneCore::ConnectionResult start();
+    DroneCore::ConnectionResult stop();
+
+    // Nothing is sent anywhere during a replay.
+    bool send_message(const mavlink_message_t &message);
+
+    bool is_finished() const { return _finished; }
+
+    // Non-copyable
+    ReplayConnection(const ReplayConnection &) = delete;
+    const ReplayConnection &operator=(const ReplayConnection &) = delete;
+
+private:
+    static void replay(ReplayConnection *parent);
+    void wait_until_due(uint64_t timestamp_us);
+
+    std::string _path;
+    float _speed_factor;
+
+    FlightRecordReader _reader {};
+    uint64_t _session_id = 0;
+    uint64_t _first_timestamp_us = 0;
+    dl_time_t _start_time {};
+
+    std::thread *_replay_thread = nullptr;
+    std::atomic_bool _should_exit {false};
+    std::atomic_bool _finished {false};
+};
+
+} // namespace dronecore
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dronecore {
+
+// Value shared with a reader that must not block, e.g. a real-time thread.
+//
+// The writer makes the sequence odd while it writes, the reader retries if
+// the sequence was odd or changed while it read. The value is copied in words
+// of relaxed atomics, so the reader never sees a torn value and there is no
+// data race.
+//
+// store() must only be called from one thread at a time, load() from any.
+template<typename T>
+class SeqLock
+{
+public:
+    SeqLock()
+    {
+        store(T {});
+    }
+
+    explicit SeqLock(const T &value)
+    {
+        store(value);
+    }
+
+    ~SeqLock() = default;
+
+    // delete copy and move constructors and assign operators
+    SeqLock(SeqLock const &) = delete;            // Copy construct
+    SeqLock(SeqLock &&) = delete;                 // Move construct
+    SeqLock &operator=(SeqLock const &) = delete; // Copy assign
+    SeqLock &operator=(SeqLock &&) = delete;      // Move assign
+
+    void store(const T &value)
+    {
+        uint64_t words[NUM_WORDS] {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (unsigned i = 0; i < NUM_WORDS; ++i) {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const
+    {
+        uint64_t words[NUM_WORDS];
+        uint32_t seq_before;
+        uint32_t seq_after;
+        do {
+            seq_before = _seq.load(std::memory_order_acquire);
+            for (unsigned i = 0; i < NUM_WORDS; ++i) {
+                words[i] = _words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq_after = _seq.load(std::memory_order_relaxed);
+        } while ((seq_before & 1) != 0 || seq_before != seq_after);
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // Changes every time a value is stored.
+    uint32_t version() const { return _seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+    static constexpr unsigned NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> _seq {0};
+    std::atomic<uint64_t> _words[NUM_WORDS];
+};
+
+} // namespace dronecore
@@ -0,0 +1,59 @@
+#include "seqlock.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+using namespace dronecore;
+
+namespace {
+
+// Odd size to cover the padding of the last word.
+struct Value {
+    uint32_t a;
+    uint32_t b;
+    float c;
+    uint8_t d;
+};
+
+} // namespace
+
+TEST(SeqLock, StoreAndLoad)
+{
+    SeqLock<Value> value;
+    EXPECT_EQ(value.load().a, 0u);
+
+    const uint32_t version = value.version();
+    value.store(Value {1, 2, 3.0f, 4});
+    EXPECT_NE(value.version(), version);
+
+    const Value loaded = value.load();
+    EXPECT_EQ(loaded.a, 1u);
+    EXPECT_EQ(loaded.b, 2u);
+    EXPECT_EQ(loaded.c, 3.0f);
+    EXPECT_EQ(loaded.d, 4);
+}
+
+TEST(SeqLock, NeverTorn)
+{
+    SeqLock<Value> value(Value {0, ~0u, 0.0f, 0});
+    std::atomic<bool> done {false};
+
+    std::thread writer([&value, &done]() {
+        for (uint32_t i = 1; i < 200000; ++i) {
+            value.store(Value {i, ~i, float(i % 1000), uint8_t(i)});
+        }
+        done = true;
+    });
+
+    unsigned num_loads = 0;
+    while (!done) {
+        const Value loaded = value.load();
+        ASSERT_EQ(loaded.b, ~loaded.a);
+        ASSERT_EQ(loaded.d, uint8_t(loaded.a));
+        ++num_loads;
+    }
+    writer.join();
+
+    EXPECT_GT(num_loads, 0u);
+    EXPECT_EQ(value.load().a, 199999u);
+}
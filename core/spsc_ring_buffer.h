@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace dronecore {
+
+// Fixed size ring buffer for one producer and one consumer thread without
+// locks, e.g. to hand data to a real-time thread.
+//
+// The producer only writes the head and the consumer only the tail, the
+// elements between them belong to the consumer. push() is all or nothing so
+// the consumer never sees half of a batch.
+template<typename T>
+class SpscRingBuffer
+{
+public:
+    // The capacity is rounded up to a power of two.
+    explicit SpscRingBuffer(size_t capacity) :
+        _buffer(round_up_to_power_of_two(capacity)),
+        _mask(_buffer.size() - 1)
+    {}
+
+    ~SpscRingBuffer() = default;
+
+    // delete copy and move constructors and assign operators
+    SpscRingBuffer(SpscRingBuffer const &) = delete;            // Copy construct
+    SpscRingBuffer(SpscRingBuffer &&) = delete;                 // Move construct
+    SpscRingBuffer &operator=(SpscRingBuffer const &) = delete; // Copy assign
+    SpscRingBuffer &operator=(SpscRingBuffer &&) = delete;      // Move assign
+
+    size_t capacity() const { return _buffer.size(); }
+
+    // Producer only. Returns false if there is not enough space for all values.
+    bool push(const T *values, size_t count)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+        if (count > capacity() - (head - tail)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            _buffer[(head + i) & _mask] = values[i];
+        }
+        _head.store(head + count, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only, the producer might add more at any time.
+    size_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed);
+    }
+
+    // Consumer only, index must be below size().
+    const T &peek(size_t index) const
+    {
+        return _buffer[(_tail.load(std::memory_order_relaxed) + index) & _mask];
+    }
+
+    // Consumer only, count must not be above size().
+    void pop(size_t count = 1)
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Only while neither the producer nor the consumer use the buffer.
+    void clear()
+    {
+        _tail.store(_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+private:
+    static size_t round_up_to_power_of_two(size_t value)
+    {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::vector<T> _buffer;
+    const size_t _mask;
+
+    // Both only ever grow, the indices into the buffer are masked.
+    std::atomic<size_t> _head {0};
+    std::atomic<size_t> _tail {0};
+};
+
+} // namespace dronecore
@@ -0,0 +1,72 @@
+#include "spsc_ring_buffer.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace dronecore;
+
+TEST(SpscRingBuffer, PushPeekPop)
+{
+    SpscRingBuffer<int> buffer(3);
+    EXPECT_EQ(buffer.capacity(), 4u);
+    EXPECT_EQ(buffer.size(), 0u);
+
+    const int values[] = {1, 2, 3, 4, 5};
+    EXPECT_TRUE(buffer.push(values, 3));
+    EXPECT_EQ(buffer.size(), 3u);
+
+    // All or nothing.
+    EXPECT_FALSE(buffer.push(values, 2));
+    EXPECT_EQ(buffer.size(), 3u);
+
+    EXPECT_EQ(buffer.peek(0), 1);
+    EXPECT_EQ(buffer.peek(2), 3);
+    buffer.pop(2);
+    EXPECT_EQ(buffer.size(), 1u);
+    EXPECT_EQ(buffer.peek(0), 3);
+
+    // Wraps around.
+    EXPECT_TRUE(buffer.push(values + 3, 2));
+    EXPECT_EQ(buffer.size(), 3u);
+    EXPECT_EQ(buffer.peek(1), 4);
+    EXPECT_EQ(buffer.peek(2), 5);
+
+    buffer.clear();
+    EXPECT_EQ(buffer.size(), 0u);
+    EXPECT_TRUE(buffer.push(values, 4));
+}
+
+TEST(SpscRingBuffer, ProducerAndConsumerThreads)
+{
+    SpscRingBuffer<unsigned> buffer(64);
+    const unsigned num_values = 100000;
+
+    std::thread producer([&buffer]() {
+        std::vector<unsigned> batch(10);
+        for (unsigned i = 0; i < num_values; i += unsigned(batch.size())) {
+            for (unsigned j = 0; j < batch.size(); ++j) {
+                batch[j] = i + j;
+            }
+            while (!buffer.push(batch.data(), batch.size())) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    unsigned expected = 0;
+    while (expected < num_values) {
+        const size_t size = buffer.size();
+        if (size == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(buffer.peek(i), expected + i);
+        }
+        buffer.pop(size);
+        expected += unsigned(size);
+    }
+    producer.join();
+
+    EXPECT_EQ(buffer.size(), 0u);
+}
@@ -34,6 +34,8 @@ TcpConnection::TcpConnection(DroneCoreImpl *parent, const std::string &remote_ip
     if (_remote_ip == "") {
         _remote_ip = DEFAULT_TCP_REMOTE_IP;
     }
+    // TCP already checks and retransmits corrupted segments.
+    _trusted_transport = true;
 }
 
 TcpConnection::~TcpConnection()
@@ -11,10 +11,10 @@ TimeoutHandler::~TimeoutHandler()
 {
 }
 
-void TimeoutHandler::add(std::function<void()> callback, double duration_s, void **cookie)
+void TimeoutHandler::add(Delegate<void()> callback, double duration_s, void **cookie)
 {
     auto new_timeout = std::make_shared<Timeout>();
-    new_timeout->callback = callback;
+    new_timeout->callback = std::move(callback);
     new_timeout->time = _time.steady_time_in_future(duration_s);
     new_timeout->duration_s = duration_s;
 
@@ -64,15 +64,15 @@ void TimeoutHandler::run_once()
 
             if (it->second->callback) {
 
-                // Get a copy for the callback because we will remove it.
-                std::function<void()> callback = it->second->callback;
+                // Keep the timeout alive because we will remove it.
+                std::shared_ptr<Timeout> timeout = it->second;
 
                 // Self-destruct before calling to avoid locking issues.
                 _timeouts.erase(it++);
 
                 // Unlock while we callback because it might in turn want to add timeouts.
                 _timeouts_mutex.unlock();
-                callback();
+                timeout->callback();
                 _timeouts_mutex.lock();
             }
 
@@ -2,9 +2,9 @@
 
 #include <mutex>
 #include <memory>
-#include <functional>
 #include <map>
 #include "global_include.h"
+#include "delegate.h"
 
 namespace dronecore {
 
@@ -20,7 +20,7 @@ public:
     TimeoutHandler &operator=(TimeoutHandler const &) = delete; // Copy assign
     TimeoutHandler &operator=(TimeoutHandler &&) = delete;      // Move assign
 
-    void add(std::function<void()> callback, double duration_s, void **cookie);
+    void add(Delegate<void()> callback, double duration_s, void **cookie);
     void refresh(const void *cookie);
     void remove(const void *cookie);
 
@@ -28,7 +28,7 @@ public:
 
 private:
     struct Timeout {
-        std::function<void()> callback;
+        Delegate<void()> callback;
         dl_time_t time;
         double duration_s;
     };
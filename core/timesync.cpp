@@ -0,0 +1,146 @@
+#include "timesync.h"
+#include "device_impl.h"
+#include <chrono>
+#include <cmath>
+
+namespace dronecore {
+
+constexpr double Timesync::SYNC_INTERVAL_S;
+constexpr double Timesync::CONVERGE_INTERVAL_S;
+
+Timesync::Timesync(DeviceImpl *parent) :
+    _parent(parent)
+{
+    _parent->register_mavlink_message_view_handler(
+        MAVLINK_MSG_ID_TIMESYNC,
+        std::bind(&Timesync::process_timesync, this, std::placeholders::_1), this);
+}
+
+Timesync::~Timesync()
+{
+    _parent->unregister_all_mavlink_message_handlers(this);
+}
+
+void Timesync::do_work()
+{
+    if (!_parent->is_connected()) {
+        return;
+    }
+
+    int64_t request_ns;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const double interval_s = _filter.is_converged() ? SYNC_INTERVAL_S : CONVERGE_INTERVAL_S;
+        if (_parent->get_time().elapsed_since_s(_last_request_time) < interval_s) {
+            return;
+        }
+        _last_request_time = _parent->get_time().steady_time();
+
+        // An earlier request not answered by now is lost or too late to use.
+        request_ns = host_time_ns();
+        _request_ns = request_ns;
+    }
+    send_timesync(0, request_ns);
+}
+
+void Timesync::process_timesync(const MavlinkMessageView &view)
+{
+    const int64_t now_ns = host_time_ns();
+    const int64_t tc1 = view.get(&mavlink_timesync_t::tc1);
+    const int64_t ts1 = view.get(&mavlink_timesync_t::ts1);
+
+    if (tc1 == 0) {
+        // The vehicle syncs to us.
+        send_timesync(now_ns, ts1);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Only the answer to the latest request, anything else is stale or was
+    // meant for someone else.
+    if (_request_ns == 0 || ts1 != _request_ns) {
+        return;
+    }
+    _request_ns = 0;
+
+    const bool was_synced = _filter.is_converged();
+    _filter.add_sample(ts1, tc1, now_ns);
+    if (was_synced != _filter.is_converged()) {
+        if (was_synced) {
+            LogWarn() << "Vehicle clock jumped, syncing again";
+        } else {
+            LogDebug() << "Vehicle clock synced";
+        }
+    }
+}
+
+void Timesync::send_timesync(int64_t tc1, int64_t ts1)
+{
+    mavlink_message_t message;
+    mavlink_msg_timesync_pack(_parent->get_own_system_id(),
+                              _parent->get_own_component_id(),
+                              &message, tc1, ts1);
+    _parent->send_message(message);
+}
+
+bool Timesync::is_synced() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _filter.is_converged();
+}
+
+uint64_t Timesync::to_vehicle_time_us(double host_time_s) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_filter.is_converged()) {
+        return 0;
+    }
+    const int64_t vehicle_ns = _filter.to_vehicle_ns(int64_t(std::llround(host_time_s * 1e9)));
+    return vehicle_ns > 0 ? uint64_t(vehicle_ns / 1000) : 0;
+}
+
+double Timesync::to_host_time_s(uint64_t vehicle_time_us) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_filter.is_converged()) {
+        return double(NAN);
+    }
+    return double(_filter.to_host_ns(int64_t(vehicle_time_us) * 1000)) * 1e-9;
+}
+
+uint32_t Timesync::get_vehicle_time_boot_ms() const
+{
+    const uint64_t vehicle_time_us = to_vehicle_time_us(_parent->get_time().elapsed_s());
+    if (vehicle_time_us == 0) {
+        return uint32_t(_parent->get_time().elapsed_s() * 1e3);
+    }
+    return uint32_t(vehicle_time_us / 1000);
+}
+
+Timesync::Stats Timesync::get_stats() const
+{
+    const int64_t now_ns = host_time_ns();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Stats stats {false, double(NAN), double(NAN), double(NAN)};
+    if (_filter.is_converged()) {
+        stats.synced = true;
+        stats.offset_s = _filter.get_offset_ns(now_ns) * 1e-9;
+        stats.drift_ppm = _filter.get_drift() * 1e6;
+        stats.rtt_ms = _filter.get_rtt_ns() * 1e-6;
+    }
+    return stats;
+}
+
+int64_t Timesync::host_time_ns() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               _parent->get_time().steady_time().time_since_epoch()).count();
+}
+
+} // namespace dronecore
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "clock_offset_filter.h"
+#include "global_include.h"
+#include "mavlink_message_view.h"
+#include <cstdint>
+#include <mutex>
+
+namespace dronecore {
+
+class DeviceImpl;
+
+// Aligns the host clock with the clock of the vehicle using TIMESYNC.
+//
+// A request carries the host time in ts1 and tc1 set to 0. The vehicle
+// answers with its own time in tc1 and ts1 echoed, which makes a round trip
+// for the ClockOffsetFilter. Requests of the vehicle are answered the same
+// way, so that it can sync its clock to ours.
+//
+// Host times are in seconds of Time::elapsed_s(), vehicle times in
+// microseconds since the vehicle booted, like the time_boot_ms and time_usec
+// fields of the messages.
+class Timesync
+{
+public:
+    explicit Timesync(DeviceImpl *parent);
+    ~Timesync();
+
+    struct Stats {
+        bool synced;
+        // Vehicle clock minus host clock.
+        double offset_s;
+        // How much faster the vehicle clock runs.
+        double drift_ppm;
+        double rtt_ms;
+    };
+
+    void do_work();
+
+    bool is_synced() const;
+
+    // 0 as long as the clocks are not synced.
+    uint64_t to_vehicle_time_us(double host_time_s) const;
+    // NAN as long as the clocks are not synced.
+    double to_host_time_s(uint64_t vehicle_time_us) const;
+
+    // For messages to the vehicle, falls back to the host time as long as
+    // the clocks are not synced.
+    uint32_t get_vehicle_time_boot_ms() const;
+
+    Stats get_stats() const;
+
+    // Until synced, requests are sent faster.
+    static constexpr double SYNC_INTERVAL_S = 1.0;
+    static constexpr double CONVERGE_INTERVAL_S = 0.2;
+
+    // Non-copyable
+    Timesync(const Timesync &) = delete;
+    const Timesync &operator=(const Timesync &) = delete;
+
+private:
+    void process_timesync(const MavlinkMessageView &view);
+    void send_timesync(int64_t tc1, int64_t ts1);
+    int64_t host_time_ns() const;
+
+    DeviceImpl *_parent;
+
+    mutable std::mutex _mutex {};
+    ClockOffsetFilter _filter {};
+    // Host time of the request not answered yet, 0 if none.
+    int64_t _request_ns = 0;
+    dl_time_t _last_request_time {};
+};
+
+} // namespace dronecore
@@ -8,6 +8,7 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <unistd.h> // for close()
+#include <sys/uio.h>
 #else
 #include <winsock2.h>
 #include <Ws2tcpip.h> // For InetPton
@@ -15,6 +16,7 @@
 #pragma comment(lib, "Ws2_32.lib") // Without this, Ws2_32.lib is not included in static library.
 #endif
 
+#include <algorithm>
 #include <cassert>
 
 #ifndef WINDOWS
@@ -25,6 +27,8 @@
 
 namespace dronecore {
 
+constexpr unsigned UdpConnection::SEND_BATCH_SIZE;
+
 UdpConnection::UdpConnection(DroneCoreImpl *parent,
                              int local_port_number) :
     Connection(parent),
@@ -33,6 +37,8 @@ UdpConnection::UdpConnection(DroneCoreImpl *parent,
     if (_local_port_number == 0) {
         _local_port_number = DEFAULT_UDP_LOCAL_PORT;
     }
+    // Datagrams with a bad UDP checksum are discarded by the kernel.
+    _trusted_transport = true;
 }
 
 UdpConnection::~UdpConnection()
@@ -129,28 +135,35 @@ DroneCore::ConnectionResult UdpConnection::stop()
     return DroneCore::ConnectionResult::SUCCESS;
 }
 
-bool UdpConnection::send_message(const mavlink_message_t &message)
+bool UdpConnection::get_remote_address(struct sockaddr_in &dest_addr)
 {
-    struct sockaddr_in dest_addr {};
+    std::lock_guard<std::mutex> lock(_remote_mutex);
 
-    {
-        std::lock_guard<std::mutex> lock(_remote_mutex);
+    if (_remote_ip_addr == 0) {
+        LogErr() << "Remote IP unknown";
+        return false;
+    }
 
-        if (_remote_ip.empty()) {
-            LogErr() << "Remote IP unknown";
-            return false;
-        }
+    if (_remote_port_number == 0) {
+        LogErr() << "Remote port unknown";
+        return false;
+    }
 
-        if (_remote_port_number == 0) {
-            LogErr() << "Remote port unknown";
-            return false;
-        }
+    dest_addr = {};
+    dest_addr.sin_family = AF_INET;
 
-        dest_addr.sin_family = AF_INET;
+    dest_addr.sin_addr.s_addr = _remote_ip_addr;
+    dest_addr.sin_port = htons(_remote_port_number);
 
-        inet_pton(AF_INET, _remote_ip.c_str(), &dest_addr.sin_addr.s_addr);
+    return true;
+}
 
-        dest_addr.sin_port = htons(_remote_port_number);
+bool UdpConnection::send_message(const mavlink_message_t &message)
+{
+    struct sockaddr_in dest_addr {};
+
+    if (!get_remote_address(dest_addr)) {
+        return false;
     }
 
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
@@ -170,6 +183,51 @@ bool UdpConnection::send_message(const mavlink_message_t &message)
     return true;
 }
 
+bool UdpConnection::send_messages(const mavlink_message_t *messages, size_t count)
+{
+#if !defined(WINDOWS) && !defined(APPLE)
+    struct sockaddr_in dest_addr {};
+
+    if (!get_remote_address(dest_addr)) {
+        return false;
+    }
+
+    // Every message still goes in a datagram of its own, as receivers expect,
+    // but up to SEND_BATCH_SIZE of them are sent with one system call.
+    uint8_t buffers[SEND_BATCH_SIZE][MAVLINK_MAX_PACKET_LEN];
+    struct iovec iovecs[SEND_BATCH_SIZE];
+    struct mmsghdr headers[SEND_BATCH_SIZE];
+
+    size_t num_done = 0;
+    while (num_done < count) {
+        const unsigned batch_size = unsigned(std::min<size_t>(count - num_done, SEND_BATCH_SIZE));
+
+        for (unsigned i = 0; i < batch_size; ++i) {
+            iovecs[i].iov_base = buffers[i];
+            iovecs[i].iov_len = mavlink_msg_to_send_buffer(buffers[i], &messages[num_done + i]);
+
+            headers[i] = {};
+            headers[i].msg_hdr.msg_name = &dest_addr;
+            headers[i].msg_hdr.msg_namelen = sizeof(dest_addr);
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // Fewer datagrams than requested can be sent, the rest go in the next call.
+        int num_sent = sendmmsg(_socket_fd, headers, batch_size, 0);
+        if (num_sent <= 0) {
+            LogErr() << "sendmmsg failure: " << GET_ERROR(errno);
+            return false;
+        }
+        num_done += size_t(num_sent);
+    }
+
+    return true;
+#else
+    return Connection::send_messages(messages, count);
+#endif
+}
+
 void UdpConnection::receive(UdpConnection *parent)
 {
     // Enough for MTU 1500 bytes.
@@ -198,28 +256,29 @@ void UdpConnection::receive(UdpConnection *parent)
         {
             std::lock_guard<std::mutex> lock(parent->_remote_mutex);
 
-            int new_remote_port_number = ntohs(src_addr.sin_port);
-            std::string new_remote_ip(inet_ntoa(src_addr.sin_addr));
+            const uint32_t new_remote_ip_addr = src_addr.sin_addr.s_addr;
+            const int new_remote_port_number = ntohs(src_addr.sin_port);
 
-            if (parent->_remote_ip.empty() ||
+            if (parent->_remote_ip_addr == 0 ||
                 parent->_remote_port_number == 0) {
 
                 // Set IP if we don't know it yet.
-                parent->_remote_ip = new_remote_ip;
+                parent->_remote_ip_addr = new_remote_ip_addr;
                 parent->_remote_port_number = new_remote_port_number;
 
-                LogInfo() << "New device on: " << parent->_remote_ip
+                LogInfo() << "New device on: " << inet_ntoa(src_addr.sin_addr)
                           << ":" << parent->_remote_port_number;
 
-            } else if (parent->_remote_ip.compare(new_remote_ip) != 0 ||
+            } else if (parent->_remote_ip_addr != new_remote_ip_addr ||
                        parent->_remote_port_number != new_remote_port_number) {
 
                 // It is possible that wifi disconnects and a device might get a new
                 // IP and/or UDP port.
-                parent->_remote_ip = new_remote_ip;
+                parent->_remote_ip_addr = new_remote_ip_addr;
                 parent->_remote_port_number = new_remote_port_number;
 
-                LogInfo() << "Device changed to: " << new_remote_ip << ":" << new_remote_port_number;
+                LogInfo() << "Device changed to: " << inet_ntoa(src_addr.sin_addr)
+                          << ":" << new_remote_port_number;
             }
         }
 
@@ -7,6 +7,8 @@
 #include <thread>
 #include <atomic>
 
+struct sockaddr_in;
+
 namespace dronecore {
 
 class UdpConnection : public Connection
@@ -19,6 +21,7 @@ public:
     DroneCore::ConnectionResult stop();
 
     bool send_message(const mavlink_message_t &message);
+    bool send_messages(const mavlink_message_t *messages, size_t count) override;
 
     // Non-copyable
     UdpConnection(const UdpConnection &) = delete;
@@ -26,6 +29,7 @@ public:
 
 private:
     DroneCore::ConnectionResult setup_port();
+    bool get_remote_address(struct sockaddr_in &dest_addr);
     void start_recv_thread();
 
     static void receive(UdpConnection *parent);
@@ -33,10 +37,15 @@ private:
     // This port is shared with mavros, so either one, this SDK or mavros can be used.
     static constexpr int DEFAULT_UDP_LOCAL_PORT = 14540;
 
+    // Datagrams handed to the kernel per sendmmsg call.
+    static constexpr unsigned SEND_BATCH_SIZE = 32;
+
     int _local_port_number;
 
+    // The remote is kept as received, in network byte order, so that every
+    // datagram can be checked against it without formatting the address.
     std::mutex _remote_mutex = {};
-    std::string _remote_ip = {};
+    uint32_t _remote_ip_addr = 0;
     int _remote_port_number = 0;
 
     int _socket_fd = -1;
@@ -1,11 +1,10 @@
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <thread>
 #include <unistd.h>
 #include "dronecore.h"
 
-#if DROP_DEBUG != 1
-#error DROB_DEBUG needs to be set for this test to work
-#endif
-
 #define UNUSED(x) (void)(x)
 
 bool _discovered_device = false;
@@ -13,6 +12,7 @@ bool _timeouted_device = false;
 
 void on_discover(uint64_t uuid);
 void on_timeout(uint64_t uuid);
+void print_statistics(const dronecore::DroneCore::Statistics &statistics);
 
 int main(int argc, const char *argv[])
 {
@@ -33,6 +33,8 @@ int main(int argc, const char *argv[])
     while (true) {
         if (!_discovered_device) {
             std::cout << "waiting for device to appear..." << std::endl;
+        } else {
+            print_statistics(dc.statistics());
         }
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
@@ -52,3 +54,45 @@ void on_timeout(uint64_t uuid)
     _timeouted_device = true;
 }
 
+
+void print_statistics(const dronecore::DroneCore::Statistics &statistics)
+{
+    for (auto &connection : statistics.connections) {
+        std::cout << "connection " << connection.connection_id
+                  << ": " << connection.bytes_received << " bytes, "
+                  << connection.messages_received << " messages, "
+                  << connection.parse_errors << " parse errors, "
+                  << connection.crc_errors << " crc errors" << std::endl;
+    }
+
+    for (auto &link : statistics.links) {
+        std::cout << "connection " << link.connection_id
+                  << ", sysid " << int(link.system_id)
+                  << ", compid " << int(link.component_id)
+                  << ": loss " << std::setw(6) << std::setprecision(2) << std::fixed
+                  << 100.0f * link.loss_rate << " %, "
+                  << std::setw(8) << std::setprecision(2) << std::fixed
+                  << link.throughput_bytes_s / 1024.0 << " KiB/s, "
+                  << link.lost << " lost, "
+                  << link.duplicates << " duplicates, "
+                  << link.reordered << " reordered" << std::endl;
+    }
+
+    for (auto &stream : statistics.messages) {
+        std::cout << "connection " << stream.connection_id
+                  << ", sysid " << int(stream.system_id)
+                  << ", msgid " << std::setw(3) << stream.message_id
+                  << ": " << std::setw(6) << stream.messages << " messages, "
+                  << std::setw(8) << stream.bytes << " bytes, "
+                  << std::setw(6) << std::setprecision(1) << std::fixed << stream.rate_hz << " Hz"
+                  << std::endl;
+    }
+
+    for (auto &dispatch : statistics.dispatch) {
+        std::cout << "sysid " << int(dispatch.system_id)
+                  << ", msgid " << std::setw(3) << dispatch.message_id
+                  << ": " << std::setw(6) << dispatch.calls << " calls, p50 "
+                  << std::setprecision(1) << std::fixed << dispatch.p50_us << " us, p99 "
+                  << dispatch.p99_us << " us, max " << dispatch.max_us << " us" << std::endl;
+    }
+}
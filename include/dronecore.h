@@ -113,6 +113,160 @@ public:
      */
     ConnectionResult add_serial_connection(std::string dev_path, int baudrate);
 
+    /**
+     * @brief Adds a connection replaying a recording in real time.
+     *
+     * @param path Recording directory or segment file written by start_recording().
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_replay_connection(const std::string &path);
+
+    /**
+     * @brief Adds a connection replaying a recording with a given speed.
+     *
+     * The messages of the recording are fed into DroneCore as if they were received on a
+     * live connection. Messages sent by DroneCore are discarded.
+     *
+     * @param path Recording directory or segment file written by start_recording().
+     * @param speed_factor Replay speed, 1 for real time, 10 for 10 times faster, 0 for as
+     *                     fast as possible.
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_replay_connection(const std::string &path, float speed_factor);
+
+    /**
+     * @brief Starts recording all received MAVLink messages with the default settings.
+     *
+     * This keeps at most 8 segments of 64 MiB each.
+     *
+     * @param directory Existing directory to write the recording to.
+     * @return `true` if the recording was started.
+     */
+    bool start_recording(const std::string &directory);
+
+    /**
+     * @brief Starts recording all received MAVLink messages.
+     *
+     * Every raw frame is appended to a memory-mapped segment file together with the time it
+     * was received and the connection it was received on. Once a segment is full a new one
+     * is started and the oldest one is deleted if more than `max_segments` exist.
+     *
+     * @param directory Existing directory to write the recording to.
+     * @param segment_size_bytes Size of one segment file in bytes.
+     * @param max_segments Maximum number of segment files kept on disk.
+     * @return `true` if the recording was started.
+     */
+    bool start_recording(const std::string &directory, uint64_t segment_size_bytes,
+                         unsigned max_segments);
+
+    /**
+     * @brief Stops recording received MAVLink messages.
+     */
+    void stop_recording();
+
+    /**
+     * @brief Counters of one message stream.
+     *
+     * A stream is identified by the connection it was received on, the system ID of the
+     * sender and the message ID.
+     */
+    struct MessageStats {
+        unsigned connection_id; /**< @brief ID of the connection, see ConnectionStats. */
+        uint8_t system_id; /**< @brief MAVLink system ID of the sender. */
+        uint32_t message_id; /**< @brief MAVLink message ID. */
+        uint64_t messages; /**< @brief Number of messages received. */
+        uint64_t bytes; /**< @brief Number of bytes received including framing. */
+        double rate_hz; /**< @brief Currently observed rate in Hz. */
+    };
+
+    /**
+     * @brief Time spent in the plugin handlers for one message type of a device.
+     */
+    struct DispatchStats {
+        uint8_t system_id; /**< @brief MAVLink system ID of the device. */
+        uint32_t message_id; /**< @brief MAVLink message ID. */
+        uint64_t calls; /**< @brief Number of messages dispatched to handlers. */
+        double mean_us; /**< @brief Mean dispatch time in microseconds. */
+        double p50_us; /**< @brief Median dispatch time in microseconds. */
+        double p90_us; /**< @brief 90th percentile of the dispatch time in microseconds. */
+        double p99_us; /**< @brief 99th percentile of the dispatch time in microseconds. */
+        double max_us; /**< @brief Maximum dispatch time in microseconds. */
+    };
+
+    /**
+     * @brief Counters of the parser of one connection.
+     */
+    struct ConnectionStats {
+        unsigned connection_id; /**< @brief ID of the connection. */
+        uint64_t bytes_received; /**< @brief Number of bytes received. */
+        uint64_t messages_received; /**< @brief Number of valid messages parsed. */
+        uint64_t parse_errors; /**< @brief Number of bytes discarded while out of sync. */
+        uint64_t crc_errors; /**< @brief Number of frames with a bad checksum or signature. */
+        uint64_t messages_dropped; /**< @brief Number of frames dropped as nothing handles them. */
+        uint64_t bytes_dropped; /**< @brief Number of bytes of the dropped frames. */
+    };
+
+    /**
+     * @brief Link quality of one sender on one connection derived from the MAVLink sequence
+     * numbers.
+     *
+     * The rates are calculated over the last completed window of one second, the counters
+     * are totals since the first message.
+     */
+    struct LinkStats {
+        unsigned connection_id; /**< @brief ID of the connection, see ConnectionStats. */
+        uint8_t system_id; /**< @brief MAVLink system ID of the sender. */
+        uint8_t component_id; /**< @brief MAVLink component ID of the sender. */
+        uint64_t received; /**< @brief Number of messages received. */
+        uint64_t lost; /**< @brief Number of messages missing in the sequence. */
+        uint64_t duplicates; /**< @brief Number of messages received more than once. */
+        uint64_t reordered; /**< @brief Number of messages which arrived late. */
+        float loss_rate; /**< @brief Share of lost messages in the last window (0..1). */
+        double throughput_bytes_s; /**< @brief Bytes per second received in the last window. */
+    };
+
+    /**
+     * @brief Callback type for link statistics.
+     *
+     * @param link_stats Statistics of the link whose window has just completed.
+     */
+    typedef std::function<void(const LinkStats &link_stats)> link_stats_callback_t;
+
+    /**
+     * @brief Snapshot of all statistics.
+     */
+    struct Statistics {
+        std::vector<MessageStats> messages; /**< @brief Per message stream. */
+        std::vector<DispatchStats> dispatch; /**< @brief Per device and message type. */
+        std::vector<ConnectionStats> connections; /**< @brief Per connection. */
+        std::vector<LinkStats> links; /**< @brief Per connection and sender. */
+    };
+
+    /**
+     * @brief Get the statistics of received messages.
+     *
+     * The statistics are always collected, the counters are kept per thread and only
+     * summed up when this is called. This makes it possible to see which message streams
+     * and plugins cost bandwidth and CPU.
+     *
+     * @return Snapshot of the statistics since DroneCore was started.
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Register callback for link statistics.
+     *
+     * The callback is called once a second for every sender on every connection as long as
+     * messages are received from it. It is called from the receive thread of the connection
+     * and should therefore return quickly.
+     *
+     * **Note** Only one callback can be registered at a time. If this function is called several
+     * times, previous callbacks will be overwritten.
+     *
+     * @param callback Callback to register.
+     */
+    void register_on_link_stats(link_stats_callback_t callback);
+
     /**
      * @brief Get vector of device UUIDs.
      *
@@ -163,3 +163,52 @@ TEST_F(SitlTest, OffboardVelocityBody)
     action_ret = device.action().land();
     EXPECT_EQ(action_ret, Action::Result::SUCCESS);
 }
+
+
+TEST_F(SitlTest, OffboardVelocityHighRate)
+{
+    DroneCore dc;
+
+    DroneCore::ConnectionResult ret = dc.add_udp_connection();
+    ASSERT_EQ(DroneCore::ConnectionResult::SUCCESS, ret);
+
+    // Wait for device to connect via heartbeat.
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    Device &device = dc.device();
+
+    while (!device.telemetry().health_all_ok()) {
+        std::cout << "waiting for device to be ready" << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    EXPECT_EQ(device.offboard().set_rate_hz(0.5f), Offboard::Result::INVALID_ARGUMENT);
+    ASSERT_EQ(device.offboard().set_rate_hz(100.0f), Offboard::Result::SUCCESS);
+
+    Action::Result action_ret = device.action().arm();
+    ASSERT_EQ(Action::Result::SUCCESS, action_ret);
+
+    action_ret = device.action().takeoff();
+    ASSERT_EQ(Action::Result::SUCCESS, action_ret);
+
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+
+    device.offboard().set_velocity_ned({0.0f, 0.0f, 0.0f, 0.0f});
+    Offboard::Result offboard_result = device.offboard().start();
+    EXPECT_EQ(offboard_result, Offboard::Result::SUCCESS);
+
+    device.offboard().set_velocity_ned({1.0f, 0.0f, 0.0f, 0.0f});
+    std::this_thread::sleep_for(std::chrono::seconds(3));
+
+    const Offboard::SenderStats stats = device.offboard().sender_stats();
+    std::cout << "Achieved rate: " << stats.achieved_rate_hz << " Hz, jitter p50: "
+              << stats.jitter.p50_us << " us, p99: " << stats.jitter.p99_us << " us"
+              << std::endl;
+    EXPECT_NEAR(stats.achieved_rate_hz, 100.0, 5.0);
+    EXPECT_GT(stats.setpoints_sent, 250u);
+
+    offboard_result = device.offboard().stop();
+    EXPECT_EQ(offboard_result, Offboard::Result::SUCCESS);
+
+    action_ret = device.action().land();
+    EXPECT_EQ(action_ret, Action::Result::SUCCESS);
+}
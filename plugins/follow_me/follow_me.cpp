@@ -37,6 +37,21 @@ void FollowMe::get_last_location(TargetLocation &last_location)
     return _impl->get_last_location(last_location);
 }
 
+FollowMe::SenderConfig FollowMe::get_sender_config() const
+{
+    return _impl->get_sender_config();
+}
+
+bool FollowMe::set_sender_config(const SenderConfig &config)
+{
+    return _impl->set_sender_config(config);
+}
+
+FollowMe::SenderStats FollowMe::get_sender_stats() const
+{
+    return _impl->get_sender_stats();
+}
+
 std::string FollowMe::Config::to_str(FollowMe::Config::FollowDirection direction)
 {
     switch (direction) {
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 
 namespace dronecore {
@@ -142,6 +143,65 @@ public:
      */
     void get_last_location(TargetLocation &last_location);
 
+    /**
+     * @brief Configuration of how the target location is sent to the vehicle.
+     *
+     * Instead of sending the target location at a fixed rate, its motion is extrapolated from
+     * the last location sent, assuming constant acceleration like the vehicle does. A new
+     * location is only sent once this prediction is off by more than error_threshold_m, but at
+     * least at min_rate_hz and at most at max_rate_hz.
+     *
+     * If the velocity of the target location is not finite, it is estimated from consecutive
+     * locations. The acceleration is always estimated.
+     *
+     * @sa get_sender_config(), set_sender_config()
+     */
+    struct SenderConfig {
+        constexpr static const float MIN_RATE_HZ = 0.2f; /**< @brief Lowest rate, in Hz. */
+        constexpr static const float MAX_RATE_HZ = 50.0f; /**< @brief Highest rate, in Hz. */
+
+        float min_rate_hz = 1.0f; /**< @brief Rate when the prediction is good, in Hz. */
+        float max_rate_hz = 10.0f; /**< @brief Rate when the prediction is bad, in Hz. */
+        float error_threshold_m = 0.5f; /**< @brief Prediction error allowed, in meters. */
+    };
+
+    /**
+     * @brief Gets the current configuration of the target location sender.
+     * @return Current sender configuration.
+     * @sa set_sender_config()
+     */
+    SenderConfig get_sender_config() const;
+
+    /**
+     * @brief Sets the configuration of the target location sender.
+     * @param[in] config Sender configuration to be applied.
+     * @return `true` if the configuration is applied, `false` if the rates are out of range or
+     *         the minimum rate is above the maximum rate, or the threshold is not positive.
+     * @sa get_sender_config()
+     */
+    bool set_sender_config(const SenderConfig &config);
+
+    /**
+     * @brief Statistics of the target location sender since FollowMe was started.
+     */
+    struct SenderStats {
+        uint64_t locations_sent; /**< @brief Number of target locations sent. */
+        uint64_t bytes_sent; /**< @brief Bytes of the messages sent. */
+        uint64_t bytes_saved; /**< @brief Bytes saved compared to sending at max_rate_hz. */
+        double mean_error_m; /**< @brief Mean error of the location predicted by the vehicle. */
+        double max_error_m; /**< @brief Maximum error of the location predicted by the vehicle. */
+    };
+
+    /**
+     * @brief Returns the statistics of the target location sender.
+     *
+     * The error is the distance between the location the vehicle predicts from the last
+     * location sent and the location of the target, checked at max_rate_hz.
+     *
+     * @return Sender statistics.
+     */
+    SenderStats get_sender_stats() const;
+
     /**
      * @brief Returns English string for FollowMe error codes
      *
@@ -0,0 +1,167 @@
+#include "follow_me_extrapolator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dronecore {
+
+constexpr double FollowMeExtrapolator::MAX_EXTRAPOLATION_S;
+constexpr float FollowMeExtrapolator::ACCELERATION_GAIN;
+constexpr float FollowMeExtrapolator::MAX_ACCELERATION_M_S2;
+
+namespace {
+
+// Locations closer in time than this don't give a usable velocity.
+constexpr double MIN_INTERVAL_S = 1e-3;
+
+// Checks driven by a timer at the maximum rate can come a bit early.
+constexpr double MAX_RATE_MARGIN = 0.9;
+
+void limit_norm(float *vector, float max_norm)
+{
+    const float norm = std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] +
+                                 vector[2] * vector[2]);
+    if (norm > max_norm) {
+        for (unsigned i = 0; i < 3; ++i) {
+            vector[i] *= max_norm / norm;
+        }
+    }
+}
+
+} // namespace
+
+void FollowMeExtrapolator::reset()
+{
+    _plane.reset();
+    _has_location = false;
+    _has_sent = false;
+}
+
+void FollowMeExtrapolator::add_location(const FollowMe::TargetLocation &location, double time_s)
+{
+    if (!std::isfinite(location.latitude_deg) || !std::isfinite(location.longitude_deg) ||
+        !std::isfinite(location.absolute_altitude_m)) {
+        return;
+    }
+
+    const GeodeticPosition geodetic {location.latitude_deg, location.longitude_deg,
+                                     location.absolute_altitude_m};
+    if (!_plane) {
+        _plane.reset(new LocalTangentPlane(geodetic));
+    }
+    const NedPosition ned = _plane->to_ned(geodetic);
+
+    State state {};
+    state.time_s = time_s;
+    state.position_m[0] = ned.north_m;
+    state.position_m[1] = ned.east_m;
+    state.position_m[2] = ned.down_m;
+
+    // The velocity of the target location is taken as north, east and down.
+    const bool has_velocity = std::isfinite(location.velocity_x_m_s) &&
+                              std::isfinite(location.velocity_y_m_s) &&
+                              std::isfinite(location.velocity_z_m_s);
+    const double interval_s = time_s - _target.time_s;
+    const bool has_interval = _has_location && interval_s >= MIN_INTERVAL_S;
+
+    if (has_velocity) {
+        state.velocity_m_s[0] = location.velocity_x_m_s;
+        state.velocity_m_s[1] = location.velocity_y_m_s;
+        state.velocity_m_s[2] = location.velocity_z_m_s;
+    }
+
+    for (unsigned i = 0; i < 3; ++i) {
+        if (has_interval) {
+            if (!has_velocity) {
+                state.velocity_m_s[i] =
+                    float((state.position_m[i] - _target.position_m[i]) / interval_s);
+            }
+            const float acceleration_m_s2 =
+                (state.velocity_m_s[i] - _target.velocity_m_s[i]) / float(interval_s);
+            state.acceleration_m_s2[i] = _target.acceleration_m_s2[i] + ACCELERATION_GAIN *
+                                         (acceleration_m_s2 - _target.acceleration_m_s2[i]);
+        } else if (_has_location) {
+            // Too close to the last one, keep what we estimated so far.
+            if (!has_velocity) {
+                state.velocity_m_s[i] = _target.velocity_m_s[i];
+            }
+            state.acceleration_m_s2[i] = _target.acceleration_m_s2[i];
+        }
+    }
+    limit_norm(state.acceleration_m_s2, MAX_ACCELERATION_M_S2);
+
+    _target = state;
+    _has_location = true;
+}
+
+FollowMeExtrapolator::State FollowMeExtrapolator::estimate(double time_s) const
+{
+    return extrapolate(_target, time_s);
+}
+
+double FollowMeExtrapolator::prediction_error_m(double time_s) const
+{
+    if (!_has_location || !_has_sent) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    const State predicted = extrapolate(_sent, time_s);
+    const State estimated = estimate(time_s);
+
+    double sum = 0.0;
+    for (unsigned i = 0; i < 3; ++i) {
+        const double difference = predicted.position_m[i] - estimated.position_m[i];
+        sum += difference * difference;
+    }
+    return std::sqrt(sum);
+}
+
+bool FollowMeExtrapolator::should_send(double time_s, const FollowMe::SenderConfig &config,
+                                       double &error_m) const
+{
+    error_m = prediction_error_m(time_s);
+
+    if (!_has_location) {
+        return false;
+    }
+    if (!_has_sent) {
+        return true;
+    }
+
+    const double since_sent_s = time_s - _sent.time_s;
+    if (since_sent_s * double(config.max_rate_hz) < MAX_RATE_MARGIN) {
+        return false;
+    }
+    if (since_sent_s * double(config.min_rate_hz) >= 1.0) {
+        return true;
+    }
+    return error_m > double(config.error_threshold_m);
+}
+
+void FollowMeExtrapolator::set_sent(const State &state)
+{
+    _sent = state;
+    _has_sent = true;
+}
+
+GeodeticPosition FollowMeExtrapolator::to_geodetic(const State &state) const
+{
+    return _plane->from_ned(NedPosition {state.position_m[0], state.position_m[1],
+                                         state.position_m[2]});
+}
+
+FollowMeExtrapolator::State FollowMeExtrapolator::extrapolate(const State &state, double time_s)
+{
+    const double dt = std::min(std::max(time_s - state.time_s, 0.0), MAX_EXTRAPOLATION_S);
+
+    State result = state;
+    result.time_s = time_s;
+    for (unsigned i = 0; i < 3; ++i) {
+        result.position_m[i] += double(state.velocity_m_s[i]) * dt +
+                                0.5 * double(state.acceleration_m_s2[i]) * dt * dt;
+        result.velocity_m_s[i] += state.acceleration_m_s2[i] * float(dt);
+    }
+    return result;
+}
+
+} // namespace dronecore
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "follow_me.h"
+#include "geodesy.h"
+#include <memory>
+
+namespace dronecore {
+
+// Decides when the target location needs to be sent to the vehicle.
+//
+// Both the target, from the locations the app sets, and what the vehicle
+// knows about it, from the last location sent, are extrapolated with a
+// constant acceleration model. A location is sent when the two are further
+// apart than the threshold, when the last one sent is older than the minimum
+// rate allows, but never faster than the maximum rate.
+//
+// Positions are kept in metres north, east and down of the first location.
+class FollowMeExtrapolator
+{
+public:
+    struct State {
+        double time_s;
+        double position_m[3];
+        float velocity_m_s[3];
+        float acceleration_m_s2[3];
+    };
+
+    FollowMeExtrapolator() = default;
+    ~FollowMeExtrapolator() = default;
+
+    // delete copy and move constructors and assign operators
+    FollowMeExtrapolator(FollowMeExtrapolator const &) = delete;            // Copy construct
+    FollowMeExtrapolator(FollowMeExtrapolator &&) = delete;                 // Move construct
+    FollowMeExtrapolator &operator=(FollowMeExtrapolator const &) = delete; // Copy assign
+    FollowMeExtrapolator &operator=(FollowMeExtrapolator &&) = delete;      // Move assign
+
+    // Forgets everything, including the reference position.
+    void reset();
+
+    // Locations with a non-finite position are ignored.
+    void add_location(const FollowMe::TargetLocation &location, double time_s);
+
+    bool has_location() const { return _has_location; }
+
+    // Estimated state of the target at time_s.
+    State estimate(double time_s) const;
+
+    // Distance between where the vehicle thinks the target is and our
+    // estimate, infinite if nothing was sent yet.
+    double prediction_error_m(double time_s) const;
+
+    // Whether to send now, error_m is set to the prediction error.
+    bool should_send(double time_s, const FollowMe::SenderConfig &config, double &error_m) const;
+
+    // The state has been sent, the vehicle extrapolates from it now.
+    void set_sent(const State &state);
+
+    // Forgets what was sent, e.g. when the vehicle starts following again.
+    void reset_sent() { _has_sent = false; }
+
+    GeodeticPosition to_geodetic(const State &state) const;
+
+    static State extrapolate(const State &state, double time_s);
+
+    // A target which stops reporting is not extrapolated any further.
+    static constexpr double MAX_EXTRAPOLATION_S = 2.0;
+
+    // Weight of a new acceleration estimate, the differences of noisy
+    // velocities are noisy.
+    static constexpr float ACCELERATION_GAIN = 0.5f;
+
+    // Higher accelerations are taken as noise.
+    static constexpr float MAX_ACCELERATION_M_S2 = 20.0f;
+
+private:
+    std::unique_ptr<LocalTangentPlane> _plane {};
+
+    bool _has_location = false;
+    State _target {};
+
+    bool _has_sent = false;
+    State _sent {};
+};
+
+} // namespace dronecore
@@ -0,0 +1,152 @@
+#include "follow_me_extrapolator.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+
+using namespace dronecore;
+
+namespace {
+
+const GeodeticPosition REFERENCE {47.397742, 8.545594, 488.0};
+
+// Target at north and east metres of the reference, velocity NAN if unknown.
+FollowMe::TargetLocation target_location(double north_m, double east_m,
+                                         float velocity_north_m_s, float velocity_east_m_s)
+{
+    const LocalTangentPlane plane(REFERENCE);
+    const GeodeticPosition geodetic = plane.from_ned(NedPosition {north_m, east_m, 0.0});
+    const float velocity_down_m_s = std::isfinite(velocity_north_m_s) ? 0.0f : NAN;
+    return FollowMe::TargetLocation {geodetic.latitude_deg, geodetic.longitude_deg,
+                                     geodetic.altitude_m, velocity_north_m_s,
+                                     velocity_east_m_s, velocity_down_m_s};
+}
+
+struct Result {
+    unsigned num_sent;
+    double max_error_m;
+};
+
+// Locations at 10 Hz for 10 seconds, checked at 50 Hz like the timer would.
+Result simulate(const std::function<FollowMe::TargetLocation(double)> &target,
+                const FollowMe::SenderConfig &config)
+{
+    FollowMeExtrapolator extrapolator;
+    Result result {0, 0.0};
+
+    for (unsigned i = 0; i < 500; ++i) {
+        const double time_s = i * 0.02;
+        if (i % 5 == 0) {
+            extrapolator.add_location(target(time_s), time_s);
+        }
+
+        double error_m;
+        if (extrapolator.should_send(time_s, config, error_m)) {
+            extrapolator.set_sent(extrapolator.estimate(time_s));
+            ++result.num_sent;
+        } else if (time_s > 1.0) {
+            // Ignore the start while the estimates settle.
+            result.max_error_m = std::max(result.max_error_m, error_m);
+        }
+    }
+    return result;
+}
+
+FollowMe::SenderConfig config_at_50_hz()
+{
+    FollowMe::SenderConfig config {};
+    config.min_rate_hz = 1.0f;
+    config.max_rate_hz = 50.0f;
+    config.error_threshold_m = 0.5f;
+    return config;
+}
+
+} // namespace
+
+TEST(FollowMeExtrapolator, ConvertsBackToGeodetic)
+{
+    FollowMeExtrapolator extrapolator;
+    EXPECT_FALSE(extrapolator.has_location());
+
+    const FollowMe::TargetLocation location = target_location(100.0, -50.0, 1.0f, 2.0f);
+    extrapolator.add_location(location, 3.0);
+    ASSERT_TRUE(extrapolator.has_location());
+
+    const GeodeticPosition geodetic = extrapolator.to_geodetic(extrapolator.estimate(3.0));
+    EXPECT_NEAR(geodetic.latitude_deg, location.latitude_deg, 1e-9);
+    EXPECT_NEAR(geodetic.longitude_deg, location.longitude_deg, 1e-9);
+    EXPECT_NEAR(geodetic.altitude_m, location.absolute_altitude_m, 1e-3);
+
+    // Nothing sent, so the vehicle knows nothing.
+    EXPECT_TRUE(std::isinf(extrapolator.prediction_error_m(3.0)));
+}
+
+TEST(FollowMeExtrapolator, EstimatesVelocityAndAcceleration)
+{
+    FollowMeExtrapolator extrapolator;
+
+    // Accelerating north at 2 m/s^2 from standstill, without velocities.
+    for (unsigned i = 0; i <= 50; ++i) {
+        const double time_s = i * 0.1;
+        extrapolator.add_location(target_location(time_s * time_s, 0.0, NAN, NAN), time_s);
+    }
+
+    const FollowMeExtrapolator::State state = extrapolator.estimate(5.0);
+    // The difference quotient is the velocity half a step ago.
+    EXPECT_NEAR(state.velocity_m_s[0], 9.9f, 0.05f);
+    EXPECT_NEAR(state.velocity_m_s[1], 0.0f, 0.05f);
+    EXPECT_NEAR(state.acceleration_m_s2[0], 2.0f, 0.05f);
+}
+
+TEST(FollowMeExtrapolator, StationaryTargetIsSentAtMinRate)
+{
+    const Result result = simulate([](double) {
+        return target_location(10.0, 20.0, 0.0f, 0.0f);
+    }, config_at_50_hz());
+
+    EXPECT_GE(result.num_sent, 10u);
+    EXPECT_LE(result.num_sent, 11u);
+    EXPECT_LT(result.max_error_m, 0.01);
+}
+
+TEST(FollowMeExtrapolator, ConstantVelocityIsPredicted)
+{
+    // With and without velocities in the locations.
+    const Result with_velocity = simulate([](double time_s) {
+        return target_location(0.0, 5.0 * time_s, 0.0f, 5.0f);
+    }, config_at_50_hz());
+
+    EXPECT_LE(with_velocity.num_sent, 11u);
+    EXPECT_LT(with_velocity.max_error_m, 0.01);
+
+    const Result without_velocity = simulate([](double time_s) {
+        return target_location(0.0, 5.0 * time_s, NAN, NAN);
+    }, config_at_50_hz());
+
+    EXPECT_LE(without_velocity.num_sent, 15u);
+    EXPECT_LT(without_velocity.max_error_m, 0.5);
+}
+
+TEST(FollowMeExtrapolator, ManeuveringTargetIsSentMoreOften)
+{
+    // Back and forth at 5 m/s, turning around every second.
+    auto zigzag = [](double time_s) {
+        const double phase = std::fmod(time_s, 2.0);
+        const bool forward = (phase < 1.0);
+        return target_location(0.0, forward ? 5.0 * phase : 5.0 * (2.0 - phase),
+                               0.0f, forward ? 5.0f : -5.0f);
+    };
+
+    const Result result = simulate(zigzag, config_at_50_hz());
+    EXPECT_GT(result.num_sent, 20u);
+    // Still far fewer than the 500 checks.
+    EXPECT_LT(result.num_sent, 100u);
+    EXPECT_LE(result.max_error_m, 0.5);
+
+    // The maximum rate wins over the threshold.
+    FollowMe::SenderConfig slow = config_at_50_hz();
+    slow.max_rate_hz = 2.0f;
+    const Result limited = simulate(zigzag, slow);
+    EXPECT_LE(limited.num_sent, 21u);
+    EXPECT_GT(limited.max_error_m, 1.0);
+}
@@ -2,11 +2,14 @@
 #include "device_impl.h"
 #include "global_include.h"
 #include "px4_custom_mode.h"
+#include <algorithm>
 #include <functional>
 #include <cmath>
 
 namespace dronecore {
 
+constexpr unsigned FollowMeImpl::FOLLOW_TARGET_MESSAGE_LEN;
+
 using namespace std::placeholders; // for `_1`
 
 FollowMeImpl::FollowMeImpl() :
@@ -82,27 +85,21 @@ void FollowMeImpl::set_curr_target_location(const FollowMe::TargetLocation &loca
 {
     _mutex.lock();
     _curr_target_location = location;
-    // We're sending only lat, long & alt to the vehicle.
-    _estimatation_capabilities |= (1 << static_cast<int>(EstimationCapabilites::POS));
+    _extrapolator.add_location(location, _time.elapsed_s());
+    // The velocity and acceleration are estimated if not given.
+    _estimatation_capabilities |= (1 << static_cast<int>(EstimationCapabilites::POS)) |
+                                  (1 << static_cast<int>(EstimationCapabilites::VEL)) |
+                                  (1 << static_cast<int>(EstimationCapabilites::ACCEL));
 
     if (_mode != Mode::ACTIVE) {
         _mutex.unlock();
         return;
     }
-    // If set already, reschedule it.
-    if (_curr_target_location_cookie) {
-        _parent->reset_call_every(_curr_target_location_cookie);
-        _curr_target_location_cookie = nullptr;
-    } else {
-        // Regiter now for sending in the next cycle.
-        _parent->add_call_every([this]() { send_curr_target_location(); },
-        SENDER_RATE,
-        &_curr_target_location_cookie);
-    }
+    start_checking_target_location();
     _mutex.unlock();
 
-    // Send it immediately for now.
-    send_curr_target_location();
+    // A location which the vehicle couldn't predict goes out right away.
+    check_target_location(false);
 }
 
 void FollowMeImpl::get_last_location(FollowMe::TargetLocation &last_location)
@@ -141,10 +138,10 @@ FollowMe::Result FollowMeImpl::start()
         // If location was set before, lets send it to vehicle
         std::lock_guard<std::mutex> lock(
             _mutex); // locking is not necessary here but lets do it for integrity
+        reset_sender_stats();
+        _extrapolator.reset_sent();
         if (is_current_location_set()) {
-            _parent->add_call_every([this]() { send_curr_target_location(); },
-            SENDER_RATE,
-            &_curr_target_location_cookie);
+            start_checking_target_location();
         }
     }
     return result;
@@ -176,6 +173,60 @@ FollowMe::Result FollowMeImpl::stop()
                    MavlinkCommands::DEFAULT_COMPONENT_ID_AUTOPILOT));
 }
 
+FollowMe::SenderConfig FollowMeImpl::get_sender_config() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _sender_config;
+}
+
+bool FollowMeImpl::set_sender_config(const FollowMe::SenderConfig &config)
+{
+    if (!(config.min_rate_hz >= FollowMe::SenderConfig::MIN_RATE_HZ &&
+          config.max_rate_hz <= FollowMe::SenderConfig::MAX_RATE_HZ &&
+          config.min_rate_hz <= config.max_rate_hz)) {
+        LogErr() << "Err: Sender rates must be in range (0.2 to 50 Hz)";
+        return false;
+    }
+    if (!(config.error_threshold_m > 0.0f && std::isfinite(config.error_threshold_m))) {
+        LogErr() << "Err: Sender error threshold must be positive";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sender_config = config;
+    if (_curr_target_location_cookie) {
+        _parent->change_call_every(1.0f / _sender_config.max_rate_hz,
+                                   _curr_target_location_cookie);
+    }
+    return true;
+}
+
+FollowMe::SenderStats FollowMeImpl::get_sender_stats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    FollowMe::SenderStats stats {};
+    stats.locations_sent = _num_locations_sent;
+    stats.bytes_sent = _num_locations_sent * FOLLOW_TARGET_MESSAGE_LEN;
+    if (_num_timer_checks > _num_locations_sent) {
+        stats.bytes_saved = (_num_timer_checks - _num_locations_sent) * FOLLOW_TARGET_MESSAGE_LEN;
+    }
+    if (_num_timer_checks > 0) {
+        stats.mean_error_m = _error_sum_m / double(_num_timer_checks);
+    }
+    stats.max_error_m = _max_error_m;
+    return stats;
+}
+
+void FollowMeImpl::reset_sender_stats()
+{
+    // We assume that mutex was acquired by the caller
+    _num_timer_checks = 0;
+    _num_locations_sent = 0;
+    _error_sum_m = 0.0;
+    _max_error_m = 0.0;
+}
+
 // Applies default FollowMe configuration to the device
 void FollowMeImpl::set_default_config()
 {
@@ -299,28 +350,85 @@ bool FollowMeImpl::is_current_location_set() const
     return std::isfinite(_curr_target_location.latitude_deg);
 }
 
-void FollowMeImpl::send_curr_target_location()
+void FollowMeImpl::start_checking_target_location()
+{
+    // We assume that mutex was acquired by the caller
+    if (_curr_target_location_cookie) {
+        return;
+    }
+    // At the maximum rate, the location is only sent when needed.
+    _parent->add_call_every([this]() { check_target_location(true); },
+    1.0f / _sender_config.max_rate_hz,
+    &_curr_target_location_cookie);
+}
+
+void FollowMeImpl::check_target_location(bool on_timer)
 {
     // Don't send if we're not in FollowMe mode.
     if (!is_active()) {
         return;
     }
 
-    dl_time_t now = _time.steady_time();
+    const double time_s = _time.elapsed_s();
+
+    FollowMeExtrapolator::State state;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_extrapolator.has_location()) {
+            return;
+        }
+
+        double error_m;
+        const bool send = _extrapolator.should_send(time_s, _sender_config, error_m);
+
+        if (on_timer) {
+            // Once sent, the vehicle knows where the target is.
+            const double remaining_error_m = send ? 0.0 : error_m;
+            ++_num_timer_checks;
+            _error_sum_m += remaining_error_m;
+            _max_error_m = std::max(_max_error_m, remaining_error_m);
+        }
+
+        if (!send) {
+            return;
+        }
+
+        // Set before sending so that a concurrent check doesn't send it again.
+        state = _extrapolator.estimate(time_s);
+        _extrapolator.set_sent(state);
+    }
+
+    if (!send_target_state(state)) {
+        LogErr() << "send_target_state() failed..";
+        // The vehicle didn't get it, so it is sent again on the next check.
+        std::lock_guard<std::mutex> lock(_mutex);
+        _extrapolator.reset_sent();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_num_locations_sent;
+    _last_location = _curr_target_location;
+}
+
+bool FollowMeImpl::send_target_state(const FollowMeExtrapolator::State &state)
+{
+    GeodeticPosition geodetic;
+    uint8_t estimation_capabilities;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        geodetic = _extrapolator.to_geodetic(state);
+        estimation_capabilities = _estimatation_capabilities;
+    }
+
     // needed by http://mavlink.org/messages/common#FOLLOW_TARGET
-    uint64_t elapsed_msec = static_cast<uint64_t>(_time.elapsed_since_s(now) * 1000); // milliseconds
+    const uint64_t elapsed_msec = static_cast<uint64_t>(state.time_s * 1000); // milliseconds
 
-    _mutex.lock();
-//    LogDebug() << "Lat: " << _curr_target_location.latitude_deg << " Lon: " << _curr_target_location.longitude_deg <<
-//	" Alt: " << _curr_target_location.absolute_altitude_m;
-    const int32_t lat_int = static_cast<int32_t>(_curr_target_location.latitude_deg * 1e7);
-    const int32_t lon_int = static_cast<int32_t>(_curr_target_location.longitude_deg * 1e7);
-    const float alt = static_cast<float>(_curr_target_location.absolute_altitude_m);
-    _mutex.unlock();
+    const int32_t lat_int = static_cast<int32_t>(std::round(geodetic.latitude_deg * 1e7));
+    const int32_t lon_int = static_cast<int32_t>(std::round(geodetic.longitude_deg * 1e7));
+    const float alt = static_cast<float>(geodetic.altitude_m);
 
     const float pos_std_dev[] = { NAN, NAN, NAN };
-    const float vel[] = { NAN, NAN, NAN };
-    const float accel_unknown[] = { NAN, NAN, NAN };
     const float attitude_q_unknown[] = { 1.f, NAN, NAN, NAN };
     const float rates_unknown[] = { NAN, NAN, NAN };
     uint64_t custom_state = 0;
@@ -330,23 +438,18 @@ void FollowMeImpl::send_curr_target_location()
                                    _parent->get_own_component_id(),
                                    &msg,
                                    elapsed_msec,
-                                   _estimatation_capabilities,
+                                   estimation_capabilities,
                                    lat_int,
                                    lon_int,
                                    alt,
-                                   vel,
-                                   accel_unknown,
+                                   state.velocity_m_s,
+                                   state.acceleration_m_s2,
                                    attitude_q_unknown,
                                    rates_unknown,
                                    pos_std_dev,
                                    custom_state);
 
-    if (!_parent->send_message(msg)) {
-        LogErr() << "send_curr_target_location() failed..";
-    } else {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _last_location = _curr_target_location;
-    }
+    return _parent->send_message(msg);
 }
 
 void FollowMeImpl::stop_sending_target_location()
@@ -385,7 +488,6 @@ void FollowMeImpl::process_heartbeat(const mavlink_message_t &message)
         } else if (follow_me_active && _mode == Mode::NOT_ACTIVE) {
             // We're in FollowMe mode now
             _mode = Mode::ACTIVE;
-            _mutex.unlock(); // we must unlock to avoid deadlock in send_curr_target_location()
             return;
         }
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "follow_me.h"
+#include "follow_me_extrapolator.h"
 #include "mavlink_include.h"
 #include "plugin_impl_base.h"
 #include "device_impl.h"
@@ -27,6 +28,10 @@ public:
     void set_curr_target_location(const FollowMe::TargetLocation &location);
     void get_last_location(FollowMe::TargetLocation &last_location);
 
+    FollowMe::SenderConfig get_sender_config() const;
+    bool set_sender_config(const FollowMe::SenderConfig &config);
+    FollowMe::SenderStats get_sender_stats() const;
+
     bool is_active() const;
 
     FollowMe::Result start();
@@ -45,12 +50,17 @@ private:
     FollowMe::Result to_follow_me_result(MavlinkCommands::Result result) const;
 
     bool is_current_location_set() const;
-    void send_curr_target_location();
+    void start_checking_target_location();
+    // Sends the target location if the prediction of the vehicle is off.
+    void check_target_location(bool on_timer);
+    bool send_target_state(const FollowMeExtrapolator::State &state);
     void stop_sending_target_location();
+    void reset_sender_stats();
 
     enum class EstimationCapabilites {
         POS,
-        VEL
+        VEL,
+        ACCEL
     };
 
     enum class Mode {
@@ -67,7 +77,18 @@ private:
     uint8_t _estimatation_capabilities = 0; // sent to vehicle
     FollowMe::Config _config {}; // has FollowMe configuration settings
 
-    const float SENDER_RATE = 1.0f; // send location updates once in a second
+    FollowMe::SenderConfig _sender_config {};
+    FollowMeExtrapolator _extrapolator {};
+
+    // Since FollowMe was started, for the sender statistics.
+    uint64_t _num_timer_checks = 0;
+    uint64_t _num_locations_sent = 0;
+    double _error_sum_m = 0.0;
+    double _max_error_m = 0.0;
+
+    // FOLLOW_TARGET without signature.
+    static constexpr unsigned FOLLOW_TARGET_MESSAGE_LEN =
+        MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_MSG_ID_FOLLOW_TARGET_LEN;
 };
 
 } // namespace dronecore
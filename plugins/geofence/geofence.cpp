@@ -0,0 +1,57 @@
+#include "geofence.h"
+#include "geofence_impl.h"
+
+namespace dronecore {
+
+Geofence::Geofence(GeofenceImpl *impl) :
+    _impl(impl)
+{
+}
+
+Geofence::~Geofence()
+{
+}
+
+Geofence::Result Geofence::set_zones(const std::vector<Polygon> &polygons,
+                                     const std::vector<Circle> &circles)
+{
+    return _impl->set_zones(polygons, circles);
+}
+
+Geofence::Status Geofence::check(double latitude_deg, double longitude_deg) const
+{
+    return _impl->check(latitude_deg, longitude_deg);
+}
+
+void Geofence::breach_async(breach_callback_t callback)
+{
+    _impl->breach_async(callback);
+}
+
+void Geofence::upload_async(result_callback_t callback)
+{
+    _impl->upload_async(callback);
+}
+
+const char *Geofence::result_str(Result result)
+{
+    switch (result) {
+        case Result::SUCCESS:
+            return "Success";
+        case Result::ERROR:
+            return "Error";
+        case Result::TOO_MANY_GEOFENCE_ITEMS:
+            return "Too many geofence items";
+        case Result::BUSY:
+            return "Busy";
+        case Result::TIMEOUT:
+            return "Timeout";
+        case Result::INVALID_ARGUMENT:
+            return "Invalid argument";
+        case Result::UNKNOWN:
+        default:
+            return "Unknown";
+    }
+}
+
+} // namespace dronecore
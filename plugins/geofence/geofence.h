@@ -0,0 +1,186 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace dronecore {
+
+class GeofenceImpl;
+
+/**
+ * @brief The Geofence class checks the vehicle position against keep-in and keep-out zones
+ * and uploads these zones to the vehicle.
+ *
+ * Zones are polygons or circles, each either an inclusion zone (the vehicle has to stay inside)
+ * or an exclusion zone (the vehicle has to stay outside). If there are inclusion zones, the
+ * vehicle has to be inside at least one of them.
+ *
+ * The zones are kept in a spatial index, so that every position received from the vehicle
+ * is checked in well under a microsecond, even for hundreds of zones.
+ */
+class Geofence
+{
+public:
+    /**
+     * @brief Constructor (internal use only).
+     *
+     * @param impl Private internal implementation.
+     */
+    explicit Geofence(GeofenceImpl *impl);
+
+    /**
+     * @brief Destructor (internal use only).
+     */
+    ~Geofence();
+
+    /**
+     * @brief Possible results returned for geofence requests.
+     */
+    enum class Result {
+        SUCCESS = 0, /**< @brief Request succeeded. */
+        ERROR, /**< @brief Error. */
+        TOO_MANY_GEOFENCE_ITEMS, /**< @brief Too many zones for the vehicle. */
+        BUSY, /**< @brief Vehicle busy. */
+        TIMEOUT, /**< @brief Request timed out. */
+        INVALID_ARGUMENT, /**< @brief Invalid zone. */
+        UNKNOWN /**< @brief Unknown error. */
+    };
+
+    /**
+     * @brief Gets a human-readable English string for a Geofence::Result.
+     *
+     * @param result Enum for which string is required.
+     * @return Human readable string for the Geofence::Result.
+     */
+    static const char *result_str(Result result);
+
+    /**
+     * @brief Callback type for asynchronous Geofence calls.
+     */
+    typedef std::function<void(Result)> result_callback_t;
+
+    /**
+     * @brief Whether the vehicle needs to stay inside or outside a zone.
+     */
+    enum class FenceType {
+        INCLUSION, /**< @brief The vehicle has to stay inside. */
+        EXCLUSION /**< @brief The vehicle has to stay outside. */
+    };
+
+    /**
+     * @brief Position of a polygon vertex or circle center.
+     */
+    struct Point {
+        double latitude_deg; /**< @brief Latitude in degrees. */
+        double longitude_deg; /**< @brief Longitude in degrees. */
+    };
+
+    /**
+     * @brief Polygon zone.
+     *
+     * The edges connect the points in order and the last point back to the first one. The
+     * polygon must not cross the antimeridian.
+     */
+    struct Polygon {
+        FenceType fence_type; /**< @brief Inclusion or exclusion. */
+        std::vector<Point> points; /**< @brief At least 3 vertices. */
+    };
+
+    /**
+     * @brief Circular zone.
+     */
+    struct Circle {
+        FenceType fence_type; /**< @brief Inclusion or exclusion. */
+        Point center; /**< @brief Center of the circle. */
+        float radius_m; /**< @brief Radius in metres. */
+    };
+
+    /**
+     * @brief Result of checking a position against the zones.
+     */
+    struct Status {
+        /**
+         * @brief True if the position is outside all inclusion zones (if there are any) or
+         * inside an exclusion zone.
+         */
+        bool breached;
+
+        /**
+         * @brief True if there are inclusion zones and the position is in none of them.
+         */
+        bool outside_inclusion;
+
+        /**
+         * @brief Index of an exclusion polygon containing the position, -1 if none.
+         */
+        int exclusion_polygon_index;
+
+        /**
+         * @brief Index of an exclusion circle containing the position, -1 if none.
+         */
+        int exclusion_circle_index;
+    };
+
+    /**
+     * @brief Callback type for breach updates.
+     */
+    typedef std::function<void(Status)> breach_callback_t;
+
+    /**
+     * @brief Sets the zones used to check positions and to upload.
+     *
+     * This replaces the previous zones and only changes the local copy, use upload_async() to
+     * send them to the vehicle.
+     *
+     * @param polygons Polygon zones.
+     * @param circles Circular zones.
+     * @return SUCCESS, or INVALID_ARGUMENT if a zone is invalid.
+     */
+    Result set_zones(const std::vector<Polygon> &polygons, const std::vector<Circle> &circles);
+
+    /**
+     * @brief Checks a position against the zones.
+     *
+     * @param latitude_deg Latitude in degrees.
+     * @param longitude_deg Longitude in degrees.
+     * @return Status of the position.
+     */
+    Status check(double latitude_deg, double longitude_deg) const;
+
+    /**
+     * @brief Subscribes to breaches of the zones by the vehicle.
+     *
+     * Every position received from the vehicle is checked against the zones. The callback is
+     * called whenever the status changes, so when a breach starts or ends, or when the vehicle
+     * moves from one breached zone into another.
+     *
+     * @param callback Function called when the status changes.
+     */
+    void breach_async(breach_callback_t callback);
+
+    /**
+     * @brief Uploads the zones to the vehicle (asynchronous).
+     *
+     * The zones are sent using the MAVLink mission protocol with the fence mission type and
+     * replace the fence on the vehicle.
+     *
+     * @param callback Function called with the result of the upload.
+     */
+    void upload_async(result_callback_t callback);
+
+    /**
+     * @brief Copy constructor (object is not copyable).
+     */
+    Geofence(const Geofence &) = delete;
+
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const Geofence &operator=(const Geofence &) = delete;
+
+private:
+    /** @private Underlying implementation, set at instantiation */
+    GeofenceImpl *_impl;
+};
+
+} // namespace dronecore
@@ -0,0 +1,330 @@
+#include "geofence_impl.h"
+#include "device_impl.h"
+#include "global_include.h"
+#include <cmath>
+
+namespace dronecore {
+
+constexpr double GeofenceImpl::UPLOAD_TIMEOUT_S;
+
+GeofenceImpl::GeofenceImpl() :
+    PluginImplBase() {}
+
+GeofenceImpl::~GeofenceImpl() {}
+
+void GeofenceImpl::init()
+{
+    using namespace std::placeholders; // for `_1`
+
+    _parent->register_mavlink_message_view_handler(
+        MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+        std::bind(&GeofenceImpl::process_global_position_int, this, _1), this);
+
+    _parent->register_mavlink_message_handler(
+        MAVLINK_MSG_ID_MISSION_REQUEST_INT,
+        std::bind(&GeofenceImpl::process_mission_request_int, this, _1), this);
+
+    _parent->register_mavlink_message_handler(
+        MAVLINK_MSG_ID_MISSION_ACK,
+        std::bind(&GeofenceImpl::process_mission_ack, this, _1), this);
+}
+
+void GeofenceImpl::deinit()
+{
+    _parent->unregister_all_mavlink_message_handlers(this);
+}
+
+void GeofenceImpl::enable() {}
+
+void GeofenceImpl::disable()
+{
+    _parent->unregister_timeout_handler(_timeout_cookie);
+}
+
+Geofence::Result GeofenceImpl::set_zones(const std::vector<Geofence::Polygon> &polygons,
+                                         const std::vector<Geofence::Circle> &circles)
+{
+    // Building can take a while for many zones, so it is done without the lock.
+    std::shared_ptr<GeofenceIndex> index = std::make_shared<GeofenceIndex>();
+    if (!index->build(polygons, circles)) {
+        return Geofence::Result::INVALID_ARGUMENT;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _index = index;
+    _polygons = polygons;
+    _circles = circles;
+    // The cells are different now.
+    _last_cell = -1;
+    _last_status_valid = false;
+    return Geofence::Result::SUCCESS;
+}
+
+Geofence::Status GeofenceImpl::check(double latitude_deg, double longitude_deg) const
+{
+    std::shared_ptr<GeofenceIndex> index;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        index = _index;
+    }
+
+    if (!index) {
+        Geofence::Status status {};
+        status.exclusion_polygon_index = -1;
+        status.exclusion_circle_index = -1;
+        return status;
+    }
+    return index->check(latitude_deg, longitude_deg);
+}
+
+void GeofenceImpl::breach_async(Geofence::breach_callback_t callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _breach_callback = callback;
+    // Report the current status to the new subscriber with the next position.
+    _last_cell = -1;
+    _last_status_valid = false;
+}
+
+void GeofenceImpl::process_global_position_int(const MavlinkMessageView &view)
+{
+    const double latitude_deg = view.get(&mavlink_global_position_int_t::lat) * 1e-7;
+    const double longitude_deg = view.get(&mavlink_global_position_int_t::lon) * 1e-7;
+
+    Geofence::breach_callback_t callback;
+    Geofence::Status status;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_index || !_breach_callback) {
+            return;
+        }
+
+        const int cell = _index->cell_index(latitude_deg, longitude_deg);
+        if (_last_status_valid && cell == _last_cell && !_index->cell_has_boundary(cell)) {
+            return;
+        }
+
+        status = _index->check_in_cell(cell, latitude_deg, longitude_deg);
+        _last_cell = cell;
+
+        if (_last_status_valid && status_equal(status, _last_status)) {
+            return;
+        }
+        _last_status = status;
+        _last_status_valid = true;
+        callback = _breach_callback;
+    }
+
+    callback(status);
+}
+
+bool GeofenceImpl::status_equal(const Geofence::Status &lhs, const Geofence::Status &rhs)
+{
+    return lhs.breached == rhs.breached && lhs.outside_inclusion == rhs.outside_inclusion &&
+           lhs.exclusion_polygon_index == rhs.exclusion_polygon_index &&
+           lhs.exclusion_circle_index == rhs.exclusion_circle_index;
+}
+
+void GeofenceImpl::upload_async(const Geofence::result_callback_t &callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_uploading) {
+        report_result(callback, Geofence::Result::BUSY);
+        return;
+    }
+
+    if (!_parent->target_supports_mission_int()) {
+        LogWarn() << "Mission int messages not supported";
+        report_result(callback, Geofence::Result::ERROR);
+        return;
+    }
+
+    assemble_mavlink_fence_items(_polygons, _circles);
+    if (_mavlink_fence_items.size() > UINT16_MAX) {
+        report_result(callback, Geofence::Result::TOO_MANY_GEOFENCE_ITEMS);
+        return;
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_mission_count_pack(_parent->get_own_system_id(),
+                                   _parent->get_own_component_id(),
+                                   &message,
+                                   _parent->get_target_system_id(),
+                                   _parent->get_target_component_id(),
+                                   uint16_t(_mavlink_fence_items.size()),
+                                   MAV_MISSION_TYPE_FENCE);
+
+    if (!_parent->send_message(message)) {
+        report_result(callback, Geofence::Result::ERROR);
+        return;
+    }
+
+    _parent->register_timeout_handler(std::bind(&GeofenceImpl::process_timeout, this),
+                                      UPLOAD_TIMEOUT_S, &_timeout_cookie);
+
+    _uploading = true;
+    _result_callback = callback;
+}
+
+void GeofenceImpl::assemble_mavlink_fence_items(const std::vector<Geofence::Polygon> &polygons,
+                                                const std::vector<Geofence::Circle> &circles)
+{
+    _mavlink_fence_items.clear();
+
+    auto add_item = [this](uint16_t command, float param1, const Geofence::Point & point) {
+        mavlink_mission_item_int_t item {};
+        item.seq = uint16_t(_mavlink_fence_items.size());
+        item.frame = MAV_FRAME_GLOBAL;
+        item.command = command;
+        item.autocontinue = 1;
+        item.param1 = param1;
+        item.x = int32_t(std::round(point.latitude_deg * 1e7));
+        item.y = int32_t(std::round(point.longitude_deg * 1e7));
+        item.mission_type = MAV_MISSION_TYPE_FENCE;
+        _mavlink_fence_items.push_back(item);
+    };
+
+    // Every vertex carries the vertex count of its polygon.
+    for (const auto &polygon : polygons) {
+        const uint16_t command = (polygon.fence_type == Geofence::FenceType::INCLUSION) ?
+                                 uint16_t(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION) :
+                                 uint16_t(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION);
+        for (const auto &point : polygon.points) {
+            add_item(command, float(polygon.points.size()), point);
+        }
+    }
+
+    for (const auto &circle : circles) {
+        const uint16_t command = (circle.fence_type == Geofence::FenceType::INCLUSION) ?
+                                 uint16_t(MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION) :
+                                 uint16_t(MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION);
+        add_item(command, circle.radius_m, circle.center);
+    }
+}
+
+void GeofenceImpl::process_mission_request_int(const mavlink_message_t &message)
+{
+    mavlink_mission_request_int_t mission_request_int;
+    mavlink_msg_mission_request_int_decode(&message, &mission_request_int);
+
+    // Requests for the mission are handled by the mission plugin.
+    if (mission_request_int.mission_type != MAV_MISSION_TYPE_FENCE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (mission_request_int.target_system != _parent->get_own_system_id() &&
+        mission_request_int.target_component != _parent->get_own_component_id()) {
+
+        LogWarn() << "Ignore fence request int that is not for us";
+        return;
+    }
+
+    if (!_uploading) {
+        LogWarn() << "Ignoring fence request int, not active";
+        return;
+    }
+
+    upload_fence_item(mission_request_int.seq);
+
+    // Reset the timeout because we're still communicating.
+    _parent->refresh_timeout_handler(_timeout_cookie);
+}
+
+void GeofenceImpl::upload_fence_item(uint16_t seq)
+{
+    LogDebug() << "Send fence item " << int(seq);
+    if (seq >= _mavlink_fence_items.size()) {
+        LogErr() << "Fence item requested out of bounds.";
+        return;
+    }
+
+    // The target might have changed since the upload was started.
+    mavlink_mission_item_int_t mavlink_item = _mavlink_fence_items[seq];
+    mavlink_item.target_system = _parent->get_target_system_id();
+    mavlink_item.target_component = _parent->get_target_component_id();
+
+    mavlink_message_t message;
+    mavlink_msg_mission_item_int_encode(_parent->get_own_system_id(),
+                                        _parent->get_own_component_id(),
+                                        &message,
+                                        &mavlink_item);
+    _parent->send_message(message);
+}
+
+void GeofenceImpl::process_mission_ack(const mavlink_message_t &message)
+{
+    mavlink_mission_ack_t mission_ack;
+    mavlink_msg_mission_ack_decode(&message, &mission_ack);
+
+    if (mission_ack.mission_type != MAV_MISSION_TYPE_FENCE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_uploading) {
+        LogWarn() << "Ignoring fence ack, not active";
+        return;
+    }
+
+    if (mission_ack.target_system != _parent->get_own_system_id() &&
+        mission_ack.target_component != _parent->get_own_component_id()) {
+
+        LogWarn() << "Ignore fence ack that is not for us";
+        return;
+    }
+
+    // We got some response, so it wasn't a timeout and we can remove it.
+    _parent->unregister_timeout_handler(_timeout_cookie);
+    _uploading = false;
+
+    Geofence::Result result;
+    switch (mission_ack.type) {
+        case MAV_MISSION_ACCEPTED:
+            LogInfo() << "Fence accepted";
+            result = Geofence::Result::SUCCESS;
+            break;
+        case MAV_MISSION_NO_SPACE:
+            LogErr() << "Error: too many fence items";
+            result = Geofence::Result::TOO_MANY_GEOFENCE_ITEMS;
+            break;
+        default:
+            LogErr() << "Error: unknown fence ack: " << int(mission_ack.type);
+            result = Geofence::Result::ERROR;
+            break;
+    }
+
+    report_result(_result_callback, result);
+    _result_callback = nullptr;
+}
+
+void GeofenceImpl::process_timeout()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_uploading) {
+        return;
+    }
+
+    LogErr() << "Fence upload timed out.";
+    _uploading = false;
+    report_result(_result_callback, Geofence::Result::TIMEOUT);
+    _result_callback = nullptr;
+}
+
+void GeofenceImpl::report_result(const Geofence::result_callback_t &callback,
+                                 Geofence::Result result)
+{
+    if (callback == nullptr) {
+        LogWarn() << "Callback is not set";
+        return;
+    }
+
+    callback(result);
+}
+
+} // namespace dronecore
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "device_impl.h"
+#include "geofence.h"
+#include "geofence_index.h"
+#include "mavlink_include.h"
+#include "plugin_impl_base.h"
+
+namespace dronecore {
+
+class GeofenceImpl : public PluginImplBase
+{
+public:
+    GeofenceImpl();
+    ~GeofenceImpl();
+
+    void init() override;
+    void deinit() override;
+
+    void enable() override;
+    void disable() override;
+
+    Geofence::Result set_zones(const std::vector<Geofence::Polygon> &polygons,
+                               const std::vector<Geofence::Circle> &circles);
+
+    Geofence::Status check(double latitude_deg, double longitude_deg) const;
+
+    void breach_async(Geofence::breach_callback_t callback);
+
+    void upload_async(const Geofence::result_callback_t &callback);
+
+    // Non-copyable
+    GeofenceImpl(const GeofenceImpl &) = delete;
+    const GeofenceImpl &operator=(const GeofenceImpl &) = delete;
+
+private:
+    void process_global_position_int(const MavlinkMessageView &view);
+    void process_mission_request_int(const mavlink_message_t &message);
+    void process_mission_ack(const mavlink_message_t &message);
+    void process_timeout();
+
+    void assemble_mavlink_fence_items(const std::vector<Geofence::Polygon> &polygons,
+                                      const std::vector<Geofence::Circle> &circles);
+    void upload_fence_item(uint16_t seq);
+
+    static bool status_equal(const Geofence::Status &lhs, const Geofence::Status &rhs);
+    static void report_result(const Geofence::result_callback_t &callback,
+                              Geofence::Result result);
+
+    mutable std::mutex _mutex {};
+
+    // Replaced as a whole by set_zones(), so checks only hold the lock to copy
+    // the pointer.
+    std::shared_ptr<GeofenceIndex> _index {};
+    std::vector<Geofence::Polygon> _polygons {};
+    std::vector<Geofence::Circle> _circles {};
+
+    Geofence::breach_callback_t _breach_callback = nullptr;
+
+    // Positions in the same cell as the last one and without a boundary in it
+    // have the same status, so they are not checked again.
+    int _last_cell = -1;
+    bool _last_status_valid = false;
+    Geofence::Status _last_status {};
+
+    bool _uploading = false;
+    Geofence::result_callback_t _result_callback = nullptr;
+    std::vector<mavlink_mission_item_int_t> _mavlink_fence_items {};
+
+    static constexpr double UPLOAD_TIMEOUT_S = 1.0;
+
+    void *_timeout_cookie = nullptr;
+};
+
+} // namespace dronecore
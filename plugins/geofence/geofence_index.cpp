@@ -0,0 +1,419 @@
+#include "geofence_index.h"
+#include "geodesy.h"
+#include "global_include.h"
+#include "log.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dronecore {
+
+constexpr unsigned GeofenceIndex::CELLS_PER_EDGE;
+constexpr unsigned GeofenceIndex::MAX_CELLS;
+
+namespace {
+
+constexpr double METRES_PER_DEGREE = MEAN_EARTH_RADIUS_M * M_PI / 180.0;
+
+// Edges touching a cell boundary are added to both cells.
+constexpr double CELL_MARGIN = 1e-9;
+
+bool is_valid(const Geofence::Point &point)
+{
+    return std::fabs(point.latitude_deg) <= 90.0 && std::fabs(point.longitude_deg) <= 180.0;
+}
+
+double metres_per_degree_longitude(double latitude_deg)
+{
+    // Keeps circles around the poles finite.
+    return METRES_PER_DEGREE * std::max(std::cos(to_rad_from_deg(latitude_deg)), 1e-6);
+}
+
+inline double orientation(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+} // namespace
+
+GeofenceIndex::GeofenceIndex() {}
+
+GeofenceIndex::~GeofenceIndex() {}
+
+void GeofenceIndex::clear()
+{
+    _zones.clear();
+    _edges.clear();
+    _has_inclusion = false;
+    _num_columns = 0;
+    _num_rows = 0;
+    _cell_begin.clear();
+    _entries.clear();
+    _entry_edges.clear();
+    _cell_has_boundary.clear();
+}
+
+bool GeofenceIndex::build(const std::vector<Geofence::Polygon> &polygons,
+                          const std::vector<Geofence::Circle> &circles)
+{
+    clear();
+
+    double min_x = std::numeric_limits<double>::infinity();
+    double min_y = std::numeric_limits<double>::infinity();
+    double max_x = -std::numeric_limits<double>::infinity();
+    double max_y = -std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        const auto &points = polygons[i].points;
+        if (points.size() < 3 || !std::all_of(points.begin(), points.end(), is_valid)) {
+            LogErr() << "Invalid geofence polygon " << i;
+            clear();
+            return false;
+        }
+
+        Zone zone {};
+        zone.kind = ZoneKind::POLYGON;
+        zone.fence_type = polygons[i].fence_type;
+        zone.index = int(i);
+        zone.edges_begin = uint32_t(_edges.size());
+        for (size_t j = 0; j < points.size(); ++j) {
+            const auto &from = points[j];
+            const auto &to = points[(j + 1) % points.size()];
+            _edges.push_back(Edge {from.longitude_deg, from.latitude_deg,
+                                   to.longitude_deg, to.latitude_deg});
+            min_x = std::min(min_x, from.longitude_deg);
+            max_x = std::max(max_x, from.longitude_deg);
+            min_y = std::min(min_y, from.latitude_deg);
+            max_y = std::max(max_y, from.latitude_deg);
+        }
+        zone.edges_end = uint32_t(_edges.size());
+        _zones.push_back(zone);
+    }
+
+    for (size_t i = 0; i < circles.size(); ++i) {
+        const auto &circle = circles[i];
+        if (!is_valid(circle.center) || !(circle.radius_m > 0.0f) ||
+            !std::isfinite(circle.radius_m)) {
+            LogErr() << "Invalid geofence circle " << i;
+            clear();
+            return false;
+        }
+
+        Zone zone {};
+        zone.kind = ZoneKind::CIRCLE;
+        zone.fence_type = circle.fence_type;
+        zone.index = int(i);
+        zone.center_x = circle.center.longitude_deg;
+        zone.center_y = circle.center.latitude_deg;
+        zone.metres_per_degree_x = metres_per_degree_longitude(circle.center.latitude_deg);
+        zone.metres_per_degree_y = METRES_PER_DEGREE;
+        zone.radius_squared = double(circle.radius_m) * double(circle.radius_m);
+        _zones.push_back(zone);
+
+        const double radius_x = double(circle.radius_m) / zone.metres_per_degree_x;
+        const double radius_y = double(circle.radius_m) / zone.metres_per_degree_y;
+        min_x = std::min(min_x, zone.center_x - radius_x);
+        max_x = std::max(max_x, zone.center_x + radius_x);
+        min_y = std::min(min_y, zone.center_y - radius_y);
+        max_y = std::max(max_y, zone.center_y + radius_y);
+    }
+
+    for (const auto &zone : _zones) {
+        if (zone.fence_type == Geofence::FenceType::INCLUSION) {
+            _has_inclusion = true;
+        }
+    }
+
+    if (_zones.empty()) {
+        return true;
+    }
+
+    // Roughly square cells in metres.
+    const double width = std::max(max_x - min_x, 1e-9);
+    const double height = std::max(max_y - min_y, 1e-9);
+    const double aspect = width * std::max(std::cos(to_rad_from_deg(0.5 * (min_y + max_y))),
+                                           1e-6) / height;
+    const double target_cells = double(std::min<size_t>(
+                                           std::max<size_t>(_edges.size() * CELLS_PER_EDGE,
+                                                            circles.size() * 16),
+                                           MAX_CELLS));
+    _num_columns = unsigned(std::max(1.0, std::round(std::sqrt(target_cells * aspect))));
+    _num_rows = unsigned(std::max(1.0, std::round(target_cells / double(_num_columns))));
+    _num_columns = std::min(_num_columns, MAX_CELLS);
+    _num_rows = std::min(_num_rows, MAX_CELLS / _num_columns);
+
+    _min_x = min_x;
+    _min_y = min_y;
+    _cell_width = width / double(_num_columns);
+    _cell_height = height / double(_num_rows);
+
+    std::vector<std::pair<uint32_t, Entry>> entries;
+    for (uint32_t zone = 0; zone < _zones.size(); ++zone) {
+        if (_zones[zone].kind == ZoneKind::POLYGON) {
+            add_polygon_entries(zone, entries);
+        } else {
+            add_circle_entries(zone, entries);
+        }
+    }
+
+    // Keeps the zones of a cell in the order they were given.
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const std::pair<uint32_t, Entry> &lhs,
+    const std::pair<uint32_t, Entry> &rhs) { return lhs.first < rhs.first; });
+
+    _cell_begin.assign(num_cells() + 1, 0);
+    _cell_has_boundary.assign(num_cells(), 0);
+    _entries.reserve(entries.size());
+    for (const auto &cell_and_entry : entries) {
+        const uint32_t cell = cell_and_entry.first;
+        const Entry &entry = cell_and_entry.second;
+        ++_cell_begin[cell + 1];
+        if (entry.edges_end > entry.edges_begin ||
+            _zones[entry.zone].kind == ZoneKind::CIRCLE) {
+            _cell_has_boundary[cell] = 1;
+        }
+        _entries.push_back(entry);
+    }
+    for (unsigned cell = 0; cell < num_cells(); ++cell) {
+        _cell_begin[cell + 1] += _cell_begin[cell];
+    }
+
+    LogDebug() << "Geofence index: " << _zones.size() << " zones, " << _num_columns << "x"
+               << _num_rows << " cells, " << _entries.size() << " entries";
+    return true;
+}
+
+void GeofenceIndex::add_polygon_entries(uint32_t zone,
+                                        std::vector<std::pair<uint32_t, Entry>> &entries)
+{
+    const Zone &polygon = _zones[zone];
+    const int last_column = int(_num_columns) - 1;
+    const int last_row = int(_num_rows) - 1;
+
+    // Cells crossed by every edge, row by row.
+    std::vector<std::pair<uint32_t, uint32_t>> cells_and_edges;
+    int min_row = last_row;
+    int max_row = 0;
+    int min_column = last_column;
+    int max_column = 0;
+
+    for (uint32_t e = polygon.edges_begin; e < polygon.edges_end; ++e) {
+        const Edge &edge = _edges[e];
+        const double column_0 = column_of(edge.x0);
+        const double row_0 = row_of(edge.y0);
+        const double column_1 = column_of(edge.x1);
+        const double row_1 = row_of(edge.y1);
+
+        const int first_row = std::max(0, int(std::floor(std::min(row_0, row_1) - CELL_MARGIN)));
+        const int end_row = std::min(last_row, int(std::floor(std::max(row_0, row_1) +
+                                                              CELL_MARGIN)));
+
+        for (int row = first_row; row <= end_row; ++row) {
+            // Part of the edge within this row.
+            double from = column_0;
+            double to = column_1;
+            if (row_1 != row_0) {
+                const double slope = (column_1 - column_0) / (row_1 - row_0);
+                const double band_low = std::max(double(row), std::min(row_0, row_1));
+                const double band_high = std::min(double(row + 1), std::max(row_0, row_1));
+                from = column_0 + (band_low - row_0) * slope;
+                to = column_0 + (band_high - row_0) * slope;
+            }
+            const int first_column = std::max(0, int(std::floor(std::min(from, to) -
+                                                                 CELL_MARGIN)));
+            const int end_column = std::min(last_column, int(std::floor(std::max(from, to) +
+                                                                        CELL_MARGIN)));
+            for (int column = first_column; column <= end_column; ++column) {
+                cells_and_edges.emplace_back(uint32_t(row) * _num_columns + uint32_t(column), e);
+            }
+            min_column = std::min(min_column, first_column);
+            max_column = std::max(max_column, end_column);
+        }
+        min_row = std::min(min_row, first_row);
+        max_row = std::max(max_row, end_row);
+    }
+
+    std::sort(cells_and_edges.begin(), cells_and_edges.end());
+    cells_and_edges.erase(std::unique(cells_and_edges.begin(), cells_and_edges.end()),
+                          cells_and_edges.end());
+
+    // Walk all cells of the bounding box, deciding the centers by scanlines.
+    std::vector<double> crossings;
+    auto next = cells_and_edges.begin();
+
+    for (int row = min_row; row <= max_row; ++row) {
+        const double center_y = _min_y + (double(row) + 0.5) * _cell_height;
+
+        crossings.clear();
+        for (uint32_t e = polygon.edges_begin; e < polygon.edges_end; ++e) {
+            const Edge &edge = _edges[e];
+            if ((edge.y0 > center_y) != (edge.y1 > center_y)) {
+                crossings.push_back(edge.x0 + (center_y - edge.y0) * (edge.x1 - edge.x0) /
+                                    (edge.y1 - edge.y0));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        size_t num_crossings_left = 0;
+
+        for (int column = min_column; column <= max_column; ++column) {
+            const uint32_t cell = uint32_t(row) * _num_columns + uint32_t(column);
+            const double center_x = _min_x + (double(column) + 0.5) * _cell_width;
+            while (num_crossings_left < crossings.size() &&
+                   crossings[num_crossings_left] < center_x) {
+                ++num_crossings_left;
+            }
+
+            Entry entry {};
+            entry.zone = zone;
+            entry.center_inside = (num_crossings_left % 2 == 1);
+            entry.edges_begin = uint32_t(_entry_edges.size());
+
+            while (next != cells_and_edges.end() && next->first < cell) {
+                ++next;
+            }
+            while (next != cells_and_edges.end() && next->first == cell) {
+                _entry_edges.push_back(next->second);
+                ++next;
+            }
+            entry.edges_end = uint32_t(_entry_edges.size());
+
+            if (entry.center_inside || entry.edges_end > entry.edges_begin) {
+                entries.emplace_back(cell, entry);
+            }
+        }
+    }
+}
+
+void GeofenceIndex::add_circle_entries(uint32_t zone,
+                                       std::vector<std::pair<uint32_t, Entry>> &entries)
+{
+    const Zone &circle = _zones[zone];
+    const double radius_m = std::sqrt(circle.radius_squared);
+    const double radius_x = radius_m / circle.metres_per_degree_x;
+    const double radius_y = radius_m / circle.metres_per_degree_y;
+
+    const int first_column = std::max(0, int(std::floor(column_of(circle.center_x - radius_x) -
+                                                        CELL_MARGIN)));
+    const int end_column = std::min(int(_num_columns) - 1,
+                                    int(std::floor(column_of(circle.center_x + radius_x) +
+                                                   CELL_MARGIN)));
+    const int first_row = std::max(0, int(std::floor(row_of(circle.center_y - radius_y) -
+                                                     CELL_MARGIN)));
+    const int end_row = std::min(int(_num_rows) - 1,
+                                 int(std::floor(row_of(circle.center_y + radius_y) +
+                                                CELL_MARGIN)));
+
+    for (int row = first_row; row <= end_row; ++row) {
+        for (int column = first_column; column <= end_column; ++column) {
+            Entry entry {};
+            entry.zone = zone;
+            entries.emplace_back(uint32_t(row) * _num_columns + uint32_t(column), entry);
+        }
+    }
+}
+
+int GeofenceIndex::cell_index(double latitude_deg, double longitude_deg) const
+{
+    const double column = column_of(longitude_deg);
+    const double row = row_of(latitude_deg);
+
+    // Also catches NaN.
+    if (!(column >= 0.0 && column < double(_num_columns) &&
+          row >= 0.0 && row < double(_num_rows))) {
+        return -1;
+    }
+    return int(unsigned(row) * _num_columns + unsigned(column));
+}
+
+bool GeofenceIndex::cell_has_boundary(int cell) const
+{
+    return cell >= 0 && _cell_has_boundary[size_t(cell)] != 0;
+}
+
+Geofence::Status GeofenceIndex::check(double latitude_deg, double longitude_deg) const
+{
+    return check_in_cell(cell_index(latitude_deg, longitude_deg), latitude_deg, longitude_deg);
+}
+
+Geofence::Status GeofenceIndex::check_in_cell(int cell, double latitude_deg,
+                                              double longitude_deg) const
+{
+    Geofence::Status status {};
+    status.exclusion_polygon_index = -1;
+    status.exclusion_circle_index = -1;
+
+    bool inside_inclusion = false;
+
+    if (cell >= 0) {
+        for (uint32_t i = _cell_begin[size_t(cell)]; i < _cell_begin[size_t(cell) + 1]; ++i) {
+            const Entry &entry = _entries[i];
+            const Zone &zone = _zones[entry.zone];
+
+            if (zone.fence_type == Geofence::FenceType::INCLUSION) {
+                if (inside_inclusion) {
+                    continue;
+                }
+            } else if ((zone.kind == ZoneKind::POLYGON && status.exclusion_polygon_index >= 0) ||
+                       (zone.kind == ZoneKind::CIRCLE && status.exclusion_circle_index >= 0)) {
+                continue;
+            }
+
+            if (!entry_contains(entry, cell, longitude_deg, latitude_deg)) {
+                continue;
+            }
+
+            if (zone.fence_type == Geofence::FenceType::INCLUSION) {
+                inside_inclusion = true;
+            } else if (zone.kind == ZoneKind::POLYGON) {
+                status.exclusion_polygon_index = zone.index;
+            } else {
+                status.exclusion_circle_index = zone.index;
+            }
+        }
+    }
+
+    status.outside_inclusion = _has_inclusion && !inside_inclusion;
+    status.breached = status.outside_inclusion || status.exclusion_polygon_index >= 0 ||
+                      status.exclusion_circle_index >= 0;
+    return status;
+}
+
+bool GeofenceIndex::entry_contains(const Entry &entry, int cell, double x, double y) const
+{
+    const Zone &zone = _zones[entry.zone];
+
+    if (zone.kind == ZoneKind::CIRCLE) {
+        const double dx = (x - zone.center_x) * zone.metres_per_degree_x;
+        const double dy = (y - zone.center_y) * zone.metres_per_degree_y;
+        return dx * dx + dy * dy <= zone.radius_squared;
+    }
+
+    bool inside = entry.center_inside;
+    if (entry.edges_end == entry.edges_begin) {
+        return inside;
+    }
+
+    const unsigned row = unsigned(cell) / _num_columns;
+    const unsigned column = unsigned(cell) % _num_columns;
+    const double center_x = _min_x + (double(column) + 0.5) * _cell_width;
+    const double center_y = _min_y + (double(row) + 0.5) * _cell_height;
+
+    for (uint32_t i = entry.edges_begin; i < entry.edges_end; ++i) {
+        if (segments_cross(center_x, center_y, x, y, _edges[_entry_edges[i]])) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool GeofenceIndex::segments_cross(double ax, double ay, double bx, double by, const Edge &edge)
+{
+    // Points on a line count as being on its negative side, like the half-open
+    // rule of ray casting, so touching a vertex is counted consistently.
+    return ((orientation(ax, ay, bx, by, edge.x0, edge.y0) > 0.0) !=
+            (orientation(ax, ay, bx, by, edge.x1, edge.y1) > 0.0)) &&
+           ((orientation(edge.x0, edge.y0, edge.x1, edge.y1, ax, ay) > 0.0) !=
+            (orientation(edge.x0, edge.y0, edge.x1, edge.y1, bx, by) > 0.0));
+}
+
+} // namespace dronecore
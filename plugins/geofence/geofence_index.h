@@ -0,0 +1,107 @@
+#pragma once
+
+#include "geofence.h"
+#include <cstdint>
+#include <vector>
+
+namespace dronecore {
+
+// Uniform grid over all zones for constant time position checks.
+//
+// Every cell lists the zones which touch it. For a polygon the entry says
+// whether the center of the cell is inside and lists the polygon edges which
+// cross the cell. A position is then inside if the center is, toggled for
+// every listed edge crossed on the way from the center to the position. Cells
+// no edge crosses are decided without looking at any edge.
+//
+// Positions are handled in degrees, the edges are straight lines in
+// latitude/longitude like on the autopilot. Circles are checked exactly, on a
+// plane tangent at their center.
+class GeofenceIndex
+{
+public:
+    GeofenceIndex();
+    ~GeofenceIndex();
+
+    // delete copy and move constructors and assign operators
+    GeofenceIndex(GeofenceIndex const &) = delete;            // Copy construct
+    GeofenceIndex(GeofenceIndex &&) = delete;                 // Move construct
+    GeofenceIndex &operator=(GeofenceIndex const &) = delete; // Copy assign
+    GeofenceIndex &operator=(GeofenceIndex &&) = delete;      // Move assign
+
+    // Returns false and stays empty if a zone is invalid.
+    bool build(const std::vector<Geofence::Polygon> &polygons,
+               const std::vector<Geofence::Circle> &circles);
+
+    Geofence::Status check(double latitude_deg, double longitude_deg) const;
+
+    // Cell of a position, -1 outside of the grid. Positions in the same cell
+    // without a boundary have the same status.
+    int cell_index(double latitude_deg, double longitude_deg) const;
+    bool cell_has_boundary(int cell) const;
+    Geofence::Status check_in_cell(int cell, double latitude_deg, double longitude_deg) const;
+
+    unsigned num_cells() const { return _num_columns * _num_rows; }
+
+    // The grid gets about this many cells per polygon edge, so that most
+    // cells are crossed by no edge at all, but never more than MAX_CELLS.
+    static constexpr unsigned CELLS_PER_EDGE = 4;
+    static constexpr unsigned MAX_CELLS = 1u << 20;
+
+private:
+    struct Edge {
+        double x0, y0, x1, y1;
+    };
+
+    enum class ZoneKind : uint8_t { POLYGON, CIRCLE };
+
+    struct Zone {
+        ZoneKind kind;
+        Geofence::FenceType fence_type;
+        int index; // into the polygons or circles given to build()
+        // Polygons only: edges are _edges[edges_begin, edges_end).
+        uint32_t edges_begin, edges_end;
+        // Circles only: center and metres per degree.
+        double center_x, center_y;
+        double metres_per_degree_x, metres_per_degree_y;
+        double radius_squared;
+    };
+
+    // A zone touching a cell, the edges are _entry_edges[edges_begin, edges_end).
+    struct Entry {
+        uint32_t zone;
+        uint32_t edges_begin;
+        uint32_t edges_end;
+        bool center_inside;
+    };
+
+    void clear();
+    void add_polygon_entries(uint32_t zone, std::vector<std::pair<uint32_t, Entry>> &entries);
+    void add_circle_entries(uint32_t zone, std::vector<std::pair<uint32_t, Entry>> &entries);
+
+    bool entry_contains(const Entry &entry, int cell, double x, double y) const;
+    static bool segments_cross(double ax, double ay, double bx, double by,
+                               const Edge &edge);
+
+    double column_of(double x) const { return (x - _min_x) / _cell_width; }
+    double row_of(double y) const { return (y - _min_y) / _cell_height; }
+
+    std::vector<Zone> _zones {};
+    std::vector<Edge> _edges {};
+    bool _has_inclusion = false;
+
+    double _min_x = 0.0;
+    double _min_y = 0.0;
+    double _cell_width = 1.0;
+    double _cell_height = 1.0;
+    unsigned _num_columns = 0;
+    unsigned _num_rows = 0;
+
+    // Entries of cell i are _entries[_cell_begin[i], _cell_begin[i + 1]).
+    std::vector<uint32_t> _cell_begin {};
+    std::vector<Entry> _entries {};
+    std::vector<uint32_t> _entry_edges {};
+    std::vector<uint8_t> _cell_has_boundary {};
+};
+
+} // namespace dronecore
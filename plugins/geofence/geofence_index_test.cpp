@@ -0,0 +1,201 @@
+#include "geofence_index.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+Geofence::Polygon square(Geofence::FenceType fence_type, double latitude_deg, double longitude_deg,
+                         double size_deg)
+{
+    Geofence::Polygon polygon {fence_type, {}};
+    polygon.points.push_back(Geofence::Point {latitude_deg, longitude_deg});
+    polygon.points.push_back(Geofence::Point {latitude_deg, longitude_deg + size_deg});
+    polygon.points.push_back(Geofence::Point {latitude_deg + size_deg, longitude_deg + size_deg});
+    polygon.points.push_back(Geofence::Point {latitude_deg + size_deg, longitude_deg});
+    return polygon;
+}
+
+// Plain ray casting over all edges.
+bool naive_contains(const Geofence::Polygon &polygon, double latitude_deg, double longitude_deg)
+{
+    bool inside = false;
+    const auto &points = polygon.points;
+    for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+        const double y0 = points[j].latitude_deg;
+        const double y1 = points[i].latitude_deg;
+        if ((y0 > latitude_deg) != (y1 > latitude_deg)) {
+            const double x = points[j].longitude_deg + (latitude_deg - y0) *
+                             (points[i].longitude_deg - points[j].longitude_deg) / (y1 - y0);
+            if (longitude_deg < x) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+// Star shaped, so concave but not self-intersecting.
+Geofence::Polygon random_star(std::mt19937 &generator, Geofence::FenceType fence_type,
+                              double latitude_deg, double longitude_deg, double size_deg)
+{
+    std::uniform_int_distribution<unsigned> num_points(3, 40);
+    std::uniform_real_distribution<double> radius(0.2 * size_deg, size_deg);
+
+    Geofence::Polygon polygon {fence_type, {}};
+    const unsigned count = num_points(generator);
+    for (unsigned i = 0; i < count; ++i) {
+        const double angle = 2.0 * M_PI * i / count;
+        const double r = radius(generator);
+        polygon.points.push_back(Geofence::Point {latitude_deg + r * std::sin(angle),
+                                                  longitude_deg + r * std::cos(angle)});
+    }
+    return polygon;
+}
+
+} // namespace
+
+TEST(GeofenceIndex, InclusionExclusionAndCircle)
+{
+    GeofenceIndex index;
+    ASSERT_TRUE(index.build({square(Geofence::FenceType::INCLUSION, 47.0, 8.0, 0.1),
+                             square(Geofence::FenceType::EXCLUSION, 47.04, 8.04, 0.02)
+                            },
+    {Geofence::Circle {Geofence::FenceType::EXCLUSION, {47.08, 8.02}, 200.0f}}));
+
+    Geofence::Status status = index.check(47.01, 8.01);
+    EXPECT_FALSE(status.breached);
+    EXPECT_FALSE(status.outside_inclusion);
+    EXPECT_EQ(status.exclusion_polygon_index, -1);
+    EXPECT_EQ(status.exclusion_circle_index, -1);
+
+    // Outside of the inclusion square, and outside of the grid.
+    status = index.check(46.99, 8.01);
+    EXPECT_TRUE(status.breached);
+    EXPECT_TRUE(status.outside_inclusion);
+    status = index.check(10.0, 10.0);
+    EXPECT_TRUE(status.breached);
+    EXPECT_TRUE(status.outside_inclusion);
+
+    status = index.check(47.05, 8.05);
+    EXPECT_TRUE(status.breached);
+    EXPECT_FALSE(status.outside_inclusion);
+    EXPECT_EQ(status.exclusion_polygon_index, 1);
+
+    // 0.001 degrees of latitude are about 111 m.
+    status = index.check(47.081, 8.02);
+    EXPECT_TRUE(status.breached);
+    EXPECT_EQ(status.exclusion_circle_index, 0);
+    status = index.check(47.0825, 8.02);
+    EXPECT_FALSE(status.breached);
+    EXPECT_EQ(status.exclusion_circle_index, -1);
+}
+
+TEST(GeofenceIndex, OnlyExclusion)
+{
+    GeofenceIndex index;
+    ASSERT_TRUE(index.build({square(Geofence::FenceType::EXCLUSION, -33.9, 151.2, 0.01)}, {}));
+
+    EXPECT_TRUE(index.check(-33.895, 151.205).breached);
+    EXPECT_FALSE(index.check(-33.8, 151.205).breached);
+    EXPECT_FALSE(index.check(-33.8, 151.205).outside_inclusion);
+
+    // Without zones nothing is breached.
+    ASSERT_TRUE(index.build({}, {}));
+    EXPECT_FALSE(index.check(-33.895, 151.205).breached);
+}
+
+TEST(GeofenceIndex, MatchesNaiveCheck)
+{
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> center(0.0, 1.0);
+
+    std::vector<Geofence::Polygon> polygons;
+    for (unsigned i = 0; i < 50; ++i) {
+        polygons.push_back(random_star(generator, (i % 3 == 0) ? Geofence::FenceType::INCLUSION :
+                                       Geofence::FenceType::EXCLUSION,
+                                       center(generator), center(generator), 0.2));
+    }
+
+    GeofenceIndex index;
+    ASSERT_TRUE(index.build(polygons, {}));
+
+    std::uniform_real_distribution<double> position(-0.3, 1.3);
+    for (unsigned i = 0; i < 100000; ++i) {
+        const double latitude_deg = position(generator);
+        const double longitude_deg = position(generator);
+
+        bool inside_inclusion = false;
+        bool inside_exclusion = false;
+        for (const auto &polygon : polygons) {
+            if (naive_contains(polygon, latitude_deg, longitude_deg)) {
+                if (polygon.fence_type == Geofence::FenceType::INCLUSION) {
+                    inside_inclusion = true;
+                } else {
+                    inside_exclusion = true;
+                }
+            }
+        }
+
+        const Geofence::Status status = index.check(latitude_deg, longitude_deg);
+        ASSERT_EQ(status.outside_inclusion, !inside_inclusion) << latitude_deg << ", "
+                                                               << longitude_deg;
+        ASSERT_EQ(status.exclusion_polygon_index >= 0, inside_exclusion) << latitude_deg << ", "
+                                                                         << longitude_deg;
+        ASSERT_EQ(status.breached, !inside_inclusion || inside_exclusion);
+    }
+}
+
+TEST(GeofenceIndex, CellsWithoutBoundaryHaveOneStatus)
+{
+    std::mt19937 generator(5);
+    GeofenceIndex index;
+    ASSERT_TRUE(index.build({random_star(generator, Geofence::FenceType::INCLUSION, 0.0, 0.0, 1.0)},
+    {}));
+
+    std::uniform_real_distribution<double> position(-1.0, 1.0);
+    unsigned num_cells_without_boundary = 0;
+    for (unsigned i = 0; i < 10000; ++i) {
+        const double latitude_deg = position(generator);
+        const double longitude_deg = position(generator);
+        const int cell = index.cell_index(latitude_deg, longitude_deg);
+        if (cell < 0 || index.cell_has_boundary(cell)) {
+            continue;
+        }
+        ++num_cells_without_boundary;
+
+        // Any other position in the same cell.
+        const Geofence::Status status = index.check_in_cell(cell, latitude_deg, longitude_deg);
+        for (double offset = -0.05; offset <= 0.05; offset += 0.01) {
+            if (index.cell_index(latitude_deg + offset, longitude_deg) == cell) {
+                ASSERT_EQ(index.check(latitude_deg + offset, longitude_deg).breached,
+                          status.breached);
+            }
+        }
+    }
+    EXPECT_GT(num_cells_without_boundary, 0u);
+}
+
+TEST(GeofenceIndex, InvalidZones)
+{
+    GeofenceIndex index;
+
+    Geofence::Polygon too_few_points = square(Geofence::FenceType::INCLUSION, 0.0, 0.0, 1.0);
+    too_few_points.points.resize(2);
+    EXPECT_FALSE(index.build({too_few_points}, {}));
+
+    EXPECT_FALSE(index.build({square(Geofence::FenceType::INCLUSION, 89.5, 0.0, 1.0)}, {}));
+    EXPECT_FALSE(index.build({square(Geofence::FenceType::INCLUSION, 0.0, NAN, 1.0)}, {}));
+
+    EXPECT_FALSE(index.build({}, {Geofence::Circle {Geofence::FenceType::INCLUSION, {0.0, 0.0},
+                                                    0.0f}}));
+    EXPECT_FALSE(index.build({}, {Geofence::Circle {Geofence::FenceType::INCLUSION, {0.0, 0.0},
+                                                    INFINITY}}));
+
+    // An invalid index checks like an empty one.
+    EXPECT_EQ(index.num_cells(), 0u);
+    EXPECT_FALSE(index.check(0.5, 0.5).breached);
+}
@@ -1,5 +1,6 @@
 #include "mission.h"
 #include "mission_impl.h"
+#include <utility>
 #include <vector>
 
 namespace dronecore {
@@ -17,12 +18,47 @@ Mission::~Mission()
 void Mission::upload_mission_async(const std::vector<std::shared_ptr<MissionItem>> &mission_items,
                                    result_callback_t callback)
 {
-    _impl->upload_mission_async(mission_items, callback);
+    _impl->upload_mission_async(MissionPlan::from_mission_items(mission_items), callback);
+}
+
+void Mission::upload_mission_async(MissionPlan mission_plan, result_callback_t callback)
+{
+    _impl->upload_mission_async(std::move(mission_plan), callback);
+}
+
+void Mission::upload_mission_file_async(const std::string &path, result_callback_t callback)
+{
+    _impl->upload_mission_file_async(path, callback);
+}
+
+void Mission::update_mission_async(const std::vector<std::shared_ptr<MissionItem>> &mission_items,
+                                   update_result_callback_t callback)
+{
+    _impl->update_mission_async(MissionPlan::from_mission_items(mission_items), callback);
+}
+
+void Mission::update_mission_async(MissionPlan mission_plan, update_result_callback_t callback)
+{
+    _impl->update_mission_async(std::move(mission_plan), callback);
+}
+
+void Mission::set_cache_directory(const std::string &directory)
+{
+    _impl->set_cache_directory(directory);
 }
 
 void Mission::download_mission_async(Mission::mission_items_and_result_callback_t callback)
 {
-    _impl->download_mission_async(callback);
+    _impl->download_mission_plan_async([callback](Result result, MissionPlan mission_plan) {
+        if (callback) {
+            callback(result, mission_plan.to_mission_items());
+        }
+    });
+}
+
+void Mission::download_mission_plan_async(mission_plan_and_result_callback_t callback)
+{
+    _impl->download_mission_plan_async(callback);
 }
 
 void Mission::start_mission_async(result_callback_t callback)
@@ -81,4 +117,9 @@ void Mission::subscribe_progress(progress_callback_t callback)
     _impl->subscribe_progress(callback);
 }
 
+void Mission::subscribe_upload_progress(upload_progress_callback_t callback)
+{
+    _impl->subscribe_upload_progress(callback);
+}
+
 } // namespace dronelin
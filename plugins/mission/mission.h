@@ -1,6 +1,9 @@
 #pragma once
 
 #include "mission_item.h"
+#include "mission_plan.h"
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -59,12 +62,87 @@ public:
      * The mission items are uploaded to a drone. Once uploaded the mission can be started and
      * executed even if a connection is lost.
      *
+     * MAVLink counts mission items in 16 bits, missions which take more than 65535 MAVLink
+     * mission items (camera and gimbal actions and speed changes are items of their own) are
+     * rejected with TOO_MANY_MISSION_ITEMS before anything is sent.
+     *
      * @param mission_items Reference to vector of mission items.
      * @param callback Callback to receive result of this request.
      */
     void upload_mission_async(const std::vector<std::shared_ptr<MissionItem>> &mission_items,
                               result_callback_t callback);
 
+    /**
+     * @brief Uploads a mission plan to the device (asynchronous).
+     *
+     * Same as the upload of a vector of mission items but the plan can be moved in
+     * instead of being converted.
+     *
+     * @param mission_plan Plan to upload, pass it with `std::move()` to avoid a copy.
+     * @param callback Callback to receive result of this request.
+     */
+    void upload_mission_async(MissionPlan mission_plan, result_callback_t callback);
+
+    /**
+     * @brief Uploads a mission file to the device (asynchronous).
+     *
+     * Binary mission files (`.dcmission`, see MissionFile::save_binary()) are memory-mapped
+     * and their MAVLink mission items are uploaded as they are, without parsing them.
+     * Other files are loaded using MissionFile::load() first, items which it skips (such as
+     * takeoff and return to launch) are not uploaded. Use MissionFile::load() and
+     * upload_mission_async() to find out about them before uploading.
+     *
+     * @param path Path of the mission file.
+     * @param callback Callback to receive result of this request, INVALID_ARGUMENT if the
+     *                 file could not be loaded, TOO_MANY_MISSION_ITEMS if it has more items
+     *                 than MAVLink can upload.
+     */
+    void upload_mission_file_async(const std::string &path, result_callback_t callback);
+
+    /**
+     * @brief Callback type for `update_mission_async()`.
+     *
+     * @param result Result of the update.
+     * @param bytes_saved Number of bytes not sent compared to a full upload.
+     */
+    typedef std::function<void(Result result, uint64_t bytes_saved)> update_result_callback_t;
+
+    /**
+     * @brief Updates the mission on the device by only sending what changed (asynchronous).
+     *
+     * The mission items are compared to the mission last uploaded to or downloaded from the
+     * device and only the changed ranges are sent using partial writes. If the number of
+     * underlying MAVLink mission items changed, if there is no previous mission to compare to,
+     * or if the device rejects a partial write, the whole mission is uploaded instead.
+     *
+     * @param mission_items Reference to vector of mission items.
+     * @param callback Callback to receive result of this request and the bytes saved.
+     */
+    void update_mission_async(const std::vector<std::shared_ptr<MissionItem>> &mission_items,
+                              update_result_callback_t callback);
+
+    /**
+     * @brief Updates the mission on the device from a mission plan (asynchronous).
+     *
+     * See `update_mission_async()` for a vector of mission items.
+     *
+     * @param mission_plan Plan to update to, pass it with `std::move()` to avoid a copy.
+     * @param callback Callback to receive result of this request and the bytes saved.
+     */
+    void update_mission_async(MissionPlan mission_plan, update_result_callback_t callback);
+
+    /**
+     * @brief Sets a directory to keep the mission cache on disk.
+     *
+     * The mission last uploaded to or downloaded from a device is always cached in memory.
+     * `download_mission_async()` then only checks the number of mission items and a few
+     * mission items of the device against the cache, and skips the download if they match.
+     * With a directory set, the cache also survives restarts of the application.
+     *
+     * @param directory Existing directory for the cache files, empty to only cache in memory.
+     */
+    void set_cache_directory(const std::string &directory);
+
     /**
      * @brief Callback type for `download_mission_async()` call to get mission items and result.
      */
@@ -81,6 +159,21 @@ public:
      */
     void download_mission_async(mission_items_and_result_callback_t callback);
 
+    /**
+     * @brief Callback type for `download_mission_plan_async()` call to get the plan and result.
+     */
+    typedef std::function<void(Result, MissionPlan)> mission_plan_and_result_callback_t;
+
+    /**
+     * @brief Downloads the mission from the device as a mission plan (asynchronous).
+     *
+     * The plan is moved into the callback, so large missions don't need to be converted
+     * into separate mission items.
+     *
+     * @param callback Callback to receive the mission plan and result of this request.
+     */
+    void download_mission_plan_async(mission_plan_and_result_callback_t callback);
+
     /**
      * @brief Starts the mission (asynchronous).
      *
@@ -158,6 +251,30 @@ public:
      */
     void subscribe_progress(progress_callback_t callback);
 
+    /**
+     * @brief Progress of a mission upload.
+     */
+    struct UploadProgress {
+        int items_uploaded; /**< @brief Number of MAVLink mission items requested so far. */
+        int items_total; /**< @brief Total number of MAVLink mission items to upload. */
+        double bytes_per_second; /**< @brief Average upload rate since the start. */
+    };
+
+    /**
+     * @brief Callback type to receive mission upload progress.
+     */
+    typedef std::function<void(UploadProgress)> upload_progress_callback_t;
+
+    /**
+     * @brief Subscribes to mission upload progress (asynchronous).
+     *
+     * The mission items are packed one by one when the device requests them, the callback is
+     * called at most 10 times per second while uploading and once when all items are sent.
+     *
+     * @param callback Callback to receive the upload progress.
+     */
+    void subscribe_upload_progress(upload_progress_callback_t callback);
+
     // Non-copyable
     /**
      * @brief Copy constructor (object is not copyable).
@@ -0,0 +1,217 @@
+#include "mission_binary_file.h"
+#include "log.h"
+#include <cstdio>
+#include <cstring>
+
+#ifndef WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dronecore {
+
+constexpr uint32_t MissionBinaryFile::VERSION;
+const char MissionBinaryFile::MAGIC[8] = {'D', 'C', 'M', 'I', 'S', 'S', 'N', '\0'};
+const char MissionBinaryFile::FILE_SUFFIX[] = ".dcmission";
+
+static_assert(sizeof(MissionBinaryFile::Header) % sizeof(int32_t) == 0,
+              "Indices after the header need to be aligned");
+
+MissionBinaryFile::MissionBinaryFile() {}
+
+MissionBinaryFile::~MissionBinaryFile()
+{
+    close();
+}
+
+uint64_t MissionBinaryFile::file_size(const Header &header)
+{
+    return sizeof(Header) + uint64_t(header.num_mavlink_items) *
+           (sizeof(int32_t) + sizeof(mavlink_mission_item_int_t));
+}
+
+bool MissionBinaryFile::has_suffix(const std::string &path)
+{
+    const size_t suffix_len = strlen(FILE_SUFFIX);
+    return path.size() >= suffix_len &&
+           path.compare(path.size() - suffix_len, suffix_len, FILE_SUFFIX) == 0;
+}
+
+bool MissionBinaryFile::open(const std::string &path)
+{
+    close();
+
+#ifndef WINDOWS
+    _fd = ::open(path.c_str(), O_RDONLY);
+    if (_fd < 0) {
+        LogErr() << "Could not open " << path;
+        return false;
+    }
+
+    struct stat file_stat {};
+    if (fstat(_fd, &file_stat) != 0 || uint64_t(file_stat.st_size) < sizeof(Header)) {
+        LogErr() << "Mission file " << path << " too short";
+        close();
+        return false;
+    }
+
+    _size = size_t(file_stat.st_size);
+    void *mapped = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _fd, 0);
+    if (mapped == MAP_FAILED) {
+        LogErr() << "Could not map " << path;
+        _size = 0;
+        close();
+        return false;
+    }
+    _data = static_cast<const uint8_t *>(mapped);
+#else
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        LogErr() << "Could not open " << path;
+        return false;
+    }
+
+    uint8_t chunk[65536];
+    size_t num_read;
+    while ((num_read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        _buffer.insert(_buffer.end(), chunk, chunk + num_read);
+    }
+    fclose(file);
+
+    _data = _buffer.data();
+    _size = _buffer.size();
+#endif
+
+    if (_size < sizeof(Header)) {
+        LogErr() << "Mission file " << path << " too short";
+        close();
+        return false;
+    }
+
+    memcpy(&_header, _data, sizeof(_header));
+
+    if (memcmp(_header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        _header.version != VERSION) {
+        LogErr() << path << " is not a mission file of version " << VERSION;
+        close();
+        return false;
+    }
+
+    if (_header.item_size != sizeof(mavlink_mission_item_int_t)) {
+        LogErr() << "Mission file " << path << " was written with another MAVLink version";
+        close();
+        return false;
+    }
+
+    if (_size < file_size(_header) || _header.num_mission_items > _header.num_mavlink_items) {
+        LogErr() << "Mission file " << path << " is truncated";
+        close();
+        return false;
+    }
+
+    // The indices are searched and reported as they are, they have to be
+    // sorted and in range.
+    const int32_t *indices = mission_item_indices();
+    for (unsigned i = 0; i < _header.num_mavlink_items; ++i) {
+        if (indices[i] < 0 || uint32_t(indices[i]) >= _header.num_mission_items ||
+            (i > 0 && indices[i] < indices[i - 1])) {
+            LogErr() << "Mission file " << path << " has an invalid index at item " << i;
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MissionBinaryFile::close()
+{
+#ifndef WINDOWS
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t *>(_data), _size);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+#else
+    _buffer.clear();
+#endif
+    _data = nullptr;
+    _size = 0;
+    _header = Header {};
+}
+
+const int32_t *MissionBinaryFile::mission_item_indices() const
+{
+    return reinterpret_cast<const int32_t *>(_data + sizeof(Header));
+}
+
+const mavlink_mission_item_int_t *MissionBinaryFile::mavlink_items() const
+{
+    return reinterpret_cast<const mavlink_mission_item_int_t *>(
+               _data + sizeof(Header) + _header.num_mavlink_items * sizeof(int32_t));
+}
+
+bool MissionBinaryFile::write(const std::string &path,
+                              const std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                              const std::vector<int> &mission_item_indices,
+                              unsigned num_mission_items)
+{
+    if (mavlink_items.size() != mission_item_indices.size()) {
+        LogErr() << "Inconsistent mission items";
+        return false;
+    }
+
+    Header header {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.item_size = sizeof(mavlink_mission_item_int_t);
+    header.num_mavlink_items = uint32_t(mavlink_items.size());
+    header.num_mission_items = num_mission_items;
+
+    // The file is written next to the target and renamed over it, a mission
+    // still mapped from the target keeps its own, unchanged copy.
+    const std::string tmp_path = path + ".tmp";
+
+    FILE *file = fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr) {
+        LogErr() << "Could not create " << tmp_path;
+        return false;
+    }
+
+    std::vector<int32_t> indices(mission_item_indices.begin(), mission_item_indices.end());
+
+    bool success = (fwrite(&header, sizeof(header), 1, file) == 1);
+    if (success && !indices.empty()) {
+        success = (fwrite(indices.data(), sizeof(int32_t), indices.size(), file) ==
+                   indices.size()) &&
+                  (fwrite(mavlink_items.data(), sizeof(mavlink_mission_item_int_t),
+                          mavlink_items.size(), file) == mavlink_items.size());
+    }
+
+    if (fclose(file) != 0) {
+        success = false;
+    }
+
+#ifdef WINDOWS
+    // Windows does not rename over existing files.
+    if (success) {
+        remove(path.c_str());
+    }
+#endif
+
+    if (success && rename(tmp_path.c_str(), path.c_str()) != 0) {
+        success = false;
+    }
+
+    if (!success) {
+        LogErr() << "Could not write " << path;
+        remove(tmp_path.c_str());
+    }
+    return success;
+}
+
+} // namespace dronecore
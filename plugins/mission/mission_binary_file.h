@@ -0,0 +1,70 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dronecore {
+
+// Compact binary mission file which is memory-mapped and uploaded as is.
+//
+// The file starts with a Header, followed by the index of the mission item
+// every MAVLink item belongs to (int32_t) and the MAVLink mission items in the
+// memory layout of mavlink_mission_item_int_t. Everything is stored in the byte
+// order of the host, item_size guards against a different MAVLink version.
+class MissionBinaryFile
+{
+public:
+    MissionBinaryFile();
+    ~MissionBinaryFile();
+
+    // delete copy and move constructors and assign operators
+    MissionBinaryFile(MissionBinaryFile const &) = delete;            // Copy construct
+    MissionBinaryFile(MissionBinaryFile &&) = delete;                 // Move construct
+    MissionBinaryFile &operator=(MissionBinaryFile const &) = delete; // Copy assign
+    MissionBinaryFile &operator=(MissionBinaryFile &&) = delete;      // Move assign
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t item_size;
+        uint32_t num_mavlink_items;
+        uint32_t num_mission_items;
+    };
+
+    // Maps the file and checks the header, size and indices, the items are not read.
+    bool open(const std::string &path);
+    void close();
+
+    unsigned num_mavlink_items() const { return _header.num_mavlink_items; }
+    unsigned num_mission_items() const { return _header.num_mission_items; }
+
+    // Both point into the mapped file and are valid until close().
+    const int32_t *mission_item_indices() const;
+    const mavlink_mission_item_int_t *mavlink_items() const;
+
+    static bool write(const std::string &path,
+                      const std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                      const std::vector<int> &mission_item_indices,
+                      unsigned num_mission_items);
+
+    static bool has_suffix(const std::string &path);
+
+    static constexpr uint32_t VERSION = 1;
+    static const char MAGIC[8];
+    static const char FILE_SUFFIX[];
+
+private:
+    static uint64_t file_size(const Header &header);
+
+    Header _header {};
+    const uint8_t *_data = nullptr;
+    size_t _size = 0;
+
+    // Without mmap the file is read into this buffer instead.
+    std::vector<uint8_t> _buffer {};
+    int _fd = -1;
+};
+
+} // namespace dronecore
@@ -0,0 +1,181 @@
+#include "mission_cache.h"
+#include "log.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace dronecore {
+
+constexpr uint32_t MissionCache::FILE_MAGIC;
+constexpr uint32_t MissionCache::FILE_VERSION;
+
+namespace {
+
+template<typename T>
+void add_to_hash(uint32_t &hash, T value)
+{
+    uint8_t bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+
+    for (unsigned i = 0; i < sizeof(T); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+}
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t item_size;
+    uint32_t count;
+    uint32_t checksum;
+};
+
+} // namespace
+
+MissionCache::MissionCache() {}
+
+MissionCache::~MissionCache() {}
+
+void MissionCache::set_directory(const std::string &directory)
+{
+    _directory = directory;
+}
+
+void MissionCache::store(uint64_t uuid,
+                         const std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                         const std::vector<uint32_t> &hashes)
+{
+    if (uuid == 0) {
+        return;
+    }
+
+    Entry &entry = _entries[uuid];
+    entry.mavlink_items = mavlink_items;
+    entry.hashes = hashes;
+    entry.checksum = checksum(hashes);
+
+    if (!_directory.empty()) {
+        save_to_disk(uuid, entry);
+    }
+}
+
+const MissionCache::Entry *MissionCache::get(uint64_t uuid)
+{
+    auto it = _entries.find(uuid);
+    if (it != _entries.end()) {
+        return &it->second;
+    }
+
+    if (uuid == 0 || _directory.empty()) {
+        return nullptr;
+    }
+
+    Entry entry;
+    if (!load_from_disk(uuid, entry)) {
+        return nullptr;
+    }
+
+    return &(_entries[uuid] = std::move(entry));
+}
+
+void MissionCache::remove(uint64_t uuid)
+{
+    _entries.erase(uuid);
+
+    if (!_directory.empty()) {
+        std::remove(get_path(uuid).c_str());
+    }
+}
+
+uint32_t MissionCache::hash_mission_item(const mavlink_mission_item_int_t &mavlink_item)
+{
+    uint32_t hash = 2166136261u;
+    add_to_hash(hash, mavlink_item.frame);
+    add_to_hash(hash, mavlink_item.command);
+    add_to_hash(hash, mavlink_item.autocontinue);
+    add_to_hash(hash, mavlink_item.param1);
+    add_to_hash(hash, mavlink_item.param2);
+    add_to_hash(hash, mavlink_item.param3);
+    add_to_hash(hash, mavlink_item.param4);
+    add_to_hash(hash, mavlink_item.x);
+    add_to_hash(hash, mavlink_item.y);
+    add_to_hash(hash, mavlink_item.z);
+    return hash;
+}
+
+uint32_t MissionCache::checksum(const std::vector<uint32_t> &hashes)
+{
+    uint32_t result = 2166136261u;
+    for (auto hash : hashes) {
+        add_to_hash(result, hash);
+    }
+    return result;
+}
+
+std::string MissionCache::get_path(uint64_t uuid) const
+{
+    std::stringstream path;
+    path << _directory << "/mission_" << uuid << ".cache";
+    return path.str();
+}
+
+bool MissionCache::load_from_disk(uint64_t uuid, Entry &entry) const
+{
+    std::ifstream file(get_path(uuid).c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        header.magic != FILE_MAGIC ||
+        header.version != FILE_VERSION ||
+        header.item_size != sizeof(mavlink_mission_item_int_t)) {
+        LogWarn() << "Ignoring invalid mission cache for " << uuid;
+        return false;
+    }
+
+    entry.mavlink_items.resize(header.count);
+    if (!file.read(reinterpret_cast<char *>(entry.mavlink_items.data()),
+                   std::streamsize(header.count * sizeof(mavlink_mission_item_int_t)))) {
+        LogWarn() << "Ignoring truncated mission cache for " << uuid;
+        return false;
+    }
+
+    entry.hashes.clear();
+    entry.hashes.reserve(header.count);
+    for (const auto &mavlink_item : entry.mavlink_items) {
+        entry.hashes.push_back(hash_mission_item(mavlink_item));
+    }
+
+    entry.checksum = checksum(entry.hashes);
+    if (entry.checksum != header.checksum) {
+        LogWarn() << "Ignoring corrupt mission cache for " << uuid;
+        return false;
+    }
+
+    return true;
+}
+
+void MissionCache::save_to_disk(uint64_t uuid, const Entry &entry) const
+{
+    std::ofstream file(get_path(uuid).c_str(), std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LogWarn() << "Could not write mission cache to " << _directory;
+        return;
+    }
+
+    FileHeader header;
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.item_size = sizeof(mavlink_mission_item_int_t);
+    header.count = uint32_t(entry.mavlink_items.size());
+    header.checksum = entry.checksum;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entry.mavlink_items.data()),
+               std::streamsize(entry.mavlink_items.size() * sizeof(mavlink_mission_item_int_t)));
+}
+
+} // namespace dronecore
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dronecore {
+
+// Keeps the MAVLink mission items last uploaded to or downloaded from a
+// device, keyed by the UUID of the device, in memory and optionally on disk.
+//
+// This is not thread-safe, MissionImpl only uses it with its mutex held.
+class MissionCache
+{
+public:
+    MissionCache();
+    ~MissionCache();
+
+    // delete copy and move constructors and assign operators
+    MissionCache(MissionCache const &) = delete;            // Copy construct
+    MissionCache(MissionCache &&) = delete;                 // Move construct
+    MissionCache &operator=(MissionCache const &) = delete; // Copy assign
+    MissionCache &operator=(MissionCache &&) = delete;      // Move assign
+
+    struct Entry {
+        std::vector<mavlink_mission_item_int_t> mavlink_items;
+        // Hash of every item, see hash_mission_item().
+        std::vector<uint32_t> hashes;
+        // Over all hashes, to detect corrupt files.
+        uint32_t checksum;
+    };
+
+    // An empty directory only keeps the cache in memory.
+    void set_directory(const std::string &directory);
+
+    void store(uint64_t uuid, const std::vector<mavlink_mission_item_int_t> &mavlink_items,
+               const std::vector<uint32_t> &hashes);
+
+    // Returns nullptr if there is nothing cached for this UUID.
+    const Entry *get(uint64_t uuid);
+
+    void remove(uint64_t uuid);
+
+    // FNV-1a over everything that ends up on the device, seq and current excluded.
+    static uint32_t hash_mission_item(const mavlink_mission_item_int_t &mavlink_item);
+
+    static uint32_t checksum(const std::vector<uint32_t> &hashes);
+
+private:
+    std::string get_path(uint64_t uuid) const;
+    bool load_from_disk(uint64_t uuid, Entry &entry) const;
+    void save_to_disk(uint64_t uuid, const Entry &entry) const;
+
+    static constexpr uint32_t FILE_MAGIC = 0x4E53494D; // "MISN"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    std::string _directory {};
+    std::map<uint64_t, Entry> _entries {};
+};
+
+} // namespace dronecore
@@ -0,0 +1,106 @@
+#include "mission_cache.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+using namespace dronecore;
+
+namespace {
+
+std::vector<mavlink_mission_item_int_t> make_mavlink_items(unsigned count)
+{
+    std::vector<mavlink_mission_item_int_t> mavlink_items(count);
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_items[i] = mavlink_mission_item_int_t {};
+        mavlink_items[i].seq = uint16_t(i);
+        mavlink_items[i].command = MAV_CMD_NAV_WAYPOINT;
+        mavlink_items[i].frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+        mavlink_items[i].x = int32_t(473977418 + i);
+        mavlink_items[i].y = int32_t(85455939 + i);
+        mavlink_items[i].z = 10.0f;
+    }
+    return mavlink_items;
+}
+
+std::vector<uint32_t> make_hashes(const std::vector<mavlink_mission_item_int_t> &mavlink_items)
+{
+    std::vector<uint32_t> hashes;
+    for (const auto &mavlink_item : mavlink_items) {
+        hashes.push_back(MissionCache::hash_mission_item(mavlink_item));
+    }
+    return hashes;
+}
+
+} // namespace
+
+TEST(MissionCache, HashIgnoresSeqAndCurrent)
+{
+    auto mavlink_items = make_mavlink_items(2);
+    mavlink_items[1].x = mavlink_items[0].x;
+    mavlink_items[1].y = mavlink_items[0].y;
+    mavlink_items[1].current = 1;
+
+    EXPECT_EQ(MissionCache::hash_mission_item(mavlink_items[0]),
+              MissionCache::hash_mission_item(mavlink_items[1]));
+
+    mavlink_items[1].z = 11.0f;
+    EXPECT_NE(MissionCache::hash_mission_item(mavlink_items[0]),
+              MissionCache::hash_mission_item(mavlink_items[1]));
+}
+
+TEST(MissionCache, InMemory)
+{
+    MissionCache cache;
+    EXPECT_EQ(cache.get(42), nullptr);
+
+    auto mavlink_items = make_mavlink_items(10);
+    cache.store(42, mavlink_items, make_hashes(mavlink_items));
+
+    const MissionCache::Entry *entry = cache.get(42);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->mavlink_items.size(), 10u);
+    EXPECT_EQ(entry->checksum, MissionCache::checksum(make_hashes(mavlink_items)));
+
+    cache.remove(42);
+    EXPECT_EQ(cache.get(42), nullptr);
+}
+
+#ifndef WINDOWS
+TEST(MissionCache, OnDisk)
+{
+    char path[] = "/tmp/mission_cache_test_XXXXXX";
+    ASSERT_NE(mkdtemp(path), nullptr);
+    const std::string directory(path);
+
+    auto mavlink_items = make_mavlink_items(1000);
+    {
+        MissionCache cache;
+        cache.set_directory(directory);
+        cache.store(42, mavlink_items, make_hashes(mavlink_items));
+    }
+
+    {
+        // A new cache has to load it from disk.
+        MissionCache cache;
+        cache.set_directory(directory);
+        const MissionCache::Entry *entry = cache.get(42);
+        ASSERT_NE(entry, nullptr);
+        ASSERT_EQ(entry->mavlink_items.size(), 1000u);
+        EXPECT_EQ(entry->mavlink_items[999].x, mavlink_items[999].x);
+        EXPECT_EQ(entry->hashes, make_hashes(mavlink_items));
+
+        EXPECT_EQ(cache.get(43), nullptr);
+        cache.remove(42);
+    }
+
+    {
+        MissionCache cache;
+        cache.set_directory(directory);
+        EXPECT_EQ(cache.get(42), nullptr);
+    }
+
+    rmdir(directory.c_str());
+}
+#endif
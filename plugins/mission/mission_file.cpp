@@ -0,0 +1,872 @@
+#include "mission_file.h"
+#include "mission_binary_file.h"
+#include "mission_plan_mavlink.h"
+#include "log.h"
+#include <cmath>
+#include <cstdio>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace dronecore {
+
+namespace {
+
+bool ends_with(const std::string &str, const char *suffix)
+{
+    const size_t suffix_len = strlen(suffix);
+    return str.size() >= suffix_len &&
+           str.compare(str.size() - suffix_len, suffix_len, suffix) == 0;
+}
+
+MissionFile::Result to_file_result(Mission::Result result)
+{
+    switch (result) {
+        case Mission::Result::SUCCESS:
+            return MissionFile::Result::SUCCESS;
+        case Mission::Result::NO_MISSION_AVAILABLE:
+            return MissionFile::Result::NO_MISSION_ITEMS;
+        default:
+            return MissionFile::Result::UNSUPPORTED;
+    }
+}
+
+// Frame and command are read as numbers, they have to fit into the MAVLink item
+// before they are converted.
+bool is_valid_frame_and_command(double frame, double command)
+{
+    return std::isfinite(frame) && frame >= 0.0 && frame <= 255.0 &&
+           std::isfinite(command) && command >= 0.0 && command <= 65535.0;
+}
+
+// Files use the frames with positions in degrees, MAVLink items the ones in 1e-7 degrees.
+bool is_global_frame(unsigned frame)
+{
+    switch (frame) {
+        case MAV_FRAME_GLOBAL:
+        case MAV_FRAME_GLOBAL_RELATIVE_ALT:
+        case MAV_FRAME_GLOBAL_TERRAIN_ALT:
+        case MAV_FRAME_GLOBAL_INT:
+        case MAV_FRAME_GLOBAL_RELATIVE_ALT_INT:
+        case MAV_FRAME_GLOBAL_TERRAIN_ALT_INT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint8_t to_int_frame(unsigned frame)
+{
+    switch (frame) {
+        case MAV_FRAME_GLOBAL:
+            return MAV_FRAME_GLOBAL_INT;
+        case MAV_FRAME_GLOBAL_RELATIVE_ALT:
+            return MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+        case MAV_FRAME_GLOBAL_TERRAIN_ALT:
+            return MAV_FRAME_GLOBAL_TERRAIN_ALT_INT;
+        default:
+            return uint8_t(frame);
+    }
+}
+
+uint8_t to_file_frame(unsigned frame)
+{
+    switch (frame) {
+        case MAV_FRAME_GLOBAL_INT:
+            return MAV_FRAME_GLOBAL;
+        case MAV_FRAME_GLOBAL_RELATIVE_ALT_INT:
+            return MAV_FRAME_GLOBAL_RELATIVE_ALT;
+        case MAV_FRAME_GLOBAL_TERRAIN_ALT_INT:
+            return MAV_FRAME_GLOBAL_TERRAIN_ALT;
+        default:
+            return uint8_t(frame);
+    }
+}
+
+int32_t to_mavlink_int(double value, bool is_position)
+{
+    if (!std::isfinite(value)) {
+        return 0;
+    }
+    return is_position ? int32_t(std::lround(value * 1e7)) : int32_t(value);
+}
+
+// Mission items in files have 7 parameters, positions are in degrees.
+mavlink_mission_item_int_t to_mavlink_item(uint16_t seq, unsigned frame, unsigned command,
+                                           bool autocontinue, const double *params)
+{
+    const bool is_position = is_global_frame(frame);
+
+    mavlink_mission_item_int_t mavlink_item {};
+    mavlink_item.seq = seq;
+    mavlink_item.frame = to_int_frame(frame);
+    mavlink_item.command = uint16_t(command);
+    mavlink_item.autocontinue = autocontinue ? 1 : 0;
+    mavlink_item.param1 = float(params[0]);
+    mavlink_item.param2 = float(params[1]);
+    mavlink_item.param3 = float(params[2]);
+    mavlink_item.param4 = float(params[3]);
+    mavlink_item.x = to_mavlink_int(params[4], is_position);
+    mavlink_item.y = to_mavlink_int(params[5], is_position);
+    mavlink_item.z = float(params[6]);
+    mavlink_item.mission_type = MAV_MISSION_TYPE_MISSION;
+    return mavlink_item;
+}
+
+void from_mavlink_item(const mavlink_mission_item_int_t &mavlink_item, double *params)
+{
+    const double scale = is_global_frame(mavlink_item.frame) ? 1e-7 : 1.0;
+
+    params[0] = double(mavlink_item.param1);
+    params[1] = double(mavlink_item.param2);
+    params[2] = double(mavlink_item.param3);
+    params[3] = double(mavlink_item.param4);
+    params[4] = double(mavlink_item.x) * scale;
+    params[5] = double(mavlink_item.y) * scale;
+    params[6] = double(mavlink_item.z);
+}
+
+// Items a MissionPlan can't represent are left out, but not without notice.
+void skip_item(const mavlink_mission_item_int_t &mavlink_item,
+               std::vector<MissionFile::SkippedItem> *skipped_items)
+{
+    LogWarn() << "Skipping unsupported mission item " << mavlink_item.seq << " (command "
+              << mavlink_item.command << ")";
+    if (skipped_items != nullptr) {
+        skipped_items->push_back({mavlink_item.seq, mavlink_item.command});
+    }
+}
+
+// Reads a file in chunks so that it never needs to be in memory as a whole.
+class BufferedReader
+{
+public:
+    explicit BufferedReader(FILE *file) :
+        _file(file),
+        _buffer(BUFFER_SIZE)
+    {}
+
+    int peek()
+    {
+        if (_pos == _len && !fill()) {
+            return EOF;
+        }
+        return _buffer[_pos];
+    }
+
+    int get()
+    {
+        const int c = peek();
+        if (c != EOF) {
+            ++_pos;
+            ++_offset;
+        }
+        return c;
+    }
+
+    uint64_t offset() const { return _offset; }
+
+private:
+    bool fill()
+    {
+        _len = fread(_buffer.data(), 1, _buffer.size(), _file);
+        _pos = 0;
+        return _len > 0;
+    }
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    FILE *_file;
+    std::vector<unsigned char> _buffer;
+    size_t _pos = 0;
+    size_t _len = 0;
+    uint64_t _offset = 0;
+};
+
+// Counts the levels of objects and arrays being parsed.
+class Nesting
+{
+public:
+    explicit Nesting(unsigned &depth) : _depth(depth) { ++_depth; }
+    ~Nesting() { --_depth; }
+
+    // delete copy and move constructors and assign operators
+    Nesting(Nesting const &) = delete;            // Copy construct
+    Nesting(Nesting &&) = delete;                 // Move construct
+    Nesting &operator=(Nesting const &) = delete; // Copy assign
+    Nesting &operator=(Nesting &&) = delete;      // Move assign
+
+private:
+    unsigned &_depth;
+};
+
+// Parses a QGroundControl plan while reading it and hands every simple item
+// to the MissionPlanBuilder. Only the keys which are needed are looked at,
+// everything else is skipped without being stored.
+class PlanParser
+{
+public:
+    PlanParser(BufferedReader &reader, MissionPlanBuilder &mission_plan_builder,
+               std::vector<MissionFile::SkippedItem> *skipped_items) :
+        _reader(reader),
+        _mission_plan_builder(mission_plan_builder),
+        _skipped_items(skipped_items)
+    {}
+
+    bool parse()
+    {
+        skip_whitespace();
+        return parse_object([this](const std::string & key) -> bool {
+            if (key == "mission") {
+                return parse_object([this](const std::string & mission_key) -> bool {
+                    if (mission_key == "items") {
+                        return parse_items();
+                    }
+                    return skip_value();
+                });
+            }
+            return skip_value();
+        });
+    }
+
+    MissionFile::Result result() const { return _result; }
+
+private:
+    struct Item {
+        std::string type {};
+        double command = double(NAN);
+        double frame = double(NAN);
+        bool autocontinue = true;
+        double params[7] = {double(NAN), double(NAN), double(NAN), double(NAN),
+                            double(NAN), double(NAN), double(NAN)
+                           };
+    };
+
+    bool parse_items()
+    {
+        return parse_array([this]() { return parse_item(); });
+    }
+
+    bool parse_item()
+    {
+        Item item {};
+
+        const bool parsed = parse_object([this, &item](const std::string & key) -> bool {
+            if (key == "type") {
+                return parse_string(item.type);
+            } else if (key == "command") {
+                return parse_number(item.command);
+            } else if (key == "frame") {
+                return parse_number(item.frame);
+            } else if (key == "autoContinue") {
+                return parse_bool(item.autocontinue);
+            } else if (key == "params") {
+                return parse_numbers(item.params, 7);
+            } else if (key == "coordinate") {
+                // Version 1 of the format has the position separately.
+                return parse_numbers(&item.params[4], 3);
+            } else if (key.size() == 6 && key.compare(0, 5, "param") == 0 &&
+                       key[5] >= '1' && key[5] <= '4') {
+                return parse_number(item.params[key[5] - '1']);
+            } else if (key == "Items") {
+                // The items generated for complex items like surveys.
+                return parse_items();
+            } else if (key == "TransectStyleComplexItem") {
+                return parse_item();
+            }
+            return skip_value();
+        });
+
+        if (!parsed || item.type != "SimpleItem") {
+            return parsed;
+        }
+
+        if (!std::isfinite(item.command) || !std::isfinite(item.frame)) {
+            return fail("Simple item without command or frame");
+        }
+
+        if (!is_valid_frame_and_command(item.frame, item.command)) {
+            return fail("Simple item with invalid command or frame");
+        }
+
+        if (_seq == MavlinkMissionItemsBuilder::MAX_MAVLINK_ITEMS) {
+            LogErr() << "Plan file has more than " << _seq << " items";
+            _result = MissionFile::Result::TOO_MANY_MISSION_ITEMS;
+            return false;
+        }
+
+        const mavlink_mission_item_int_t mavlink_item =
+            to_mavlink_item(uint16_t(_seq++), unsigned(item.frame), unsigned(item.command),
+                            item.autocontinue, item.params);
+
+        if (_mission_plan_builder.add(mavlink_item) != Mission::Result::SUCCESS) {
+            skip_item(mavlink_item, _skipped_items);
+        }
+        return true;
+    }
+
+    template<typename KeyHandler>
+    bool parse_object(KeyHandler handler)
+    {
+        if (_reader.get() != '{') {
+            return fail("Expected object");
+        }
+        if (_depth == MAX_DEPTH) {
+            return fail("Nested too deeply");
+        }
+        Nesting nesting(_depth);
+
+        skip_whitespace();
+        if (_reader.peek() == '}') {
+            _reader.get();
+            return true;
+        }
+
+        std::string key;
+        while (true) {
+            skip_whitespace();
+            if (!parse_string(key)) {
+                return false;
+            }
+            skip_whitespace();
+            if (_reader.get() != ':') {
+                return fail("Expected ':'");
+            }
+            skip_whitespace();
+            if (!handler(key)) {
+                return false;
+            }
+            skip_whitespace();
+
+            const int c = _reader.get();
+            if (c == '}') {
+                return true;
+            } else if (c != ',') {
+                return fail("Expected ',' or '}'");
+            }
+        }
+    }
+
+    template<typename ElementHandler>
+    bool parse_array(ElementHandler handler)
+    {
+        if (_reader.get() != '[') {
+            return fail("Expected array");
+        }
+        if (_depth == MAX_DEPTH) {
+            return fail("Nested too deeply");
+        }
+        Nesting nesting(_depth);
+
+        skip_whitespace();
+        if (_reader.peek() == ']') {
+            _reader.get();
+            return true;
+        }
+
+        while (true) {
+            skip_whitespace();
+            if (!handler()) {
+                return false;
+            }
+            skip_whitespace();
+
+            const int c = _reader.get();
+            if (c == ']') {
+                return true;
+            } else if (c != ',') {
+                return fail("Expected ',' or ']'");
+            }
+        }
+    }
+
+    // Numbers beyond max_values are ignored.
+    bool parse_numbers(double *values, unsigned max_values)
+    {
+        unsigned num_values = 0;
+        return parse_array([this, values, max_values, &num_values]() -> bool {
+            if (num_values < max_values) {
+                return parse_number(values[num_values++]);
+            }
+            return skip_value();
+        });
+    }
+
+    bool parse_string(std::string &str)
+    {
+        if (_reader.get() != '"') {
+            return fail("Expected string");
+        }
+
+        str.clear();
+        while (true) {
+            int c = _reader.get();
+            if (c == EOF) {
+                return fail("Unterminated string");
+            } else if (c == '"') {
+                return true;
+            } else if (c == '\\') {
+                c = _reader.get();
+                switch (c) {
+                    case 'b':
+                        c = '\b';
+                        break;
+                    case 'f':
+                        c = '\f';
+                        break;
+                    case 'n':
+                        c = '\n';
+                        break;
+                    case 'r':
+                        c = '\r';
+                        break;
+                    case 't':
+                        c = '\t';
+                        break;
+                    case 'u':
+                        // None of the keys or values we look at need unicode.
+                        for (unsigned i = 0; i < 4; ++i) {
+                            if (!isxdigit(_reader.get())) {
+                                return fail("Invalid unicode escape");
+                            }
+                        }
+                        c = '?';
+                        break;
+                    case EOF:
+                        return fail("Unterminated string");
+                    default:
+                        break;
+                }
+            }
+            str.push_back(char(c));
+        }
+    }
+
+    // Null is read as NaN, QGroundControl writes NaN parameters like that.
+    bool parse_number(double &value)
+    {
+        if (_reader.peek() == 'n') {
+            value = double(NAN);
+            return parse_literal("null");
+        }
+
+        char number[64];
+        unsigned len = 0;
+        while (len < sizeof(number) - 1) {
+            const int c = _reader.peek();
+            if (!isdigit(c) && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') {
+                break;
+            }
+            number[len++] = char(_reader.get());
+        }
+        number[len] = '\0';
+
+        char *end = nullptr;
+        value = strtod(number, &end);
+        if (len == 0 || end != number + len) {
+            return fail("Invalid number");
+        }
+        return true;
+    }
+
+    bool parse_bool(bool &value)
+    {
+        value = (_reader.peek() == 't');
+        return parse_literal(value ? "true" : "false");
+    }
+
+    bool parse_literal(const char *literal)
+    {
+        for (const char *c = literal; *c != '\0'; ++c) {
+            if (_reader.get() != *c) {
+                return fail("Invalid literal");
+            }
+        }
+        return true;
+    }
+
+    bool skip_value()
+    {
+        switch (_reader.peek()) {
+            case '{':
+                return parse_object([this](const std::string &) { return skip_value(); });
+            case '[':
+                return parse_array([this]() { return skip_value(); });
+            case '"':
+                return parse_string(_skipped_string);
+            case 't':
+            case 'f': {
+                    bool skipped_bool;
+                    return parse_bool(skipped_bool);
+                }
+            default: {
+                    double skipped_number;
+                    return parse_number(skipped_number);
+                }
+        }
+    }
+
+    void skip_whitespace()
+    {
+        while (isspace(_reader.peek())) {
+            _reader.get();
+        }
+    }
+
+    bool fail(const char *error)
+    {
+        LogErr() << "Invalid plan file: " << error << " at byte " << _reader.offset();
+        _result = MissionFile::Result::PARSE_ERROR;
+        return false;
+    }
+
+    BufferedReader &_reader;
+    MissionPlanBuilder &_mission_plan_builder;
+    std::vector<MissionFile::SkippedItem> *_skipped_items;
+    MissionFile::Result _result = MissionFile::Result::SUCCESS;
+    size_t _seq = 0;
+    unsigned _depth = 0;
+    std::string _skipped_string {};
+
+    // Objects and arrays are parsed recursively, the nesting is limited so
+    // that no file can overflow the stack.
+    static constexpr unsigned MAX_DEPTH = 64;
+};
+
+// Doubles are written so that they are read back exactly, NaN as null.
+void write_json_number(FILE *file, double value)
+{
+    if (std::isfinite(value)) {
+        fprintf(file, "%.17g", value);
+    } else {
+        fputs("null", file);
+    }
+}
+
+} // namespace
+
+const char *MissionFile::result_str(Result result)
+{
+    switch (result) {
+        case Result::SUCCESS:
+            return "Success";
+        case Result::FILE_ERROR:
+            return "File error";
+        case Result::PARSE_ERROR:
+            return "Parse error";
+        case Result::UNSUPPORTED:
+            return "Unsupported";
+        case Result::NO_MISSION_ITEMS:
+            return "No mission items";
+        case Result::TOO_MANY_MISSION_ITEMS:
+            return "Too many mission items";
+        default:
+            return "Unknown";
+    }
+}
+
+MissionFile::Result MissionFile::load(const std::string &path, MissionPlan &mission_plan,
+                                      std::vector<SkippedItem> *skipped_items)
+{
+    if (skipped_items != nullptr) {
+        skipped_items->clear();
+    }
+
+    if (ends_with(path, ".plan")) {
+        return load_plan(path, mission_plan, skipped_items);
+    } else if (ends_with(path, ".waypoints")) {
+        return load_waypoints(path, mission_plan, skipped_items);
+    } else if (MissionBinaryFile::has_suffix(path)) {
+        return load_binary(path, mission_plan);
+    }
+
+    LogErr() << "Unknown mission file type: " << path;
+    mission_plan.clear();
+    return Result::UNSUPPORTED;
+}
+
+MissionFile::Result MissionFile::load_plan(const std::string &path, MissionPlan &mission_plan,
+                                           std::vector<SkippedItem> *skipped_items)
+{
+    mission_plan.clear();
+    if (skipped_items != nullptr) {
+        skipped_items->clear();
+    }
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        LogErr() << "Could not open " << path;
+        return Result::FILE_ERROR;
+    }
+
+    MissionPlanBuilder mission_plan_builder(mission_plan, true);
+    BufferedReader reader(file);
+    PlanParser parser(reader, mission_plan_builder, skipped_items);
+
+    const bool parsed = parser.parse();
+    const bool read_error = (ferror(file) != 0);
+    fclose(file);
+
+    if (read_error) {
+        LogErr() << "Could not read " << path;
+        mission_plan.clear();
+        return Result::FILE_ERROR;
+    }
+
+    if (!parsed) {
+        mission_plan.clear();
+        return parser.result();
+    }
+
+    return to_file_result(mission_plan_builder.finish());
+}
+
+MissionFile::Result MissionFile::load_waypoints(const std::string &path,
+                                                MissionPlan &mission_plan,
+                                                std::vector<SkippedItem> *skipped_items)
+{
+    mission_plan.clear();
+    if (skipped_items != nullptr) {
+        skipped_items->clear();
+    }
+
+    FILE *file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        LogErr() << "Could not open " << path;
+        return Result::FILE_ERROR;
+    }
+
+    char line[1024];
+    if (fgets(line, sizeof(line), file) == nullptr || strncmp(line, "QGC WPL", 7) != 0) {
+        LogErr() << path << " is not a waypoint file";
+        fclose(file);
+        return Result::PARSE_ERROR;
+    }
+
+    MissionPlanBuilder mission_plan_builder(mission_plan, true);
+    Result result = Result::SUCCESS;
+    bool first_item = true;
+    size_t seq = 0;
+    unsigned line_number = 1;
+
+    // Each line: index, current, frame, command, param1-4, x, y, z, autocontinue
+    while (result == Result::SUCCESS && fgets(line, sizeof(line), file) != nullptr) {
+        ++line_number;
+
+        const char *cursor = line;
+        while (isspace(*cursor)) {
+            ++cursor;
+        }
+        if (*cursor == '\0') {
+            continue;
+        }
+
+        double fields[12];
+        for (unsigned i = 0; i < 12; ++i) {
+            char *end = nullptr;
+            fields[i] = strtod(cursor, &end);
+            if (end == cursor) {
+                LogErr() << "Invalid waypoint in line " << line_number;
+                result = Result::PARSE_ERROR;
+                break;
+            }
+            cursor = end;
+        }
+        if (result != Result::SUCCESS) {
+            break;
+        }
+
+        if (!is_valid_frame_and_command(fields[2], fields[3])) {
+            LogErr() << "Invalid waypoint in line " << line_number;
+            result = Result::PARSE_ERROR;
+            break;
+        }
+
+        const unsigned frame = unsigned(fields[2]);
+
+        if (first_item) {
+            first_item = false;
+            if (fields[0] == 0.0 && frame == MAV_FRAME_GLOBAL) {
+                // Home position, it is not uploaded.
+                continue;
+            }
+        }
+
+        if (seq == MavlinkMissionItemsBuilder::MAX_MAVLINK_ITEMS) {
+            LogErr() << path << " has more than " << seq << " items";
+            result = Result::TOO_MANY_MISSION_ITEMS;
+            break;
+        }
+
+        const mavlink_mission_item_int_t mavlink_item =
+            to_mavlink_item(uint16_t(seq++), frame, unsigned(fields[3]), fields[11] > 0.0,
+                            &fields[4]);
+
+        if (mission_plan_builder.add(mavlink_item) != Mission::Result::SUCCESS) {
+            skip_item(mavlink_item, skipped_items);
+        }
+    }
+
+    const bool read_error = (ferror(file) != 0);
+    fclose(file);
+
+    if (read_error) {
+        LogErr() << "Could not read " << path;
+        result = Result::FILE_ERROR;
+    }
+
+    if (result != Result::SUCCESS) {
+        mission_plan.clear();
+        return result;
+    }
+
+    return to_file_result(mission_plan_builder.finish());
+}
+
+MissionFile::Result MissionFile::load_binary(const std::string &path, MissionPlan &mission_plan)
+{
+    mission_plan.clear();
+
+    MissionBinaryFile binary_file;
+    if (!binary_file.open(path)) {
+        return Result::FILE_ERROR;
+    }
+
+    MissionPlanBuilder mission_plan_builder(mission_plan);
+    mission_plan.reserve(binary_file.num_mission_items());
+
+    const mavlink_mission_item_int_t *mavlink_items = binary_file.mavlink_items();
+    for (unsigned i = 0; i < binary_file.num_mavlink_items(); ++i) {
+        if (mission_plan_builder.add(mavlink_items[i]) != Mission::Result::SUCCESS) {
+            break;
+        }
+    }
+
+    return to_file_result(mission_plan_builder.finish());
+}
+
+MissionFile::Result MissionFile::save_plan(const MissionPlan &mission_plan,
+                                           const std::string &path)
+{
+    std::vector<mavlink_mission_item_int_t> mavlink_items;
+    std::vector<int> mission_item_indices;
+    MavlinkMissionItemsBuilder::build(mission_plan, mavlink_items, mission_item_indices);
+
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        LogErr() << "Could not create " << path;
+        return Result::FILE_ERROR;
+    }
+
+    fputs("{\n"
+          "    \"fileType\": \"Plan\",\n"
+          "    \"geoFence\": {\"circles\": [], \"polygons\": [], \"version\": 2},\n"
+          "    \"groundStation\": \"DroneCore\",\n"
+          "    \"mission\": {\n"
+          "        \"items\": [", file);
+
+    double params[7];
+    for (size_t i = 0; i < mavlink_items.size(); ++i) {
+        const mavlink_mission_item_int_t &mavlink_item = mavlink_items[i];
+        from_mavlink_item(mavlink_item, params);
+
+        fprintf(file, "%s\n            {\"autoContinue\": %s, \"command\": %u, "
+                "\"doJumpId\": %u, \"frame\": %u, \"params\": [",
+                (i > 0) ? "," : "",
+                (mavlink_item.autocontinue != 0) ? "true" : "false",
+                unsigned(mavlink_item.command), unsigned(i + 1),
+                unsigned(to_file_frame(mavlink_item.frame)));
+        for (unsigned j = 0; j < 7; ++j) {
+            if (j > 0) {
+                fputs(", ", file);
+            }
+            write_json_number(file, params[j]);
+        }
+        fputs("], \"type\": \"SimpleItem\"}", file);
+    }
+
+    fputs("\n        ],\n"
+          "        \"plannedHomePosition\": [", file);
+    if (!mission_plan.empty() && mission_plan.has_position(0)) {
+        write_json_number(file, mission_plan.get_latitude_deg(0));
+        fputs(", ", file);
+        write_json_number(file, mission_plan.get_longitude_deg(0));
+        fputs(", 0", file);
+    } else {
+        fputs("0, 0, 0", file);
+    }
+    fputs("],\n"
+          "        \"version\": 2\n"
+          "    },\n"
+          "    \"rallyPoints\": {\"points\": [], \"version\": 2},\n"
+          "    \"version\": 1\n"
+          "}\n", file);
+
+    const bool write_error = (ferror(file) != 0);
+    if (fclose(file) != 0 || write_error) {
+        LogErr() << "Could not write " << path;
+        return Result::FILE_ERROR;
+    }
+    return Result::SUCCESS;
+}
+
+MissionFile::Result MissionFile::save_waypoints(const MissionPlan &mission_plan,
+                                                const std::string &path)
+{
+    std::vector<mavlink_mission_item_int_t> mavlink_items;
+    std::vector<int> mission_item_indices;
+    MavlinkMissionItemsBuilder::build(mission_plan, mavlink_items, mission_item_indices);
+
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        LogErr() << "Could not create " << path;
+        return Result::FILE_ERROR;
+    }
+
+    fputs("QGC WPL 110\n", file);
+
+    // Readers expect the home position first.
+    const bool has_home = !mission_plan.empty() && mission_plan.has_position(0);
+    fprintf(file, "0\t1\t%u\t%u\t0\t0\t0\t0\t%.7f\t%.7f\t0\t1\n",
+            unsigned(MAV_FRAME_GLOBAL), unsigned(MAV_CMD_NAV_WAYPOINT),
+            has_home ? mission_plan.get_latitude_deg(0) : 0.0,
+            has_home ? mission_plan.get_longitude_deg(0) : 0.0);
+
+    double params[7];
+    for (const auto &mavlink_item : mavlink_items) {
+        from_mavlink_item(mavlink_item, params);
+
+        fprintf(file, "%u\t0\t%u\t%u\t%.9g\t%.9g\t%.9g\t%.9g\t%.*f\t%.*f\t%.9g\t%u\n",
+                unsigned(mavlink_item.seq) + 1,
+                unsigned(to_file_frame(mavlink_item.frame)),
+                unsigned(mavlink_item.command),
+                params[0], params[1], params[2], params[3],
+                is_global_frame(mavlink_item.frame) ? 7 : 0, params[4],
+                is_global_frame(mavlink_item.frame) ? 7 : 0, params[5],
+                params[6],
+                unsigned(mavlink_item.autocontinue));
+    }
+
+    const bool write_error = (ferror(file) != 0);
+    if (fclose(file) != 0 || write_error) {
+        LogErr() << "Could not write " << path;
+        return Result::FILE_ERROR;
+    }
+    return Result::SUCCESS;
+}
+
+MissionFile::Result MissionFile::save_binary(const MissionPlan &mission_plan,
+                                             const std::string &path)
+{
+    std::vector<mavlink_mission_item_int_t> mavlink_items;
+    std::vector<int> mission_item_indices;
+    MavlinkMissionItemsBuilder::build(mission_plan, mavlink_items, mission_item_indices);
+
+    if (!MissionBinaryFile::write(path, mavlink_items, mission_item_indices,
+                                  unsigned(mission_plan.size()))) {
+        return Result::FILE_ERROR;
+    }
+    return Result::SUCCESS;
+}
+
+} // namespace dronecore
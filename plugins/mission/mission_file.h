@@ -0,0 +1,142 @@
+#pragma once
+
+#include "mission_plan.h"
+#include <string>
+#include <vector>
+
+namespace dronecore {
+
+/**
+ * @brief Loads and saves missions from and to files.
+ *
+ * Supported are QGroundControl plan files (`.plan`), waypoint files as written by
+ * QGroundControl and Mission Planner (`.waypoints`, `QGC WPL 110`) and a compact binary format
+ * (`.dcmission`).
+ *
+ * The text formats are parsed while reading the file, directly into a MissionPlan, without
+ * keeping the whole file or a document tree in memory. The binary format contains the MAVLink
+ * mission items exactly as they are uploaded, so it can be memory-mapped and uploaded using
+ * `Mission::upload_mission_file_async()` without being parsed at all.
+ *
+ * A MissionPlan can only represent waypoints relative to the takeoff altitude together with
+ * their camera, gimbal and speed actions. Other items of the text formats, e.g. the takeoff and
+ * return to launch items QGroundControl adds to most plans, are skipped while loading and
+ * reported as MissionFile::SkippedItem.
+ */
+class MissionFile
+{
+public:
+    /**
+     * @brief Possible results returned when loading or saving a mission file.
+     */
+    enum class Result {
+        SUCCESS = 0, /**< @brief Mission file loaded or saved. */
+        FILE_ERROR, /**< @brief File could not be opened, read or written. */
+        PARSE_ERROR, /**< @brief File is not valid. */
+        UNSUPPORTED, /**< @brief File type or mission items of a binary file not supported. */
+        NO_MISSION_ITEMS, /**< @brief File contains no mission items. */
+        TOO_MANY_MISSION_ITEMS /**< @brief File contains more items than MAVLink can upload. */
+    };
+
+    /**
+     * @brief Gets a human-readable English string for a MissionFile::Result.
+     *
+     * @param result Enum for which string is required.
+     * @return Human readable string for the MissionFile::Result.
+     */
+    static const char *result_str(Result result);
+
+    /**
+     * @brief Mission item of a file which is not part of the loaded plan.
+     */
+    struct SkippedItem {
+        /**
+         * @brief Index of the mission item in the file, starting at 0, not counting a home
+         * position.
+         */
+        unsigned index;
+        unsigned command; /**< @brief MAVLink command of the mission item (MAV_CMD). */
+    };
+
+    /**
+     * @brief Loads a mission file, the format is chosen by the file extension.
+     *
+     * @param path Path of a `.plan`, `.waypoints` or `.dcmission` file.
+     * @param mission_plan Plan to fill, it is cleared first.
+     * @param skipped_items If not null, the items which could not be loaded are put in here.
+     * @return Result of loading the file.
+     */
+    static Result load(const std::string &path, MissionPlan &mission_plan,
+                       std::vector<SkippedItem> *skipped_items = nullptr);
+
+    /**
+     * @brief Loads a QGroundControl plan file.
+     *
+     * Simple items as well as the items generated for complex items such as surveys are loaded,
+     * geofence and rally points are ignored.
+     *
+     * @param path Path of the file.
+     * @param mission_plan Plan to fill, it is cleared first.
+     * @param skipped_items If not null, the items which could not be loaded are put in here.
+     * @return Result of loading the file.
+     */
+    static Result load_plan(const std::string &path, MissionPlan &mission_plan,
+                            std::vector<SkippedItem> *skipped_items = nullptr);
+
+    /**
+     * @brief Loads a `QGC WPL 110` waypoint file.
+     *
+     * The first item is skipped if it is a home position in the global frame, as written by
+     * QGroundControl and Mission Planner.
+     *
+     * @param path Path of the file.
+     * @param mission_plan Plan to fill, it is cleared first.
+     * @param skipped_items If not null, the items which could not be loaded are put in here.
+     * @return Result of loading the file.
+     */
+    static Result load_waypoints(const std::string &path, MissionPlan &mission_plan,
+                                 std::vector<SkippedItem> *skipped_items = nullptr);
+
+    /**
+     * @brief Loads a binary mission file written by save_binary().
+     *
+     * @param path Path of the file.
+     * @param mission_plan Plan to fill, it is cleared first.
+     * @return Result of loading the file.
+     */
+    static Result load_binary(const std::string &path, MissionPlan &mission_plan);
+
+    /**
+     * @brief Saves a mission as QGroundControl plan file.
+     *
+     * @param mission_plan Plan to save.
+     * @param path Path of the file, it is overwritten if it exists.
+     * @return Result of saving the file.
+     */
+    static Result save_plan(const MissionPlan &mission_plan, const std::string &path);
+
+    /**
+     * @brief Saves a mission as `QGC WPL 110` waypoint file.
+     *
+     * The position of the first waypoint is written as home position.
+     *
+     * @param mission_plan Plan to save.
+     * @param path Path of the file, it is overwritten if it exists.
+     * @return Result of saving the file.
+     */
+    static Result save_waypoints(const MissionPlan &mission_plan, const std::string &path);
+
+    /**
+     * @brief Saves a mission in the binary format.
+     *
+     * The file stores the MAVLink mission items in the memory layout of the MAVLink version
+     * DroneCore is built with, it is not meant to be exchanged between different builds.
+     *
+     * @param mission_plan Plan to save.
+     * @param path Path of the file, it is overwritten if it exists.
+     * @return Result of saving the file.
+     */
+    static Result save_binary(const MissionPlan &mission_plan, const std::string &path);
+};
+
+} // namespace dronecore
@@ -0,0 +1,328 @@
+#include "mission_file.h"
+#include "mission_binary_file.h"
+#include "mission_cache.h"
+#include "mission_plan_mavlink.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+using namespace dronecore;
+
+namespace {
+
+class MissionFileTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char path[] = "/tmp/mission_file_test_XXXXXX";
+        ASSERT_NE(mkdtemp(path), nullptr);
+        _directory = path;
+    }
+
+    void TearDown() override
+    {
+        for (const auto &path : _paths) {
+            remove(path.c_str());
+        }
+        rmdir(_directory.c_str());
+    }
+
+    std::string path(const std::string &name)
+    {
+        _paths.push_back(_directory + "/" + name);
+        return _paths.back();
+    }
+
+    std::string write_file(const std::string &name, const std::string &content)
+    {
+        const std::string file_path = path(name);
+        FILE *file = fopen(file_path.c_str(), "w");
+        fputs(content.c_str(), file);
+        fclose(file);
+        return file_path;
+    }
+
+    std::string _directory {};
+    std::vector<std::string> _paths {};
+};
+
+std::vector<uint32_t> mavlink_hashes(const MissionPlan &mission_plan)
+{
+    std::vector<mavlink_mission_item_int_t> mavlink_items;
+    std::vector<int> mission_item_indices;
+    MavlinkMissionItemsBuilder::build(mission_plan, mavlink_items, mission_item_indices);
+
+    std::vector<uint32_t> hashes;
+    for (const auto &mavlink_item : mavlink_items) {
+        hashes.push_back(MissionCache::hash_mission_item(mavlink_item));
+    }
+    return hashes;
+}
+
+MissionPlan survey_mission_plan(unsigned count)
+{
+    MissionPlan mission_plan;
+    for (unsigned i = 0; i < count; ++i) {
+        const size_t index = mission_plan.add_waypoint(47.3977418 + 1e-5 * double(i % 10),
+                                                       8.5455939 + 1e-5 * double(i / 10),
+                                                       10.0f + float(i % 3));
+        mission_plan.set_fly_through(index, i % 2 == 0);
+        if (i % 4 == 0) {
+            mission_plan.set_speed(index, 5.0f);
+        }
+        if (i % 5 == 0) {
+            mission_plan.set_camera_action(index, MissionItem::CameraAction::TAKE_PHOTO);
+        }
+        if (i % 7 == 0) {
+            mission_plan.set_gimbal_pitch_and_yaw(index, -90.0f, 0.0f);
+        }
+    }
+    return mission_plan;
+}
+
+} // namespace
+
+TEST_F(MissionFileTest, LoadsPlanWithComplexItems)
+{
+    const std::string plan_path = write_file("survey.plan", R"({
+    "fileType": "Plan",
+    "geoFence": {"circles": [], "polygons": [{"polygon": [[47.1, 8.1], [47.2, 8.2]]}]},
+    "groundStation": "QGroundControl",
+    "mission": {
+        "cruiseSpeed": 15,
+        "items": [
+            {
+                "autoContinue": true, "command": 16, "doJumpId": 1, "frame": 3,
+                "params": [0, 0, 0, null, 47.3977418, 8.5455939, 20],
+                "type": "SimpleItem"
+            },
+            {
+                "autoContinue": true, "command": 178, "doJumpId": 2, "frame": 2,
+                "params": [1, 7.5, -1, 0, 0, 0, 0], "type": "SimpleItem"
+            },
+            {
+                "complexItemType": "survey",
+                "TransectStyleComplexItem": {
+                    "CameraCalc": {"CameraName": "Manual"},
+                    "Items": [
+                        {"autoContinue": true, "command": 16, "frame": 3,
+                         "params": [0, 0, 0, null, 47.3978, 8.5456, 20], "type": "SimpleItem"},
+                        {"autoContinue": true, "command": 2000, "frame": 2,
+                         "params": [0, 0, 1, null, null, null, null], "type": "SimpleItem"}
+                    ]
+                },
+                "type": "ComplexItem",
+                "polygon": [[47.39, 8.54], [47.40, 8.55]]
+            }
+        ],
+        "plannedHomePosition": [47.39, 8.54, 488],
+        "version": 2
+    },
+    "rallyPoints": {"points": [[47.1, 8.1, 10]], "version": 2},
+    "version": 1
+}
+)");
+
+    MissionPlan mission_plan;
+    ASSERT_EQ(MissionFile::load(plan_path, mission_plan), MissionFile::Result::SUCCESS);
+    ASSERT_EQ(mission_plan.size(), 2u);
+
+    EXPECT_EQ(mission_plan.latitudes_e7()[0], 473977418);
+    EXPECT_EQ(mission_plan.longitudes_e7()[0], 85455939);
+    EXPECT_FLOAT_EQ(mission_plan.get_relative_altitude_m(0), 20.0f);
+    EXPECT_TRUE(mission_plan.get_fly_through(0));
+    EXPECT_FLOAT_EQ(mission_plan.get_speed_m_s(0), 7.5f);
+
+    EXPECT_EQ(mission_plan.latitudes_e7()[1], 473978000);
+    EXPECT_EQ(mission_plan.get_camera_action(1), MissionItem::CameraAction::TAKE_PHOTO);
+}
+
+TEST_F(MissionFileTest, LoadsWaypointsWithoutHome)
+{
+    const std::string waypoints_path = write_file("mission.waypoints",
+                                                  "QGC WPL 110\n"
+                                                  "0\t1\t0\t16\t0\t0\t0\t0\t47.39\t8.54\t488\t1\n"
+                                                  "1\t0\t3\t16\t0.5\t1\t0\t0\t47.3977418\t8.5455939\t10\t1\n"
+                                                  "\n"
+                                                  "2\t0\t3\t16\t0\t3\t0\t0\t47.3978\t8.5456\t15\t1\n");
+
+    MissionPlan mission_plan;
+    ASSERT_EQ(MissionFile::load(waypoints_path, mission_plan), MissionFile::Result::SUCCESS);
+    ASSERT_EQ(mission_plan.size(), 2u);
+    EXPECT_EQ(mission_plan.latitudes_e7()[0], 473977418);
+    EXPECT_FALSE(mission_plan.get_fly_through(0));
+    EXPECT_TRUE(mission_plan.get_fly_through(1));
+    EXPECT_FLOAT_EQ(mission_plan.get_relative_altitude_m(1), 15.0f);
+}
+
+TEST_F(MissionFileTest, RoundTrip)
+{
+    const MissionPlan mission_plan = survey_mission_plan(100);
+    const std::vector<uint32_t> expected_hashes = mavlink_hashes(mission_plan);
+
+    const std::string paths[] = {path("mission.plan"), path("mission.waypoints"),
+                                 path(std::string("mission") + MissionBinaryFile::FILE_SUFFIX)
+                                };
+
+    ASSERT_EQ(MissionFile::save_plan(mission_plan, paths[0]), MissionFile::Result::SUCCESS);
+    ASSERT_EQ(MissionFile::save_waypoints(mission_plan, paths[1]), MissionFile::Result::SUCCESS);
+    ASSERT_EQ(MissionFile::save_binary(mission_plan, paths[2]), MissionFile::Result::SUCCESS);
+
+    for (const auto &file_path : paths) {
+        MissionPlan loaded_plan;
+        ASSERT_EQ(MissionFile::load(file_path, loaded_plan), MissionFile::Result::SUCCESS)
+                << file_path;
+        EXPECT_EQ(loaded_plan.size(), mission_plan.size()) << file_path;
+        EXPECT_EQ(mavlink_hashes(loaded_plan), expected_hashes) << file_path;
+    }
+
+    MissionBinaryFile binary_file;
+    ASSERT_TRUE(binary_file.open(paths[2]));
+    EXPECT_EQ(binary_file.num_mission_items(), 100u);
+    EXPECT_EQ(binary_file.num_mavlink_items(), unsigned(expected_hashes.size()));
+    EXPECT_EQ(binary_file.mission_item_indices()[binary_file.num_mavlink_items() - 1], 99);
+
+    // Saving over a mapped file must not change what is mapped.
+    ASSERT_EQ(MissionFile::save_binary(survey_mission_plan(10), paths[2]),
+              MissionFile::Result::SUCCESS);
+    const unsigned last = binary_file.num_mavlink_items() - 1;
+    EXPECT_EQ(binary_file.mission_item_indices()[last], 99);
+    EXPECT_EQ(MissionCache::hash_mission_item(binary_file.mavlink_items()[last]),
+              expected_hashes.back());
+}
+
+TEST_F(MissionFileTest, RejectsInvalidFiles)
+{
+    MissionPlan mission_plan;
+
+    EXPECT_EQ(MissionFile::load(path("missing.plan"), mission_plan),
+              MissionFile::Result::FILE_ERROR);
+
+    const std::string truncated_path = write_file("truncated.plan",
+                                                  R"({"mission": {"items": [{"command": 16,)");
+    EXPECT_EQ(MissionFile::load(truncated_path, mission_plan), MissionFile::Result::PARSE_ERROR);
+
+    // Nothing is left once the takeoff is skipped.
+    const std::string takeoff_path = write_file("takeoff.plan", R"({"mission": {"items": [
+        {"command": 22, "frame": 3, "params": [0, 0, 0, 0, 47.39, 8.54, 10], "type": "SimpleItem"}
+    ]}})");
+    EXPECT_EQ(MissionFile::load(takeoff_path, mission_plan),
+              MissionFile::Result::NO_MISSION_ITEMS);
+    EXPECT_TRUE(mission_plan.empty());
+
+    const std::string nested_path = write_file("nested.plan", R"({"mission": {"items": [)" +
+                                               std::string(100000, '[') + "]}}");
+    EXPECT_EQ(MissionFile::load(nested_path, mission_plan), MissionFile::Result::PARSE_ERROR);
+
+    const std::string empty_path = write_file("empty.plan", R"({"mission": {"items": []}})");
+    EXPECT_EQ(MissionFile::load(empty_path, mission_plan),
+              MissionFile::Result::NO_MISSION_ITEMS);
+
+    // Frame and command have to fit into a MAVLink item.
+    const std::string frame_path = write_file("frame.plan", R"({"mission": {"items": [
+        {"command": 16, "frame": 1e30, "params": [0, 0, 0, 0, 47, 8, 10], "type": "SimpleItem"}
+    ]}})");
+    EXPECT_EQ(MissionFile::load(frame_path, mission_plan), MissionFile::Result::PARSE_ERROR);
+
+    const std::string command_path = write_file("command.waypoints", "QGC WPL 110\n"
+                                                "1\t0\t3\t-1\t0\t0\t0\t0\t47.39\t8.54\t10\t1\n");
+    EXPECT_EQ(MissionFile::load(command_path, mission_plan), MissionFile::Result::PARSE_ERROR);
+
+    // Cut off the last MAVLink item.
+    const std::string binary_path = path(std::string("short") + MissionBinaryFile::FILE_SUFFIX);
+    ASSERT_EQ(MissionFile::save_binary(survey_mission_plan(10), binary_path),
+              MissionFile::Result::SUCCESS);
+    FILE *file = fopen(binary_path.c_str(), "r+");
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fclose(file);
+    ASSERT_EQ(truncate(binary_path.c_str(), size - 1), 0);
+    EXPECT_EQ(MissionFile::load(binary_path, mission_plan), MissionFile::Result::FILE_ERROR);
+
+    // Point the first MAVLink item to a mission item which doesn't exist.
+    const std::string index_path = path(std::string("index") + MissionBinaryFile::FILE_SUFFIX);
+    ASSERT_EQ(MissionFile::save_binary(survey_mission_plan(10), index_path),
+              MissionFile::Result::SUCCESS);
+    file = fopen(index_path.c_str(), "r+");
+    const int32_t invalid_index = 10;
+    fseek(file, sizeof(MissionBinaryFile::Header), SEEK_SET);
+    fwrite(&invalid_index, sizeof(invalid_index), 1, file);
+    fclose(file);
+    EXPECT_EQ(MissionFile::load(index_path, mission_plan), MissionFile::Result::FILE_ERROR);
+}
+
+TEST_F(MissionFileTest, RejectsTooManyItems)
+{
+    // The speed, camera and gimbal actions make this more items than MAVLink can count.
+    const MissionPlan mission_plan = survey_mission_plan(45000);
+    ASSERT_GT(mavlink_hashes(mission_plan).size(), MavlinkMissionItemsBuilder::MAX_MAVLINK_ITEMS);
+
+    const std::string plan_path = path("huge.plan");
+    const std::string waypoints_path = path("huge.waypoints");
+    ASSERT_EQ(MissionFile::save_plan(mission_plan, plan_path), MissionFile::Result::SUCCESS);
+    ASSERT_EQ(MissionFile::save_waypoints(mission_plan, waypoints_path),
+              MissionFile::Result::SUCCESS);
+
+    for (const std::string &file_path : {plan_path, waypoints_path}) {
+        MissionPlan loaded_plan;
+        EXPECT_EQ(MissionFile::load(file_path, loaded_plan),
+                  MissionFile::Result::TOO_MANY_MISSION_ITEMS) << file_path;
+        EXPECT_TRUE(loaded_plan.empty());
+    }
+}
+
+TEST_F(MissionFileTest, SkipsUnsupportedItems)
+{
+    // As written by QGroundControl: takeoff first, return to launch last.
+    const std::string plan_path = write_file("qgc.plan", R"({"mission": {"items": [
+        {"command": 22, "frame": 3, "params": [0, 0, 0, null, 47.39, 8.54, 10],
+         "type": "SimpleItem"},
+        {"command": 16, "frame": 3, "params": [0, 0, 0, null, 47.391, 8.541, 20],
+         "type": "SimpleItem"},
+        {"command": 178, "frame": 2, "params": [1, 5, -1, 0, 0, 0, 0], "type": "SimpleItem"},
+        {"command": 16, "frame": 0, "params": [0, 0, 0, null, 47.392, 8.542, 500],
+         "type": "SimpleItem"},
+        {"command": 16, "frame": 3, "params": [0, 0, 0, null, 47.393, 8.543, 20],
+         "type": "SimpleItem"},
+        {"command": 20, "frame": 2, "params": [0, 0, 0, 0, 0, 0, 0], "type": "SimpleItem"}
+    ]}})");
+    const std::string waypoints_path = write_file("qgc.waypoints", "QGC WPL 110\n"
+                                                  "0\t1\t0\t16\t0\t0\t0\t0\t47.39\t8.54\t400\t1\n"
+                                                  "1\t0\t3\t22\t0\t0\t0\t0\t47.39\t8.54\t10\t1\n"
+                                                  "2\t0\t3\t16\t0\t0\t0\t0\t47.391\t8.541\t20\t1\n"
+                                                  "3\t0\t2\t178\t1\t5\t-1\t0\t0\t0\t0\t1\n"
+                                                  "4\t0\t0\t16\t0\t0\t0\t0\t47.392\t8.542\t500\t1\n"
+                                                  "5\t0\t3\t16\t0\t0\t0\t0\t47.393\t8.543\t20\t1\n"
+                                                  "6\t0\t2\t20\t0\t0\t0\t0\t0\t0\t0\t1\n");
+
+    for (const std::string &file_path : {plan_path, waypoints_path}) {
+        MissionPlan mission_plan;
+        std::vector<MissionFile::SkippedItem> skipped_items;
+        ASSERT_EQ(MissionFile::load(file_path, mission_plan, &skipped_items),
+                  MissionFile::Result::SUCCESS) << file_path;
+
+        // The takeoff, the waypoint above mean sea level and the return to launch.
+        ASSERT_EQ(skipped_items.size(), 3u) << file_path;
+        EXPECT_EQ(skipped_items[0].index, 0u);
+        EXPECT_EQ(skipped_items[0].command, unsigned(MAV_CMD_NAV_TAKEOFF));
+        EXPECT_EQ(skipped_items[1].index, 3u);
+        EXPECT_EQ(skipped_items[1].command, unsigned(MAV_CMD_NAV_WAYPOINT));
+        EXPECT_EQ(skipped_items[2].index, 5u);
+        EXPECT_EQ(skipped_items[2].command, unsigned(MAV_CMD_NAV_RETURN_TO_LAUNCH));
+
+        ASSERT_EQ(mission_plan.size(), 2u) << file_path;
+        EXPECT_DOUBLE_EQ(mission_plan.get_latitude_deg(0), 47.391);
+        EXPECT_FLOAT_EQ(mission_plan.get_speed_m_s(0), 5.0f);
+        EXPECT_DOUBLE_EQ(mission_plan.get_latitude_deg(1), 47.393);
+        EXPECT_FLOAT_EQ(mission_plan.get_relative_altitude_m(1), 20.0f);
+    }
+
+    // Loading without asking for them works the same.
+    MissionPlan mission_plan;
+    EXPECT_EQ(MissionFile::load(plan_path, mission_plan), MissionFile::Result::SUCCESS);
+    EXPECT_EQ(mission_plan.size(), 2u);
+}
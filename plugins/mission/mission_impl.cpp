@@ -1,7 +1,10 @@
 #include "mission_impl.h"
-#include "mission_item_impl.h"
+#include "mission_binary_file.h"
+#include "mission_file.h"
+#include "mission_plan_mavlink.h"
 #include "device_impl.h"
 #include "global_include.h"
+#include <algorithm>
 #include <cmath>
 
 namespace dronecore {
@@ -84,6 +87,11 @@ void MissionImpl::process_mission_request_int(const mavlink_message_t &message)
     mavlink_mission_request_int_t mission_request_int;
     mavlink_msg_mission_request_int_decode(&message, &mission_request_int);
 
+    // Fence and rally points are uploaded by other plugins.
+    if (mission_request_int.mission_type != MAV_MISSION_TYPE_MISSION) {
+        return;
+    }
+
     if (mission_request_int.target_system != _parent->get_own_system_id() &&
         mission_request_int.target_component != _parent->get_own_component_id()) {
 
@@ -105,6 +113,14 @@ void MissionImpl::process_mission_request_int(const mavlink_message_t &message)
 
 void MissionImpl::process_mission_ack(const mavlink_message_t &message)
 {
+    mavlink_mission_ack_t mission_ack;
+    mavlink_msg_mission_ack_decode(&message, &mission_ack);
+
+    // Fence and rally points are uploaded by other plugins.
+    if (mission_ack.mission_type != MAV_MISSION_TYPE_MISSION) {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(_mutex);
 
     if (_activity != Activity::SET_MISSION) {
@@ -112,9 +128,6 @@ void MissionImpl::process_mission_ack(const mavlink_message_t &message)
         return;
     }
 
-    mavlink_mission_ack_t mission_ack;
-    mavlink_msg_mission_ack_decode(&message, &mission_ack);
-
     if (mission_ack.target_system != _parent->get_own_system_id() &&
         mission_ack.target_component != _parent->get_own_component_id()) {
 
@@ -125,6 +138,11 @@ void MissionImpl::process_mission_ack(const mavlink_message_t &message)
     // We got some response, so it wasn't a timeout and we can remove it.
     _parent->unregister_timeout_handler(_timeout_cookie);
 
+    if (!_partial_write_ranges.empty()) {
+        process_partial_write_ack(mission_ack.type);
+        return;
+    }
+
     if (mission_ack.type == MAV_MISSION_ACCEPTED) {
 
         // Reset current and reached; we don't want to get confused
@@ -132,18 +150,25 @@ void MissionImpl::process_mission_ack(const mavlink_message_t &message)
         _last_current_mavlink_mission_item = -1;
         _last_reached_mavlink_mission_item = -1;
 
+        _synced_mission_item_hashes.swap(_pending_mission_item_hashes);
+        store_mavlink_mission_items_in_cache();
         _activity = Activity::NONE;
 
         report_mission_result(_result_callback, Mission::Result::SUCCESS);
         LogInfo() << "Mission accepted";
     } else if (mission_ack.type == MAV_MISSION_NO_SPACE) {
+        _synced_mission_item_hashes.clear();
+        _mission_cache.remove(_parent->get_target_uuid());
         LogErr() << "Error: too many waypoints: " << int(mission_ack.type);
         report_mission_result(_result_callback, Mission::Result::TOO_MANY_MISSION_ITEMS);
     } else {
+        _synced_mission_item_hashes.clear();
+        _mission_cache.remove(_parent->get_target_uuid());
         LogErr() << "Error: unknown mission ack: " << int(mission_ack.type);
         report_mission_result(_result_callback, Mission::Result::ERROR);
     }
 
+    release_binary_file();
 }
 
 void MissionImpl::process_mission_current(const mavlink_message_t &message)
@@ -192,49 +217,190 @@ void MissionImpl::process_mission_count(const mavlink_message_t &message)
     mavlink_msg_mission_count_decode(&message, &mission_count);
 
     _num_mission_items_to_download = mission_count.count;
+    _num_mission_items_downloaded = 0;
+    _download_retries = 0;
+
+    // All items are written into place, so we only need to allocate once.
+    _mavlink_mission_items_downloaded.assign(mission_count.count, mavlink_mission_item_int_t {});
+    _mission_items_received.assign(mission_count.count, false);
+
+    if (_num_mission_items_to_download == 0) {
+        _validating_cache = false;
+        finish_download();
+        return;
+    }
+
     _next_mission_item_to_download = 0;
+
+    if (_validating_cache) {
+        const MissionCache::Entry *entry = _mission_cache.get(_parent->get_target_uuid());
+        if (entry != nullptr && int(entry->mavlink_items.size()) == _num_mission_items_to_download) {
+            request_spot_checks();
+            _parent->refresh_timeout_handler(_timeout_cookie);
+            return;
+        }
+
+        LogDebug() << "Mission count changed, cache can't be used";
+        _validating_cache = false;
+    }
+
+    // Fill the window of outstanding requests.
+    request_next_mission_items(DOWNLOAD_WINDOW_SIZE);
+
     _parent->refresh_timeout_handler(_timeout_cookie);
-    download_next_mission_item();
 }
 
 void MissionImpl::process_mission_item_int(const mavlink_message_t &message)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    auto mission_item_int_ptr = std::make_shared<mavlink_mission_item_int_t>();
-    mavlink_msg_mission_item_int_decode(&message, mission_item_int_ptr.get());
+    if (_activity != Activity::GET_MISSION || _num_mission_items_to_download <= 0) {
+        return;
+    }
 
-    _mavlink_mission_items_downloaded.push_back(mission_item_int_ptr);
+    mavlink_mission_item_int_t mission_item_int;
+    mavlink_msg_mission_item_int_decode(&message, &mission_item_int);
 
-    if (mission_item_int_ptr->seq == _next_mission_item_to_download) {
-        LogDebug() << "Received mission item " << _next_mission_item_to_download;
+    const int seq = mission_item_int.seq;
+    if (seq >= _num_mission_items_to_download) {
+        LogWarn() << "Ignoring mission item " << seq << " out of range";
+        return;
     }
 
-    if (_next_mission_item_to_download + 1 == _num_mission_items_to_download) {
-        _parent->unregister_timeout_handler(_timeout_cookie);
-
-        mavlink_message_t ack_message;
-        mavlink_msg_mission_ack_pack(_parent->get_own_system_id(),
-                                     _parent->get_own_component_id(),
-                                     &ack_message,
-                                     _parent->get_target_system_id(),
-                                     _parent->get_target_component_id(),
-                                     MAV_MISSION_ACCEPTED,
-                                     MAV_MISSION_TYPE_MISSION);
+    if (_mission_items_received[seq]) {
+        // Duplicate because we re-requested it, nothing to do.
+        return;
+    }
 
-        _parent->send_message(ack_message);
+    LogDebug() << "Received mission item " << seq;
 
-        assemble_mission_items();
+    _mavlink_mission_items_downloaded[seq] = mission_item_int;
+    _mission_items_received[seq] = true;
+    ++_num_mission_items_downloaded;
+    _download_retries = 0;
 
-    } else {
-        ++_next_mission_item_to_download;
+    if (_validating_cache) {
+        process_spot_check(mission_item_int);
         _parent->refresh_timeout_handler(_timeout_cookie);
-        download_next_mission_item();
+        return;
+    }
+
+    if (_num_mission_items_downloaded == _num_mission_items_to_download) {
+        finish_download();
+        return;
+    }
+
+    // Keep the window full.
+    request_next_mission_items(1);
+
+    _parent->refresh_timeout_handler(_timeout_cookie);
+}
+
+void MissionImpl::request_spot_checks()
+{
+    // Instead of downloading everything, we compare the first, the last and a
+    // few random items with the cache.
+    const uint16_t last = uint16_t(_num_mission_items_to_download - 1);
+    _spot_check_seqs.clear();
+    _spot_check_seqs.push_back(0);
+    _spot_check_seqs.push_back(last);
+
+    std::uniform_int_distribution<unsigned> distribution(0, last);
+    for (unsigned i = 0; i < NUM_RANDOM_SPOT_CHECKS; ++i) {
+        _spot_check_seqs.push_back(uint16_t(distribution(_random_engine)));
+    }
+
+    std::sort(_spot_check_seqs.begin(), _spot_check_seqs.end());
+    _spot_check_seqs.erase(std::unique(_spot_check_seqs.begin(), _spot_check_seqs.end()),
+                           _spot_check_seqs.end());
+
+    for (auto seq : _spot_check_seqs) {
+        request_mission_item(seq);
+    }
+}
+
+void MissionImpl::process_spot_check(const mavlink_mission_item_int_t &mission_item_int)
+{
+    const MissionCache::Entry *entry = _mission_cache.get(_parent->get_target_uuid());
+
+    if (entry == nullptr ||
+        entry->hashes.at(mission_item_int.seq) !=
+        MissionCache::hash_mission_item(mission_item_int)) {
+
+        LogDebug() << "Mission item " << mission_item_int.seq << " differs from cache";
+        _validating_cache = false;
+
+        // With few items, every item is a spot check and this might have been
+        // the last one to arrive.
+        if (_num_mission_items_downloaded == _num_mission_items_to_download) {
+            finish_download();
+            return;
+        }
+
+        // Continue with a normal download, what we already got is kept.
+        request_next_mission_items(DOWNLOAD_WINDOW_SIZE);
+        return;
+    }
+
+    for (auto seq : _spot_check_seqs) {
+        if (!_mission_items_received[seq]) {
+            // Still waiting for other spot checks.
+            return;
+        }
     }
+
+    LogInfo() << "Mission matches cache, skipping download";
+    _mavlink_mission_items_downloaded = entry->mavlink_items;
+    finish_download();
 }
 
-void MissionImpl::upload_mission_async(const std::vector<std::shared_ptr<MissionItem>>
-                                       &mission_items,
+void MissionImpl::request_next_mission_items(int max_requests)
+{
+    int num_requested = 0;
+
+    while (num_requested < max_requests &&
+           _next_mission_item_to_download < _num_mission_items_to_download) {
+
+        const int seq = _next_mission_item_to_download++;
+
+        // Might have already arrived as part of checking the cache.
+        if (!_mission_items_received[seq]) {
+            request_mission_item(uint16_t(seq));
+            ++num_requested;
+        }
+    }
+}
+
+void MissionImpl::finish_download()
+{
+    _parent->unregister_timeout_handler(_timeout_cookie);
+
+    // This is now what the device has, whether we can represent it or not.
+    compute_mission_item_hashes(_mavlink_mission_items_downloaded.data(),
+                                _mavlink_mission_items_downloaded.size(),
+                                _synced_mission_item_hashes);
+
+    if (!_validating_cache) {
+        _mission_cache.store(_parent->get_target_uuid(), _mavlink_mission_items_downloaded,
+                             _synced_mission_item_hashes);
+    }
+    _validating_cache = false;
+
+    mavlink_message_t ack_message;
+    mavlink_msg_mission_ack_pack(_parent->get_own_system_id(),
+                                 _parent->get_own_component_id(),
+                                 &ack_message,
+                                 _parent->get_target_system_id(),
+                                 _parent->get_target_component_id(),
+                                 MAV_MISSION_ACCEPTED,
+                                 MAV_MISSION_TYPE_MISSION);
+
+    _parent->send_message(ack_message);
+
+    assemble_mission_items();
+}
+
+void MissionImpl::upload_mission_async(MissionPlan mission_plan,
                                        const Mission::result_callback_t &callback)
 {
     std::lock_guard<std::mutex> lock(_mutex);
@@ -250,20 +416,80 @@ void MissionImpl::upload_mission_async(const std::vector<std::shared_ptr<Mission
         return;
     }
 
-    copy_mission_item_vector(mission_items);
+    // The items are only unpacked here, the messages are packed when requested.
+    _mission_plan.clear();
+    assemble_mavlink_mission_items(mission_plan);
+    _num_mission_items = int(mission_plan.size());
 
-    assemble_mavlink_messages();
+    start_mission_upload(callback);
+}
 
-    mavlink_message_t message;
-    mavlink_msg_mission_count_pack(_parent->get_own_system_id(),
-                                   _parent->get_own_component_id(),
-                                   &message,
-                                   _parent->get_target_system_id(),
-                                   _parent->get_target_component_id(),
-                                   _mavlink_mission_item_messages.size(),
-                                   MAV_MISSION_TYPE_MISSION);
+void MissionImpl::upload_mission_file_async(const std::string &path,
+                                            const Mission::result_callback_t &callback)
+{
+    // Text files are parsed before taking the lock, binary files are only mapped.
+    const bool is_binary = MissionBinaryFile::has_suffix(path);
+    std::unique_ptr<MissionBinaryFile> binary_file(new MissionBinaryFile());
+    MissionPlan mission_plan;
+    MissionFile::Result file_result = MissionFile::Result::SUCCESS;
+
+    if (is_binary) {
+        if (!binary_file->open(path)) {
+            file_result = MissionFile::Result::FILE_ERROR;
+        }
+    } else {
+        file_result = MissionFile::load(path, mission_plan);
+    }
 
-    if (!_parent->send_message(message)) {
+    if (file_result != MissionFile::Result::SUCCESS) {
+        report_mission_result(callback,
+                              (file_result == MissionFile::Result::TOO_MANY_MISSION_ITEMS) ?
+                              Mission::Result::TOO_MANY_MISSION_ITEMS :
+                              Mission::Result::INVALID_ARGUMENT);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_activity != Activity::NONE) {
+        report_mission_result(callback, Mission::Result::BUSY);
+        return;
+    }
+
+    if (!_parent->target_supports_mission_int()) {
+        LogWarn() << "Mission int messages not supported";
+        report_mission_result(callback, Mission::Result::ERROR);
+        return;
+    }
+
+    _mission_plan.clear();
+    if (is_binary) {
+        // The file already contains the MAVLink items exactly as they are sent,
+        // so they are served from the mapping while it is uploaded.
+        use_mavlink_mission_items(std::move(binary_file));
+    } else {
+        assemble_mavlink_mission_items(mission_plan);
+        _num_mission_items = int(mission_plan.size());
+    }
+
+    start_mission_upload(callback);
+}
+
+void MissionImpl::start_mission_upload(const Mission::result_callback_t &callback)
+{
+    if (too_many_mavlink_mission_items()) {
+        release_binary_file();
+        report_mission_result(callback, Mission::Result::TOO_MANY_MISSION_ITEMS);
+        return;
+    }
+
+    compute_mission_item_hashes(mavlink_mission_items(), num_mavlink_mission_items(),
+                                _pending_mission_item_hashes);
+    _partial_write_ranges.clear();
+    reset_upload_progress();
+
+    if (!send_mission_count()) {
+        release_binary_file();
         report_mission_result(callback, Mission::Result::ERROR);
         return;
     }
@@ -272,379 +498,194 @@ void MissionImpl::upload_mission_async(const std::vector<std::shared_ptr<Mission
     _result_callback = callback;
 }
 
-void MissionImpl::download_mission_async(const Mission::mission_items_and_result_callback_t
-                                         &callback)
+void MissionImpl::update_mission_async(MissionPlan mission_plan,
+                                       const Mission::update_result_callback_t &callback)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
     if (_activity != Activity::NONE) {
-        report_mission_items_and_result(callback, Mission::Result::BUSY);
+        if (callback) {
+            callback(Mission::Result::BUSY, 0);
+        }
         return;
     }
 
-    mavlink_message_t message;
-    mavlink_msg_mission_request_list_pack(_parent->get_own_system_id(),
-                                          _parent->get_own_component_id(),
-                                          &message,
-                                          _parent->get_target_system_id(),
-                                          _parent->get_target_component_id(),
-                                          MAV_MISSION_TYPE_MISSION);
-
-    if (!_parent->send_message(message)) {
-        report_mission_items_and_result(callback, Mission::Result::ERROR);
+    if (!_parent->target_supports_mission_int()) {
+        LogWarn() << "Mission int messages not supported";
+        if (callback) {
+            callback(Mission::Result::ERROR, 0);
+        }
         return;
     }
 
-    _parent->register_timeout_handler(std::bind(&MissionImpl::process_timeout, this), 1.0,
-                                      &_timeout_cookie);
+    _mission_plan.clear();
+    assemble_mavlink_mission_items(mission_plan);
+    _num_mission_items = int(mission_plan.size());
 
-    // Clear our internal cache and re-populate it.
-    _mavlink_mission_items_downloaded.clear();
-    _activity = Activity::GET_MISSION;
-    _mission_items_and_result_callback = callback;
-}
-
-void MissionImpl::assemble_mavlink_messages()
-{
-    _mavlink_mission_item_messages.clear();
-
-    bool last_position_valid = false; // This flag is to protect us from using an invalid x/y.
-    MAV_FRAME last_frame;
-    int32_t last_x;
-    int32_t last_y;
-    float last_z;
-
-    unsigned item_i = 0;
-    for (auto item : _mission_items) {
-
-        MissionItemImpl &mission_item_impl = (*(item)->_impl);
-
-        if (mission_item_impl.is_position_finite()) {
-            // Current is the 0th waypoint
-            uint8_t current = ((_mavlink_mission_item_messages.size() == 0) ? 1 : 0);
-
-            auto message = std::make_shared<mavlink_message_t>();
-            mavlink_msg_mission_item_int_pack(_parent->get_own_system_id(),
-                                              _parent->get_own_component_id(),
-                                              message.get(),
-                                              _parent->get_target_system_id(),
-                                              _parent->get_target_component_id(),
-                                              _mavlink_mission_item_messages.size(),
-                                              mission_item_impl.get_mavlink_frame(),
-                                              mission_item_impl.get_mavlink_cmd(),
-                                              current,
-                                              mission_item_impl.get_mavlink_autocontinue(),
-                                              mission_item_impl.get_mavlink_param1(),
-                                              mission_item_impl.get_mavlink_param2(),
-                                              mission_item_impl.get_mavlink_param3(),
-                                              mission_item_impl.get_mavlink_param4(),
-                                              mission_item_impl.get_mavlink_x(),
-                                              mission_item_impl.get_mavlink_y(),
-                                              mission_item_impl.get_mavlink_z(),
-                                              MAV_MISSION_TYPE_MISSION);
-
-            last_position_valid = true; // because we checked is_position_finite
-            last_x = mission_item_impl.get_mavlink_x();
-            last_y = mission_item_impl.get_mavlink_y();
-            last_z = mission_item_impl.get_mavlink_z();
-            last_frame = mission_item_impl.get_mavlink_frame();
-
-            _mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair <int, int>
-            {static_cast<int>(_mavlink_mission_item_messages.size()), item_i});
-            _mavlink_mission_item_messages.push_back(message);
+    if (too_many_mavlink_mission_items()) {
+        if (callback) {
+            callback(Mission::Result::TOO_MANY_MISSION_ITEMS, 0);
         }
+        return;
+    }
 
-        if (std::isfinite(mission_item_impl.get_speed_m_s())) {
-
-            // The speed has changed, we need to add a speed command.
-
-            // Current is the 0th waypoint
-            uint8_t current = ((_mavlink_mission_item_messages.size() == 0) ? 1 : 0);
-
-            uint8_t autocontinue = 1;
-
-            auto message_speed = std::make_shared<mavlink_message_t>();
-            mavlink_msg_mission_item_int_pack(_parent->get_own_system_id(),
-                                              _parent->get_own_component_id(),
-                                              message_speed.get(),
-                                              _parent->get_target_system_id(),
-                                              _parent->get_target_component_id(),
-                                              _mavlink_mission_item_messages.size(),
-                                              MAV_FRAME_MISSION,
-                                              MAV_CMD_DO_CHANGE_SPEED,
-                                              current,
-                                              autocontinue,
-                                              1.0f, // ground speed
-                                              mission_item_impl.get_speed_m_s(),
-                                              -1.0f, // no throttle change
-                                              0.0f, // absolute
-                                              0,
-                                              0,
-                                              NAN,
-                                              MAV_MISSION_TYPE_MISSION);
-
-            _mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair <int, int>
-            {static_cast<int>(_mavlink_mission_item_messages.size()), item_i});
-            _mavlink_mission_item_messages.push_back(message_speed);
-        }
+    compute_mission_item_hashes(mavlink_mission_items(), num_mavlink_mission_items(),
+                                _pending_mission_item_hashes);
+    reset_upload_progress();
+    _update_bytes_saved = 0;
 
-        if (std::isfinite(mission_item_impl.get_gimbal_yaw_deg()) ||
-            std::isfinite(mission_item_impl.get_gimbal_pitch_deg())) {
-            // The gimbal has changed, we need to add a gimbal command.
-
-            // Current is the 0th waypoint
-            uint8_t current = ((_mavlink_mission_item_messages.size() == 0) ? 1 : 0);
-
-            uint8_t autocontinue = 1;
-
-            auto message_gimbal = std::make_shared<mavlink_message_t>();
-            mavlink_msg_mission_item_int_pack(_parent->get_own_system_id(),
-                                              _parent->get_own_component_id(),
-                                              message_gimbal.get(),
-                                              _parent->get_target_system_id(),
-                                              _parent->get_target_component_id(),
-                                              _mavlink_mission_item_messages.size(),
-                                              MAV_FRAME_MISSION,
-                                              MAV_CMD_DO_MOUNT_CONTROL,
-                                              current,
-                                              autocontinue,
-                                              mission_item_impl.get_gimbal_pitch_deg(), // pitch
-                                              0.0f, // roll (yes it is a weird order)
-                                              mission_item_impl.get_gimbal_yaw_deg(), // yaw
-                                              NAN,
-                                              0,
-                                              0,
-                                              MAV_MOUNT_MODE_MAVLINK_TARGETING,
-                                              MAV_MISSION_TYPE_MISSION);
-
-            _mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair <int, int>
-            {static_cast<int>(_mavlink_mission_item_messages.size()), item_i});
-            _mavlink_mission_item_messages.push_back(message_gimbal);
+    // All results are reported through the usual result callback, the bytes
+    // saved are only set once the update succeeded.
+    _result_callback = [this, callback](Mission::Result result) {
+        if (callback) {
+            callback(result, _update_bytes_saved);
         }
+    };
 
-        // FIXME: It is a bit of a hack to set a LOITER_TIME waypoint to add a delay.
-        //        A better solution would be to properly use NAV_DELAY instead. This
-        //        would not require us to keep the last lat/lon.
-        if (std::isfinite(mission_item_impl.get_camera_action_delay_s())) {
-            if (!last_position_valid) {
-                // In the case where we get a delay without a previous position, we will have to
-                // ignore it.
-                LogErr() << "Can't set camera action delay without previous position set.";
-
-            } else {
-
-                // Current is the 0th waypoint
-                uint8_t current = ((_mavlink_mission_item_messages.size() == 0) ? 1 : 0);
-
-                uint8_t autocontinue = 1;
-
-                std::shared_ptr<mavlink_message_t> message_delay(new mavlink_message_t());
-                mavlink_msg_mission_item_int_pack(_parent->get_own_system_id(),
-                                                  _parent->get_own_component_id(),
-                                                  message_delay.get(),
-                                                  _parent->get_target_system_id(),
-                                                  _parent->get_target_component_id(),
-                                                  _mavlink_mission_item_messages.size(),
-                                                  last_frame,
-                                                  MAV_CMD_NAV_LOITER_TIME,
-                                                  current,
-                                                  autocontinue,
-                                                  mission_item_impl.get_camera_action_delay_s(), // loiter time in seconds
-                                                  NAN, // empty
-                                                  0.0f, // radius around waypoint in meters ?
-                                                  0.0f, // loiter at center of waypoint
-                                                  last_x,
-                                                  last_y,
-                                                  last_z,
-                                                  MAV_MISSION_TYPE_MISSION);
-
-                _mavlink_mission_item_to_mission_item_indices.insert(
-                    std::pair <int, int>
-                {static_cast<int>(_mavlink_mission_item_messages.size()), item_i});
-                _mavlink_mission_item_messages.push_back(message_delay);
-            }
-        }
+    if (!find_changed_ranges(_pending_mission_item_hashes)) {
+        LogInfo() << "Mission can't be updated partially, uploading whole mission";
 
-        if (mission_item_impl.get_camera_action() != MissionItem::CameraAction::NONE) {
-            // There is a camera action that we need to send.
-
-            // Current is the 0th waypoint
-            uint8_t current = ((_mavlink_mission_item_messages.size() == 0) ? 1 : 0);
-
-            uint8_t autocontinue = 1;
-
-            uint16_t cmd = 0;
-            float param1 = NAN;
-            float param2 = NAN;
-            float param3 = NAN;
-            switch (mission_item_impl.get_camera_action()) {
-                case MissionItem::CameraAction::TAKE_PHOTO:
-                    cmd = MAV_CMD_IMAGE_START_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    param2 = 0.0f; // no duration, take only one picture
-                    param3 = 1.0f; // only take one picture
-                    break;
-                case MissionItem::CameraAction::START_PHOTO_INTERVAL:
-                    cmd = MAV_CMD_IMAGE_START_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    param2 = mission_item_impl.get_camera_photo_interval_s();
-                    param3 = 0.0f; // unlimited photos
-                    break;
-                case MissionItem::CameraAction::STOP_PHOTO_INTERVAL:
-                    cmd = MAV_CMD_IMAGE_STOP_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    break;
-                case MissionItem::CameraAction::START_VIDEO:
-                    cmd = MAV_CMD_VIDEO_START_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    break;
-                case MissionItem::CameraAction::STOP_VIDEO:
-                    cmd = MAV_CMD_VIDEO_STOP_CAPTURE;
-                    param1 = 0.0f; // all camera IDs
-                    break;
-                default:
-                    LogErr() << "Error: camera action not supported";
-                    break;
-            }
-
-            auto message_camera = std::make_shared<mavlink_message_t>();
-            mavlink_msg_mission_item_int_pack(_parent->get_own_system_id(),
-                                              _parent->get_own_component_id(),
-                                              message_camera.get(),
-                                              _parent->get_target_system_id(),
-                                              _parent->get_target_component_id(),
-                                              _mavlink_mission_item_messages.size(),
-                                              MAV_FRAME_MISSION,
-                                              cmd,
-                                              current,
-                                              autocontinue,
-                                              param1,
-                                              param2,
-                                              param3,
-                                              NAN,
-                                              0,
-                                              0,
-                                              NAN,
-                                              MAV_MISSION_TYPE_MISSION);
-
-            _mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair <int, int>
-            {static_cast<int>(_mavlink_mission_item_messages.size()), item_i});
-            _mavlink_mission_item_messages.push_back(message_camera);
-        }
+    } else if (_partial_write_ranges.empty()) {
+        LogInfo() << "Mission unchanged, nothing to update";
+        _update_bytes_saved = full_upload_bytes();
+        report_mission_result(_result_callback, Mission::Result::SUCCESS);
+        return;
+    }
 
-        ++item_i;
+    const bool sent = _partial_write_ranges.empty() ? send_mission_count() : send_partial_write();
+    if (!sent) {
+        report_mission_result(_result_callback, Mission::Result::ERROR);
+        return;
     }
+
+    _activity = Activity::SET_MISSION;
 }
 
-void MissionImpl::assemble_mission_items()
+void MissionImpl::download_mission_plan_async(const Mission::mission_plan_and_result_callback_t
+                                              &callback)
 {
-    _mission_items.clear();
-
-    Mission::Result result = Mission::Result::SUCCESS;
-
-    auto new_mission_item = std::make_shared<MissionItem>();
-    bool have_set_position = false;
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_mavlink_mission_items_downloaded.size() > 0) {
-        // The first mission item needs to be a waypoint with position.
-        if (_mavlink_mission_items_downloaded.at(0)->command != MAV_CMD_NAV_WAYPOINT) {
-            LogErr() << "First mission item is not a waypoint";
-            result = Mission::Result::UNSUPPORTED;
-            return;
-        }
+    if (_activity != Activity::NONE) {
+        report_mission_plan_and_result(callback, Mission::Result::BUSY);
+        return;
     }
 
-    if (_mavlink_mission_items_downloaded.size() == 0) {
-        LogErr() << "No downloaded mission items";
-        result = Mission::Result::NO_MISSION_AVAILABLE;
+    mavlink_message_t message;
+    mavlink_msg_mission_request_list_pack(_parent->get_own_system_id(),
+                                          _parent->get_own_component_id(),
+                                          &message,
+                                          _parent->get_target_system_id(),
+                                          _parent->get_target_component_id(),
+                                          MAV_MISSION_TYPE_MISSION);
+
+    if (!_parent->send_message(message)) {
+        report_mission_plan_and_result(callback, Mission::Result::ERROR);
         return;
     }
 
-    for (auto &it : _mavlink_mission_items_downloaded) {
-        LogDebug() << "Assembling Message: " << int(it->seq);
+    _parent->register_timeout_handler(std::bind(&MissionImpl::process_timeout, this),
+                                      DOWNLOAD_TIMEOUT_S, &_timeout_cookie);
 
+    // Clear our internal cache and re-populate it.
+    _mavlink_mission_items_downloaded.clear();
+    _mission_items_received.clear();
+    _num_mission_items_to_download = -1;
 
-        if (it->command == MAV_CMD_NAV_WAYPOINT) {
-            if (it->frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-                LogErr() << "Waypoint frame not supported unsupported";
-                result = Mission::Result::UNSUPPORTED;
-                break;
-            }
+    // If we have seen the mission of this device before, we only check whether it changed.
+    _validating_cache = (_mission_cache.get(_parent->get_target_uuid()) != nullptr);
+    _activity = Activity::GET_MISSION;
+    _mission_plan_and_result_callback = callback;
+}
 
-            if (have_set_position) {
-                // When a new position comes in, create next mission item.
-                _mission_items.push_back(new_mission_item);
-                new_mission_item = std::make_shared<MissionItem>();
-                have_set_position = false;
-            }
+void MissionImpl::assemble_mavlink_mission_items(const MissionPlan &mission_plan)
+{
+    _binary_file.reset();
+    MavlinkMissionItemsBuilder::build(mission_plan, _mavlink_mission_items,
+                                      _mavlink_mission_item_to_mission_item_indices);
+}
 
-            new_mission_item->set_position(double(it->x) * 1e-7, double(it->y) * 1e-7);
-            new_mission_item->set_relative_altitude(it->z);
+void MissionImpl::use_mavlink_mission_items(std::unique_ptr<MissionBinaryFile> binary_file)
+{
+    _binary_file = std::move(binary_file);
+    _num_mission_items = int(_binary_file->num_mission_items());
+
+    // Nothing assembled earlier is needed anymore.
+    std::vector<mavlink_mission_item_int_t>().swap(_mavlink_mission_items);
 
-            new_mission_item->set_fly_through(!(it->param1 > 0));
+    // The indices are small, they are kept once the file is unmapped.
+    const int32_t *indices = _binary_file->mission_item_indices();
+    _mavlink_mission_item_to_mission_item_indices.assign(
+        indices, indices + _binary_file->num_mavlink_items());
+}
 
-            have_set_position = true;
+void MissionImpl::release_binary_file()
+{
+    // Once the upload is over the file is not read anymore, it must not stay
+    // mapped in case it gets overwritten.
+    _binary_file.reset();
+}
 
-        } else if (it->command == MAV_CMD_DO_MOUNT_CONTROL) {
-            if (int(it->z) != MAV_MOUNT_MODE_MAVLINK_TARGETING) {
-                LogErr() << "Gimbal mount mode unsupported";
-                result = Mission::Result::UNSUPPORTED;
-                break;
-            }
+const mavlink_mission_item_int_t *MissionImpl::mavlink_mission_items() const
+{
+    return _binary_file ? _binary_file->mavlink_items() : _mavlink_mission_items.data();
+}
 
-            new_mission_item->set_gimbal_pitch_and_yaw(it->param1, it->param3);
+size_t MissionImpl::num_mavlink_mission_items() const
+{
+    return _binary_file ? _binary_file->num_mavlink_items() : _mavlink_mission_items.size();
+}
 
-        } else if (it->command == MAV_CMD_IMAGE_START_CAPTURE) {
-            if (it->param2 > 0 && int(it->param3) == 0) {
-                new_mission_item->set_camera_action(MissionItem::CameraAction::START_PHOTO_INTERVAL);
-                new_mission_item->set_camera_photo_interval(double(it->param2));
-            } else if (int(it->param2) == 0 && int(it->param3) == 1) {
-                new_mission_item->set_camera_action(MissionItem::CameraAction::TAKE_PHOTO);
-            } else {
-                LogErr() << "Mission item START_CAPTURE params unsupported.";
-                result = Mission::Result::UNSUPPORTED;
-                break;
-            }
+bool MissionImpl::too_many_mavlink_mission_items() const
+{
+    // Anything beyond would be cut off by the 16 bit count without notice.
+    if (num_mavlink_mission_items() <= MavlinkMissionItemsBuilder::MAX_MAVLINK_ITEMS) {
+        return false;
+    }
+    LogErr() << "Mission has " << num_mavlink_mission_items() << " items, only "
+             << MavlinkMissionItemsBuilder::MAX_MAVLINK_ITEMS << " can be uploaded";
+    return true;
+}
 
-        } else if (it->command == MAV_CMD_IMAGE_STOP_CAPTURE) {
-            new_mission_item->set_camera_action(MissionItem::CameraAction::STOP_PHOTO_INTERVAL);
+void MissionImpl::store_mavlink_mission_items_in_cache()
+{
+    if (!_binary_file) {
+        _mission_cache.store(_parent->get_target_uuid(), _mavlink_mission_items,
+                             _synced_mission_item_hashes);
+        return;
+    }
 
-        } else if (it->command == MAV_CMD_VIDEO_START_CAPTURE) {
-            new_mission_item->set_camera_action(MissionItem::CameraAction::START_VIDEO);
+    // The cache keeps its own copy, the mapping is gone by the next upload.
+    const mavlink_mission_item_int_t *mavlink_items = mavlink_mission_items();
+    _mission_cache.store(_parent->get_target_uuid(),
+                         std::vector<mavlink_mission_item_int_t>(
+                             mavlink_items, mavlink_items + num_mavlink_mission_items()),
+                         _synced_mission_item_hashes);
+}
 
-        } else if (it->command == MAV_CMD_VIDEO_STOP_CAPTURE) {
-            new_mission_item->set_camera_action(MissionItem::CameraAction::STOP_VIDEO);
+void MissionImpl::assemble_mission_items()
+{
+    MissionPlanBuilder mission_plan_builder(_mission_plan);
 
-        } else if (it->command == MAV_CMD_DO_CHANGE_SPEED) {
-            if (int(it->param1) == 1 && it->param3 < 0 && int(it->param4) == 0) {
-                new_mission_item->set_speed(it->param2);
-            } else {
-                LogErr() << "Mission item DO_CHANGE_SPEED params unsupported";
-                result = Mission::Result::UNSUPPORTED;
-            }
+    // There are at most as many mission items as MAVLink items.
+    _mission_plan.reserve(_mavlink_mission_items_downloaded.size());
 
-        } else if (it->command == MAV_CMD_NAV_LOITER_TIME) {
-            new_mission_item->set_camera_action_delay(it->param1);
+    for (const auto &mavlink_item : _mavlink_mission_items_downloaded) {
+        LogDebug() << "Assembling Message: " << int(mavlink_item.seq);
 
-        } else {
-            LogErr() << "UNSUPPORTED mission item command (" << it->command << ")";
-            result = Mission::Result::UNSUPPORTED;
+        if (mission_plan_builder.add(mavlink_item) != Mission::Result::SUCCESS) {
             break;
         }
     }
 
-    // Don't forget to add last mission item.
-    _mission_items.push_back(new_mission_item);
+    const Mission::Result result = mission_plan_builder.finish();
+    _num_mission_items = int(_mission_plan.size());
 
-    report_mission_items_and_result(_mission_items_and_result_callback, result);
+    report_mission_plan_and_result(_mission_plan_and_result_callback, result);
     _activity = Activity::NONE;
 }
 
-void MissionImpl::download_next_mission_item()
+void MissionImpl::request_mission_item(uint16_t seq)
 {
     mavlink_message_t message;
     mavlink_msg_mission_request_int_pack(_parent->get_own_system_id(),
@@ -652,14 +693,31 @@ void MissionImpl::download_next_mission_item()
                                          &message,
                                          _parent->get_target_system_id(),
                                          _parent->get_target_component_id(),
-                                         _next_mission_item_to_download,
+                                         seq,
                                          MAV_MISSION_TYPE_MISSION);
 
-    LogDebug() << "Requested mission item " << _next_mission_item_to_download;
+    LogDebug() << "Requested mission item " << seq;
 
     _parent->send_message(message);
 }
 
+void MissionImpl::request_missing_mission_items()
+{
+    // Re-request the gaps of what has been requested so far, and top it up
+    // with new requests if there are fewer gaps than the window.
+    int num_requested = 0;
+
+    for (int seq = 0; seq < _next_mission_item_to_download &&
+         num_requested < DOWNLOAD_WINDOW_SIZE; ++seq) {
+        if (!_mission_items_received[seq]) {
+            request_mission_item(uint16_t(seq));
+            ++num_requested;
+        }
+    }
+
+    request_next_mission_items(DOWNLOAD_WINDOW_SIZE - num_requested);
+}
+
 void MissionImpl::start_mission_async(const Mission::result_callback_t &callback)
 {
     std::lock_guard<std::mutex> lock(_mutex);
@@ -735,13 +793,10 @@ void MissionImpl::set_current_mission_item_async(int current, Mission::result_ca
 
     int mavlink_index = -1;
     // We need to find the first mavlink item which maps to the current mission item.
-    for (auto it = _mavlink_mission_item_to_mission_item_indices.begin();
-         it != _mavlink_mission_item_to_mission_item_indices.end();
-         ++it) {
-        if (it->second == current) {
-            mavlink_index = it->first;
-            break;
-        }
+    const auto &indices = _mavlink_mission_item_to_mission_item_indices;
+    auto it = std::lower_bound(indices.begin(), indices.end(), current);
+    if (it != indices.end() && *it == current) {
+        mavlink_index = int(it - indices.begin());
     }
 
     // If we coudln't find it, the requested item is out of range and probably an invalid argument.
@@ -770,23 +825,193 @@ void MissionImpl::set_current_mission_item_async(int current, Mission::result_ca
 void MissionImpl::upload_mission_item(uint16_t seq)
 {
     LogDebug() << "Send mission item " << int(seq);
-    if (seq >= _mavlink_mission_item_messages.size()) {
+    if (seq >= num_mavlink_mission_items()) {
         LogErr() << "Mission item requested out of bounds.";
         return;
     }
 
-    _parent->send_message(*_mavlink_mission_item_messages.at(seq));
+    mavlink_message_t message;
+    pack_mission_item(seq, message);
+    _parent->send_message(message);
+
+    report_upload_progress(seq, message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES);
+}
+
+void MissionImpl::pack_mission_item(uint16_t seq, mavlink_message_t &message) const
+{
+    // The target might have changed since the upload was started, and items
+    // from binary files are not trusted to carry the right seq and type.
+    mavlink_mission_item_int_t mavlink_item = mavlink_mission_items()[seq];
+    mavlink_item.target_system = _parent->get_target_system_id();
+    mavlink_item.target_component = _parent->get_target_component_id();
+    mavlink_item.seq = seq;
+    mavlink_item.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_msg_mission_item_int_encode(_parent->get_own_system_id(),
+                                        _parent->get_own_component_id(),
+                                        &message,
+                                        &mavlink_item);
+}
+
+void MissionImpl::reset_upload_progress()
+{
+    _upload_start_time = _parent->get_time().steady_time();
+    _upload_last_report_time = _upload_start_time;
+    _upload_bytes_sent = 0;
+    _upload_items_requested = 0;
+}
+
+bool MissionImpl::send_mission_count()
+{
+    mavlink_message_t message;
+    mavlink_msg_mission_count_pack(_parent->get_own_system_id(),
+                                   _parent->get_own_component_id(),
+                                   &message,
+                                   _parent->get_target_system_id(),
+                                   _parent->get_target_component_id(),
+                                   uint16_t(num_mavlink_mission_items()),
+                                   MAV_MISSION_TYPE_MISSION);
+
+    if (!_parent->send_message(message)) {
+        return false;
+    }
+
+    _upload_bytes_sent += message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    return true;
+}
+
+bool MissionImpl::send_partial_write()
+{
+    const auto &range = _partial_write_ranges.at(_partial_write_range_index);
+
+    mavlink_message_t message;
+    mavlink_msg_mission_write_partial_list_pack(_parent->get_own_system_id(),
+                                                _parent->get_own_component_id(),
+                                                &message,
+                                                _parent->get_target_system_id(),
+                                                _parent->get_target_component_id(),
+                                                int16_t(range.first),
+                                                int16_t(range.second),
+                                                MAV_MISSION_TYPE_MISSION);
+
+    if (!_parent->send_message(message)) {
+        return false;
+    }
+
+    LogDebug() << "Partial mission write " << range.first << " to " << range.second;
+
+    _upload_bytes_sent += message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+    // A device which does not support partial writes might just ignore it.
+    _parent->register_timeout_handler(std::bind(&MissionImpl::process_timeout, this),
+                                      PARTIAL_WRITE_TIMEOUT_S, &_timeout_cookie);
+    return true;
+}
+
+void MissionImpl::process_partial_write_ack(uint8_t type)
+{
+    if (type != MAV_MISSION_ACCEPTED) {
+        LogWarn() << "Partial mission write rejected (" << int(type)
+                  << "), uploading whole mission";
+        fall_back_to_full_upload();
+        return;
+    }
+
+    if (++_partial_write_range_index < _partial_write_ranges.size()) {
+        if (!send_partial_write()) {
+            fall_back_to_full_upload();
+        }
+        return;
+    }
+
+    _partial_write_ranges.clear();
+    _synced_mission_item_hashes.swap(_pending_mission_item_hashes);
+    store_mavlink_mission_items_in_cache();
+
+    const uint64_t full_bytes = full_upload_bytes();
+    _update_bytes_saved = (full_bytes > _upload_bytes_sent) ? full_bytes - _upload_bytes_sent : 0;
+
+    LogInfo() << "Mission updated, saved " << _update_bytes_saved << " bytes";
+
+    _activity = Activity::NONE;
+    report_mission_result(_result_callback, Mission::Result::SUCCESS);
+}
+
+void MissionImpl::fall_back_to_full_upload()
+{
+    _parent->unregister_timeout_handler(_timeout_cookie);
+
+    // Whatever was written partially, we don't know the state anymore.
+    _synced_mission_item_hashes.clear();
+    _mission_cache.remove(_parent->get_target_uuid());
+    _partial_write_ranges.clear();
+
+    if (!send_mission_count()) {
+        _activity = Activity::NONE;
+        report_mission_result(_result_callback, Mission::Result::ERROR);
+    }
+}
+
+uint64_t MissionImpl::full_upload_bytes() const
+{
+    // MISSION_COUNT plus every item. The items are packed to get their real
+    // length because MAVLink 2 truncates trailing zeros.
+    mavlink_message_t message;
+    mavlink_msg_mission_count_pack(_parent->get_own_system_id(),
+                                   _parent->get_own_component_id(),
+                                   &message,
+                                   _parent->get_target_system_id(),
+                                   _parent->get_target_component_id(),
+                                   uint16_t(num_mavlink_mission_items()),
+                                   MAV_MISSION_TYPE_MISSION);
+
+    uint64_t bytes = message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+    for (unsigned seq = 0; seq < num_mavlink_mission_items(); ++seq) {
+        pack_mission_item(uint16_t(seq), message);
+        bytes += message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    }
+    return bytes;
+}
+
+void MissionImpl::compute_mission_item_hashes(const mavlink_mission_item_int_t *mavlink_items,
+                                              size_t num_mavlink_items,
+                                              std::vector<uint32_t> &hashes)
+{
+    hashes.clear();
+    hashes.reserve(num_mavlink_items);
+
+    for (size_t i = 0; i < num_mavlink_items; ++i) {
+        hashes.push_back(MissionCache::hash_mission_item(mavlink_items[i]));
+    }
 }
 
-void MissionImpl::copy_mission_item_vector(const std::vector<std::shared_ptr<MissionItem>>
-                                           &mission_items)
+bool MissionImpl::find_changed_ranges(const std::vector<uint32_t> &hashes)
 {
-    _mission_items.clear();
+    _partial_write_ranges.clear();
+    _partial_write_range_index = 0;
+
+    // A partial write can't change the number of items, and the indices are int16.
+    if (_synced_mission_item_hashes.empty() ||
+        _synced_mission_item_hashes.size() != hashes.size() ||
+        hashes.size() > size_t(INT16_MAX) + 1) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < hashes.size(); ++i) {
+        if (hashes[i] == _synced_mission_item_hashes[i]) {
+            continue;
+        }
 
-    // Copy over the shared_ptr into our own vector.
-    for (auto item : mission_items) {
-        _mission_items.push_back(item);
+        if (!_partial_write_ranges.empty() &&
+            i - _partial_write_ranges.back().second <= PARTIAL_WRITE_MERGE_GAP + 1) {
+            _partial_write_ranges.back().second = uint16_t(i);
+        } else {
+            _partial_write_ranges.push_back(std::make_pair(uint16_t(i), uint16_t(i)));
+        }
     }
+
+    return true;
 }
 
 void MissionImpl::report_mission_result(const Mission::result_callback_t &callback,
@@ -800,9 +1025,9 @@ void MissionImpl::report_mission_result(const Mission::result_callback_t &callba
     callback(result);
 }
 
-void MissionImpl::report_mission_items_and_result(const Mission::mission_items_and_result_callback_t
-                                                  &callback,
-                                                  Mission::Result result)
+void MissionImpl::report_mission_plan_and_result(const Mission::mission_plan_and_result_callback_t
+                                                 &callback,
+                                                 Mission::Result result)
 {
     if (callback == nullptr) {
         LogWarn() << "Callback is not set";
@@ -811,9 +1036,13 @@ void MissionImpl::report_mission_items_and_result(const Mission::mission_items_a
 
     if (result != Mission::Result::SUCCESS) {
         // Don't return garbage, better clear it.
-        _mission_items.clear();
+        _mission_plan.clear();
     }
-    callback(result, _mission_items);
+
+    // Nobody needs the downloaded plan here afterwards, so it is moved out.
+    MissionPlan mission_plan = std::move(_mission_plan);
+    _mission_plan.clear();
+    callback(result, std::move(mission_plan));
 }
 
 void MissionImpl::report_progress()
@@ -822,7 +1051,35 @@ void MissionImpl::report_progress()
         return;
     }
 
-    _progress_callback(current_mission_item(), total_mission_items());
+    _progress_callback(current_mission_item_unlocked(), _num_mission_items);
+}
+
+void MissionImpl::report_upload_progress(uint16_t seq, unsigned bytes_sent)
+{
+    _upload_bytes_sent += bytes_sent;
+    _upload_items_requested = MAX(_upload_items_requested, int(seq) + 1);
+
+    if (_upload_progress_callback == nullptr) {
+        return;
+    }
+
+    const int items_total = int(num_mavlink_mission_items());
+    const bool done = (_upload_items_requested == items_total);
+
+    // Don't flood the user with callbacks for big missions.
+    Time &time = _parent->get_time();
+    if (!done && time.elapsed_since_s(_upload_last_report_time) < UPLOAD_PROGRESS_INTERVAL_S) {
+        return;
+    }
+    _upload_last_report_time = time.steady_time();
+
+    const double elapsed_s = time.elapsed_since_s(_upload_start_time);
+
+    Mission::UploadProgress progress;
+    progress.items_uploaded = _upload_items_requested;
+    progress.items_total = items_total;
+    progress.bytes_per_second = (elapsed_s > 0.0) ? double(_upload_bytes_sent) / elapsed_s : 0.0;
+    _upload_progress_callback(progress);
 }
 
 void MissionImpl::receive_command_result(MavlinkCommands::Result result,
@@ -845,6 +1102,12 @@ void MissionImpl::receive_command_result(MavlinkCommands::Result result,
 }
 
 bool MissionImpl::is_mission_finished() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return is_mission_finished_unlocked();
+}
+
+bool MissionImpl::is_mission_finished_unlocked() const
 {
     if (_last_current_mavlink_mission_item < 0) {
         return false;
@@ -854,7 +1117,7 @@ bool MissionImpl::is_mission_finished() const
         return false;
     }
 
-    if (_mavlink_mission_item_messages.size() == 0) {
+    if (_mavlink_mission_item_to_mission_item_indices.empty()) {
         return false;
     }
 
@@ -862,24 +1125,29 @@ bool MissionImpl::is_mission_finished() const
     // once the last item has been done. Therefore we have to lo decide using
     // "reached" here.
     return (unsigned(_last_reached_mavlink_mission_item + 1)
-            == _mavlink_mission_item_messages.size());
+            == _mavlink_mission_item_to_mission_item_indices.size());
 }
 
 int MissionImpl::current_mission_item() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return current_mission_item_unlocked();
+}
+
+int MissionImpl::current_mission_item_unlocked() const
 {
     // If the mission is finished, let's return the total as the current
     // to signal this.
-    if (is_mission_finished()) {
-        return total_mission_items();
+    if (is_mission_finished_unlocked()) {
+        return _num_mission_items;
     }
 
     // We want to return the current mission item and not the underlying
     // mavlink mission item. Therefore we check the index map.
-    auto entry = _mavlink_mission_item_to_mission_item_indices.find(
-                     _last_current_mavlink_mission_item);
-
-    if (entry != _mavlink_mission_item_to_mission_item_indices.end()) {
-        return entry->second;
+    if (_last_current_mavlink_mission_item >= 0 &&
+        unsigned(_last_current_mavlink_mission_item) <
+        _mavlink_mission_item_to_mission_item_indices.size()) {
+        return _mavlink_mission_item_to_mission_item_indices[_last_current_mavlink_mission_item];
 
     } else {
         // Somehow we couldn't find it in the map
@@ -889,7 +1157,8 @@ int MissionImpl::current_mission_item() const
 
 int MissionImpl::total_mission_items() const
 {
-    return _mission_items.size();
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _num_mission_items;
 }
 
 void MissionImpl::subscribe_progress(Mission::progress_callback_t callback)
@@ -897,13 +1166,53 @@ void MissionImpl::subscribe_progress(Mission::progress_callback_t callback)
     _progress_callback = callback;
 }
 
+void MissionImpl::set_cache_directory(const std::string &directory)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _mission_cache.set_directory(directory);
+}
+
+void MissionImpl::subscribe_upload_progress(Mission::upload_progress_callback_t callback)
+{
+    _upload_progress_callback = callback;
+}
+
 void MissionImpl::process_timeout()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    if (_activity == Activity::SET_MISSION && !_partial_write_ranges.empty()) {
+        LogWarn() << "Partial mission write timed out, uploading whole mission";
+        fall_back_to_full_upload();
+        return;
+    }
+
+    if (_activity == Activity::GET_MISSION) {
+        // Only re-request the items we are missing, as long as we have not given up yet.
+        if (_num_mission_items_to_download > 0 && _download_retries < DOWNLOAD_MAX_RETRIES) {
+            ++_download_retries;
+            LogWarn() << "Mission download timed out, retrying (" << _download_retries << ")";
+
+            // Don't bother with the cache anymore, just download everything.
+            _validating_cache = false;
+
+            request_missing_mission_items();
+            _parent->register_timeout_handler(std::bind(&MissionImpl::process_timeout, this),
+                                              DOWNLOAD_TIMEOUT_S, &_timeout_cookie);
+            return;
+        }
+
+        LogErr() << "Mission handling timed out.";
+        _activity = Activity::NONE;
+        report_mission_plan_and_result(_mission_plan_and_result_callback,
+                                        Mission::Result::TIMEOUT);
+        return;
+    }
+
     LogErr() << "Mission handling timed out.";
 
     if (_activity != Activity::NONE) {
+        release_binary_file();
         report_mission_result(_result_callback, Mission::Result::TIMEOUT);
     }
 }
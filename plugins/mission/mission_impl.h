@@ -1,15 +1,19 @@
 #pragma once
 
 #include <memory>
-#include <map>
 #include <mutex>
+#include <random>
 #include "device_impl.h"
 #include "mission.h"
+#include "mission_cache.h"
+#include "mission_plan.h"
 #include "mavlink_include.h"
 #include "plugin_impl_base.h"
 
 namespace dronecore {
 
+class MissionBinaryFile;
+
 class MissionImpl : public PluginImplBase
 {
 public:
@@ -22,10 +26,15 @@ public:
     void enable() override;
     void disable() override;
 
-    void upload_mission_async(const std::vector<std::shared_ptr<MissionItem>> &mission_items,
-                              const Mission::result_callback_t &callback);
+    void upload_mission_async(MissionPlan mission_plan, const Mission::result_callback_t &callback);
+
+    void upload_mission_file_async(const std::string &path,
+                                   const Mission::result_callback_t &callback);
 
-    void download_mission_async(const Mission::mission_items_and_result_callback_t &callback);
+    void update_mission_async(MissionPlan mission_plan,
+                              const Mission::update_result_callback_t &callback);
+
+    void download_mission_plan_async(const Mission::mission_plan_and_result_callback_t &callback);
 
     void start_mission_async(const Mission::result_callback_t &callback);
     void pause_mission_async(const Mission::result_callback_t &callback);
@@ -38,12 +47,18 @@ public:
     int total_mission_items() const;
 
     void subscribe_progress(Mission::progress_callback_t callback);
+    void subscribe_upload_progress(Mission::upload_progress_callback_t callback);
+
+    void set_cache_directory(const std::string &directory);
 
     // Non-copyable
     MissionImpl(const MissionImpl &) = delete;
     const MissionImpl &operator=(const MissionImpl &) = delete;
 
 private:
+    // Allows the benchmarks to measure internal steps.
+    friend class MissionImplBenchmark;
+
     void process_mission_request(const mavlink_message_t &message);
     void process_mission_request_int(const mavlink_message_t &message);
     void process_mission_ack(const mavlink_message_t &message);
@@ -55,28 +70,57 @@ private:
     void process_timeout();
 
     void upload_mission_item(uint16_t seq);
-
-    void copy_mission_item_vector(const std::vector<std::shared_ptr<MissionItem>> &mission_items);
-
-    void assemble_mavlink_messages();
+    void start_mission_upload(const Mission::result_callback_t &callback);
+    void reset_upload_progress();
+    bool send_mission_count();
+    bool send_partial_write();
+    void process_partial_write_ack(uint8_t type);
+    void fall_back_to_full_upload();
+    uint64_t full_upload_bytes() const;
+
+    static void compute_mission_item_hashes(const mavlink_mission_item_int_t *mavlink_items,
+                                            size_t num_mavlink_items,
+                                            std::vector<uint32_t> &hashes);
+    bool find_changed_ranges(const std::vector<uint32_t> &hashes);
+    void pack_mission_item(uint16_t seq, mavlink_message_t &message) const;
+
+    void assemble_mavlink_mission_items(const MissionPlan &mission_plan);
+    void use_mavlink_mission_items(std::unique_ptr<MissionBinaryFile> binary_file);
+
+    // The items to upload, either assembled or straight from a mapped binary file.
+    const mavlink_mission_item_int_t *mavlink_mission_items() const;
+    size_t num_mavlink_mission_items() const;
+    void release_binary_file();
+    bool too_many_mavlink_mission_items() const;
+    void store_mavlink_mission_items_in_cache();
 
     static void report_mission_result(const Mission::result_callback_t &callback,
                                       Mission::Result result);
 
-    void report_mission_items_and_result(const Mission::mission_items_and_result_callback_t &callback,
-                                         Mission::Result result);
+    void report_mission_plan_and_result(const Mission::mission_plan_and_result_callback_t &callback,
+                                        Mission::Result result);
 
     void report_progress();
 
+    // Same as the public ones but for callers already holding _mutex.
+    bool is_mission_finished_unlocked() const;
+    int current_mission_item_unlocked() const;
+    void report_upload_progress(uint16_t seq, unsigned bytes_sent);
+
     void receive_command_result(MavlinkCommands::Result result,
                                 const Mission::result_callback_t &callback);
 
-    void download_next_mission_item();
+    void request_mission_item(uint16_t seq);
+    void request_missing_mission_items();
+    void request_next_mission_items(int max_requests);
+    void request_spot_checks();
+    void process_spot_check(const mavlink_mission_item_int_t &mission_item_int);
+    void finish_download();
     void assemble_mission_items();
 
-    std::mutex _mutex {};
+    mutable std::mutex _mutex {};
     Mission::result_callback_t _result_callback = nullptr;
-    Mission::mission_items_and_result_callback_t _mission_items_and_result_callback = nullptr;
+    Mission::mission_plan_and_result_callback_t _mission_plan_and_result_callback = nullptr;
 
     enum class Activity {
         NONE,
@@ -89,13 +133,49 @@ private:
     int _last_current_mavlink_mission_item = -1;
     int _last_reached_mavlink_mission_item = -1;
 
-    std::vector<std::shared_ptr<MissionItem>> _mission_items {};
-    std::vector<std::shared_ptr<mavlink_message_t>> _mavlink_mission_item_messages {};
+    // Only used to assemble downloaded missions, it is moved out to the
+    // caller. No upload keeps a copy of the plan it was given.
+    MissionPlan _mission_plan {};
+    int _num_mission_items = 0;
 
-    std::map<int, int> _mavlink_mission_item_to_mission_item_indices {};
+    // The MAVLink items are kept unpacked and only packed into a message when
+    // the device requests them.
+    std::vector<mavlink_mission_item_int_t> _mavlink_mission_items {};
+
+    // Index of the mission item for every MAVLink item, this is sorted. It is
+    // copied out of binary files as well, progress is reported long after
+    // their upload.
+    std::vector<int> _mavlink_mission_item_to_mission_item_indices {};
+
+    // A binary mission file is only mapped while its items are uploaded, they
+    // are served from it instead of _mavlink_mission_items.
+    std::unique_ptr<MissionBinaryFile> _binary_file {};
 
     Mission::progress_callback_t _progress_callback = nullptr;
 
+    Mission::upload_progress_callback_t _upload_progress_callback = nullptr;
+    dl_time_t _upload_start_time {};
+    dl_time_t _upload_last_report_time {};
+    uint64_t _upload_bytes_sent = 0;
+    int _upload_items_requested = 0;
+
+    static constexpr double UPLOAD_PROGRESS_INTERVAL_S = 0.1;
+
+    // Hash of every MAVLink item the device has, as far as we know, from the
+    // last upload or download. Empty if we don't know.
+    std::vector<uint32_t> _synced_mission_item_hashes {};
+    // Hashes of the upload in progress, they become the synced ones once accepted.
+    std::vector<uint32_t> _pending_mission_item_hashes {};
+
+    // Ranges (first and last seq) which are sent using partial writes.
+    std::vector<std::pair<uint16_t, uint16_t>> _partial_write_ranges {};
+    unsigned _partial_write_range_index = 0;
+    uint64_t _update_bytes_saved = 0;
+
+    // Sending a few unchanged items is cheaper than another partial write round trip.
+    static constexpr unsigned PARTIAL_WRITE_MERGE_GAP = 4;
+    static constexpr double PARTIAL_WRITE_TIMEOUT_S = 1.0;
+
     static constexpr uint8_t VEHICLE_MODE_FLAG_CUSTOM_MODE_ENABLED = 1;
 
     // FIXME: these chould potentially change anytime
@@ -105,9 +185,27 @@ private:
     static constexpr uint8_t PX4_CUSTOM_SUB_MODE_AUTO_LOITER = 3;
     static constexpr uint8_t PX4_CUSTOM_SUB_MODE_AUTO_MISSION = 4;
 
+    // The download keeps a window of requests outstanding instead of waiting
+    // for every item before requesting the next one.
     int _num_mission_items_to_download = -1;
+    // The lowest seq which has not been requested yet.
     int _next_mission_item_to_download = -1;
-    std::vector<std::shared_ptr<mavlink_mission_item_int_t>> _mavlink_mission_items_downloaded {};
+    int _num_mission_items_downloaded = 0;
+    unsigned _download_retries = 0;
+    std::vector<mavlink_mission_item_int_t> _mavlink_mission_items_downloaded {};
+    // Set for every seq which has been received.
+    std::vector<bool> _mission_items_received {};
+
+    // The mission last seen on the device, used to skip downloads.
+    MissionCache _mission_cache {};
+    bool _validating_cache = false;
+    std::vector<uint16_t> _spot_check_seqs {};
+    std::minstd_rand _random_engine {};
+
+    static constexpr unsigned NUM_RANDOM_SPOT_CHECKS = 3;
+    static constexpr int DOWNLOAD_WINDOW_SIZE = 8;
+    static constexpr unsigned DOWNLOAD_MAX_RETRIES = 5;
+    static constexpr double DOWNLOAD_TIMEOUT_S = 1.0;
 
     void *_timeout_cookie = nullptr;
 };
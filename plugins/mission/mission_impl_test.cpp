@@ -0,0 +1,184 @@
+#include "mission_impl.h"
+#include "dronecore_impl.h"
+#include "survey_generator.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+// Plays the device side of mission transfers by handing the messages it
+// would send straight to the device.
+class MissionDevice
+{
+public:
+    MissionDevice() :
+        _device_impl(&_dronecore_impl, 1)
+    {
+        _mission_impl.set_parent(&_device_impl);
+        _mission_impl.init();
+
+        // Missions are only cached for devices with a UUID.
+        mavlink_autopilot_version_t autopilot_version {};
+        autopilot_version.capabilities = MAV_PROTOCOL_CAPABILITY_MISSION_INT;
+        autopilot_version.uid = 42;
+        mavlink_message_t message;
+        mavlink_msg_autopilot_version_encode(1, MavlinkCommands::DEFAULT_COMPONENT_ID_AUTOPILOT,
+                                             &message, &autopilot_version);
+        _device_impl.process_mavlink_message(message);
+    }
+
+    ~MissionDevice() { _mission_impl.deinit(); }
+
+    // Returns whether the result was reported right away, without the device
+    // having to request any items.
+    bool upload(MissionPlan mission_plan, Mission::Result &result)
+    {
+        bool done = false;
+        _mission_impl.upload_mission_async(std::move(mission_plan),
+        [&done, &result](Mission::Result callback_result) {
+            done = true;
+            result = callback_result;
+        });
+        return done;
+    }
+
+    // Returns the result, or ERROR if the download did not finish.
+    Mission::Result download(const std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                             MissionPlan &mission_plan)
+    {
+        bool done = false;
+        Mission::Result result = Mission::Result::ERROR;
+        _mission_impl.download_mission_plan_async(
+        [&done, &result, &mission_plan](Mission::Result callback_result, MissionPlan plan) {
+            done = true;
+            result = callback_result;
+            mission_plan = std::move(plan);
+        });
+
+        mavlink_message_t message;
+        mavlink_msg_mission_count_pack(1, 1, &message, 0, 0, uint16_t(mavlink_items.size()),
+                                       MAV_MISSION_TYPE_MISSION);
+        _device_impl.process_mavlink_message(message);
+
+        // Whatever was requested, the device answers with all items.
+        for (const auto &mavlink_item : mavlink_items) {
+            mavlink_msg_mission_item_int_encode(1, 1, &message, &mavlink_item);
+            _device_impl.process_mavlink_message(message);
+        }
+        return done ? result : Mission::Result::ERROR;
+    }
+
+private:
+    DroneCoreImpl _dronecore_impl {};
+    DeviceImpl _device_impl;
+    MissionImpl _mission_impl {};
+};
+
+std::vector<mavlink_mission_item_int_t> make_mavlink_items(unsigned count)
+{
+    std::vector<mavlink_mission_item_int_t> mavlink_items(count);
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_items[i] = mavlink_mission_item_int_t {};
+        mavlink_items[i].seq = uint16_t(i);
+        mavlink_items[i].command = MAV_CMD_NAV_WAYPOINT;
+        mavlink_items[i].frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+        mavlink_items[i].autocontinue = 1;
+        mavlink_items[i].x = int32_t(473977418 + i);
+        mavlink_items[i].y = int32_t(85455939 + i);
+        mavlink_items[i].z = 10.0f;
+        mavlink_items[i].mission_type = MAV_MISSION_TYPE_MISSION;
+    }
+    return mavlink_items;
+}
+
+} // namespace
+
+TEST(MissionImpl, SpotCheckMismatchOnLastItemFinishesDownload)
+{
+    MissionDevice device;
+    MissionPlan mission_plan;
+
+    auto mavlink_items = make_mavlink_items(3);
+    ASSERT_EQ(device.download(mavlink_items, mission_plan), Mission::Result::SUCCESS);
+    ASSERT_EQ(mission_plan.size(), 3u);
+
+    // With this few items, all of them are spot checks of the cached mission,
+    // and the one which differs arrives last.
+    mavlink_items[2].x += 1000;
+    ASSERT_EQ(device.download(mavlink_items, mission_plan), Mission::Result::SUCCESS);
+    ASSERT_EQ(mission_plan.size(), 3u);
+    EXPECT_DOUBLE_EQ(mission_plan.get_latitude_deg(2), mavlink_items[2].x * 1e-7);
+}
+
+TEST(MissionImpl, RejectsMissionsMavlinkCantCount)
+{
+    MissionDevice device;
+    Mission::Result result = Mission::Result::UNKNOWN;
+
+    MissionPlan mission_plan;
+    for (unsigned i = 0; i < 65536; ++i) {
+        mission_plan.add_waypoint(47.3977418 + 1e-5 * double(i % 100),
+                                  8.5455939 + 1e-5 * double(i / 100), 10.0f);
+    }
+    // The count would be sent as 0.
+    ASSERT_TRUE(device.upload(mission_plan, result));
+    EXPECT_EQ(result, Mission::Result::TOO_MANY_MISSION_ITEMS);
+
+    // Every photo is an item of its own.
+    mission_plan.clear();
+    for (unsigned i = 0; i < 40000; ++i) {
+        const size_t index = mission_plan.add_waypoint(47.3977418 + 1e-5 * double(i % 100),
+                                                       8.5455939 + 1e-5 * double(i / 100), 10.0f);
+        mission_plan.set_camera_action(index, MissionItem::CameraAction::TAKE_PHOTO);
+    }
+    ASSERT_TRUE(device.upload(mission_plan, result));
+    EXPECT_EQ(result, Mission::Result::TOO_MANY_MISSION_ITEMS);
+
+    mission_plan.clear();
+    for (unsigned i = 0; i < 65535; ++i) {
+        mission_plan.add_waypoint(47.3977418, 8.5455939 + 1e-5 * double(i), 10.0f);
+    }
+    // Just fits, so the upload starts and waits for the device.
+    EXPECT_FALSE(device.upload(std::move(mission_plan), result));
+}
+
+TEST(MissionImpl, RejectsSurveyMavlinkCantCount)
+{
+    MissionDevice device;
+    Mission::Result result = Mission::Result::UNKNOWN;
+
+    // About 1 km square with a photo every 2 m, about 100k mission items.
+    const SurveyGenerator::Polygon polygon {
+        {47.3900, 8.5400}, {47.3900, 8.5533}, {47.3990, 8.5533}, {47.3990, 8.5400}
+    };
+    SurveyGenerator::Settings settings;
+    settings.line_spacing_m = 5.0f;
+    settings.trigger_distance_m = 2.0f;
+
+    MissionPlan mission_plan;
+    ASSERT_EQ(SurveyGenerator::generate(polygon, settings, mission_plan),
+              SurveyGenerator::Result::SUCCESS);
+    ASSERT_GT(mission_plan.size(), 65535u);
+
+    ASSERT_TRUE(device.upload(std::move(mission_plan), result));
+    EXPECT_EQ(result, Mission::Result::TOO_MANY_MISSION_ITEMS);
+}
+
+TEST(MissionImpl, RejectsSurveyTooBigToGenerate)
+{
+    // The same area with a photo every 0.1 mm would be billions of mission items,
+    // it is refused before anything is allocated.
+    const SurveyGenerator::Polygon polygon {
+        {47.3900, 8.5400}, {47.3900, 8.5533}, {47.3990, 8.5533}, {47.3990, 8.5400}
+    };
+    SurveyGenerator::Settings settings;
+    settings.line_spacing_m = 5.0f;
+    settings.trigger_distance_m = 1e-4f;
+
+    MissionPlan mission_plan;
+    EXPECT_EQ(SurveyGenerator::generate(polygon, settings, mission_plan),
+              SurveyGenerator::Result::INVALID_SETTINGS);
+    EXPECT_TRUE(mission_plan.empty());
+}
@@ -4,6 +4,7 @@ namespace dronecore {
 
 class MissionItemImpl;
 class MissionImpl;
+class MissionPlan;
 
 /**
  * @brief A mission is a vector of `MissionItem`s.
@@ -168,6 +169,12 @@ public:
      */
     friend MissionImpl;
 
+    /**
+     * @private
+     * MissionPlan converts from and to mission items.
+     */
+    friend MissionPlan;
+
     // Non-copyable
     /**
      * @brief Copy constructor (object is not copyable).
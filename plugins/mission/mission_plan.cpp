@@ -0,0 +1,242 @@
+#include "mission_plan.h"
+#include "mission_item_impl.h"
+#include "log.h"
+#include <cmath>
+
+namespace dronecore {
+
+constexpr int32_t MissionPlan::INVALID_POSITION;
+
+namespace {
+
+// Truncates like MissionItemImpl::get_mavlink_x() so that both produce the same MAVLink items.
+int32_t deg_to_e7(double deg)
+{
+    if (!std::isfinite(deg)) {
+        return MissionPlan::INVALID_POSITION;
+    }
+    return int32_t(deg * 1e7);
+}
+
+double e7_to_deg(int32_t e7)
+{
+    if (e7 == MissionPlan::INVALID_POSITION) {
+        return double(NAN);
+    }
+    return double(e7) * 1e-7;
+}
+
+} // namespace
+
+MissionPlan::MissionPlan() {}
+
+MissionPlan::~MissionPlan() {}
+
+MissionPlan MissionPlan::from_mission_items(
+    const std::vector<std::shared_ptr<MissionItem>> &mission_items)
+{
+    MissionPlan mission_plan;
+    mission_plan.reserve(mission_items.size());
+
+    for (const auto &item : mission_items) {
+        const MissionItemImpl &mission_item_impl = *(item->_impl);
+
+        const size_t index = mission_plan.add_item();
+        mission_plan.set_position(index, mission_item_impl.get_latitude_deg(),
+                                  mission_item_impl.get_longitude_deg());
+        mission_plan.set_relative_altitude(index, mission_item_impl.get_relative_altitude_m());
+        mission_plan.set_fly_through(index, mission_item_impl.get_fly_through());
+        mission_plan.set_speed(index, mission_item_impl.get_speed_m_s());
+        mission_plan.set_gimbal_pitch_and_yaw(index, mission_item_impl.get_gimbal_pitch_deg(),
+                                              mission_item_impl.get_gimbal_yaw_deg());
+        mission_plan.set_camera_action_delay(index, mission_item_impl.get_camera_action_delay_s());
+        mission_plan.set_camera_action(index, mission_item_impl.get_camera_action());
+        mission_plan._camera_photo_interval_s[index] =
+            mission_item_impl.get_camera_photo_interval_s();
+    }
+
+    return mission_plan;
+}
+
+std::vector<std::shared_ptr<MissionItem>> MissionPlan::to_mission_items() const
+{
+    std::vector<std::shared_ptr<MissionItem>> mission_items;
+    mission_items.reserve(size());
+
+    for (size_t i = 0; i < size(); ++i) {
+        auto item = std::make_shared<MissionItem>();
+        MissionItemImpl &mission_item_impl = *(item->_impl);
+
+        mission_item_impl.set_position(get_latitude_deg(i), get_longitude_deg(i));
+        mission_item_impl.set_relative_altitude(_relative_altitude_m[i]);
+        mission_item_impl.set_fly_through(get_fly_through(i));
+        mission_item_impl.set_speed(_speed_m_s[i]);
+        mission_item_impl.set_gimbal_pitch_and_yaw(_gimbal_pitch_deg[i], _gimbal_yaw_deg[i]);
+        mission_item_impl.set_camera_action_delay(_camera_action_delay_s[i]);
+        mission_item_impl.set_camera_action(get_camera_action(i));
+        mission_item_impl.set_camera_photo_interval(_camera_photo_interval_s[i]);
+
+        mission_items.push_back(item);
+    }
+
+    return mission_items;
+}
+
+void MissionPlan::reserve(size_t num_items)
+{
+    _latitude_e7.reserve(num_items);
+    _longitude_e7.reserve(num_items);
+    _relative_altitude_m.reserve(num_items);
+    _speed_m_s.reserve(num_items);
+    _gimbal_pitch_deg.reserve(num_items);
+    _gimbal_yaw_deg.reserve(num_items);
+    _camera_action_delay_s.reserve(num_items);
+    _camera_photo_interval_s.reserve(num_items);
+    _fly_through.reserve(num_items);
+    _camera_action.reserve(num_items);
+}
+
+void MissionPlan::clear()
+{
+    _latitude_e7.clear();
+    _longitude_e7.clear();
+    _relative_altitude_m.clear();
+    _speed_m_s.clear();
+    _gimbal_pitch_deg.clear();
+    _gimbal_yaw_deg.clear();
+    _camera_action_delay_s.clear();
+    _camera_photo_interval_s.clear();
+    _fly_through.clear();
+    _camera_action.clear();
+}
+
+size_t MissionPlan::add_item()
+{
+    // Same defaults as MissionItemImpl.
+    _latitude_e7.push_back(INVALID_POSITION);
+    _longitude_e7.push_back(INVALID_POSITION);
+    _relative_altitude_m.push_back(NAN);
+    _speed_m_s.push_back(NAN);
+    _gimbal_pitch_deg.push_back(NAN);
+    _gimbal_yaw_deg.push_back(NAN);
+    _camera_action_delay_s.push_back(NAN);
+    _camera_photo_interval_s.push_back(1.0);
+    _fly_through.push_back(0);
+    _camera_action.push_back(uint8_t(MissionItem::CameraAction::NONE));
+
+    return _latitude_e7.size() - 1;
+}
+
+void MissionPlan::resize(size_t num_items)
+{
+    // Same defaults as add_item().
+    _latitude_e7.resize(num_items, INVALID_POSITION);
+    _longitude_e7.resize(num_items, INVALID_POSITION);
+    _relative_altitude_m.resize(num_items, NAN);
+    _speed_m_s.resize(num_items, NAN);
+    _gimbal_pitch_deg.resize(num_items, NAN);
+    _gimbal_yaw_deg.resize(num_items, NAN);
+    _camera_action_delay_s.resize(num_items, NAN);
+    _camera_photo_interval_s.resize(num_items, 1.0);
+    _fly_through.resize(num_items, 0);
+    _camera_action.resize(num_items, uint8_t(MissionItem::CameraAction::NONE));
+}
+
+size_t MissionPlan::add_waypoint(double latitude_deg, double longitude_deg,
+                                 float relative_altitude_m)
+{
+    const size_t index = add_item();
+    set_position(index, latitude_deg, longitude_deg);
+    set_relative_altitude(index, relative_altitude_m);
+    return index;
+}
+
+void MissionPlan::set_position(size_t index, double latitude_deg, double longitude_deg)
+{
+    _latitude_e7[index] = deg_to_e7(latitude_deg);
+    _longitude_e7[index] = deg_to_e7(longitude_deg);
+}
+
+void MissionPlan::set_position_e7(size_t index, int32_t latitude_e7, int32_t longitude_e7)
+{
+    _latitude_e7[index] = latitude_e7;
+    _longitude_e7[index] = longitude_e7;
+}
+
+void MissionPlan::set_relative_altitude(size_t index, float altitude_m)
+{
+    _relative_altitude_m[index] = altitude_m;
+}
+
+void MissionPlan::set_fly_through(size_t index, bool fly_through)
+{
+    _fly_through[index] = fly_through ? 1 : 0;
+}
+
+void MissionPlan::set_speed(size_t index, float speed_m_s)
+{
+    _speed_m_s[index] = speed_m_s;
+}
+
+void MissionPlan::set_gimbal_pitch_and_yaw(size_t index, float pitch_deg, float yaw_deg)
+{
+    _gimbal_pitch_deg[index] = pitch_deg;
+    _gimbal_yaw_deg[index] = yaw_deg;
+}
+
+void MissionPlan::set_camera_action_delay(size_t index, float delay_s)
+{
+    _camera_action_delay_s[index] = delay_s;
+}
+
+void MissionPlan::set_camera_action(size_t index, MissionItem::CameraAction action)
+{
+    _camera_action[index] = uint8_t(action);
+}
+
+void MissionPlan::set_camera_photo_interval(size_t index, double interval_s)
+{
+    if (interval_s > 0.0) {
+        _camera_photo_interval_s[index] = interval_s;
+    } else {
+        LogWarn() << "Invalid interval argument";
+    }
+}
+
+bool MissionPlan::has_position(size_t index) const
+{
+    return _latitude_e7[index] != INVALID_POSITION
+           && _longitude_e7[index] != INVALID_POSITION
+           && std::isfinite(_relative_altitude_m[index]);
+}
+
+double MissionPlan::get_latitude_deg(size_t index) const
+{
+    return e7_to_deg(_latitude_e7[index]);
+}
+
+double MissionPlan::get_longitude_deg(size_t index) const
+{
+    return e7_to_deg(_longitude_e7[index]);
+}
+
+MissionItem::CameraAction MissionPlan::get_camera_action(size_t index) const
+{
+    return static_cast<MissionItem::CameraAction>(_camera_action[index]);
+}
+
+size_t MissionPlan::memory_usage_bytes() const
+{
+    return _latitude_e7.capacity() * sizeof(int32_t)
+           + _longitude_e7.capacity() * sizeof(int32_t)
+           + _relative_altitude_m.capacity() * sizeof(float)
+           + _speed_m_s.capacity() * sizeof(float)
+           + _gimbal_pitch_deg.capacity() * sizeof(float)
+           + _gimbal_yaw_deg.capacity() * sizeof(float)
+           + _camera_action_delay_s.capacity() * sizeof(float)
+           + _camera_photo_interval_s.capacity() * sizeof(double)
+           + _fly_through.capacity() * sizeof(uint8_t)
+           + _camera_action.capacity() * sizeof(uint8_t);
+}
+
+} // namespace dronecore
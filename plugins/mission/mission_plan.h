@@ -0,0 +1,266 @@
+#pragma once
+
+#include "mission_item.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dronecore {
+
+/**
+ * @brief A whole mission stored as a compact value type.
+ *
+ * Unlike a vector of `MissionItem`s, a %MissionPlan keeps every property of the mission items
+ * in its own column (structure of arrays). Building a plan of many thousand items therefore
+ * only needs a handful of allocations, and the plan can be moved into
+ * `Mission::upload_mission_async()` and out of `Mission::download_mission_plan_async()`
+ * without copying any item.
+ *
+ * The items are addressed by their index. All setters and getters behave like the ones of
+ * `MissionItem`, positions are stored with a resolution of 1e-7 degrees.
+ */
+class MissionPlan
+{
+public:
+    /**
+     * @brief Constructor for an empty plan.
+     */
+    MissionPlan();
+
+    /**
+     * @brief Destructor.
+     */
+    ~MissionPlan();
+
+    /**
+     * @brief Copy constructor.
+     */
+    MissionPlan(const MissionPlan &) = default;
+
+    /**
+     * @brief Move constructor.
+     */
+    MissionPlan(MissionPlan &&) = default;
+
+    /**
+     * @brief Copy assignment.
+     */
+    MissionPlan &operator=(const MissionPlan &) = default;
+
+    /**
+     * @brief Move assignment.
+     */
+    MissionPlan &operator=(MissionPlan &&) = default;
+
+    /**
+     * @brief Creates a plan from a vector of mission items.
+     *
+     * @param mission_items Mission items to convert.
+     * @return Plan with the same content.
+     */
+    static MissionPlan from_mission_items(
+        const std::vector<std::shared_ptr<MissionItem>> &mission_items);
+
+    /**
+     * @brief Creates a vector of mission items from this plan.
+     *
+     * @return Mission items with the same content.
+     */
+    std::vector<std::shared_ptr<MissionItem>> to_mission_items() const;
+
+    /**
+     * @brief Get the number of mission items.
+     *
+     * @return Number of mission items in the plan.
+     */
+    size_t size() const { return _latitude_e7.size(); }
+
+    /**
+     * @brief Check if the plan contains no mission items.
+     *
+     * @return true if there are no mission items.
+     */
+    bool empty() const { return _latitude_e7.empty(); }
+
+    /**
+     * @brief Reserve memory for a number of mission items.
+     *
+     * @param num_items Number of mission items to reserve memory for.
+     */
+    void reserve(size_t num_items);
+
+    /**
+     * @brief Remove all mission items.
+     */
+    void clear();
+
+    /**
+     * @brief Append a mission item without position or actions.
+     *
+     * @return Index of the new mission item.
+     */
+    size_t add_item();
+
+    /**
+     * @brief Resize the plan, new mission items have no position or actions.
+     *
+     * @param num_items New number of mission items.
+     */
+    void resize(size_t num_items);
+
+    /**
+     * @brief Append a waypoint.
+     *
+     * @param latitude_deg Latitude of the waypoint in degrees.
+     * @param longitude_deg Longitude of the waypoint in degrees.
+     * @param relative_altitude_m Altitude relative to takeoff position in metres.
+     * @return Index of the new mission item.
+     */
+    size_t add_waypoint(double latitude_deg, double longitude_deg, float relative_altitude_m);
+
+    /**
+     * @brief Set the position of a mission item, see MissionItem::set_position().
+     */
+    void set_position(size_t index, double latitude_deg, double longitude_deg);
+
+    /**
+     * @brief Set the position of a mission item in 1e-7 degrees as used by MAVLink.
+     */
+    void set_position_e7(size_t index, int32_t latitude_e7, int32_t longitude_e7);
+
+    /**
+     * @brief Set the relative altitude, see MissionItem::set_relative_altitude().
+     */
+    void set_relative_altitude(size_t index, float altitude_m);
+
+    /**
+     * @brief Set the fly-through property, see MissionItem::set_fly_through().
+     */
+    void set_fly_through(size_t index, bool fly_through);
+
+    /**
+     * @brief Set the speed to use after a mission item, see MissionItem::set_speed().
+     */
+    void set_speed(size_t index, float speed_m_s);
+
+    /**
+     * @brief Set the gimbal angles, see MissionItem::set_gimbal_pitch_and_yaw().
+     */
+    void set_gimbal_pitch_and_yaw(size_t index, float pitch_deg, float yaw_deg);
+
+    /**
+     * @brief Set a delay before the camera action, see MissionItem::set_camera_action_delay().
+     */
+    void set_camera_action_delay(size_t index, float delay_s);
+
+    /**
+     * @brief Set the camera action, see MissionItem::set_camera_action().
+     */
+    void set_camera_action(size_t index, MissionItem::CameraAction action);
+
+    /**
+     * @brief Set the camera photo interval, see MissionItem::set_camera_photo_interval().
+     */
+    void set_camera_photo_interval(size_t index, double interval_s);
+
+    /**
+     * @brief Check if a mission item has a complete position (latitude, longitude and altitude).
+     */
+    bool has_position(size_t index) const;
+
+    /**
+     * @brief Get the latitude in degrees, NaN if not set.
+     */
+    double get_latitude_deg(size_t index) const;
+
+    /**
+     * @brief Get the longitude in degrees, NaN if not set.
+     */
+    double get_longitude_deg(size_t index) const;
+
+    /**
+     * @brief Get the relative altitude in metres.
+     */
+    float get_relative_altitude_m(size_t index) const { return _relative_altitude_m[index]; }
+
+    /**
+     * @brief Get the fly-through property.
+     */
+    bool get_fly_through(size_t index) const { return _fly_through[index] != 0; }
+
+    /**
+     * @brief Get the speed in metres/second.
+     */
+    float get_speed_m_s(size_t index) const { return _speed_m_s[index]; }
+
+    /**
+     * @brief Get the gimbal pitch angle in degrees.
+     */
+    float get_gimbal_pitch_deg(size_t index) const { return _gimbal_pitch_deg[index]; }
+
+    /**
+     * @brief Get the gimbal yaw angle in degrees.
+     */
+    float get_gimbal_yaw_deg(size_t index) const { return _gimbal_yaw_deg[index]; }
+
+    /**
+     * @brief Get the delay before the camera action in seconds.
+     */
+    float get_camera_action_delay_s(size_t index) const { return _camera_action_delay_s[index]; }
+
+    /**
+     * @brief Get the camera action.
+     */
+    MissionItem::CameraAction get_camera_action(size_t index) const;
+
+    /**
+     * @brief Get the camera photo interval in seconds.
+     */
+    double get_camera_photo_interval_s(size_t index) const
+    {
+        return _camera_photo_interval_s[index];
+    }
+
+    /**
+     * @brief Latitudes of all mission items in 1e-7 degrees, `INVALID_POSITION` if not set.
+     */
+    const std::vector<int32_t> &latitudes_e7() const { return _latitude_e7; }
+
+    /**
+     * @brief Longitudes of all mission items in 1e-7 degrees, `INVALID_POSITION` if not set.
+     */
+    const std::vector<int32_t> &longitudes_e7() const { return _longitude_e7; }
+
+    /**
+     * @brief Relative altitudes of all mission items in metres.
+     */
+    const std::vector<float> &relative_altitudes_m() const { return _relative_altitude_m; }
+
+    /**
+     * @brief Approximate number of bytes allocated for the mission items.
+     */
+    size_t memory_usage_bytes() const;
+
+    /**
+     * @brief Marks a latitude or longitude which is not set.
+     */
+    static constexpr int32_t INVALID_POSITION = INT32_MAX;
+
+private:
+    // The survey generator fills the columns directly.
+    friend class SurveyGenerator;
+
+    std::vector<int32_t> _latitude_e7 {};
+    std::vector<int32_t> _longitude_e7 {};
+    std::vector<float> _relative_altitude_m {};
+    std::vector<float> _speed_m_s {};
+    std::vector<float> _gimbal_pitch_deg {};
+    std::vector<float> _gimbal_yaw_deg {};
+    std::vector<float> _camera_action_delay_s {};
+    std::vector<double> _camera_photo_interval_s {};
+    std::vector<uint8_t> _fly_through {};
+    std::vector<uint8_t> _camera_action {};
+};
+
+} // namespace dronecore
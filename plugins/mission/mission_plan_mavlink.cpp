@@ -0,0 +1,310 @@
+#include "mission_plan_mavlink.h"
+#include "global_include.h"
+#include "log.h"
+#include <cmath>
+
+namespace dronecore {
+
+constexpr size_t MavlinkMissionItemsBuilder::MAX_MAVLINK_ITEMS;
+
+void MavlinkMissionItemsBuilder::build(const MissionPlan &mission_plan,
+                                       std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                                       std::vector<int> &mission_item_indices)
+{
+    mavlink_items.clear();
+    mission_item_indices.clear();
+
+    // Most mission items are just a waypoint, the rest grows on demand.
+    mavlink_items.reserve(mission_plan.size());
+    mission_item_indices.reserve(mission_plan.size());
+
+    bool last_position_valid = false; // This flag is to protect us from using an invalid x/y.
+    MAV_FRAME last_frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+    int32_t last_x = 0;
+    int32_t last_y = 0;
+    float last_z = 0.0f;
+
+    const std::vector<int32_t> &latitudes_e7 = mission_plan.latitudes_e7();
+    const std::vector<int32_t> &longitudes_e7 = mission_plan.longitudes_e7();
+    const std::vector<float> &relative_altitudes_m = mission_plan.relative_altitudes_m();
+
+    for (size_t i = 0; i < mission_plan.size(); ++i) {
+
+        const int item_i = int(i);
+
+        if (mission_plan.has_position(i)) {
+            const bool fly_through = mission_plan.get_fly_through(i);
+
+            add(mavlink_items, mission_item_indices, item_i,
+                MAV_FRAME_GLOBAL_RELATIVE_ALT_INT,
+                MAV_CMD_NAV_WAYPOINT,
+                1, // autocontinue
+                fly_through ? 0.0f : 0.5f, // hold time in seconds
+                fly_through ? 3.0f : 1.0f, // acceptance radius in meters
+                0.0f, // pass radius
+                0.0f, // yaw angle
+                latitudes_e7[i],
+                longitudes_e7[i],
+                relative_altitudes_m[i]);
+
+            last_position_valid = true; // because we checked has_position
+            last_x = latitudes_e7[i];
+            last_y = longitudes_e7[i];
+            last_z = relative_altitudes_m[i];
+            last_frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+        }
+
+        if (std::isfinite(mission_plan.get_speed_m_s(i))) {
+
+            // The speed has changed, we need to add a speed command.
+            add(mavlink_items, mission_item_indices, item_i,
+                MAV_FRAME_MISSION,
+                MAV_CMD_DO_CHANGE_SPEED,
+                1, // autocontinue
+                1.0f, // ground speed
+                mission_plan.get_speed_m_s(i),
+                -1.0f, // no throttle change
+                0.0f, // absolute
+                0,
+                0,
+                NAN);
+        }
+
+        if (std::isfinite(mission_plan.get_gimbal_yaw_deg(i)) ||
+            std::isfinite(mission_plan.get_gimbal_pitch_deg(i))) {
+            // The gimbal has changed, we need to add a gimbal command.
+            add(mavlink_items, mission_item_indices, item_i,
+                MAV_FRAME_MISSION,
+                MAV_CMD_DO_MOUNT_CONTROL,
+                1, // autocontinue
+                mission_plan.get_gimbal_pitch_deg(i), // pitch
+                0.0f, // roll (yes it is a weird order)
+                mission_plan.get_gimbal_yaw_deg(i), // yaw
+                NAN,
+                0,
+                0,
+                MAV_MOUNT_MODE_MAVLINK_TARGETING);
+        }
+
+        // FIXME: It is a bit of a hack to set a LOITER_TIME waypoint to add a delay.
+        //        A better solution would be to properly use NAV_DELAY instead. This
+        //        would not require us to keep the last lat/lon.
+        if (std::isfinite(mission_plan.get_camera_action_delay_s(i))) {
+            if (!last_position_valid) {
+                // In the case where we get a delay without a previous position, we will have to
+                // ignore it.
+                LogErr() << "Can't set camera action delay without previous position set.";
+
+            } else {
+                add(mavlink_items, mission_item_indices, item_i,
+                    last_frame,
+                    MAV_CMD_NAV_LOITER_TIME,
+                    1, // autocontinue
+                    mission_plan.get_camera_action_delay_s(i), // loiter time in seconds
+                    NAN, // empty
+                    0.0f, // radius around waypoint in meters ?
+                    0.0f, // loiter at center of waypoint
+                    last_x,
+                    last_y,
+                    last_z);
+            }
+        }
+
+        if (mission_plan.get_camera_action(i) != MissionItem::CameraAction::NONE) {
+            // There is a camera action that we need to send.
+
+            uint16_t cmd = 0;
+            float param1 = NAN;
+            float param2 = NAN;
+            float param3 = NAN;
+            switch (mission_plan.get_camera_action(i)) {
+                case MissionItem::CameraAction::TAKE_PHOTO:
+                    cmd = MAV_CMD_IMAGE_START_CAPTURE;
+                    param1 = 0.0f; // all camera IDs
+                    param2 = 0.0f; // no duration, take only one picture
+                    param3 = 1.0f; // only take one picture
+                    break;
+                case MissionItem::CameraAction::START_PHOTO_INTERVAL:
+                    cmd = MAV_CMD_IMAGE_START_CAPTURE;
+                    param1 = 0.0f; // all camera IDs
+                    param2 = float(mission_plan.get_camera_photo_interval_s(i));
+                    param3 = 0.0f; // unlimited photos
+                    break;
+                case MissionItem::CameraAction::STOP_PHOTO_INTERVAL:
+                    cmd = MAV_CMD_IMAGE_STOP_CAPTURE;
+                    param1 = 0.0f; // all camera IDs
+                    break;
+                case MissionItem::CameraAction::START_VIDEO:
+                    cmd = MAV_CMD_VIDEO_START_CAPTURE;
+                    param1 = 0.0f; // all camera IDs
+                    break;
+                case MissionItem::CameraAction::STOP_VIDEO:
+                    cmd = MAV_CMD_VIDEO_STOP_CAPTURE;
+                    param1 = 0.0f; // all camera IDs
+                    break;
+                default:
+                    LogErr() << "Error: camera action not supported";
+                    break;
+            }
+
+            add(mavlink_items, mission_item_indices, item_i,
+                MAV_FRAME_MISSION,
+                cmd,
+                1, // autocontinue
+                param1,
+                param2,
+                param3,
+                NAN,
+                0,
+                0,
+                NAN);
+        }
+    }
+}
+
+void MavlinkMissionItemsBuilder::add(std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                                     std::vector<int> &mission_item_indices,
+                                     int mission_item_index, uint8_t frame, uint16_t command,
+                                     uint8_t autocontinue, float param1, float param2,
+                                     float param3, float param4, int32_t x, int32_t y, float z)
+{
+    mavlink_mission_item_int_t mavlink_item {};
+    mavlink_item.seq = uint16_t(mavlink_items.size());
+    mavlink_item.frame = frame;
+    mavlink_item.command = command;
+    // Current is the 0th waypoint
+    mavlink_item.current = ((mavlink_items.size() == 0) ? 1 : 0);
+    mavlink_item.autocontinue = autocontinue;
+    mavlink_item.param1 = param1;
+    mavlink_item.param2 = param2;
+    mavlink_item.param3 = param3;
+    mavlink_item.param4 = param4;
+    mavlink_item.x = x;
+    mavlink_item.y = y;
+    mavlink_item.z = z;
+    mavlink_item.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_items.push_back(mavlink_item);
+    mission_item_indices.push_back(mission_item_index);
+}
+
+MissionPlanBuilder::MissionPlanBuilder(MissionPlan &mission_plan, bool skip_unsupported) :
+    _mission_plan(mission_plan),
+    _skip_unsupported(skip_unsupported)
+{
+    _mission_plan.clear();
+}
+
+MissionPlanBuilder::~MissionPlanBuilder() {}
+
+Mission::Result MissionPlanBuilder::add(const mavlink_mission_item_int_t &mavlink_item)
+{
+    if (_result != Mission::Result::SUCCESS) {
+        return _result;
+    }
+
+    Mission::Result result = Mission::Result::SUCCESS;
+
+    // The first mission item needs to be a waypoint with position.
+    if (_mission_plan.empty() && mavlink_item.command != MAV_CMD_NAV_WAYPOINT) {
+        LogErr() << "First mission item is not a waypoint";
+        result = Mission::Result::UNSUPPORTED;
+    } else {
+        result = add_to_current(mavlink_item);
+    }
+
+    // Nothing was changed for an unsupported item, so the plan stays valid without it.
+    if (result == Mission::Result::UNSUPPORTED && _skip_unsupported) {
+        return result;
+    }
+
+    _result = result;
+    return _result;
+}
+
+Mission::Result MissionPlanBuilder::add_to_current(const mavlink_mission_item_int_t &mavlink_item)
+{
+    if (mavlink_item.command == MAV_CMD_NAV_WAYPOINT) {
+        if (mavlink_item.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
+            LogErr() << "Waypoint frame not supported unsupported";
+            return Mission::Result::UNSUPPORTED;
+        }
+
+        if (_mission_plan.empty() || _have_set_position) {
+            // When a new position comes in, create next mission item.
+            _index = _mission_plan.add_item();
+            _have_set_position = false;
+        }
+
+        _mission_plan.set_position_e7(_index, mavlink_item.x, mavlink_item.y);
+        _mission_plan.set_relative_altitude(_index, mavlink_item.z);
+
+        _mission_plan.set_fly_through(_index, !(mavlink_item.param1 > 0));
+
+        _have_set_position = true;
+
+    } else if (mavlink_item.command == MAV_CMD_DO_MOUNT_CONTROL) {
+        if (int(mavlink_item.z) != MAV_MOUNT_MODE_MAVLINK_TARGETING) {
+            LogErr() << "Gimbal mount mode unsupported";
+            return Mission::Result::UNSUPPORTED;
+        }
+
+        _mission_plan.set_gimbal_pitch_and_yaw(_index, mavlink_item.param1, mavlink_item.param3);
+
+    } else if (mavlink_item.command == MAV_CMD_IMAGE_START_CAPTURE) {
+        if (mavlink_item.param2 > 0 && int(mavlink_item.param3) == 0) {
+            _mission_plan.set_camera_action(_index,
+                                            MissionItem::CameraAction::START_PHOTO_INTERVAL);
+            _mission_plan.set_camera_photo_interval(_index, double(mavlink_item.param2));
+        } else if (int(mavlink_item.param2) == 0 && int(mavlink_item.param3) == 1) {
+            _mission_plan.set_camera_action(_index, MissionItem::CameraAction::TAKE_PHOTO);
+        } else {
+            LogErr() << "Mission item START_CAPTURE params unsupported.";
+            return Mission::Result::UNSUPPORTED;
+        }
+
+    } else if (mavlink_item.command == MAV_CMD_IMAGE_STOP_CAPTURE) {
+        _mission_plan.set_camera_action(_index, MissionItem::CameraAction::STOP_PHOTO_INTERVAL);
+
+    } else if (mavlink_item.command == MAV_CMD_VIDEO_START_CAPTURE) {
+        _mission_plan.set_camera_action(_index, MissionItem::CameraAction::START_VIDEO);
+
+    } else if (mavlink_item.command == MAV_CMD_VIDEO_STOP_CAPTURE) {
+        _mission_plan.set_camera_action(_index, MissionItem::CameraAction::STOP_VIDEO);
+
+    } else if (mavlink_item.command == MAV_CMD_DO_CHANGE_SPEED) {
+        if (int(mavlink_item.param1) == 1 && mavlink_item.param3 < 0 &&
+            int(mavlink_item.param4) == 0) {
+            _mission_plan.set_speed(_index, mavlink_item.param2);
+        } else {
+            LogErr() << "Mission item DO_CHANGE_SPEED params unsupported";
+            return Mission::Result::UNSUPPORTED;
+        }
+
+    } else if (mavlink_item.command == MAV_CMD_NAV_LOITER_TIME) {
+        _mission_plan.set_camera_action_delay(_index, mavlink_item.param1);
+
+    } else {
+        LogErr() << "UNSUPPORTED mission item command (" << mavlink_item.command << ")";
+        return Mission::Result::UNSUPPORTED;
+    }
+
+    return Mission::Result::SUCCESS;
+}
+
+Mission::Result MissionPlanBuilder::finish()
+{
+    if (_result == Mission::Result::SUCCESS && _mission_plan.empty()) {
+        LogErr() << "No mission items";
+        _result = Mission::Result::NO_MISSION_AVAILABLE;
+    }
+
+    if (_result != Mission::Result::SUCCESS) {
+        // Don't return garbage, better clear it.
+        _mission_plan.clear();
+    }
+
+    return _result;
+}
+
+} // namespace dronecore
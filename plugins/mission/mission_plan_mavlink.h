@@ -0,0 +1,64 @@
+#pragma once
+
+#include "mission.h"
+#include "mission_plan.h"
+#include "mavlink_include.h"
+#include <vector>
+
+namespace dronecore {
+
+// Unpacks a MissionPlan into the MAVLink mission items which represent it.
+class MavlinkMissionItemsBuilder
+{
+public:
+    // MISSION_COUNT and seq are 16 bit, missions with more items can't be uploaded.
+    static constexpr size_t MAX_MAVLINK_ITEMS = 65535;
+
+    // Replaces mavlink_items with the items of the plan. For every MAVLink item
+    // the index of the mission item it belongs to is put into mission_item_indices,
+    // which is therefore sorted.
+    static void build(const MissionPlan &mission_plan,
+                      std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                      std::vector<int> &mission_item_indices);
+
+private:
+    static void add(std::vector<mavlink_mission_item_int_t> &mavlink_items,
+                    std::vector<int> &mission_item_indices, int mission_item_index,
+                    uint8_t frame, uint16_t command, uint8_t autocontinue, float param1,
+                    float param2, float param3, float param4, int32_t x, int32_t y, float z);
+};
+
+// Builds a MissionPlan from MAVLink mission items, one item at a time, so
+// neither downloads nor file loaders need to keep all items around.
+class MissionPlanBuilder
+{
+public:
+    // The plan is cleared and then filled by add(). With skip_unsupported, items
+    // which can't be represented are left out instead of failing the whole plan.
+    explicit MissionPlanBuilder(MissionPlan &mission_plan, bool skip_unsupported = false);
+    ~MissionPlanBuilder();
+
+    // delete copy and move constructors and assign operators
+    MissionPlanBuilder(MissionPlanBuilder const &) = delete;            // Copy construct
+    MissionPlanBuilder(MissionPlanBuilder &&) = delete;                 // Move construct
+    MissionPlanBuilder &operator=(MissionPlanBuilder const &) = delete; // Copy assign
+    MissionPlanBuilder &operator=(MissionPlanBuilder &&) = delete;      // Move assign
+
+    // Returns UNSUPPORTED if the item can't be represented. Unless unsupported
+    // items are skipped, all further items are then ignored.
+    Mission::Result add(const mavlink_mission_item_int_t &mavlink_item);
+
+    // Clears the plan unless all items were added successfully.
+    Mission::Result finish();
+
+private:
+    Mission::Result add_to_current(const mavlink_mission_item_int_t &mavlink_item);
+
+    MissionPlan &_mission_plan;
+    const bool _skip_unsupported;
+    Mission::Result _result = Mission::Result::SUCCESS;
+    size_t _index = 0;
+    bool _have_set_position = false;
+};
+
+} // namespace dronecore
@@ -0,0 +1,80 @@
+#include "mission_plan.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace dronecore;
+
+TEST(MissionPlan, Defaults)
+{
+    MissionPlan mission_plan;
+    EXPECT_TRUE(mission_plan.empty());
+
+    const size_t index = mission_plan.add_item();
+    EXPECT_EQ(index, 0u);
+    EXPECT_EQ(mission_plan.size(), 1u);
+    EXPECT_FALSE(mission_plan.has_position(index));
+    EXPECT_TRUE(std::isnan(mission_plan.get_latitude_deg(index)));
+    EXPECT_TRUE(std::isnan(mission_plan.get_speed_m_s(index)));
+    EXPECT_FALSE(mission_plan.get_fly_through(index));
+    EXPECT_EQ(mission_plan.get_camera_action(index), MissionItem::CameraAction::NONE);
+    EXPECT_DOUBLE_EQ(mission_plan.get_camera_photo_interval_s(index), 1.0);
+
+    mission_plan.set_position(index, 47.3977418, 8.5455939);
+    EXPECT_FALSE(mission_plan.has_position(index));
+    mission_plan.set_relative_altitude(index, 10.0f);
+    EXPECT_TRUE(mission_plan.has_position(index));
+    EXPECT_EQ(mission_plan.latitudes_e7()[index], 473977418);
+}
+
+TEST(MissionPlan, ConvertsFromAndToMissionItems)
+{
+    std::vector<std::shared_ptr<MissionItem>> mission_items;
+
+    auto first_item = std::make_shared<MissionItem>();
+    first_item->set_position(47.3977418, 8.5455939);
+    first_item->set_relative_altitude(10.0f);
+    first_item->set_speed(5.0f);
+    first_item->set_fly_through(true);
+    mission_items.push_back(first_item);
+
+    auto second_item = std::make_shared<MissionItem>();
+    second_item->set_gimbal_pitch_and_yaw(-90.0f, 45.0f);
+    second_item->set_camera_action_delay(2.0f);
+    second_item->set_camera_action(MissionItem::CameraAction::START_PHOTO_INTERVAL);
+    second_item->set_camera_photo_interval(0.5);
+    mission_items.push_back(second_item);
+
+    MissionPlan mission_plan = MissionPlan::from_mission_items(mission_items);
+    ASSERT_EQ(mission_plan.size(), 2u);
+    EXPECT_TRUE(mission_plan.has_position(0));
+    EXPECT_FALSE(mission_plan.has_position(1));
+    EXPECT_FLOAT_EQ(mission_plan.get_gimbal_pitch_deg(1), -90.0f);
+    EXPECT_FLOAT_EQ(mission_plan.get_gimbal_yaw_deg(1), 45.0f);
+
+    auto converted_items = mission_plan.to_mission_items();
+    ASSERT_EQ(converted_items.size(), 2u);
+    EXPECT_NEAR(converted_items[0]->get_latitude_deg(), 47.3977418, 1e-7);
+    EXPECT_NEAR(converted_items[0]->get_longitude_deg(), 8.5455939, 1e-7);
+    EXPECT_FLOAT_EQ(converted_items[0]->get_relative_altitude_m(), 10.0f);
+    EXPECT_FLOAT_EQ(converted_items[0]->get_speed_m_s(), 5.0f);
+    EXPECT_TRUE(converted_items[0]->get_fly_through());
+    EXPECT_TRUE(std::isnan(converted_items[1]->get_latitude_deg()));
+    EXPECT_FLOAT_EQ(converted_items[1]->get_camera_action_delay_s(), 2.0f);
+    EXPECT_EQ(converted_items[1]->get_camera_action(),
+              MissionItem::CameraAction::START_PHOTO_INTERVAL);
+    EXPECT_DOUBLE_EQ(converted_items[1]->get_camera_photo_interval_s(), 0.5);
+}
+
+TEST(MissionPlan, MovesWithoutCopying)
+{
+    MissionPlan mission_plan;
+    for (unsigned i = 0; i < 1000; ++i) {
+        mission_plan.add_waypoint(47.0 + 1e-5 * double(i), 8.0, 10.0f);
+    }
+
+    const int32_t *latitudes = mission_plan.latitudes_e7().data();
+
+    MissionPlan moved_plan(std::move(mission_plan));
+    EXPECT_EQ(moved_plan.size(), 1000u);
+    EXPECT_EQ(moved_plan.latitudes_e7().data(), latitudes);
+}
@@ -0,0 +1,345 @@
+#include "survey_generator.h"
+#include "geodesy.h"
+#include "global_include.h"
+#include "log.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace dronecore {
+
+namespace {
+
+// Metres per degree of latitude on a sphere with the mean earth radius.
+constexpr double METRES_PER_DEGREE = MEAN_EARTH_RADIUS_M * M_PI / 180.0;
+
+// Below this, starting a thread costs more than it saves.
+constexpr size_t MIN_ITEMS_PER_THREAD = 20000;
+
+// Protects against a line spacing which is tiny compared to the area.
+constexpr size_t MAX_LINES = 1000000;
+
+// Same for the trigger distance, far more than can be uploaded but it keeps a
+// typo from allocating all memory.
+constexpr size_t MAX_ITEMS = 10000000;
+
+} // namespace
+
+// The polygons are projected onto a plane tangent at the first vertex (equirectangular, which
+// is accurate to centimetres over the few kilometres of a survey) and rotated so that the
+// lines run along u while they are stacked along v.
+struct SurveyGenerator::Lines {
+    double reference_latitude_e7;
+    double reference_longitude_e7;
+    double metres_to_latitude_e7;
+    double metres_to_longitude_e7;
+    double sin_angle;
+    double cos_angle;
+    double trigger_distance_m;
+    double turnaround_m;
+
+    std::vector<double> v {};
+    std::vector<double> u_start {};
+    std::vector<double> u_end {};
+
+    // Index of the first mission item of every line, one more entry than lines.
+    std::vector<size_t> first_item {};
+};
+
+const char *SurveyGenerator::result_str(Result result)
+{
+    switch (result) {
+        case Result::SUCCESS:
+            return "Success";
+        case Result::INVALID_POLYGON:
+            return "Invalid polygon";
+        case Result::INVALID_SETTINGS:
+            return "Invalid settings";
+        case Result::NO_LINES:
+            return "No lines";
+        default:
+            return "Unknown";
+    }
+}
+
+float SurveyGenerator::line_spacing_m(const Settings &settings)
+{
+    if (std::isfinite(settings.line_spacing_m)) {
+        return settings.line_spacing_m;
+    }
+    const float footprint_m =
+        settings.relative_altitude_m * settings.sensor_width_mm / settings.focal_length_mm;
+    return footprint_m * (1.0f - settings.side_overlap);
+}
+
+float SurveyGenerator::trigger_distance_m(const Settings &settings)
+{
+    if (std::isfinite(settings.trigger_distance_m)) {
+        return settings.trigger_distance_m;
+    }
+    const float footprint_m =
+        settings.relative_altitude_m * settings.sensor_height_mm / settings.focal_length_mm;
+    return footprint_m * (1.0f - settings.front_overlap);
+}
+
+SurveyGenerator::Result SurveyGenerator::generate(const Polygon &polygon,
+                                                  const Settings &settings,
+                                                  MissionPlan &mission_plan)
+{
+    return generate(std::vector<Polygon> {polygon}, settings, mission_plan);
+}
+
+SurveyGenerator::Result SurveyGenerator::generate(const std::vector<Polygon> &polygons,
+                                                  const Settings &settings,
+                                                  MissionPlan &mission_plan)
+{
+    mission_plan.clear();
+
+    const double spacing_m = double(line_spacing_m(settings));
+    const double trigger_m = double(trigger_distance_m(settings));
+
+    if (!(spacing_m > 0.0) || !std::isfinite(spacing_m) ||
+        !(trigger_m > 0.0) || !std::isfinite(trigger_m) ||
+        !std::isfinite(settings.relative_altitude_m) ||
+        !std::isfinite(settings.line_angle_deg) ||
+        !(settings.turnaround_m >= 0.0f) || !std::isfinite(settings.turnaround_m)) {
+        LogErr() << "Invalid survey settings";
+        return Result::INVALID_SETTINGS;
+    }
+
+    if (polygons.empty()) {
+        LogErr() << "No survey polygon";
+        return Result::INVALID_POLYGON;
+    }
+
+    for (const auto &polygon : polygons) {
+        if (polygon.size() < 3) {
+            LogErr() << "Survey polygon needs at least 3 vertices";
+            return Result::INVALID_POLYGON;
+        }
+        for (const auto &vertex : polygon) {
+            if (!(std::fabs(vertex.latitude_deg) < 90.0) ||
+                !(std::fabs(vertex.longitude_deg) <= 180.0)) {
+                LogErr() << "Invalid survey polygon vertex";
+                return Result::INVALID_POLYGON;
+            }
+        }
+    }
+
+    Lines lines;
+    const Coordinate &reference = polygons.front().front();
+    lines.reference_latitude_e7 = reference.latitude_deg * 1e7;
+    lines.reference_longitude_e7 = reference.longitude_deg * 1e7;
+    lines.metres_to_latitude_e7 = 1e7 / METRES_PER_DEGREE;
+    lines.metres_to_longitude_e7 =
+        1e7 / (METRES_PER_DEGREE * std::cos(to_rad_from_deg(reference.latitude_deg)));
+    lines.sin_angle = std::sin(to_rad_from_deg(double(settings.line_angle_deg)));
+    lines.cos_angle = std::cos(to_rad_from_deg(double(settings.line_angle_deg)));
+    lines.trigger_distance_m = trigger_m;
+    lines.turnaround_m = double(settings.turnaround_m);
+
+    // Project all vertices first, the lines are laid out over all polygons together.
+    std::vector<std::vector<double>> us(polygons.size());
+    std::vector<std::vector<double>> vs(polygons.size());
+    double v_min = std::numeric_limits<double>::infinity();
+    double v_max = -std::numeric_limits<double>::infinity();
+
+    for (size_t p = 0; p < polygons.size(); ++p) {
+        us[p].reserve(polygons[p].size());
+        vs[p].reserve(polygons[p].size());
+        for (const auto &vertex : polygons[p]) {
+            const double east_m = (vertex.longitude_deg * 1e7 - lines.reference_longitude_e7) /
+                                  lines.metres_to_longitude_e7;
+            const double north_m = (vertex.latitude_deg * 1e7 - lines.reference_latitude_e7) /
+                                   lines.metres_to_latitude_e7;
+            const double u = east_m * lines.sin_angle + north_m * lines.cos_angle;
+            const double v = east_m * lines.cos_angle - north_m * lines.sin_angle;
+            us[p].push_back(u);
+            vs[p].push_back(v);
+            v_min = std::min(v_min, v);
+            v_max = std::max(v_max, v);
+        }
+    }
+
+    // Center the lines over the whole area.
+    const double num_lines_total = std::max(1.0, std::ceil((v_max - v_min) / spacing_m));
+    if (num_lines_total > double(MAX_LINES)) {
+        LogErr() << "Survey line spacing too small for area";
+        return Result::INVALID_SETTINGS;
+    }
+    const double v_first = v_min + 0.5 * ((v_max - v_min) - (num_lines_total - 1.0) * spacing_m);
+
+    std::vector<double> u_min;
+    std::vector<double> u_max;
+
+    for (size_t p = 0; p < polygons.size(); ++p) {
+        const std::vector<double> &u = us[p];
+        const std::vector<double> &v = vs[p];
+
+        const double polygon_v_min = *std::min_element(v.begin(), v.end());
+        const double polygon_v_max = *std::max_element(v.begin(), v.end());
+        const double k_begin = std::max(0.0, std::ceil((polygon_v_min - v_first) / spacing_m));
+        const double k_end = std::min(num_lines_total,
+                                      std::floor((polygon_v_max - v_first) / spacing_m) + 1.0);
+        if (k_end <= k_begin) {
+            continue;
+        }
+        const size_t num_lines = size_t(k_end - k_begin);
+        const double v_begin = v_first + k_begin * spacing_m;
+
+        u_min.assign(num_lines, std::numeric_limits<double>::infinity());
+        u_max.assign(num_lines, -std::numeric_limits<double>::infinity());
+
+        // Intersect every edge with all lines it crosses at once.
+        for (size_t i = 0; i < u.size(); ++i) {
+            const size_t j = (i + 1) % u.size();
+            if (v[i] == v[j]) {
+                // Parallel to the lines, its ends belong to the neighbouring edges.
+                continue;
+            }
+            const double edge_v_min = std::min(v[i], v[j]);
+            const double edge_v_max = std::max(v[i], v[j]);
+            const double first = std::max(0.0, std::ceil((edge_v_min - v_begin) / spacing_m));
+            const double last = std::min(double(num_lines),
+                                         std::floor((edge_v_max - v_begin) / spacing_m) + 1.0);
+            if (last <= first) {
+                continue;
+            }
+
+            const double slope = (u[j] - u[i]) / (v[j] - v[i]);
+            const double u_at_first = u[i] + (v_begin + first * spacing_m - v[i]) * slope;
+            const double u_step = spacing_m * slope;
+            const size_t line_first = size_t(first);
+            const size_t count = size_t(last - first);
+            double *min_out = u_min.data() + line_first;
+            double *max_out = u_max.data() + line_first;
+
+            for (size_t k = 0; k < count; ++k) {
+                const double crossing = u_at_first + double(k) * u_step;
+                min_out[k] = std::min(min_out[k], crossing);
+                max_out[k] = std::max(max_out[k], crossing);
+            }
+        }
+
+        for (size_t k = 0; k < num_lines; ++k) {
+            if (!(u_min[k] <= u_max[k])) {
+                continue;
+            }
+            // Back and forth, every other line is flown in reverse.
+            const bool reverse = (lines.v.size() % 2 == 1);
+            lines.v.push_back(v_begin + double(k) * spacing_m);
+            lines.u_start.push_back(reverse ? u_max[k] : u_min[k]);
+            lines.u_end.push_back(reverse ? u_min[k] : u_max[k]);
+        }
+    }
+
+    if (lines.v.empty()) {
+        LogErr() << "No survey line crosses the polygons";
+        return Result::NO_LINES;
+    }
+
+    const size_t items_per_turnaround = (lines.turnaround_m > 0.0) ? 2 : 0;
+    lines.first_item.resize(lines.v.size() + 1);
+    lines.first_item[0] = 0;
+    for (size_t l = 0; l < lines.v.size(); ++l) {
+        const double length_m = std::fabs(lines.u_end[l] - lines.u_start[l]);
+        // Counted as double, the number of photos is only converted once it is known to fit.
+        const double num_photos = std::ceil(length_m / trigger_m) + 1.0;
+        if (num_photos + double(lines.first_item[l] + items_per_turnaround) > double(MAX_ITEMS)) {
+            LogErr() << "Survey trigger distance too small for area";
+            return Result::INVALID_SETTINGS;
+        }
+        lines.first_item[l + 1] = lines.first_item[l] + size_t(num_photos) + items_per_turnaround;
+    }
+
+    const size_t num_items = lines.first_item.back();
+    mission_plan.resize(num_items);
+
+    unsigned num_threads = settings.num_threads;
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = unsigned(std::min(size_t(num_threads),
+                                    std::max(size_t(1), num_items / MIN_ITEMS_PER_THREAD)));
+    num_threads = unsigned(std::min(size_t(num_threads), lines.v.size()));
+
+    // Split the lines so that every thread fills about the same number of items.
+    std::vector<std::thread> threads;
+    size_t line_begin = 0;
+    for (unsigned t = 1; t < num_threads; ++t) {
+        const size_t target = num_items * t / num_threads;
+        const size_t line_end = size_t(std::lower_bound(lines.first_item.begin(),
+                                                        lines.first_item.end(), target) -
+                                       lines.first_item.begin());
+        if (line_end > line_begin) {
+            threads.emplace_back(fill, std::cref(lines), std::cref(settings), line_begin,
+                                 line_end, std::ref(mission_plan));
+            line_begin = line_end;
+        }
+    }
+    fill(lines, settings, line_begin, lines.v.size(), mission_plan);
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Speed and gimbal stay the same for the whole survey.
+    mission_plan.set_speed(0, settings.speed_m_s);
+    if (std::isfinite(settings.gimbal_pitch_deg)) {
+        mission_plan.set_gimbal_pitch_and_yaw(0, settings.gimbal_pitch_deg, 0.0f);
+    }
+
+    return Result::SUCCESS;
+}
+
+void SurveyGenerator::fill(const Lines &lines, const Settings &settings, size_t line_begin,
+                           size_t line_end, MissionPlan &mission_plan)
+{
+    std::vector<double> u;
+
+    for (size_t l = line_begin; l < line_end; ++l) {
+        const size_t first_item = lines.first_item[l];
+        const size_t num_items = lines.first_item[l + 1] - first_item;
+        const double direction = (lines.u_end[l] >= lines.u_start[l]) ? 1.0 : -1.0;
+
+        // Photos are spread evenly, so they are never further apart than the trigger distance.
+        u.resize(num_items);
+        size_t photos_begin = 0;
+        size_t photos_end = num_items;
+        if (lines.turnaround_m > 0.0) {
+            u[0] = lines.u_start[l] - direction * lines.turnaround_m;
+            u[num_items - 1] = lines.u_end[l] + direction * lines.turnaround_m;
+            photos_begin = 1;
+            photos_end = num_items - 1;
+        }
+        const size_t num_photos = photos_end - photos_begin;
+        const double photo_step = (num_photos > 1) ?
+                                  (lines.u_end[l] - lines.u_start[l]) / double(num_photos - 1) :
+                                  0.0;
+        for (size_t i = 0; i < num_photos; ++i) {
+            u[photos_begin + i] = lines.u_start[l] + double(i) * photo_step;
+        }
+
+        // Rotate back and convert to 1e-7 degrees.
+        const double v = lines.v[l];
+        int32_t *latitude_e7 = mission_plan._latitude_e7.data() + first_item;
+        int32_t *longitude_e7 = mission_plan._longitude_e7.data() + first_item;
+        for (size_t i = 0; i < num_items; ++i) {
+            const double east_m = u[i] * lines.sin_angle + v * lines.cos_angle;
+            const double north_m = u[i] * lines.cos_angle - v * lines.sin_angle;
+            latitude_e7[i] = int32_t(std::floor(lines.reference_latitude_e7 +
+                                                north_m * lines.metres_to_latitude_e7 + 0.5));
+            longitude_e7[i] = int32_t(std::floor(lines.reference_longitude_e7 +
+                                                 east_m * lines.metres_to_longitude_e7 + 0.5));
+        }
+
+        std::fill_n(mission_plan._relative_altitude_m.data() + first_item, num_items,
+                    settings.relative_altitude_m);
+        std::fill_n(mission_plan._fly_through.data() + first_item, num_items, uint8_t(1));
+        std::fill_n(mission_plan._camera_action.data() + first_item + photos_begin, num_photos,
+                    uint8_t(MissionItem::CameraAction::TAKE_PHOTO));
+    }
+}
+
+} // namespace dronecore
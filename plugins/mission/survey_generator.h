@@ -0,0 +1,143 @@
+#pragma once
+
+#include "mission_plan.h"
+#include <cmath>
+#include <vector>
+
+namespace dronecore {
+
+/**
+ * @brief Generates survey (lawnmower) missions covering polygons.
+ *
+ * The area is covered by parallel lines flown back and forth. The distance between the lines
+ * and between the camera trigger points on a line are derived from the camera footprint at the
+ * survey altitude and the requested overlap. Every trigger point becomes a fly-through waypoint
+ * taking a photo, optionally with an extra waypoint before and after every line to give the
+ * vehicle room to turn around.
+ *
+ * The mission is written straight into a MissionPlan which can then be uploaded using
+ * `Mission::upload_mission_async()`. Large surveys are generated on several threads.
+ *
+ * Every photo is a MAVLink mission item of its own, so a survey takes about twice as many
+ * MAVLink items as trigger points. Surveys of more than 65535 MAVLink items can be generated
+ * and saved but not uploaded at once, the upload fails with
+ * `Mission::Result::TOO_MANY_MISSION_ITEMS`. Such areas need to be split into several missions.
+ */
+class SurveyGenerator
+{
+public:
+    /**
+     * @brief Position of a polygon vertex.
+     */
+    struct Coordinate {
+        double latitude_deg; /**< @brief Latitude in degrees. */
+        double longitude_deg; /**< @brief Longitude in degrees. */
+    };
+
+    /**
+     * @brief Polygon given by its vertices, the last vertex connects back to the first one.
+     *
+     * Each line covers a polygon from where it enters it first to where it leaves it last.
+     * Concave areas should therefore be split into several polygons.
+     */
+    typedef std::vector<Coordinate> Polygon;
+
+    /**
+     * @brief Settings of a survey.
+     */
+    struct Settings {
+        float relative_altitude_m = 50.0f; /**< @brief Altitude relative to takeoff. */
+        float speed_m_s = NAN; /**< @brief Survey speed, NaN to use the default speed. */
+        float gimbal_pitch_deg = -90.0f; /**< @brief Gimbal pitch, NaN to leave it as is. */
+
+        float sensor_width_mm = 6.17f; /**< @brief Sensor size across the lines. */
+        float sensor_height_mm = 4.55f; /**< @brief Sensor size along the lines. */
+        float focal_length_mm = 4.5f; /**< @brief Focal length of the lens. */
+        float side_overlap = 0.7f; /**< @brief Overlap of neighbouring lines (0 to <1). */
+        float front_overlap = 0.8f; /**< @brief Overlap of consecutive photos (0 to <1). */
+
+        /**
+         * @brief Distance between lines in metres, overrides the camera footprint if set.
+         */
+        float line_spacing_m = NAN;
+
+        /**
+         * @brief Distance between photos in metres, overrides the camera footprint if set.
+         */
+        float trigger_distance_m = NAN;
+
+        float line_angle_deg = 0.0f; /**< @brief Direction of the lines, clockwise from north. */
+        float turnaround_m = 10.0f; /**< @brief Distance flown past a line to turn, 0 for none. */
+
+        /**
+         * @brief Number of threads to use, 0 to use all cores. Small surveys use one thread.
+         */
+        unsigned num_threads = 0;
+    };
+
+    /**
+     * @brief Possible results returned when generating a survey.
+     */
+    enum class Result {
+        SUCCESS = 0, /**< @brief Survey generated. */
+        INVALID_POLYGON, /**< @brief A polygon has less than 3 vertices or invalid vertices. */
+        INVALID_SETTINGS, /**< @brief The settings are invalid or give far too many items. */
+        NO_LINES /**< @brief No line crosses any of the polygons. */
+    };
+
+    /**
+     * @brief Gets a human-readable English string for a SurveyGenerator::Result.
+     *
+     * @param result Enum for which string is required.
+     * @return Human readable string for the SurveyGenerator::Result.
+     */
+    static const char *result_str(Result result);
+
+    /**
+     * @brief Line spacing used for given settings.
+     *
+     * @param settings Survey settings.
+     * @return Distance between lines in metres.
+     */
+    static float line_spacing_m(const Settings &settings);
+
+    /**
+     * @brief Trigger distance used for given settings.
+     *
+     * @param settings Survey settings.
+     * @return Distance between photos in metres.
+     */
+    static float trigger_distance_m(const Settings &settings);
+
+    /**
+     * @brief Generates a survey covering one polygon.
+     *
+     * @param polygon Area to cover.
+     * @param settings Survey settings.
+     * @param mission_plan Plan to fill, it is cleared first.
+     * @return Result of generating the survey.
+     */
+    static Result generate(const Polygon &polygon, const Settings &settings,
+                           MissionPlan &mission_plan);
+
+    /**
+     * @brief Generates a survey covering several polygons one after the other.
+     *
+     * All polygons use the same lines, so neighbouring polygons are covered seamlessly.
+     *
+     * @param polygons Areas to cover.
+     * @param settings Survey settings.
+     * @param mission_plan Plan to fill, it is cleared first.
+     * @return Result of generating the survey.
+     */
+    static Result generate(const std::vector<Polygon> &polygons, const Settings &settings,
+                           MissionPlan &mission_plan);
+
+private:
+    struct Lines;
+
+    static void fill(const Lines &lines, const Settings &settings, size_t line_begin,
+                     size_t line_end, MissionPlan &mission_plan);
+};
+
+} // namespace dronecore
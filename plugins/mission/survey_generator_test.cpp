@@ -0,0 +1,151 @@
+#include "survey_generator.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace dronecore;
+
+// Roughly 200 m east-west by 90 m north-south.
+static SurveyGenerator::Polygon rectangle()
+{
+    return SurveyGenerator::Polygon {
+        {47.3971, 8.5450},
+        {47.3971, 8.54765},
+        {47.3979, 8.54765},
+        {47.3979, 8.5450}
+    };
+}
+
+TEST(SurveyGenerator, SpacingFromCameraFootprint)
+{
+    SurveyGenerator::Settings settings;
+    settings.relative_altitude_m = 45.0f;
+    settings.sensor_width_mm = 6.0f;
+    settings.sensor_height_mm = 4.0f;
+    settings.focal_length_mm = 4.5f;
+    settings.side_overlap = 0.5f;
+    settings.front_overlap = 0.75f;
+
+    // The footprint is 60 m by 40 m.
+    EXPECT_FLOAT_EQ(SurveyGenerator::line_spacing_m(settings), 30.0f);
+    EXPECT_FLOAT_EQ(SurveyGenerator::trigger_distance_m(settings), 10.0f);
+
+    settings.line_spacing_m = 12.0f;
+    settings.trigger_distance_m = 3.0f;
+    EXPECT_FLOAT_EQ(SurveyGenerator::line_spacing_m(settings), 12.0f);
+    EXPECT_FLOAT_EQ(SurveyGenerator::trigger_distance_m(settings), 3.0f);
+}
+
+TEST(SurveyGenerator, CoversRectangle)
+{
+    SurveyGenerator::Settings settings;
+    settings.relative_altitude_m = 30.0f;
+    settings.speed_m_s = 5.0f;
+    settings.line_spacing_m = 20.0f;
+    settings.trigger_distance_m = 10.0f;
+    settings.line_angle_deg = 90.0f; // east-west
+    settings.turnaround_m = 10.0f;
+
+    MissionPlan mission_plan;
+    ASSERT_EQ(SurveyGenerator::generate(rectangle(), settings, mission_plan),
+              SurveyGenerator::Result::SUCCESS);
+
+    // 5 lines 20 m apart over 90 m, each with 21 photos over 200 m and 2 turnaround waypoints.
+    ASSERT_EQ(mission_plan.size(), 5u * (21u + 2u));
+
+    EXPECT_FLOAT_EQ(mission_plan.get_speed_m_s(0), 5.0f);
+    EXPECT_FLOAT_EQ(mission_plan.get_gimbal_pitch_deg(0), -90.0f);
+    EXPECT_TRUE(std::isnan(mission_plan.get_speed_m_s(1)));
+
+    for (size_t line = 0; line < 5; ++line) {
+        const size_t first = line * 23;
+        const size_t last = first + 22;
+
+        EXPECT_EQ(mission_plan.get_camera_action(first), MissionItem::CameraAction::NONE);
+        EXPECT_EQ(mission_plan.get_camera_action(last), MissionItem::CameraAction::NONE);
+        for (size_t i = first + 1; i < last; ++i) {
+            EXPECT_EQ(mission_plan.get_camera_action(i), MissionItem::CameraAction::TAKE_PHOTO);
+            EXPECT_TRUE(mission_plan.get_fly_through(i));
+            EXPECT_FLOAT_EQ(mission_plan.get_relative_altitude_m(i), 30.0f);
+            // A line keeps its latitude.
+            EXPECT_NEAR(mission_plan.get_latitude_deg(i), mission_plan.get_latitude_deg(first),
+                        1e-7);
+        }
+
+        // Photos at both ends of the line, the turnaround outside of the polygon.
+        const bool eastwards = (line % 2 == 0);
+        EXPECT_NEAR(mission_plan.get_longitude_deg(first + 1), eastwards ? 8.5450 : 8.54765,
+                    1e-6);
+        EXPECT_NEAR(mission_plan.get_longitude_deg(last - 1), eastwards ? 8.54765 : 8.5450,
+                    1e-6);
+        EXPECT_EQ(mission_plan.get_longitude_deg(first) < mission_plan.get_longitude_deg(last),
+                  eastwards);
+
+        // Lines are 20 m (about 1.8e-4 degrees latitude) apart and inside the polygon.
+        const double latitude_deg = mission_plan.get_latitude_deg(first);
+        EXPECT_GT(latitude_deg, 47.3971);
+        EXPECT_LT(latitude_deg, 47.3979);
+        if (line > 0) {
+            const double previous_latitude_deg = mission_plan.get_latitude_deg(first - 1);
+            EXPECT_NEAR(std::fabs(latitude_deg - previous_latitude_deg), 1.7987e-4, 1e-6);
+        }
+    }
+}
+
+TEST(SurveyGenerator, ThreadsGenerateSamePlan)
+{
+    SurveyGenerator::Settings settings;
+    settings.line_spacing_m = 5.0f;
+    settings.trigger_distance_m = 2.0f;
+    settings.line_angle_deg = 30.0f;
+
+    // A triangle next to a quadrilateral sharing an edge, about 2 km wide.
+    const std::vector<SurveyGenerator::Polygon> polygons {
+        {{47.390, 8.540}, {47.400, 8.560}, {47.380, 8.565}},
+        {{47.400, 8.560}, {47.405, 8.570}, {47.385, 8.575}, {47.380, 8.565}}
+    };
+
+    settings.num_threads = 1;
+    MissionPlan single_threaded;
+    ASSERT_EQ(SurveyGenerator::generate(polygons, settings, single_threaded),
+              SurveyGenerator::Result::SUCCESS);
+    EXPECT_GT(single_threaded.size(), 100000u);
+
+    settings.num_threads = 4;
+    MissionPlan multi_threaded;
+    ASSERT_EQ(SurveyGenerator::generate(polygons, settings, multi_threaded),
+              SurveyGenerator::Result::SUCCESS);
+
+    ASSERT_EQ(single_threaded.size(), multi_threaded.size());
+    EXPECT_EQ(single_threaded.latitudes_e7(), multi_threaded.latitudes_e7());
+    EXPECT_EQ(single_threaded.longitudes_e7(), multi_threaded.longitudes_e7());
+    for (size_t i = 0; i < single_threaded.size(); ++i) {
+        ASSERT_TRUE(multi_threaded.has_position(i));
+        ASSERT_EQ(single_threaded.get_camera_action(i), multi_threaded.get_camera_action(i));
+    }
+}
+
+TEST(SurveyGenerator, RejectsInvalidInput)
+{
+    SurveyGenerator::Settings settings;
+    MissionPlan mission_plan;
+    mission_plan.add_waypoint(47.0, 8.0, 10.0f);
+
+    SurveyGenerator::Polygon line {{47.3971, 8.5450}, {47.3979, 8.5450}};
+    EXPECT_EQ(SurveyGenerator::generate(line, settings, mission_plan),
+              SurveyGenerator::Result::INVALID_POLYGON);
+    EXPECT_TRUE(mission_plan.empty());
+
+    SurveyGenerator::Polygon invalid_vertex = rectangle();
+    invalid_vertex[2].latitude_deg = NAN;
+    EXPECT_EQ(SurveyGenerator::generate(invalid_vertex, settings, mission_plan),
+              SurveyGenerator::Result::INVALID_POLYGON);
+
+    settings.side_overlap = 1.0f;
+    EXPECT_EQ(SurveyGenerator::generate(rectangle(), settings, mission_plan),
+              SurveyGenerator::Result::INVALID_SETTINGS);
+
+    settings.side_overlap = 0.5f;
+    settings.trigger_distance_m = -1.0f;
+    EXPECT_EQ(SurveyGenerator::generate(rectangle(), settings, mission_plan),
+              SurveyGenerator::Result::INVALID_SETTINGS);
+}
@@ -3,6 +3,8 @@
 
 namespace dronecore {
 
+constexpr unsigned Offboard::TRAJECTORY_BUFFER_SIZE;
+
 Offboard::Offboard(OffboardImpl *impl) :
     _impl(impl)
 {
@@ -47,6 +49,21 @@ void Offboard::set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_ya
     return _impl->set_velocity_body(velocity_body_yawspeed);
 }
 
+Offboard::Result Offboard::append_trajectory(const std::vector<TrajectorySample> &samples)
+{
+    return _impl->append_trajectory(samples);
+}
+
+Offboard::Result Offboard::set_rate_hz(float rate_hz)
+{
+    return _impl->set_rate_hz(rate_hz);
+}
+
+Offboard::SenderStats Offboard::sender_stats() const
+{
+    return _impl->sender_stats();
+}
+
 const char *Offboard::result_str(Result result)
 {
     switch (result) {
@@ -62,6 +79,10 @@ const char *Offboard::result_str(Result result)
             return "Command denied";
         case Result::TIMEOUT:
             return "Timeout";
+        case Result::NO_SETPOINT_SET:
+            return "No setpoint set";
+        case Result::INVALID_ARGUMENT:
+            return "Invalid argument";
         case Result::UNKNOWN:
         default:
             return "Unknown";
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 namespace dronecore {
 
@@ -14,9 +16,9 @@ class OffboardImpl;
  * as opposed to onboard control right inside the autopilot "board".
  *
  * Client code must specify a setpoint before starting offboard mode.
- * DroneCore automatically resends setpoints at 20Hz (PX4 Offboard mode requires that setpoints are
- * minimally resent at 2Hz). If more precise control is required, clients can call the
- * setpoint methods at whatever rate is required.
+ * DroneCore automatically resends setpoints at 10Hz (PX4 Offboard mode requires that setpoints are
+ * minimally resent at 2Hz). For agile control the rate can be raised with set_rate_hz(), the
+ * setpoints are then sent from a dedicated thread with sub-millisecond jitter.
  *
  * **Attention:** this is work in progress, use with caution!
  */
@@ -45,6 +47,7 @@ public:
         COMMAND_DENIED, /**< @brief Command denied. */
         TIMEOUT, /**< @brief %Request timeout. */
         NO_SETPOINT_SET, /**< Can't start without setpoint set. */
+        INVALID_ARGUMENT, /**< @brief Invalid argument. */
         UNKNOWN /**< @brief Unknown error. */
     };
 
@@ -142,6 +145,91 @@ public:
      */
     void set_velocity_body(VelocityBodyYawspeed velocity_body_yawspeed);
 
+    /**
+     * @brief Sample of a trajectory in NED coordinates relative to the home position.
+     */
+    struct TrajectorySample {
+        double time_s; /**< @brief Time since the start of the trajectory in seconds. */
+        float north_m; /**< @brief Position North in metres. */
+        float east_m; /**< @brief Position East in metres. */
+        float down_m; /**< @brief Position Down in metres. */
+        float velocity_north_m_s; /**< @brief Velocity North in metres/second. */
+        float velocity_east_m_s; /**< @brief Velocity East in metres/second. */
+        float velocity_down_m_s; /**< @brief Velocity Down in metres/second. */
+        float acceleration_north_m_s2; /**< @brief Acceleration North in metres/second^2. */
+        float acceleration_east_m_s2; /**< @brief Acceleration East in metres/second^2. */
+        float acceleration_down_m_s2; /**< @brief Acceleration Down in metres/second^2. */
+        float yaw_deg; /**< @brief Yaw in degrees (0 North, positive is clock-wise looking from
+                            above). */
+    };
+
+    /**
+     * @brief Append samples to the trajectory to follow.
+     *
+     * Instead of single setpoints a whole trajectory (or segments of it) can be given. Every
+     * time a setpoint is sent, the position, velocity, acceleration and yaw are interpolated
+     * between the samples around the current time. Before the first sample the first one is
+     * sent, after the last one its position is held.
+     *
+     * The first call starts the trajectory at the current time, which is time 0 of the
+     * samples. Further calls append to it, their times need to be later than the ones already
+     * given. Setting a velocity ends the trajectory and discards the remaining samples.
+     *
+     * Samples are buffered until their time has passed, up to TRAJECTORY_BUFFER_SIZE at a
+     * time.
+     *
+     * @param samples Samples with increasing times.
+     * @return SUCCESS, INVALID_ARGUMENT if the samples are invalid or not increasing in time,
+     * or BUSY if the buffer has no space for all of them.
+     */
+    Result append_trajectory(const std::vector<TrajectorySample> &samples);
+
+    /**
+     * @brief Maximum number of trajectory samples buffered at a time.
+     */
+    static constexpr unsigned TRAJECTORY_BUFFER_SIZE = 8192;
+
+    /**
+     * @brief Set the rate at which setpoints are sent.
+     *
+     * The setpoints are sent at deadlines on a fixed grid, so the rate does not drift. If
+     * sending is late by more than one period, the missed setpoints are skipped.
+     *
+     * @param rate_hz Rate in Hz, between 2 and 1000 Hz (default 10 Hz).
+     * @return SUCCESS, or INVALID_ARGUMENT if the rate is out of range.
+     */
+    Result set_rate_hz(float rate_hz);
+
+    /**
+     * @brief Distribution of a duration.
+     */
+    struct TimingStats {
+        double mean_us; /**< @brief Mean in microseconds. */
+        double p50_us; /**< @brief Median in microseconds. */
+        double p90_us; /**< @brief 90th percentile in microseconds. */
+        double p99_us; /**< @brief 99th percentile in microseconds. */
+        double max_us; /**< @brief Maximum in microseconds. */
+    };
+
+    /**
+     * @brief Statistics of the setpoint sender since setpoints were last started.
+     */
+    struct SenderStats {
+        float rate_hz; /**< @brief Configured rate in Hz. */
+        double achieved_rate_hz; /**< @brief Rate at which setpoints were actually sent in Hz. */
+        uint64_t setpoints_sent; /**< @brief Number of setpoints sent at their deadline. */
+        uint64_t missed_deadlines; /**< @brief Number of setpoints skipped because of delays. */
+        TimingStats jitter; /**< @brief Time from the deadline until a setpoint was sent. */
+        TimingStats interval; /**< @brief Time between consecutive setpoints. */
+    };
+
+    /**
+     * @brief Get the statistics of the setpoint sender.
+     *
+     * @return Achieved rate and the distributions of jitter and interval.
+     */
+    SenderStats sender_stats() const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -154,6 +242,8 @@ public:
 private:
     /** @private Underlying implementation, set at instantiation */
     OffboardImpl *_impl;
+
+    friend class OffboardFleet;
 };
 
 } // namespace dronecore
@@ -0,0 +1,36 @@
+#include "offboard_fleet.h"
+#include "offboard_fleet_impl.h"
+
+namespace dronecore {
+
+OffboardFleet::OffboardFleet() :
+    _impl(new OffboardFleetImpl())
+{
+}
+
+OffboardFleet::~OffboardFleet()
+{
+    delete _impl;
+}
+
+Offboard::Result OffboardFleet::add(Offboard &offboard)
+{
+    return _impl->add(*offboard._impl);
+}
+
+void OffboardFleet::remove(Offboard &offboard)
+{
+    _impl->remove(*offboard._impl);
+}
+
+Offboard::Result OffboardFleet::set_rate_hz(float rate_hz)
+{
+    return _impl->set_rate_hz(rate_hz);
+}
+
+OffboardFleet::Stats OffboardFleet::stats() const
+{
+    return _impl->stats();
+}
+
+} // namespace dronecore
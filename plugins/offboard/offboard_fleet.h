@@ -0,0 +1,108 @@
+#pragma once
+
+#include "offboard.h"
+#include <cstdint>
+#include <vector>
+
+namespace dronecore {
+
+class OffboardFleetImpl;
+
+/**
+ * @brief This class is used to send the offboard setpoints of several vehicles together, e.g. for
+ * formation flight.
+ *
+ * By default every vehicle resends its setpoints on its own, so the setpoints of a formation go
+ * out at unrelated times, one datagram after the other. The setpoints of vehicles added to a
+ * fleet are instead collected on one common tick and sent in one batch per connection (on Linux
+ * a UDP connection hands the whole batch to the kernel with one system call).
+ *
+ * Setpoints are still set using Offboard of every vehicle, and offboard mode is started and
+ * stopped per vehicle as well. Only vehicles with a setpoint set are included in a tick.
+ *
+ * A fleet needs to be destroyed before the DroneCore instance its vehicles belong to.
+ */
+class OffboardFleet
+{
+public:
+    /**
+     * @brief Constructor, the fleet starts empty.
+     */
+    OffboardFleet();
+
+    /**
+     * @brief Destructor, vehicles still in the fleet go back to sending setpoints on their own.
+     */
+    ~OffboardFleet();
+
+    /**
+     * @brief Add a vehicle to the fleet.
+     *
+     * @param offboard Offboard plugin of the vehicle, e.g. `DroneCore::device(uuid).offboard()`.
+     * @return SUCCESS, or BUSY if the vehicle is already in a fleet.
+     */
+    Offboard::Result add(Offboard &offboard);
+
+    /**
+     * @brief Remove a vehicle from the fleet, it then sends setpoints on its own again.
+     *
+     * @param offboard Offboard plugin of the vehicle.
+     */
+    void remove(Offboard &offboard);
+
+    /**
+     * @brief Set the rate of the common tick, see Offboard::set_rate_hz().
+     *
+     * The rates set for the vehicles themselves are not used while they are in the fleet.
+     *
+     * @param rate_hz Rate in Hz, between 2 and 1000 Hz (default 10 Hz).
+     * @return SUCCESS, or INVALID_ARGUMENT if the rate is out of range.
+     */
+    Offboard::Result set_rate_hz(float rate_hz);
+
+    /**
+     * @brief Statistics of one vehicle in the fleet.
+     */
+    struct VehicleStats {
+        uint64_t uuid; /**< @brief UUID of the vehicle. */
+        uint64_t setpoints_sent; /**< @brief Number of setpoints sent for this vehicle. */
+        /** @brief Time from the start of a tick until the setpoint of this vehicle was sent. */
+        Offboard::TimingStats phase_skew;
+    };
+
+    /**
+     * @brief Statistics of the fleet since it was created.
+     */
+    struct Stats {
+        float rate_hz; /**< @brief Configured rate in Hz. */
+        double achieved_rate_hz; /**< @brief Rate at which ticks actually happened in Hz. */
+        uint64_t ticks; /**< @brief Number of ticks. */
+        uint64_t missed_deadlines; /**< @brief Number of ticks skipped because of delays. */
+        uint64_t batches_sent; /**< @brief Number of batches handed to the connections. */
+        Offboard::TimingStats jitter; /**< @brief Time from the deadline until a tick started. */
+        Offboard::TimingStats tick_cpu; /**< @brief CPU time used per tick. */
+        std::vector<VehicleStats> vehicles; /**< @brief Per vehicle in the fleet. */
+    };
+
+    /**
+     * @brief Get the statistics of the fleet.
+     *
+     * @return Statistics of the ticks and of every vehicle.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Copy constructor (object is not copyable).
+     */
+    OffboardFleet(const OffboardFleet &) = delete;
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const OffboardFleet &operator=(const OffboardFleet &) = delete;
+
+private:
+    /** @private Underlying implementation */
+    OffboardFleetImpl *_impl;
+};
+
+} // namespace dronecore
@@ -0,0 +1,178 @@
+#include "offboard_fleet_impl.h"
+#include "global_include.h"
+#include <algorithm>
+#include <chrono>
+
+#ifndef WINDOWS
+#include <time.h>
+#endif
+
+namespace dronecore {
+
+OffboardFleetImpl::OffboardFleetImpl() {}
+
+OffboardFleetImpl::~OffboardFleetImpl()
+{
+    {
+        std::lock_guard<std::mutex> sender_lock(_sender_mutex);
+        _sender.stop();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &vehicle : _vehicles) {
+        vehicle.offboard->leave_fleet();
+    }
+}
+
+Offboard::Result OffboardFleetImpl::add(OffboardImpl &offboard)
+{
+    std::lock_guard<std::mutex> sender_lock(_sender_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!offboard.join_fleet()) {
+            return Offboard::Result::BUSY;
+        }
+
+        // Insert after the last vehicle sharing the connections, so every
+        // group can be sent as one batch.
+        const DeviceImpl &device = offboard.get_device_impl();
+        auto it = std::find_if(_vehicles.rbegin(), _vehicles.rend(),
+        [&device](const Vehicle & vehicle) {
+            return vehicle.offboard->get_device_impl().shares_connections_with(device);
+        });
+        _vehicles.insert(it.base(),
+                         Vehicle {&offboard, std::unique_ptr<Histogram>(new Histogram())});
+    }
+
+    if (!_sender.is_running()) {
+        _sender.start(_rate_hz, std::bind(&OffboardFleetImpl::tick, this));
+    }
+    return Offboard::Result::SUCCESS;
+}
+
+void OffboardFleetImpl::remove(OffboardImpl &offboard)
+{
+    std::lock_guard<std::mutex> sender_lock(_sender_mutex);
+    bool empty;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = std::find_if(_vehicles.begin(), _vehicles.end(),
+        [&offboard](const Vehicle & vehicle) {
+            return vehicle.offboard == &offboard;
+        });
+        if (it == _vehicles.end()) {
+            return;
+        }
+        _vehicles.erase(it);
+        offboard.leave_fleet();
+        empty = _vehicles.empty();
+    }
+
+    if (empty) {
+        _sender.stop();
+    }
+}
+
+Offboard::Result OffboardFleetImpl::set_rate_hz(float rate_hz)
+{
+    if (!(rate_hz >= OffboardImpl::MIN_RATE_HZ && rate_hz <= OffboardImpl::MAX_RATE_HZ)) {
+        return Offboard::Result::INVALID_ARGUMENT;
+    }
+
+    std::lock_guard<std::mutex> sender_lock(_sender_mutex);
+    bool empty;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rate_hz = rate_hz;
+        empty = _vehicles.empty();
+    }
+
+    if (!empty) {
+        // A running sender is restarted with the new rate.
+        _sender.start(_rate_hz, std::bind(&OffboardFleetImpl::tick, this));
+    }
+    return Offboard::Result::SUCCESS;
+}
+
+OffboardFleet::Stats OffboardFleetImpl::stats() const
+{
+    OffboardFleet::Stats stats {};
+    stats.achieved_rate_hz = _sender.achieved_rate_hz();
+    stats.ticks = _sender.num_ticks();
+    stats.missed_deadlines = _sender.num_missed_ticks();
+    stats.batches_sent = _batches_sent.load(std::memory_order_relaxed);
+    stats.jitter = OffboardImpl::timing_stats_from_histogram(_sender.jitter_ns());
+    stats.tick_cpu = OffboardImpl::timing_stats_from_histogram(_tick_cpu_ns);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    stats.rate_hz = _rate_hz;
+    for (const auto &vehicle : _vehicles) {
+        OffboardFleet::VehicleStats vehicle_stats {};
+        vehicle_stats.uuid = vehicle.offboard->get_device_impl().get_target_uuid();
+        vehicle_stats.setpoints_sent = vehicle.phase_skew_ns->count();
+        vehicle_stats.phase_skew =
+            OffboardImpl::timing_stats_from_histogram(*vehicle.phase_skew_ns);
+        stats.vehicles.push_back(vehicle_stats);
+    }
+    return stats;
+}
+
+void OffboardFleetImpl::tick()
+{
+    const int64_t cpu_start_ns = thread_cpu_time_ns();
+    const auto tick_start = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Only grows, so there are no allocations once all vehicles were added.
+    _batch.resize(_vehicles.size());
+    _batch_vehicles.resize(_vehicles.size());
+
+    size_t batch_size = 0;
+    for (size_t i = 0; i < _vehicles.size(); ++i) {
+        if (_vehicles[i].offboard->pack_fleet_setpoint(_batch[batch_size])) {
+            _batch_vehicles[batch_size++] = i;
+        }
+    }
+
+    size_t begin = 0;
+    while (begin < batch_size) {
+        DeviceImpl &device = _vehicles[_batch_vehicles[begin]].offboard->get_device_impl();
+
+        size_t end = begin + 1;
+        while (end < batch_size &&
+               _vehicles[_batch_vehicles[end]].offboard->get_device_impl()
+               .shares_connections_with(device)) {
+            ++end;
+        }
+
+        device.send_messages(&_batch[begin], end - begin);
+        _batches_sent.fetch_add(1, std::memory_order_relaxed);
+
+        const int64_t skew_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - tick_start).count();
+        for (size_t i = begin; i < end; ++i) {
+            _vehicles[_batch_vehicles[i]].phase_skew_ns->record(uint64_t(skew_ns));
+        }
+
+        begin = end;
+    }
+
+    _tick_cpu_ns.record(uint64_t(std::max<int64_t>(thread_cpu_time_ns() - cpu_start_ns, 0)));
+}
+
+int64_t OffboardFleetImpl::thread_cpu_time_ns()
+{
+#ifndef WINDOWS
+    struct timespec ts {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    const int64_t seconds = ts.tv_sec;
+    return seconds * 1000000000 + ts.tv_nsec;
+#else
+    // Not available, the wall time is an upper bound.
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+} // namespace dronecore
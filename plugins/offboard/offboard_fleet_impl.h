@@ -0,0 +1,68 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "offboard_fleet.h"
+#include "offboard_impl.h"
+#include "histogram.h"
+#include "realtime_sender.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dronecore {
+
+// Sends the setpoints of all vehicles in the fleet on one tick of a
+// RealtimeSender, in one batch per group of vehicles sharing connections.
+class OffboardFleetImpl
+{
+public:
+    OffboardFleetImpl();
+    ~OffboardFleetImpl();
+
+    Offboard::Result add(OffboardImpl &offboard);
+    void remove(OffboardImpl &offboard);
+
+    Offboard::Result set_rate_hz(float rate_hz);
+
+    OffboardFleet::Stats stats() const;
+
+    // delete copy and move constructors and assign operators
+    OffboardFleetImpl(OffboardFleetImpl const &) = delete;            // Copy construct
+    OffboardFleetImpl(OffboardFleetImpl &&) = delete;                 // Move construct
+    OffboardFleetImpl &operator=(OffboardFleetImpl const &) = delete; // Copy assign
+    OffboardFleetImpl &operator=(OffboardFleetImpl &&) = delete;      // Move assign
+
+private:
+    void tick();
+
+    static int64_t thread_cpu_time_ns();
+
+    struct Vehicle {
+        OffboardImpl *offboard;
+        // Only recorded by the sender thread.
+        std::unique_ptr<Histogram> phase_skew_ns;
+    };
+
+    // Serializes starting and stopping the sender. It is never taken by the
+    // sender thread, so the sender can be stopped while holding it.
+    std::mutex _sender_mutex {};
+
+    // Taken by the sender thread on every tick, and before the mutex of a
+    // vehicle, never the other way around.
+    mutable std::mutex _mutex {};
+    // Vehicles sharing connections are kept next to each other.
+    std::vector<Vehicle> _vehicles {};
+    float _rate_hz = OffboardImpl::DEFAULT_RATE_HZ;
+
+    // Only used by the sender thread.
+    std::vector<mavlink_message_t> _batch {};
+    std::vector<size_t> _batch_vehicles {};
+
+    std::atomic<uint64_t> _batches_sent {0};
+    Histogram _tick_cpu_ns {};
+
+    RealtimeSender _sender {};
+};
+
+} // namespace dronecore
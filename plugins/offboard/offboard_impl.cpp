@@ -2,9 +2,31 @@
 #include "offboard_impl.h"
 #include "dronecore_impl.h"
 #include "px4_custom_mode.h"
+#include <chrono>
+#include <cstddef>
+#include <cstring>
 
 namespace dronecore {
 
+constexpr float OffboardImpl::DEFAULT_RATE_HZ;
+constexpr float OffboardImpl::MIN_RATE_HZ;
+constexpr float OffboardImpl::MAX_RATE_HZ;
+constexpr float OffboardImpl::IMMEDIATE_SEND_MAX_RATE_HZ;
+
+namespace {
+
+// Bits of the type mask of SET_POSITION_TARGET_LOCAL_NED.
+constexpr uint16_t IGNORE_X = (1 << 0);
+constexpr uint16_t IGNORE_Y = (1 << 1);
+constexpr uint16_t IGNORE_Z = (1 << 2);
+constexpr uint16_t IGNORE_AX = (1 << 6);
+constexpr uint16_t IGNORE_AY = (1 << 7);
+constexpr uint16_t IGNORE_AZ = (1 << 8);
+constexpr uint16_t IGNORE_YAW = (1 << 10);
+constexpr uint16_t IGNORE_YAW_RATE = (1 << 11);
+
+} // namespace
+
 OffboardImpl::OffboardImpl() {}
 
 OffboardImpl::~OffboardImpl() {}
@@ -25,7 +47,11 @@ void OffboardImpl::deinit()
 
 void OffboardImpl::enable() {}
 
-void OffboardImpl::disable() {}
+void OffboardImpl::disable()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    stop_sending_setpoints();
+}
 
 Offboard::Result OffboardImpl::start()
 {
@@ -158,150 +184,297 @@ void OffboardImpl::receive_command_result(MavlinkCommands::Result result,
 
 void OffboardImpl::set_velocity_ned(Offboard::VelocityNEDYaw velocity_ned_yaw)
 {
-    _mutex.lock();
-    _velocity_ned_yaw = velocity_ned_yaw;
-
-    if (_mode != Mode::VELOCITY_NED) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
+    mavlink_set_position_target_local_ned_t setpoint {};
+    setpoint.coordinate_frame = MAV_FRAME_LOCAL_NED;
+    setpoint.type_mask = IGNORE_X | IGNORE_Y | IGNORE_Z |
+                         IGNORE_AX | IGNORE_AY | IGNORE_AZ |
+                         IGNORE_YAW_RATE;
+    setpoint.vx = velocity_ned_yaw.north_m_s;
+    setpoint.vy = velocity_ned_yaw.east_m_s;
+    setpoint.vz = velocity_ned_yaw.down_m_s;
+    setpoint.yaw = to_rad_from_deg(velocity_ned_yaw.yaw_deg);
+
+    set_setpoint(Mode::VELOCITY_NED, setpoint);
+}
+
+void OffboardImpl::set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_yawspeed)
+{
+    mavlink_set_position_target_local_ned_t setpoint {};
+    setpoint.coordinate_frame = MAV_FRAME_BODY_NED;
+    setpoint.type_mask = IGNORE_X | IGNORE_Y | IGNORE_Z |
+                         IGNORE_AX | IGNORE_AY | IGNORE_AZ |
+                         IGNORE_YAW;
+    setpoint.vx = velocity_body_yawspeed.forward_m_s;
+    setpoint.vy = velocity_body_yawspeed.right_m_s;
+    setpoint.vz = velocity_body_yawspeed.down_m_s;
+    setpoint.yaw_rate = to_rad_from_deg(velocity_body_yawspeed.yawspeed_deg_s);
+
+    set_setpoint(Mode::VELOCITY_BODY, setpoint);
+}
+
+void OffboardImpl::set_setpoint(Mode mode,
+                                const mavlink_set_position_target_local_ned_t &setpoint)
+{
+    mavlink_set_position_target_local_ned_t targeted_setpoint = setpoint;
+    targeted_setpoint.target_system = _parent->get_target_system_id();
+    targeted_setpoint.target_component = _parent->get_target_component_id();
+
+    bool send_now;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _setpoint.store(targeted_setpoint);
+
+        if (_mode == Mode::NOT_ACTIVE || _mode == Mode::TRAJECTORY) {
+            // We automatically send setpoints from now on, starting right away.
+            _mode = mode;
+            start_sending_setpoints();
+            send_now = false;
+        } else {
+            // At high rates the next setpoint goes out soon enough anyway, in
+            // a fleet all setpoints go out together on its tick.
+            _mode = mode;
+            send_now = (_rate_hz < IMMEDIATE_SEND_MAX_RATE_HZ && !_in_fleet);
         }
-        // We automatically send NED setpoints from now on.
-        _parent->add_call_every([this]() { send_velocity_ned(); },
-        SEND_INTERVAL_S,
-        &_call_every_cookie);
+    }
 
-        _mode = Mode::VELOCITY_NED;
-    } else {
-        // We're already sending these kind of setpoints. Since the setpoint change, let's
-        // reschedule the next call, so we don't send setpoints too often.
-        _parent->reset_call_every(_call_every_cookie);
+    if (send_now) {
+        // Also send it right now to reduce latency.
+        targeted_setpoint.time_boot_ms = _parent->get_timesync().get_vehicle_time_boot_ms();
+
+        mavlink_message_t message;
+        mavlink_msg_set_position_target_local_ned_encode(_parent->get_own_system_id(),
+                                                         _parent->get_own_component_id(),
+                                                         &message,
+                                                         &targeted_setpoint);
+        _parent->send_message(message);
     }
-    _mutex.unlock();
+}
 
-    // also send it right now to reduce latency
-    send_velocity_ned();
+void OffboardImpl::send_setpoint()
+{
+    // This runs on the sender thread, which owns the template.
+    update_setpoint_template();
+    finalize_message_template();
+    _parent->send_message(_message_template);
 }
 
-void OffboardImpl::set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_yawspeed)
+bool OffboardImpl::update_setpoint_template()
 {
-    _mutex.lock();
-    _velocity_body_yawspeed = velocity_body_yawspeed;
-
-    if (_mode != Mode::VELOCITY_BODY) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
+    char *payload = _MAV_PAYLOAD_NON_CONST(&_message_template);
+
+    // The payload is laid out like the packed struct, which is what the
+    // MAVLink headers use on little endian machines as well.
+    const uint32_t version = _setpoint.version();
+    if (version != _template_version) {
+        const mavlink_set_position_target_local_ned_t setpoint = _setpoint.load();
+        std::memcpy(payload, &setpoint, MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_LEN);
+        _message_template.msgid = MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED;
+        _template_version = version;
+    }
+
+    const uint32_t time_boot_ms = _parent->get_timesync().get_vehicle_time_boot_ms();
+    std::memcpy(payload + offsetof(mavlink_set_position_target_local_ned_t, time_boot_ms),
+                &time_boot_ms, sizeof(time_boot_ms));
+    return true;
+}
+
+Offboard::Result
+OffboardImpl::append_trajectory(const std::vector<Offboard::TrajectorySample> &samples)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const bool new_trajectory = (_mode != Mode::TRAJECTORY);
+
+    std::vector<TrajectoryPoint> points;
+    if (!trajectory_points_from_samples(samples, new_trajectory ? -1 : _trajectory_last_time_ns,
+                                        points)) {
+        LogErr() << "Invalid trajectory samples";
+        return Offboard::Result::INVALID_ARGUMENT;
+    }
+
+    if (new_trajectory) {
+        // The buffer may only be reset while the sender thread is not using it.
+        _sender.stop();
+        _trajectory.clear();
+        _trajectory_start = std::chrono::steady_clock::now();
+    }
+
+    if (!_trajectory.push(points.data(), points.size())) {
+        if (new_trajectory && _mode != Mode::NOT_ACTIVE) {
+            // Keep sending what we sent before.
+            start_sending_setpoints();
         }
-        // We automatically send body setpoints from now on.
-        _parent->add_call_every([this]() { send_velocity_body(); },
-        SEND_INTERVAL_S,
-        &_call_every_cookie);
+        return Offboard::Result::BUSY;
+    }
+    _trajectory_last_time_ns = points.back().time_ns;
+
+    if (new_trajectory) {
+        _mode = Mode::TRAJECTORY;
+        start_sending_setpoints();
+    }
+    return Offboard::Result::SUCCESS;
+}
 
-        _mode = Mode::VELOCITY_BODY;
+void OffboardImpl::send_trajectory_setpoint()
+{
+    // This runs on the sender thread, which is the only consumer of the buffer.
+    if (!update_trajectory_template()) {
+        return;
+    }
+    finalize_message_template();
+    _parent->send_message(_message_template);
+}
+
+bool OffboardImpl::update_trajectory_template()
+{
+    const int64_t time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - _trajectory_start).count();
+
+    // Drop the samples we are past, but keep the last one to hold it.
+    while (_trajectory.size() >= 2 && _trajectory.peek(1).time_ns <= time_ns) {
+        _trajectory.pop();
+    }
+
+    const size_t size = _trajectory.size();
+    if (size == 0) {
+        return false;
+    }
+
+    TrajectoryPoint point;
+    if (size >= 2 && time_ns > _trajectory.peek(0).time_ns) {
+        point = interpolate_trajectory(_trajectory.peek(0), _trajectory.peek(1), time_ns);
     } else {
-        // We're already sending these kind of setpoints. Since the setpoint change, let's
-        // reschedule the next call, so we don't send setpoints too often.
-        _parent->reset_call_every(_call_every_cookie);
+        point = _trajectory.peek(0);
+        if (time_ns > point.time_ns) {
+            // After the end, stay at the last position.
+            for (unsigned i = 0; i < 3; ++i) {
+                point.velocity_m_s[i] = 0.0f;
+                point.acceleration_m_s2[i] = 0.0f;
+            }
+        }
     }
-    _mutex.unlock();
 
-    // also send it right now to reduce latency
-    send_velocity_body();
+    mavlink_set_position_target_local_ned_t setpoint {};
+    setpoint.time_boot_ms = _parent->get_timesync().get_vehicle_time_boot_ms();
+    setpoint.target_system = _parent->get_target_system_id();
+    setpoint.target_component = _parent->get_target_component_id();
+    setpoint.coordinate_frame = MAV_FRAME_LOCAL_NED;
+    setpoint.type_mask = IGNORE_YAW_RATE;
+    setpoint.x = point.position_m[0];
+    setpoint.y = point.position_m[1];
+    setpoint.z = point.position_m[2];
+    setpoint.vx = point.velocity_m_s[0];
+    setpoint.vy = point.velocity_m_s[1];
+    setpoint.vz = point.velocity_m_s[2];
+    setpoint.afx = point.acceleration_m_s2[0];
+    setpoint.afy = point.acceleration_m_s2[1];
+    setpoint.afz = point.acceleration_m_s2[2];
+    setpoint.yaw = point.yaw_rad;
+
+    std::memcpy(_MAV_PAYLOAD_NON_CONST(&_message_template), &setpoint,
+                MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_LEN);
+    _message_template.msgid = MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED;
+    // The template doesn't contain the velocity setpoint anymore.
+    _template_version = UINT32_MAX;
+    return true;
+}
+
+void OffboardImpl::finalize_message_template()
+{
+    // Sets the sequence number and checksum.
+    mavlink_finalize_message(&_message_template,
+                             _parent->get_own_system_id(),
+                             _parent->get_own_component_id(),
+                             MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_MIN_LEN,
+                             MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_LEN,
+                             MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_CRC);
+}
+
+Offboard::Result OffboardImpl::set_rate_hz(float rate_hz)
+{
+    if (!(rate_hz >= MIN_RATE_HZ && rate_hz <= MAX_RATE_HZ)) {
+        return Offboard::Result::INVALID_ARGUMENT;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rate_hz = rate_hz;
+    if (_mode != Mode::NOT_ACTIVE) {
+        start_sending_setpoints();
+    }
+    return Offboard::Result::SUCCESS;
+}
+
+Offboard::SenderStats OffboardImpl::sender_stats() const
+{
+    Offboard::SenderStats stats {};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        stats.rate_hz = _rate_hz;
+    }
+    stats.achieved_rate_hz = _sender.achieved_rate_hz();
+    stats.setpoints_sent = _sender.num_ticks();
+    stats.missed_deadlines = _sender.num_missed_ticks();
+    stats.jitter = timing_stats_from_histogram(_sender.jitter_ns());
+    stats.interval = timing_stats_from_histogram(_sender.interval_ns());
+    return stats;
+}
+
+bool OffboardImpl::join_fleet()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_in_fleet) {
+        return false;
+    }
+    _in_fleet = true;
+    _sender.stop();
+    return true;
 }
 
-void OffboardImpl::send_velocity_ned()
+void OffboardImpl::leave_fleet()
 {
-    const static uint16_t IGNORE_X = (1 << 0);
-    const static uint16_t IGNORE_Y = (1 << 1);
-    const static uint16_t IGNORE_Z = (1 << 2);
-    //const static uint16_t IGNORE_VX = (1 << 3);
-    //const static uint16_t IGNORE_VY = (1 << 4);
-    //const static uint16_t IGNORE_VZ = (1 << 5);
-    const static uint16_t IGNORE_AX = (1 << 6);
-    const static uint16_t IGNORE_AY = (1 << 7);
-    const static uint16_t IGNORE_AZ = (1 << 8);
-    //const static uint16_t IS_FORCE = (1 << 9);
-    //const static uint16_t IGNORE_YAW = (1 << 10);
-    const static uint16_t IGNORE_YAW_RATE = (1 << 11);
-
-    _mutex.lock();
-    const float yaw = to_rad_from_deg(_velocity_ned_yaw.yaw_deg);
-    const float yaw_rate = 0.0f;
-    const float x = 0.0f;
-    const float y = 0.0f;
-    const float z = 0.0f;
-    const float vx = _velocity_ned_yaw.north_m_s;
-    const float vy = _velocity_ned_yaw.east_m_s;
-    const float vz = _velocity_ned_yaw.down_m_s;
-    const float afx = 0.0f;
-    const float afy = 0.0f;
-    const float afz = 0.0f;
-    _mutex.unlock();
-
-    mavlink_message_t message;
-    mavlink_msg_set_position_target_local_ned_pack(_parent->get_own_system_id(),
-                                                   _parent->get_own_component_id(),
-                                                   &message,
-                                                   static_cast<uint32_t>(_parent->get_time().elapsed_s() * 1e3),
-                                                   _parent->get_target_system_id(),
-                                                   _parent->get_target_component_id(),
-                                                   MAV_FRAME_LOCAL_NED,
-                                                   IGNORE_X | IGNORE_Y | IGNORE_Z |
-                                                   IGNORE_AX | IGNORE_AY | IGNORE_AZ |
-                                                   IGNORE_YAW_RATE,
-                                                   x, y, z, vx, vy, vz, afx, afy, afz,
-                                                   yaw, yaw_rate);
-    _parent->send_message(message);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _in_fleet = false;
+    if (_mode != Mode::NOT_ACTIVE) {
+        start_sending_setpoints();
+    }
 }
 
-void OffboardImpl::send_velocity_body()
+bool OffboardImpl::pack_fleet_setpoint(mavlink_message_t &message)
 {
+    // Our own sender is stopped while in a fleet, so the fleet owns the
+    // template. The lock keeps append_trajectory() from clearing the buffer
+    // under our feet.
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    const static uint16_t IGNORE_X = (1 << 0);
-    const static uint16_t IGNORE_Y = (1 << 1);
-    const static uint16_t IGNORE_Z = (1 << 2);
-    //const static uint16_t IGNORE_VX = (1 << 3);
-    //const static uint16_t IGNORE_VY = (1 << 4);
-    //const static uint16_t IGNORE_VZ = (1 << 5);
-    const static uint16_t IGNORE_AX = (1 << 6);
-    const static uint16_t IGNORE_AY = (1 << 7);
-    const static uint16_t IGNORE_AZ = (1 << 8);
-    //const static uint16_t IS_FORCE = (1 << 9);
-    const static uint16_t IGNORE_YAW = (1 << 10);
-    //const static uint16_t IGNORE_YAW_RATE = (1 << 11);
-
-
-    _mutex.lock();
-    const float yaw = 0.0f;
-    const float yaw_rate = to_rad_from_deg(_velocity_body_yawspeed.yawspeed_deg_s);
-    const float x = 0.0f;
-    const float y = 0.0f;
-    const float z = 0.0f;
-    const float vx = _velocity_body_yawspeed.forward_m_s;
-    const float vy = _velocity_body_yawspeed.right_m_s;
-    const float vz = _velocity_body_yawspeed.down_m_s;
-    const float afx = 0.0f;
-    const float afy = 0.0f;
-    const float afz = 0.0f;
-    _mutex.unlock();
-
-    mavlink_message_t message;
-    mavlink_msg_set_position_target_local_ned_pack(_parent->get_own_system_id(),
-                                                   _parent->get_own_component_id(),
-                                                   &message,
-                                                   static_cast<uint32_t>(_parent->get_time().elapsed_s() * 1e3),
-                                                   _parent->get_target_system_id(),
-                                                   _parent->get_target_component_id(),
-                                                   MAV_FRAME_BODY_NED,
-                                                   IGNORE_X | IGNORE_Y | IGNORE_Z |
-                                                   IGNORE_AX | IGNORE_AY | IGNORE_AZ |
-                                                   IGNORE_YAW,
-                                                   x, y, z, vx, vy, vz, afx, afy, afz,
-                                                   yaw, yaw_rate);
-    _parent->send_message(message);
+    bool has_setpoint;
+    switch (_mode) {
+        case Mode::NOT_ACTIVE:
+            return false;
+        case Mode::TRAJECTORY:
+            has_setpoint = update_trajectory_template();
+            break;
+        default:
+            has_setpoint = update_setpoint_template();
+            break;
+    }
+    if (!has_setpoint) {
+        return false;
+    }
+
+    finalize_message_template();
+    message = _message_template;
+    return true;
+}
+
+Offboard::TimingStats OffboardImpl::timing_stats_from_histogram(const Histogram &histogram)
+{
+    Offboard::TimingStats stats {};
+    stats.mean_us = histogram.mean() * 1e-3;
+    stats.p50_us = double(histogram.percentile(50.0)) * 1e-3;
+    stats.p90_us = double(histogram.percentile(90.0)) * 1e-3;
+    stats.p99_us = double(histogram.percentile(99.0)) * 1e-3;
+    stats.max_us = double(histogram.max()) * 1e-3;
+    return stats;
 }
 
 void OffboardImpl::process_heartbeat(const mavlink_message_t &message)
@@ -330,14 +503,28 @@ void OffboardImpl::process_heartbeat(const mavlink_message_t &message)
     }
 }
 
-void OffboardImpl::stop_sending_setpoints()
+void OffboardImpl::start_sending_setpoints()
 {
     // We assume that we already acquired the mutex in this function.
 
-    if (_call_every_cookie != nullptr) {
-        _parent->remove_call_every(_call_every_cookie);
-        _call_every_cookie = nullptr;
+    if (_in_fleet) {
+        // The fleet sends the setpoints.
+        return;
+    }
+
+    // A running sender is restarted with the new rate.
+    if (_mode == Mode::TRAJECTORY) {
+        _sender.start(_rate_hz, std::bind(&OffboardImpl::send_trajectory_setpoint, this));
+    } else {
+        _sender.start(_rate_hz, std::bind(&OffboardImpl::send_setpoint, this));
     }
+}
+
+void OffboardImpl::stop_sending_setpoints()
+{
+    // We assume that we already acquired the mutex in this function.
+
+    _sender.stop();
     _mode = Mode::NOT_ACTIVE;
 }
 
@@ -4,7 +4,12 @@
 #include "mavlink_include.h"
 #include "device_impl.h"
 #include "offboard.h"
+#include "offboard_trajectory.h"
+#include "realtime_sender.h"
+#include "seqlock.h"
+#include "spsc_ring_buffer.h"
 #include <mutex>
+#include <vector>
 
 namespace dronecore {
 
@@ -31,9 +36,46 @@ public:
     void set_velocity_ned(Offboard::VelocityNEDYaw velocity_ned_yaw);
     void set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_yawspeed);
 
+    Offboard::Result append_trajectory(const std::vector<Offboard::TrajectorySample> &samples);
+
+    Offboard::Result set_rate_hz(float rate_hz);
+    Offboard::SenderStats sender_stats() const;
+
+    // While in a fleet, the setpoints are sent on the tick of the fleet
+    // instead of by our own sender. Returns false if already in a fleet.
+    bool join_fleet();
+    void leave_fleet();
+
+    // Called on the tick of the fleet, returns false if there is nothing to send.
+    bool pack_fleet_setpoint(mavlink_message_t &message);
+
+    DeviceImpl &get_device_impl() const { return *_parent; }
+
+    static Offboard::TimingStats timing_stats_from_histogram(const Histogram &histogram);
+
+    static constexpr float DEFAULT_RATE_HZ = 10.0f;
+    static constexpr float MIN_RATE_HZ = 2.0f;
+    static constexpr float MAX_RATE_HZ = 1000.0f;
+
+    // Up to this rate a new setpoint is also sent right away.
+    static constexpr float IMMEDIATE_SEND_MAX_RATE_HZ = 50.0f;
+
 private:
-    void send_velocity_ned();
-    void send_velocity_body();
+    enum class Mode {
+        NOT_ACTIVE,
+        VELOCITY_NED,
+        VELOCITY_BODY,
+        TRAJECTORY
+    };
+
+    void set_setpoint(Mode mode, const mavlink_set_position_target_local_ned_t &setpoint);
+    void send_setpoint();
+    void send_trajectory_setpoint();
+
+    // Return false if there is no setpoint.
+    bool update_setpoint_template();
+    bool update_trajectory_template();
+    void finalize_message_template();
 
     void process_heartbeat(const mavlink_message_t &message);
     void receive_command_result(MavlinkCommands::Result result,
@@ -42,20 +84,33 @@ private:
     static Offboard::Result offboard_result_from_command_result(
         MavlinkCommands::Result result);
 
+    void start_sending_setpoints();
     void stop_sending_setpoints();
 
+
     mutable std::mutex _mutex {};
-    enum class Mode {
-        NOT_ACTIVE,
-        VELOCITY_NED,
-        VELOCITY_BODY
-    } _mode = Mode::NOT_ACTIVE;
-    Offboard::VelocityNEDYaw _velocity_ned_yaw {};
-    Offboard::VelocityBodyYawspeed _velocity_body_yawspeed {};
+    Mode _mode = Mode::NOT_ACTIVE;
+    float _rate_hz = DEFAULT_RATE_HZ;
+
+    // The setpoint as it is sent, read by the sender thread without locking.
+    SeqLock<mavlink_set_position_target_local_ned_t> _setpoint {};
+
+    // Set while a fleet sends the setpoints.
+    bool _in_fleet = false;
+
+    // Only used by the sender thread (or the one of the fleet), the message is
+    // only patched with the current setpoint and time every tick instead of
+    // being packed again.
+    mavlink_message_t _message_template {};
+    uint32_t _template_version = UINT32_MAX;
 
-    void *_call_every_cookie = nullptr;
+    // Written by append_trajectory() and consumed by the sender thread.
+    SpscRingBuffer<TrajectoryPoint> _trajectory {Offboard::TRAJECTORY_BUFFER_SIZE};
+    // Only changed while the sender is stopped.
+    std::chrono::steady_clock::time_point _trajectory_start {};
+    int64_t _trajectory_last_time_ns = -1;
 
-    const float SEND_INTERVAL_S = 0.1f;
+    RealtimeSender _sender {};
 };
 
 } // namespace dronecore
@@ -0,0 +1,104 @@
+#include "offboard_trajectory.h"
+#include "global_include.h"
+#include <algorithm>
+#include <cmath>
+
+namespace dronecore {
+
+namespace {
+
+bool is_finite(const Offboard::TrajectorySample &sample)
+{
+    return std::isfinite(sample.time_s) &&
+           std::isfinite(sample.north_m) && std::isfinite(sample.east_m) &&
+           std::isfinite(sample.down_m) &&
+           std::isfinite(sample.velocity_north_m_s) && std::isfinite(sample.velocity_east_m_s) &&
+           std::isfinite(sample.velocity_down_m_s) &&
+           std::isfinite(sample.acceleration_north_m_s2) &&
+           std::isfinite(sample.acceleration_east_m_s2) &&
+           std::isfinite(sample.acceleration_down_m_s2) &&
+           std::isfinite(sample.yaw_deg);
+}
+
+// About 30 years, far away from overflowing.
+constexpr double MAX_TIME_S = 1e9;
+
+} // namespace
+
+bool trajectory_points_from_samples(const std::vector<Offboard::TrajectorySample> &samples,
+                                    int64_t after_time_ns, std::vector<TrajectoryPoint> &points)
+{
+    points.clear();
+    if (samples.empty()) {
+        return false;
+    }
+    points.reserve(samples.size());
+
+    int64_t last_time_ns = after_time_ns;
+    for (const auto &sample : samples) {
+        if (!is_finite(sample) || sample.time_s < 0.0 || sample.time_s > MAX_TIME_S) {
+            return false;
+        }
+
+        TrajectoryPoint point {};
+        point.time_ns = int64_t(std::llround(sample.time_s * 1e9));
+        if (point.time_ns <= last_time_ns) {
+            return false;
+        }
+        last_time_ns = point.time_ns;
+
+        point.position_m[0] = sample.north_m;
+        point.position_m[1] = sample.east_m;
+        point.position_m[2] = sample.down_m;
+        point.velocity_m_s[0] = sample.velocity_north_m_s;
+        point.velocity_m_s[1] = sample.velocity_east_m_s;
+        point.velocity_m_s[2] = sample.velocity_down_m_s;
+        point.acceleration_m_s2[0] = sample.acceleration_north_m_s2;
+        point.acceleration_m_s2[1] = sample.acceleration_east_m_s2;
+        point.acceleration_m_s2[2] = sample.acceleration_down_m_s2;
+        point.yaw_rad = to_rad_from_deg(sample.yaw_deg);
+        points.push_back(point);
+    }
+    return true;
+}
+
+TrajectoryPoint interpolate_trajectory(const TrajectoryPoint &from, const TrajectoryPoint &to,
+                                       int64_t time_ns)
+{
+    const float duration_s = float(double(to.time_ns - from.time_ns) * 1e-9);
+    float s = float(double(time_ns - from.time_ns) / double(to.time_ns - from.time_ns));
+    s = std::min(std::max(s, 0.0f), 1.0f);
+
+    const float s2 = s * s;
+    const float s3 = s2 * s;
+
+    // Hermite basis functions and their derivatives.
+    const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    const float h10 = s3 - 2.0f * s2 + s;
+    const float h01 = -2.0f * s3 + 3.0f * s2;
+    const float h11 = s3 - s2;
+    const float dh00 = 6.0f * s2 - 6.0f * s;
+    const float dh10 = 3.0f * s2 - 4.0f * s + 1.0f;
+    const float dh01 = -6.0f * s2 + 6.0f * s;
+    const float dh11 = 3.0f * s2 - 2.0f * s;
+
+    TrajectoryPoint point {};
+    point.time_ns = time_ns;
+    for (unsigned i = 0; i < 3; ++i) {
+        point.position_m[i] = h00 * from.position_m[i] +
+                              h10 * duration_s * from.velocity_m_s[i] +
+                              h01 * to.position_m[i] +
+                              h11 * duration_s * to.velocity_m_s[i];
+        point.velocity_m_s[i] = (dh00 * from.position_m[i] + dh01 * to.position_m[i]) /
+                                duration_s +
+                                dh10 * from.velocity_m_s[i] + dh11 * to.velocity_m_s[i];
+        point.acceleration_m_s2[i] = from.acceleration_m_s2[i] +
+                                     s * (to.acceleration_m_s2[i] - from.acceleration_m_s2[i]);
+    }
+
+    const float yaw_difference = std::remainder(to.yaw_rad - from.yaw_rad, 2.0f * M_PI_F);
+    point.yaw_rad = std::remainder(from.yaw_rad + s * yaw_difference, 2.0f * M_PI_F);
+    return point;
+}
+
+} // namespace dronecore
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "offboard.h"
+#include <cstdint>
+#include <vector>
+
+namespace dronecore {
+
+// A trajectory sample as it is kept for the sender thread, in the units of
+// SET_POSITION_TARGET_LOCAL_NED.
+struct TrajectoryPoint {
+    // Since the start of the trajectory.
+    int64_t time_ns;
+    float position_m[3];
+    float velocity_m_s[3];
+    float acceleration_m_s2[3];
+    float yaw_rad;
+};
+
+// Converts samples appended after the point at after_time_ns. Returns false if
+// the samples are empty, not finite or their times are not increasing.
+bool trajectory_points_from_samples(const std::vector<Offboard::TrajectorySample> &samples,
+                                    int64_t after_time_ns, std::vector<TrajectoryPoint> &points);
+
+// The position is interpolated with a cubic Hermite spline, so it matches
+// position and velocity at both points, and the velocity is its derivative.
+// The acceleration is interpolated linearly and the yaw along the shorter way.
+TrajectoryPoint interpolate_trajectory(const TrajectoryPoint &from, const TrajectoryPoint &to,
+                                       int64_t time_ns);
+
+} // namespace dronecore
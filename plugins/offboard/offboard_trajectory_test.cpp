@@ -0,0 +1,93 @@
+#include "offboard_trajectory.h"
+#include "global_include.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+Offboard::TrajectorySample sample(double time_s, float north_m, float velocity_north_m_s,
+                                  float yaw_deg)
+{
+    Offboard::TrajectorySample result {};
+    result.time_s = time_s;
+    result.north_m = north_m;
+    result.velocity_north_m_s = velocity_north_m_s;
+    result.yaw_deg = yaw_deg;
+    return result;
+}
+
+} // namespace
+
+TEST(OffboardTrajectory, ConvertsSamples)
+{
+    std::vector<TrajectoryPoint> points;
+    ASSERT_TRUE(trajectory_points_from_samples({sample(0.0, 1.0f, 2.0f, 90.0f),
+                                                sample(0.5, 2.0f, 2.0f, 90.0f)
+                                               }, -1, points));
+    ASSERT_EQ(points.size(), 2u);
+    EXPECT_EQ(points[0].time_ns, 0);
+    EXPECT_EQ(points[1].time_ns, 500000000);
+    EXPECT_EQ(points[1].position_m[0], 2.0f);
+    EXPECT_EQ(points[1].velocity_m_s[0], 2.0f);
+    EXPECT_NEAR(points[1].yaw_rad, M_PI_F / 2.0f, 1e-6f);
+}
+
+TEST(OffboardTrajectory, RejectsInvalidSamples)
+{
+    std::vector<TrajectoryPoint> points;
+    EXPECT_FALSE(trajectory_points_from_samples({}, -1, points));
+    EXPECT_FALSE(trajectory_points_from_samples({sample(-1.0, 0.0f, 0.0f, 0.0f)}, -1, points));
+    EXPECT_FALSE(trajectory_points_from_samples({sample(0.0, NAN, 0.0f, 0.0f)}, -1, points));
+
+    // Times need to increase, also across appended segments.
+    EXPECT_FALSE(trajectory_points_from_samples({sample(1.0, 0.0f, 0.0f, 0.0f),
+                                                 sample(1.0, 0.0f, 0.0f, 0.0f)
+                                                }, -1, points));
+    EXPECT_FALSE(trajectory_points_from_samples({sample(1.0, 0.0f, 0.0f, 0.0f)},
+                                                1000000000, points));
+    EXPECT_TRUE(trajectory_points_from_samples({sample(1.5, 0.0f, 0.0f, 0.0f)},
+                                               1000000000, points));
+}
+
+TEST(OffboardTrajectory, InterpolatesSpline)
+{
+    std::vector<TrajectoryPoint> points;
+    // Constant acceleration of 2 m/s^2 from standstill: x = t^2, v = 2t.
+    ASSERT_TRUE(trajectory_points_from_samples({sample(0.0, 0.0f, 0.0f, 0.0f),
+                                                sample(2.0, 4.0f, 4.0f, 0.0f)
+                                               }, -1, points));
+    points[0].acceleration_m_s2[0] = 2.0f;
+    points[1].acceleration_m_s2[0] = 2.0f;
+
+    for (double t = 0.0; t <= 2.0; t += 0.25) {
+        const TrajectoryPoint point = interpolate_trajectory(points[0], points[1],
+                                                             int64_t(t * 1e9));
+        // A cubic spline reproduces the parabola exactly.
+        EXPECT_NEAR(point.position_m[0], t * t, 1e-5);
+        EXPECT_NEAR(point.velocity_m_s[0], 2.0 * t, 1e-5);
+        EXPECT_NEAR(point.acceleration_m_s2[0], 2.0f, 1e-6f);
+        EXPECT_EQ(point.position_m[1], 0.0f);
+    }
+
+    // The ends match the samples.
+    const TrajectoryPoint end = interpolate_trajectory(points[0], points[1], points[1].time_ns);
+    EXPECT_FLOAT_EQ(end.position_m[0], 4.0f);
+    EXPECT_FLOAT_EQ(end.velocity_m_s[0], 4.0f);
+}
+
+TEST(OffboardTrajectory, InterpolatesYawTheShortWay)
+{
+    std::vector<TrajectoryPoint> points;
+    ASSERT_TRUE(trajectory_points_from_samples({sample(0.0, 0.0f, 0.0f, 170.0f),
+                                                sample(1.0, 0.0f, 0.0f, -170.0f)
+                                               }, -1, points));
+
+    const TrajectoryPoint middle = interpolate_trajectory(points[0], points[1], 500000000);
+    EXPECT_NEAR(std::fabs(middle.yaw_rad), M_PI_F, 1e-5f);
+
+    const TrajectoryPoint quarter = interpolate_trajectory(points[0], points[1], 250000000);
+    EXPECT_NEAR(quarter.yaw_rad, to_rad_from_deg(175.0f), 1e-5f);
+}
@@ -101,6 +101,71 @@ void Telemetry::set_rate_rc_status_async(double rate_hz, result_callback_t callb
     _impl->set_rate_rc_status_async(rate_hz, callback);
 }
 
+Telemetry::DemandConfig Telemetry::get_demand_config() const
+{
+    return _impl->get_demand_config();
+}
+
+bool Telemetry::set_demand_config(const DemandConfig &config)
+{
+    return _impl->set_demand_config(config);
+}
+
+void Telemetry::set_stream_policy(Stream stream, StreamPolicy policy)
+{
+    _impl->set_stream_policy(stream, policy);
+}
+
+Telemetry::DemandStats Telemetry::get_demand_stats() const
+{
+    return _impl->get_demand_stats();
+}
+
+bool Telemetry::set_rate_profile(const std::string &name, const std::vector<StreamRate> &rates)
+{
+    return _impl->set_rate_profile(name, rates);
+}
+
+Telemetry::Result Telemetry::apply_rate_profile(const std::string &name)
+{
+    return _impl->apply_rate_profile(name);
+}
+
+void Telemetry::apply_rate_profile_async(const std::string &name, result_callback_t callback)
+{
+    _impl->apply_rate_profile_async(name, callback);
+}
+
+Telemetry::RateProfileStatus Telemetry::get_rate_profile_status() const
+{
+    return _impl->get_rate_profile_status();
+}
+
+Telemetry::AdaptiveRateConfig Telemetry::get_adaptive_rate_config() const
+{
+    return _impl->get_adaptive_rate_config();
+}
+
+bool Telemetry::set_adaptive_rate_config(const AdaptiveRateConfig &config)
+{
+    return _impl->set_adaptive_rate_config(config);
+}
+
+void Telemetry::set_stream_priority(Stream stream, unsigned priority, double min_rate_hz)
+{
+    _impl->set_stream_priority(stream, priority, min_rate_hz);
+}
+
+Telemetry::AdaptiveRateStats Telemetry::get_adaptive_rate_stats() const
+{
+    return _impl->get_adaptive_rate_stats();
+}
+
+Telemetry::TimingStats Telemetry::get_timing_stats() const
+{
+    return _impl->get_timing_stats();
+}
+
 Telemetry::Position Telemetry::position() const
 {
     return _impl->get_position();
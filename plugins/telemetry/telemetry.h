@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace dronecore {
 
@@ -309,6 +312,284 @@ public:
      */
     void set_rate_rc_status_async(double rate_hz, result_callback_t callback);
 
+    /**
+     * @brief Telemetry streams, each sent by the vehicle as one MAVLink message.
+     */
+    enum class Stream {
+        POSITION, /**< @brief Position and ground speed. */
+        HOME_POSITION, /**< @brief Home position, also needed for the health. */
+        IN_AIR, /**< @brief In-air state. */
+        ATTITUDE, /**< @brief Attitude. */
+        CAMERA_ATTITUDE, /**< @brief Camera attitude. */
+        GPS_INFO, /**< @brief GPS information, also needed for the health. */
+        BATTERY, /**< @brief Battery status. */
+        RC_STATUS /**< @brief RC status. */
+    };
+
+    /**
+     * @brief Whether a stream follows the demand.
+     * @sa set_stream_policy()
+     */
+    enum class StreamPolicy {
+        ON_DEMAND, /**< @brief Lowered while it is not used (default). */
+        ALWAYS /**< @brief Never lowered. */
+    };
+
+    /**
+     * @brief Configuration of demand-driven stream rates.
+     *
+     * A stream is in use while a callback is subscribed to it, its policy is
+     * StreamPolicy::ALWAYS, another plugin needs its message, or one of its getters was called
+     * within the last `unused_timeout_s`. Streams which are not in use for longer are lowered to
+     * `unused_rate_hz`. They are raised back to their previous rate within a second of being
+     * used again. Until then, a getter called after a long pause can return an old value.
+     *
+     * @sa get_demand_config(), set_demand_config()
+     */
+    struct DemandConfig {
+        bool enabled = false; /**< @brief Whether the stream rates follow the demand. */
+        double unused_timeout_s = 10.0; /**< @brief Time until an unused stream is lowered. */
+        double unused_rate_hz = 0.0; /**< @brief Rate of unused streams, 0 stops them. */
+    };
+
+    /**
+     * @brief Gets the configuration of demand-driven stream rates.
+     * @return Current configuration.
+     * @sa set_demand_config()
+     */
+    DemandConfig get_demand_config() const;
+
+    /**
+     * @brief Sets the configuration of demand-driven stream rates.
+     *
+     * Disabling it raises all lowered streams back to their previous rate.
+     *
+     * @param config Configuration to be applied.
+     * @return `true` if the configuration is applied, `false` if the timeout is not positive or
+     *         the rate is negative.
+     * @sa get_demand_config()
+     */
+    bool set_demand_config(const DemandConfig &config);
+
+    /**
+     * @brief Sets whether a stream follows the demand.
+     *
+     * @param stream Stream to set the policy of.
+     * @param policy Policy of the stream.
+     */
+    void set_stream_policy(Stream stream, StreamPolicy policy);
+
+    /**
+     * @brief Demand of one stream.
+     */
+    struct StreamDemand {
+        Stream stream; /**< @brief The stream. */
+        bool in_use; /**< @brief Whether the stream is currently in use. */
+        bool lowered; /**< @brief Whether the stream is lowered. */
+        double rate_hz; /**< @brief Rate at which the stream is currently received, in Hz. */
+        double saved_bytes_s; /**< @brief Bandwidth saved by lowering it, in bytes/second. */
+    };
+
+    /**
+     * @brief Demand of all streams.
+     */
+    struct DemandStats {
+        double saved_bytes_s; /**< @brief Bandwidth saved in total, in bytes/second. */
+        std::vector<StreamDemand> streams; /**< @brief Demand of each stream. */
+    };
+
+    /**
+     * @brief Returns the demand of the streams and the bandwidth saved.
+     *
+     * The bandwidth saved is what the lowered streams used before they were lowered minus what
+     * they use now.
+     *
+     * @return Demand statistics.
+     */
+    DemandStats get_demand_stats() const;
+
+    /**
+     * @brief Rate of one stream in a rate profile.
+     */
+    struct StreamRate {
+        Stream stream; /**< @brief The stream. */
+        double rate_hz; /**< @brief Rate in Hz, 0 stops the stream. */
+    };
+
+    /**
+     * @brief Adds a named rate profile, or replaces the one with that name.
+     *
+     * The profiles "control-loop" (position and attitude at 50 Hz) and "low-bandwidth"
+     * (everything at 1 Hz or less) are there from the start and can be replaced as well.
+     * Streams which are not in a profile keep their rate when it is applied.
+     *
+     * @param name Name of the profile.
+     * @param rates Rates of the streams in the profile.
+     * @return `true` if the profile is added, `false` if the name is empty, a rate is negative,
+     *         or a stream is in there more than once.
+     * @sa apply_rate_profile_async()
+     */
+    bool set_rate_profile(const std::string &name, const std::vector<StreamRate> &rates);
+
+    /**
+     * @brief Applies a rate profile (synchronous).
+     *
+     * @param name Name of the profile.
+     * @return Result of request.
+     * @sa apply_rate_profile_async()
+     */
+    Result apply_rate_profile(const std::string &name);
+
+    /**
+     * @brief Applies a rate profile (asynchronous).
+     *
+     * All rates of the profile are requested at once instead of one after the other. Whether
+     * they took effect is then checked on the messages received, which takes a few seconds,
+     * and the rates which do not match are requested again. The result is Result::SUCCESS
+     * once all rates match, and Result::TIMEOUT if some still do not after 3 attempts.
+     * Applying another profile in the meantime gives up the first one, its callback gets
+     * Result::BUSY.
+     *
+     * @param name Name of the profile.
+     * @param callback Callback to receive request result.
+     * @sa get_rate_profile_status()
+     */
+    void apply_rate_profile_async(const std::string &name, result_callback_t callback);
+
+    /**
+     * @brief Rate of one stream of the applied profile, as observed.
+     */
+    struct StreamRateStatus {
+        Stream stream; /**< @brief The stream. */
+        double rate_hz; /**< @brief Rate in the profile, in Hz. */
+        double observed_rate_hz; /**< @brief Rate last observed, in Hz. */
+        bool verified; /**< @brief Whether the observed rate matched. */
+    };
+
+    /**
+     * @brief State of the profile applied last.
+     */
+    struct RateProfileStatus {
+        std::string name; /**< @brief Name of the profile, empty if none was applied. */
+        bool applying; /**< @brief Whether the rates are still being checked. */
+        std::vector<StreamRateStatus> streams; /**< @brief Each stream of the profile. */
+    };
+
+    /**
+     * @brief Returns the state of the profile applied last.
+     *
+     * @return Rate profile status.
+     */
+    RateProfileStatus get_rate_profile_status() const;
+
+    /**
+     * @brief Configuration of stream rates adapting to the link.
+     *
+     * The link counts as congested while more than `max_loss_rate` of the messages are lost, or
+     * while a telemetry radio reports less than `min_radio_txbuf_percent` free space in its
+     * transmit buffer. Streams are then scaled down, the ones with the lowest priority first
+     * and none below its minimum rate, until what is received fits what the link carried. Once
+     * the link is not congested for `recovery_s`, the streams are raised step by step back to
+     * their rates.
+     *
+     * @sa get_adaptive_rate_config(), set_adaptive_rate_config(), set_stream_priority()
+     */
+    struct AdaptiveRateConfig {
+        bool enabled = false; /**< @brief Whether the stream rates adapt to the link. */
+        double max_loss_rate = 0.05; /**< @brief Share of lost messages that means congestion. */
+        double min_radio_txbuf_percent = 30.0; /**< @brief Free radio buffer that is too low. */
+        double recovery_s = 5.0; /**< @brief Time without congestion before raising again. */
+    };
+
+    /**
+     * @brief Gets the configuration of stream rates adapting to the link.
+     * @return Current configuration.
+     * @sa set_adaptive_rate_config()
+     */
+    AdaptiveRateConfig get_adaptive_rate_config() const;
+
+    /**
+     * @brief Sets the configuration of stream rates adapting to the link.
+     *
+     * Disabling it raises all scaled down streams back to their rates.
+     *
+     * @param config Configuration to be applied.
+     * @return `true` if the configuration is applied, `false` if a value is out of range.
+     * @sa get_adaptive_rate_config()
+     */
+    bool set_adaptive_rate_config(const AdaptiveRateConfig &config);
+
+    /**
+     * @brief Sets how important a stream is when the link is congested.
+     *
+     * By default, position, in-air state and battery have priority 2 and keep at least 1 Hz,
+     * attitude, GPS information and RC status have priority 1, and the rest priority 0. All
+     * but the first three can be scaled down to 0.
+     *
+     * @param stream Stream to set the priority of.
+     * @param priority Priority, streams with a higher one are scaled down last.
+     * @param min_rate_hz Rate in Hz the stream is never scaled down below.
+     */
+    void set_stream_priority(Stream stream, unsigned priority, double min_rate_hz);
+
+    /**
+     * @brief State of the stream rates adapting to the link.
+     */
+    struct AdaptiveRateStats {
+        bool congested; /**< @brief Whether the link was congested at the last check. */
+        double budget_bytes_s; /**< @brief Bandwidth allowed, infinite while not limited. */
+        double throughput_bytes_s; /**< @brief Bandwidth received from the vehicle. */
+        double loss_rate; /**< @brief Share of messages lost (0..1). */
+        double radio_txbuf_percent; /**< @brief Free radio transmit buffer, NaN without radio. */
+        std::vector<StreamRate> scaled_streams; /**< @brief Streams scaled down, with rates. */
+    };
+
+    /**
+     * @brief Returns the state of the stream rates adapting to the link.
+     *
+     * @return Adaptive rate statistics.
+     */
+    AdaptiveRateStats get_adaptive_rate_stats() const;
+
+    /**
+     * @brief When the last sample of a stream was taken and received.
+     *
+     * Host times are seconds of the steady clock of the host, the clock of
+     * `std::chrono::steady_clock`, which is the same for all vehicles. Vehicle times are
+     * converted to it using TIMESYNC. Until the clocks are synced, the sample time and the
+     * latencies are NaN.
+     *
+     * The messages of the in-air state and the battery carry no timestamp. For them, the vehicle
+     * time is when the sample was received and the latency is NaN.
+     */
+    struct StreamTiming {
+        Stream stream; /**< @brief Stream. */
+        uint64_t vehicle_time_us; /**< @brief Vehicle time since boot, 0 if unknown. */
+        double receive_time_s; /**< @brief Host time the sample was received at. */
+        double sample_time_s; /**< @brief Host time the vehicle took the sample at. */
+        double age_s; /**< @brief Time since the sample was taken, or else received. */
+        double latency_ms; /**< @brief Mean time from taking samples to receiving them. */
+        double max_latency_ms; /**< @brief Largest time from taking to receiving a sample. */
+    };
+
+    /**
+     * @brief Alignment of the vehicle clock and timing of the streams received.
+     */
+    struct TimingStats {
+        bool time_synced; /**< @brief Whether the clocks are synced using TIMESYNC. */
+        double clock_offset_s; /**< @brief Vehicle clock minus host clock, NaN until synced. */
+        double clock_drift_ppm; /**< @brief How much faster the vehicle clock runs. */
+        double round_trip_ms; /**< @brief Round trip time of the link to the vehicle. */
+        std::vector<StreamTiming> streams; /**< @brief Streams received so far. */
+    };
+
+    /**
+     * @brief Returns the alignment of the vehicle clock and the timing of the streams.
+     *
+     * @return Timing statistics.
+     */
+    TimingStats get_timing_stats() const;
+
     /**
      * @brief Get the current position (synchronous).
      *
@@ -0,0 +1,159 @@
+#include "telemetry_demand.h"
+#include <algorithm>
+
+namespace dronecore {
+
+constexpr unsigned TelemetryDemand::NUM_STREAMS;
+constexpr double TelemetryDemand::MIN_RATE_RATIO;
+
+Telemetry::DemandConfig TelemetryDemand::get_config() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _config;
+}
+
+void TelemetryDemand::set_config(const Telemetry::DemandConfig &config)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _config = config;
+}
+
+void TelemetryDemand::set_policy(Telemetry::Stream stream, Telemetry::StreamPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    state(stream).policy = policy;
+}
+
+void TelemetryDemand::set_subscribed(Telemetry::Stream stream, bool subscribed)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    state(stream).subscribed = subscribed;
+}
+
+void TelemetryDemand::set_used_elsewhere(Telemetry::Stream stream, bool used_elsewhere)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    state(stream).used_elsewhere = used_elsewhere;
+}
+
+void TelemetryDemand::touch(Telemetry::Stream stream, double time_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    state(stream).last_used_s = time_s;
+}
+
+void TelemetryDemand::set_requested_rate(Telemetry::Stream stream, double rate_hz, double time_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    State &s = state(stream);
+    s.requested_rate_hz = rate_hz;
+    s.last_used_s = time_s;
+    s.lowered = false;
+}
+
+void TelemetryDemand::set_observed(Telemetry::Stream stream, double rate_hz,
+                                   double bytes_per_message)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    State &s = state(stream);
+    s.observed_rate_hz = rate_hz;
+    s.bytes_per_message = bytes_per_message;
+}
+
+bool TelemetryDemand::is_active() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_config.enabled) {
+        return true;
+    }
+    // Lowered streams still need to be raised once it is disabled.
+    for (const auto &s : _states) {
+        if (s.lowered) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TelemetryDemand::in_use(const State &state, double time_s) const
+{
+    return state.policy == Telemetry::StreamPolicy::ALWAYS ||
+           state.subscribed ||
+           state.used_elsewhere ||
+           time_s - state.last_used_s < _config.unused_timeout_s;
+}
+
+TelemetryDemand::Change TelemetryDemand::update(Telemetry::Stream stream, double time_s,
+                                                double &rate_hz)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    State &s = state(stream);
+
+    if (std::isnan(s.last_used_s)) {
+        s.last_used_s = time_s;
+    }
+
+    if (s.policy == Telemetry::StreamPolicy::ALWAYS || s.subscribed || s.used_elsewhere) {
+        // The timeout only starts once these go away.
+        s.last_used_s = std::max(s.last_used_s, time_s);
+    }
+    const bool used = in_use(s, time_s);
+
+    if (s.lowered) {
+        if (used || !_config.enabled) {
+            s.lowered = false;
+            rate_hz = std::isnan(s.requested_rate_hz) ? s.rate_before_hz : s.requested_rate_hz;
+            return Change::RAISE;
+        }
+        return Change::NONE;
+    }
+
+    if (!used && _config.enabled &&
+        s.observed_rate_hz > _config.unused_rate_hz * MIN_RATE_RATIO &&
+        s.observed_rate_hz > 0.0) {
+        s.lowered = true;
+        s.rate_before_hz = s.observed_rate_hz;
+        rate_hz = _config.unused_rate_hz;
+        return Change::LOWER;
+    }
+
+    return Change::NONE;
+}
+
+void TelemetryDemand::revert(Telemetry::Stream stream, Change change)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (change != Change::NONE) {
+        state(stream).lowered = (change == Change::RAISE);
+    }
+}
+
+bool TelemetryDemand::is_lowered(Telemetry::Stream stream) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return state(stream).lowered;
+}
+
+Telemetry::DemandStats TelemetryDemand::get_stats(double time_s) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Telemetry::DemandStats stats {};
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        const State &s = _states[i];
+
+        Telemetry::StreamDemand demand {};
+        demand.stream = Telemetry::Stream(i);
+        demand.in_use = in_use(s, time_s);
+        demand.lowered = s.lowered;
+        demand.rate_hz = s.observed_rate_hz;
+        if (s.lowered && s.rate_before_hz > s.observed_rate_hz) {
+            demand.saved_bytes_s = (s.rate_before_hz - s.observed_rate_hz) * s.bytes_per_message;
+        }
+        stats.saved_bytes_s += demand.saved_bytes_s;
+        stats.streams.push_back(demand);
+    }
+    return stats;
+}
+
+} // namespace dronecore
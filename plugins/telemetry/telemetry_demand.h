@@ -0,0 +1,100 @@
+#pragma once
+
+#include "telemetry.h"
+#include <cmath>
+#include <mutex>
+
+namespace dronecore {
+
+// Decides which telemetry streams are worth their bandwidth.
+//
+// A stream is in use while something is subscribed to it, its policy or
+// another plugin needs it, or while one of its getters was called less than
+// config.unused_timeout_s ago. Streams which are not in use for longer are
+// lowered, and raised back to the rate they had before as soon as they are
+// used again. The timeout is the hysteresis: a getter polled every few
+// seconds keeps its stream up instead of making it flap.
+//
+// All methods can be called from any thread.
+class TelemetryDemand
+{
+public:
+    static constexpr unsigned NUM_STREAMS = unsigned(Telemetry::Stream::RC_STATUS) + 1;
+
+    enum class Change {
+        NONE,
+        LOWER,
+        RAISE
+    };
+
+    TelemetryDemand() = default;
+    ~TelemetryDemand() = default;
+
+    // delete copy and move constructors and assign operators
+    TelemetryDemand(TelemetryDemand const &) = delete;            // Copy construct
+    TelemetryDemand(TelemetryDemand &&) = delete;                 // Move construct
+    TelemetryDemand &operator=(TelemetryDemand const &) = delete; // Copy assign
+    TelemetryDemand &operator=(TelemetryDemand &&) = delete;      // Move assign
+
+    Telemetry::DemandConfig get_config() const;
+    void set_config(const Telemetry::DemandConfig &config);
+
+    void set_policy(Telemetry::Stream stream, Telemetry::StreamPolicy policy);
+    void set_subscribed(Telemetry::Stream stream, bool subscribed);
+    void set_used_elsewhere(Telemetry::Stream stream, bool used_elsewhere);
+
+    // A getter of the stream was called.
+    void touch(Telemetry::Stream stream, double time_s);
+
+    // The app set the rate itself. It counts as a use and the rate is the
+    // one the stream is raised back to. A stream which is lowered is
+    // considered raised, the rate set by the app wins.
+    void set_requested_rate(Telemetry::Stream stream, double rate_hz, double time_s);
+
+    // What is currently received of the stream.
+    void set_observed(Telemetry::Stream stream, double rate_hz, double bytes_per_message);
+
+    // Whether any stream needs to be looked at by update().
+    bool is_active() const;
+
+    bool is_lowered(Telemetry::Stream stream) const;
+
+    // Decides whether the rate of the stream has to change now and, if so,
+    // assumes that it does. rate_hz is set to the rate to ask for.
+    Change update(Telemetry::Stream stream, double time_s, double &rate_hz);
+
+    // Setting the rate after a change failed, so it is tried again.
+    void revert(Telemetry::Stream stream, Change change);
+
+    Telemetry::DemandStats get_stats(double time_s) const;
+
+    // Only lower streams which are at least this much faster than the rate
+    // they would be lowered to, the observed rate is never exact.
+    static constexpr double MIN_RATE_RATIO = 1.25;
+
+private:
+    struct State {
+        Telemetry::StreamPolicy policy = Telemetry::StreamPolicy::ON_DEMAND;
+        bool subscribed = false;
+        bool used_elsewhere = false;
+        // NAN until the first update, which counts as a use so that nothing
+        // is lowered right away.
+        double last_used_s = double(NAN);
+        // NAN as long as the app did not set a rate.
+        double requested_rate_hz = double(NAN);
+        bool lowered = false;
+        double rate_before_hz = 0.0;
+        double observed_rate_hz = 0.0;
+        double bytes_per_message = 0.0;
+    };
+
+    bool in_use(const State &state, double time_s) const;
+    State &state(Telemetry::Stream stream) { return _states[unsigned(stream)]; }
+    const State &state(Telemetry::Stream stream) const { return _states[unsigned(stream)]; }
+
+    mutable std::mutex _mutex {};
+    Telemetry::DemandConfig _config {};
+    State _states[NUM_STREAMS] {};
+};
+
+} // namespace dronecore
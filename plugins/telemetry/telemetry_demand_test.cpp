@@ -0,0 +1,165 @@
+#include "telemetry_demand.h"
+#include <gtest/gtest.h>
+
+using namespace dronecore;
+
+namespace {
+
+const Telemetry::Stream STREAM = Telemetry::Stream::ATTITUDE;
+
+Telemetry::DemandConfig enabled_config()
+{
+    Telemetry::DemandConfig config {};
+    config.enabled = true;
+    config.unused_timeout_s = 10.0;
+    config.unused_rate_hz = 0.0;
+    return config;
+}
+
+// Calls update() once a second like the plugin does, from_s included and
+// to_s excluded, and returns the last change.
+TelemetryDemand::Change run(TelemetryDemand &demand, double from_s, double to_s,
+                            double &rate_hz)
+{
+    TelemetryDemand::Change last_change = TelemetryDemand::Change::NONE;
+    for (double time_s = from_s; time_s < to_s; time_s += 1.0) {
+        const TelemetryDemand::Change change = demand.update(STREAM, time_s, rate_hz);
+        if (change != TelemetryDemand::Change::NONE) {
+            last_change = change;
+        }
+    }
+    return last_change;
+}
+
+} // namespace
+
+TEST(TelemetryDemand, DisabledByDefault)
+{
+    TelemetryDemand demand;
+    demand.set_observed(STREAM, 50.0, 40.0);
+    EXPECT_FALSE(demand.is_active());
+
+    double rate_hz;
+    EXPECT_EQ(run(demand, 0.0, 100.0, rate_hz), TelemetryDemand::Change::NONE);
+}
+
+TEST(TelemetryDemand, UnusedStreamIsLoweredAfterTimeout)
+{
+    TelemetryDemand demand;
+    demand.set_config(enabled_config());
+    demand.set_observed(STREAM, 50.0, 40.0);
+
+    double rate_hz;
+    // The start counts as a use.
+    EXPECT_EQ(run(demand, 0.0, 10.0, rate_hz), TelemetryDemand::Change::NONE);
+    EXPECT_EQ(demand.update(STREAM, 10.0, rate_hz), TelemetryDemand::Change::LOWER);
+    EXPECT_EQ(rate_hz, 0.0);
+
+    // The stream stops and the bandwidth it used is saved.
+    demand.set_observed(STREAM, 0.0, 40.0);
+    const Telemetry::DemandStats stats = demand.get_stats(11.0);
+    EXPECT_DOUBLE_EQ(stats.saved_bytes_s, 50.0 * 40.0);
+    EXPECT_TRUE(stats.streams[unsigned(STREAM)].lowered);
+    EXPECT_FALSE(stats.streams[unsigned(STREAM)].in_use);
+}
+
+TEST(TelemetryDemand, UseRaisesToPreviousRate)
+{
+    TelemetryDemand demand;
+    demand.set_config(enabled_config());
+    demand.set_observed(STREAM, 50.0, 40.0);
+
+    double rate_hz;
+    EXPECT_EQ(run(demand, 0.0, 11.0, rate_hz), TelemetryDemand::Change::LOWER);
+    demand.set_observed(STREAM, 0.0, 40.0);
+
+    demand.touch(STREAM, 20.5);
+    EXPECT_EQ(demand.update(STREAM, 21.0, rate_hz), TelemetryDemand::Change::RAISE);
+    EXPECT_EQ(rate_hz, 50.0);
+    EXPECT_DOUBLE_EQ(demand.get_stats(21.0).saved_bytes_s, 0.0);
+
+    // A rate set by the app wins over the observed one.
+    demand.set_observed(STREAM, 50.0, 40.0);
+    demand.set_requested_rate(STREAM, 20.0, 22.0);
+    EXPECT_EQ(run(demand, 22.0, 33.0, rate_hz), TelemetryDemand::Change::LOWER);
+    demand.touch(STREAM, 40.0);
+    EXPECT_EQ(demand.update(STREAM, 40.0, rate_hz), TelemetryDemand::Change::RAISE);
+    EXPECT_EQ(rate_hz, 20.0);
+}
+
+TEST(TelemetryDemand, PolledGetterKeepsStreamUp)
+{
+    TelemetryDemand demand;
+    demand.set_config(enabled_config());
+    demand.set_observed(STREAM, 50.0, 40.0);
+
+    double rate_hz;
+    for (double time_s = 0.0; time_s < 100.0; time_s += 1.0) {
+        if (int(time_s) % 5 == 0) {
+            demand.touch(STREAM, time_s);
+        }
+        EXPECT_EQ(demand.update(STREAM, time_s, rate_hz), TelemetryDemand::Change::NONE);
+    }
+}
+
+TEST(TelemetryDemand, SubscriptionsPoliciesAndOtherUsersKeepStreamUp)
+{
+    TelemetryDemand demand;
+    demand.set_config(enabled_config());
+    demand.set_observed(STREAM, 50.0, 40.0);
+
+    double rate_hz;
+    demand.set_subscribed(STREAM, true);
+    EXPECT_EQ(run(demand, 0.0, 30.0, rate_hz), TelemetryDemand::Change::NONE);
+
+    // Once unsubscribed, the timeout starts.
+    demand.set_subscribed(STREAM, false);
+    EXPECT_EQ(run(demand, 30.0, 39.0, rate_hz), TelemetryDemand::Change::NONE);
+    EXPECT_EQ(run(demand, 39.0, 41.0, rate_hz), TelemetryDemand::Change::LOWER);
+
+    demand.set_policy(STREAM, Telemetry::StreamPolicy::ALWAYS);
+    EXPECT_EQ(demand.update(STREAM, 41.0, rate_hz), TelemetryDemand::Change::RAISE);
+    demand.set_policy(STREAM, Telemetry::StreamPolicy::ON_DEMAND);
+
+    demand.set_used_elsewhere(STREAM, true);
+    EXPECT_EQ(run(demand, 42.0, 100.0, rate_hz), TelemetryDemand::Change::NONE);
+}
+
+TEST(TelemetryDemand, SlowStreamsAreLeftAlone)
+{
+    TelemetryDemand demand;
+    Telemetry::DemandConfig config = enabled_config();
+    config.unused_rate_hz = 1.0;
+    demand.set_config(config);
+
+    // Already at the rate it would be lowered to.
+    demand.set_observed(STREAM, 1.1, 40.0);
+    double rate_hz;
+    EXPECT_EQ(run(demand, 0.0, 100.0, rate_hz), TelemetryDemand::Change::NONE);
+
+    // Nothing received, nothing to save.
+    demand.set_observed(STREAM, 0.0, 0.0);
+    EXPECT_EQ(run(demand, 100.0, 200.0, rate_hz), TelemetryDemand::Change::NONE);
+}
+
+TEST(TelemetryDemand, DisablingRaisesAndFailuresAreRetried)
+{
+    TelemetryDemand demand;
+    demand.set_config(enabled_config());
+    demand.set_observed(STREAM, 50.0, 40.0);
+
+    double rate_hz;
+    EXPECT_EQ(run(demand, 0.0, 11.0, rate_hz), TelemetryDemand::Change::LOWER);
+
+    Telemetry::DemandConfig config = enabled_config();
+    config.enabled = false;
+    demand.set_config(config);
+    EXPECT_TRUE(demand.is_active());
+    EXPECT_EQ(demand.update(STREAM, 12.0, rate_hz), TelemetryDemand::Change::RAISE);
+    EXPECT_EQ(rate_hz, 50.0);
+
+    // Raising failed, so it is tried again.
+    demand.revert(STREAM, TelemetryDemand::Change::RAISE);
+    EXPECT_EQ(demand.update(STREAM, 13.0, rate_hz), TelemetryDemand::Change::RAISE);
+    EXPECT_FALSE(demand.is_active());
+}
@@ -5,9 +5,16 @@
 #include "px4_custom_mode.h"
 #include <cmath>
 #include <functional>
+#include <future>
+#include <memory>
 
 namespace dronecore {
 
+constexpr float TelemetryImpl::DEMAND_INTERVAL_S;
+constexpr float TelemetryImpl::RATE_PROFILE_INTERVAL_S;
+constexpr float TelemetryImpl::ADAPTIVE_INTERVAL_S;
+constexpr double TelemetryImpl::RADIO_STATUS_TIMEOUT_S;
+
 TelemetryImpl::TelemetryImpl() :
     _position_mutex(),
     _position(Telemetry::Position {double(NAN), double(NAN), NAN, NAN}),
@@ -55,39 +62,39 @@ void TelemetryImpl::init()
 {
     using namespace std::placeholders; // for `_1`
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
         std::bind(&TelemetryImpl::process_global_position_int, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_HOME_POSITION,
         std::bind(&TelemetryImpl::process_home_position, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
         std::bind(&TelemetryImpl::process_attitude_quaternion, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_MOUNT_ORIENTATION,
         std::bind(&TelemetryImpl::process_mount_orientation, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_GPS_RAW_INT,
         std::bind(&TelemetryImpl::process_gps_raw_int, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
         std::bind(&TelemetryImpl::process_extended_sys_state, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_SYS_STATUS,
         std::bind(&TelemetryImpl::process_sys_status, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_HEARTBEAT,
         std::bind(&TelemetryImpl::process_heartbeat, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_message_view_handler(
         MAVLINK_MSG_ID_RC_CHANNELS,
         std::bind(&TelemetryImpl::process_rc_channels, this, _1), this);
 }
@@ -103,6 +110,15 @@ void TelemetryImpl::enable()
     _parent->register_timeout_handler(
         std::bind(&TelemetryImpl::receive_rc_channels_timeout, this), 1.0, &_timeout_cookie);
 
+    _parent->add_call_every(std::bind(&TelemetryImpl::update_stream_rates, this),
+                            DEMAND_INTERVAL_S, &_demand_cookie);
+
+    _parent->add_call_every(std::bind(&TelemetryImpl::update_rate_profile, this),
+                            RATE_PROFILE_INTERVAL_S, &_rate_profile_cookie);
+
+    _parent->add_call_every(std::bind(&TelemetryImpl::update_adaptive_rates, this),
+                            ADAPTIVE_INTERVAL_S, &_adaptive_cookie);
+
     // FIXME: The calibration check should eventually be better than this.
     //        For now, we just do the same as QGC does.
 
@@ -139,12 +155,28 @@ void TelemetryImpl::enable()
 void TelemetryImpl::disable()
 {
     _parent->unregister_timeout_handler(_timeout_cookie);
+    _parent->remove_call_every(_demand_cookie);
+    _parent->remove_call_every(_rate_profile_cookie);
+    _parent->remove_call_every(_adaptive_cookie);
+
+    Telemetry::result_callback_t callback;
+    {
+        std::lock_guard<std::mutex> lock(_rate_profile_mutex);
+        if (_rate_profiles.cancel()) {
+            callback = _rate_profile_callback;
+        }
+        _rate_profile_callback = nullptr;
+    }
+    if (callback) {
+        callback(Telemetry::Result::NO_DEVICE);
+    }
 }
 
 Telemetry::Result TelemetryImpl::set_rate_position(double rate_hz)
 {
     _position_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
+    set_requested_rate(Telemetry::Stream::POSITION, max_rate_hz);
 
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
@@ -152,24 +184,32 @@ Telemetry::Result TelemetryImpl::set_rate_position(double rate_hz)
 
 Telemetry::Result TelemetryImpl::set_rate_home_position(double rate_hz)
 {
+    set_requested_rate(Telemetry::Stream::HOME_POSITION, rate_hz);
+
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_HOME_POSITION, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_in_air(double rate_hz)
 {
+    set_requested_rate(Telemetry::Stream::IN_AIR, rate_hz);
+
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_attitude(double rate_hz)
 {
+    set_requested_rate(Telemetry::Stream::ATTITUDE, rate_hz);
+
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_ATTITUDE_QUATERNION, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_camera_attitude(double rate_hz)
 {
+    set_requested_rate(Telemetry::Stream::CAMERA_ATTITUDE, rate_hz);
+
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_MOUNT_ORIENTATION, rate_hz));
 }
@@ -178,6 +218,7 @@ Telemetry::Result TelemetryImpl::set_rate_ground_speed_ned(double rate_hz)
 {
     _ground_speed_ned_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
+    set_requested_rate(Telemetry::Stream::POSITION, max_rate_hz);
 
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
@@ -185,18 +226,24 @@ Telemetry::Result TelemetryImpl::set_rate_ground_speed_ned(double rate_hz)
 
 Telemetry::Result TelemetryImpl::set_rate_gps_info(double rate_hz)
 {
+    set_requested_rate(Telemetry::Stream::GPS_INFO, rate_hz);
+
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_GPS_RAW_INT, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_battery(double rate_hz)
 {
+    set_requested_rate(Telemetry::Stream::BATTERY, rate_hz);
+
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_SYS_STATUS, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_rc_status(double rate_hz)
 {
+    set_requested_rate(Telemetry::Stream::RC_STATUS, rate_hz);
+
     return telemetry_result_from_command_result(
                _parent->set_msg_rate(MAVLINK_MSG_ID_RC_CHANNELS, rate_hz));
 }
@@ -205,6 +252,7 @@ void TelemetryImpl::set_rate_position_async(double rate_hz, Telemetry::result_ca
 {
     _position_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
+    set_requested_rate(Telemetry::Stream::POSITION, max_rate_hz);
 
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
@@ -216,6 +264,8 @@ void TelemetryImpl::set_rate_position_async(double rate_hz, Telemetry::result_ca
 void TelemetryImpl::set_rate_home_position_async(double rate_hz,
                                                  Telemetry::result_callback_t callback)
 {
+    set_requested_rate(Telemetry::Stream::HOME_POSITION, rate_hz);
+
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_HOME_POSITION,
         rate_hz,
@@ -224,6 +274,8 @@ void TelemetryImpl::set_rate_home_position_async(double rate_hz,
 
 void TelemetryImpl::set_rate_in_air_async(double rate_hz, Telemetry::result_callback_t callback)
 {
+    set_requested_rate(Telemetry::Stream::IN_AIR, rate_hz);
+
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
         rate_hz,
@@ -232,6 +284,8 @@ void TelemetryImpl::set_rate_in_air_async(double rate_hz, Telemetry::result_call
 
 void TelemetryImpl::set_rate_attitude_async(double rate_hz, Telemetry::result_callback_t callback)
 {
+    set_requested_rate(Telemetry::Stream::ATTITUDE, rate_hz);
+
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
         rate_hz,
@@ -241,6 +295,8 @@ void TelemetryImpl::set_rate_attitude_async(double rate_hz, Telemetry::result_ca
 void TelemetryImpl::set_rate_camera_attitude_async(double rate_hz,
                                                    Telemetry::result_callback_t callback)
 {
+    set_requested_rate(Telemetry::Stream::CAMERA_ATTITUDE, rate_hz);
+
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_MOUNT_ORIENTATION,
         rate_hz,
@@ -252,6 +308,7 @@ void TelemetryImpl::set_rate_ground_speed_ned_async(double rate_hz,
 {
     _ground_speed_ned_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
+    set_requested_rate(Telemetry::Stream::POSITION, max_rate_hz);
 
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
@@ -261,6 +318,8 @@ void TelemetryImpl::set_rate_ground_speed_ned_async(double rate_hz,
 
 void TelemetryImpl::set_rate_gps_info_async(double rate_hz, Telemetry::result_callback_t callback)
 {
+    set_requested_rate(Telemetry::Stream::GPS_INFO, rate_hz);
+
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_GPS_RAW_INT,
         rate_hz,
@@ -269,6 +328,8 @@ void TelemetryImpl::set_rate_gps_info_async(double rate_hz, Telemetry::result_ca
 
 void TelemetryImpl::set_rate_battery_async(double rate_hz, Telemetry::result_callback_t callback)
 {
+    set_requested_rate(Telemetry::Stream::BATTERY, rate_hz);
+
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_SYS_STATUS,
         rate_hz,
@@ -277,12 +338,395 @@ void TelemetryImpl::set_rate_battery_async(double rate_hz, Telemetry::result_cal
 
 void TelemetryImpl::set_rate_rc_status_async(double rate_hz, Telemetry::result_callback_t callback)
 {
+    set_requested_rate(Telemetry::Stream::RC_STATUS, rate_hz);
+
     _parent->set_msg_rate_async(
         MAVLINK_MSG_ID_RC_CHANNELS,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
+Telemetry::DemandConfig TelemetryImpl::get_demand_config() const
+{
+    return _demand.get_config();
+}
+
+bool TelemetryImpl::set_demand_config(const Telemetry::DemandConfig &config)
+{
+    if (!(config.unused_timeout_s > 0.0 && config.unused_rate_hz >= 0.0)) {
+        LogErr() << "Err: Demand timeout must be positive and rate not negative";
+        return false;
+    }
+
+    _demand.set_config(config);
+    return true;
+}
+
+void TelemetryImpl::set_stream_policy(Telemetry::Stream stream, Telemetry::StreamPolicy policy)
+{
+    _demand.set_policy(stream, policy);
+}
+
+Telemetry::DemandStats TelemetryImpl::get_demand_stats() const
+{
+    return _demand.get_stats(_time.elapsed_s());
+}
+
+bool TelemetryImpl::set_rate_profile(const std::string &name,
+                                     const std::vector<Telemetry::StreamRate> &rates)
+{
+    if (!_rate_profiles.set_profile(name, rates)) {
+        LogErr() << "Err: Rate profile needs a name, rates not negative and streams only once";
+        return false;
+    }
+    return true;
+}
+
+Telemetry::Result TelemetryImpl::apply_rate_profile(const std::string &name)
+{
+    auto prom = std::make_shared<std::promise<Telemetry::Result>>();
+    std::future<Telemetry::Result> res = prom->get_future();
+
+    apply_rate_profile_async(name, [prom](Telemetry::Result result) {
+        prom->set_value(result);
+    });
+
+    return res.get();
+}
+
+void TelemetryImpl::apply_rate_profile_async(const std::string &name,
+                                             Telemetry::result_callback_t callback)
+{
+    Telemetry::result_callback_t superseded_callback;
+    Telemetry::Result result = Telemetry::Result::SUCCESS;
+    {
+        std::lock_guard<std::mutex> lock(_rate_profile_mutex);
+
+        if (!_rate_profiles.start(name, _time.elapsed_s())) {
+            LogErr() << "Err: No rate profile called " << name;
+            result = Telemetry::Result::UNKNOWN;
+        } else {
+            superseded_callback = _rate_profile_callback;
+            _rate_profile_callback = callback;
+            send_rate_profile();
+        }
+    }
+
+    if (superseded_callback) {
+        superseded_callback(Telemetry::Result::BUSY);
+    }
+    if (result != Telemetry::Result::SUCCESS && callback) {
+        callback(result);
+    }
+}
+
+Telemetry::RateProfileStatus TelemetryImpl::get_rate_profile_status() const
+{
+    return _rate_profiles.get_status();
+}
+
+Telemetry::AdaptiveRateConfig TelemetryImpl::get_adaptive_rate_config() const
+{
+    return _rate_controller.get_config();
+}
+
+bool TelemetryImpl::set_adaptive_rate_config(const Telemetry::AdaptiveRateConfig &config)
+{
+    if (!(config.max_loss_rate >= 0.0 && config.max_loss_rate <= 1.0 &&
+          config.min_radio_txbuf_percent >= 0.0 && config.min_radio_txbuf_percent <= 100.0 &&
+          config.recovery_s >= 0.0)) {
+        LogErr() << "Err: Loss rate must be within 0..1, radio buffer within 0..100 %"
+                 << " and recovery time not negative";
+        return false;
+    }
+
+    _rate_controller.set_config(config);
+    return true;
+}
+
+void TelemetryImpl::set_stream_priority(Telemetry::Stream stream, unsigned priority,
+                                        double min_rate_hz)
+{
+    if (!(min_rate_hz >= 0.0)) {
+        LogErr() << "Err: Minimum rate must not be negative";
+        return;
+    }
+
+    _rate_controller.set_priority(stream, priority, min_rate_hz);
+}
+
+Telemetry::AdaptiveRateStats TelemetryImpl::get_adaptive_rate_stats() const
+{
+    return _rate_controller.get_stats();
+}
+
+Telemetry::TimingStats TelemetryImpl::get_timing_stats() const
+{
+    const Timesync::Stats sync = _parent->get_timesync().get_stats();
+
+    Telemetry::TimingStats stats {};
+    stats.time_synced = sync.synced;
+    stats.clock_offset_s = sync.offset_s;
+    stats.clock_drift_ppm = sync.drift_ppm;
+    stats.round_trip_ms = sync.rtt_ms;
+    stats.streams = _timing.get_stats(_time.elapsed_s());
+    return stats;
+}
+
+void TelemetryImpl::set_requested_rate(Telemetry::Stream stream, double rate_hz)
+{
+    _demand.set_requested_rate(stream, rate_hz, _time.elapsed_s());
+    _rate_controller.set_requested_rate(stream, rate_hz);
+}
+
+void TelemetryImpl::update_stream_rates()
+{
+    if (!_demand.is_active()) {
+        return;
+    }
+
+    observe_streams();
+
+    const double time_s = _time.elapsed_s();
+
+    for (unsigned i = 0; i < TelemetryDemand::NUM_STREAMS; ++i) {
+        const Telemetry::Stream stream = Telemetry::Stream(i);
+        const uint16_t msg_id = message_id(stream);
+
+        _demand.set_subscribed(stream, is_subscribed(stream));
+        // E.g. the geofence also needs the position.
+        _demand.set_used_elsewhere(stream, _parent->has_mavlink_message_handler(msg_id, this));
+
+        double rate_hz = 0.0;
+        const TelemetryDemand::Change change = _demand.update(stream, time_s, rate_hz);
+        if (change == TelemetryDemand::Change::NONE) {
+            continue;
+        }
+
+        LogInfo() << ((change == TelemetryDemand::Change::LOWER) ? "Lowering" : "Raising")
+                  << " rate of message " << msg_id << " to " << rate_hz << " Hz";
+
+        _parent->set_msg_rate_async(
+            msg_id, rate_hz,
+        [this, stream, change](MavlinkCommands::Result result, float) {
+            if (result != MavlinkCommands::Result::SUCCESS &&
+                result != MavlinkCommands::Result::IN_PROGRESS) {
+                LogWarn() << "Setting rate of message " << message_id(stream) << " failed";
+                _demand.revert(stream, change);
+            }
+        });
+    }
+}
+
+void TelemetryImpl::observe_streams()
+{
+    double rate_hz[TelemetryDemand::NUM_STREAMS] {};
+    uint64_t messages[TelemetryDemand::NUM_STREAMS] {};
+    uint64_t bytes[TelemetryDemand::NUM_STREAMS] {};
+
+    // Summed up over all connections.
+    for (const auto &stats : _parent->get_message_stats()) {
+        for (unsigned i = 0; i < TelemetryDemand::NUM_STREAMS; ++i) {
+            if (stats.message_id == message_id(Telemetry::Stream(i))) {
+                rate_hz[i] += stats.rate_hz;
+                messages[i] += stats.messages;
+                bytes[i] += stats.bytes;
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < TelemetryDemand::NUM_STREAMS; ++i) {
+        const double bytes_per_message = (messages[i] > 0) ? double(bytes[i]) / messages[i] : 0.0;
+        _demand.set_observed(Telemetry::Stream(i), rate_hz[i], bytes_per_message);
+        _rate_controller.set_observed(Telemetry::Stream(i), rate_hz[i], bytes_per_message);
+    }
+}
+
+void TelemetryImpl::update_adaptive_rates()
+{
+    if (!_rate_controller.is_active()) {
+        return;
+    }
+
+    observe_streams();
+
+    for (unsigned i = 0; i < TelemetryRateController::NUM_STREAMS; ++i) {
+        const Telemetry::Stream stream = Telemetry::Stream(i);
+        // Nobody uses what the demand lowered, there is nothing to scale.
+        _rate_controller.set_managed(stream, !_demand.is_lowered(stream));
+    }
+
+    TelemetryRateController::Link link {0.0, 0.0, double(NAN)};
+    for (const auto &link_stats : _parent->get_link_stats()) {
+        link.throughput_bytes_s += link_stats.throughput_bytes_s;
+        link.loss_rate = std::max(link.loss_rate, double(link_stats.loss_rate));
+    }
+    // The fullest radio is the bottleneck.
+    for (const auto &radio_status : _parent->get_radio_statuses()) {
+        if (radio_status.age_s < RADIO_STATUS_TIMEOUT_S &&
+            (std::isnan(link.radio_txbuf_percent) ||
+             radio_status.txbuf_percent < link.radio_txbuf_percent)) {
+            link.radio_txbuf_percent = radio_status.txbuf_percent;
+        }
+    }
+
+    for (const auto &change : _rate_controller.update(_time.elapsed_s(), link)) {
+        const Telemetry::Stream stream = change.stream;
+
+        LogInfo() << "Scaling rate of message " << message_id(stream) << " to "
+                  << change.rate_hz << " Hz";
+
+        _parent->set_msg_rate_async(
+            message_id(stream), change.rate_hz,
+        [this, stream](MavlinkCommands::Result result, float) {
+            if (result != MavlinkCommands::Result::SUCCESS &&
+                result != MavlinkCommands::Result::IN_PROGRESS) {
+                LogWarn() << "Setting rate of message " << message_id(stream) << " failed";
+                _rate_controller.revert(stream);
+            }
+        });
+    }
+}
+
+void TelemetryImpl::send_rate_profile()
+{
+    std::vector<std::pair<uint16_t, double>> rates;
+
+    for (const auto &rate : _rate_profiles.get_rates_to_send()) {
+        if (rate.stream == Telemetry::Stream::POSITION) {
+            _position_rate_hz = rate.rate_hz;
+            _ground_speed_ned_rate_hz = rate.rate_hz;
+        }
+        set_requested_rate(rate.stream, rate.rate_hz);
+        rates.push_back(std::make_pair(message_id(rate.stream), rate.rate_hz));
+    }
+
+    // Whether the rates took effect is checked on what is received, which
+    // also covers commands which got lost.
+    _parent->set_msg_rates_async(rates, [](MavlinkCommands::Result result, float) {
+        if (result != MavlinkCommands::Result::SUCCESS) {
+            LogWarn() << "Not all rates of the profile were accepted";
+        }
+    });
+}
+
+void TelemetryImpl::update_rate_profile()
+{
+    if (!_rate_profiles.is_applying()) {
+        return;
+    }
+
+    uint64_t messages[TelemetryRateProfiles::NUM_STREAMS] {};
+    count_messages(messages);
+
+    Telemetry::result_callback_t callback;
+    Telemetry::Result result;
+    {
+        std::lock_guard<std::mutex> lock(_rate_profile_mutex);
+
+        const TelemetryRateProfiles::Step step = _rate_profiles.update(_time.elapsed_s(), messages);
+        if (step == TelemetryRateProfiles::Step::SEND) {
+            LogWarn() << "Not all rates of profile " << _rate_profiles.get_status().name
+                      << " match yet, requesting them again";
+            send_rate_profile();
+        }
+        if (step != TelemetryRateProfiles::Step::DONE) {
+            return;
+        }
+
+        result = _rate_profiles.succeeded() ? Telemetry::Result::SUCCESS :
+                 Telemetry::Result::TIMEOUT;
+        callback = _rate_profile_callback;
+        _rate_profile_callback = nullptr;
+    }
+
+    if (callback) {
+        callback(result);
+    }
+}
+
+void TelemetryImpl::count_messages(uint64_t messages[TelemetryRateProfiles::NUM_STREAMS]) const
+{
+    // Summed up over all connections.
+    for (const auto &stats : _parent->get_message_stats()) {
+        for (unsigned i = 0; i < TelemetryRateProfiles::NUM_STREAMS; ++i) {
+            if (stats.message_id == message_id(Telemetry::Stream(i))) {
+                messages[i] += stats.messages;
+            }
+        }
+    }
+}
+
+bool TelemetryImpl::is_subscribed(Telemetry::Stream stream) const
+{
+    switch (stream) {
+        case Telemetry::Stream::POSITION:
+            return _position_subscription || _ground_speed_ned_subscription;
+        case Telemetry::Stream::HOME_POSITION:
+            return _home_position_subscription ||
+                   _health_subscription || _health_all_ok_subscription;
+        case Telemetry::Stream::IN_AIR:
+            return bool(_in_air_subscription);
+        case Telemetry::Stream::ATTITUDE:
+            return _attitude_quaternion_subscription || _attitude_euler_angle_subscription;
+        case Telemetry::Stream::CAMERA_ATTITUDE:
+            return _camera_attitude_quaternion_subscription ||
+                   _camera_attitude_euler_angle_subscription;
+        case Telemetry::Stream::GPS_INFO:
+            return _gps_info_subscription ||
+                   _health_subscription || _health_all_ok_subscription;
+        case Telemetry::Stream::BATTERY:
+            return bool(_battery_subscription);
+        case Telemetry::Stream::RC_STATUS:
+            return bool(_rc_status_subscription);
+        default:
+            return false;
+    }
+}
+
+void TelemetryImpl::touch(Telemetry::Stream stream) const
+{
+    _demand.touch(stream, _time.elapsed_s());
+}
+
+void TelemetryImpl::stamp(Telemetry::Stream stream, uint64_t vehicle_time_us)
+{
+    const double receive_time_s = _time.elapsed_s();
+    Timesync &timesync = _parent->get_timesync();
+
+    double sample_time_s = double(NAN);
+    if (vehicle_time_us != 0) {
+        sample_time_s = timesync.to_host_time_s(vehicle_time_us);
+    } else {
+        // Without a timestamp of its own, the sample is as old as it was when received.
+        vehicle_time_us = timesync.to_vehicle_time_us(receive_time_s);
+    }
+    _timing.record(stream, vehicle_time_us, receive_time_s, sample_time_s);
+}
+
+uint16_t TelemetryImpl::message_id(Telemetry::Stream stream)
+{
+    switch (stream) {
+        case Telemetry::Stream::POSITION:
+            return MAVLINK_MSG_ID_GLOBAL_POSITION_INT;
+        case Telemetry::Stream::HOME_POSITION:
+            return MAVLINK_MSG_ID_HOME_POSITION;
+        case Telemetry::Stream::IN_AIR:
+            return MAVLINK_MSG_ID_EXTENDED_SYS_STATE;
+        case Telemetry::Stream::ATTITUDE:
+            return MAVLINK_MSG_ID_ATTITUDE_QUATERNION;
+        case Telemetry::Stream::CAMERA_ATTITUDE:
+            return MAVLINK_MSG_ID_MOUNT_ORIENTATION;
+        case Telemetry::Stream::GPS_INFO:
+            return MAVLINK_MSG_ID_GPS_RAW_INT;
+        case Telemetry::Stream::BATTERY:
+            return MAVLINK_MSG_ID_SYS_STATUS;
+        case Telemetry::Stream::RC_STATUS:
+        default:
+            return MAVLINK_MSG_ID_RC_CHANNELS;
+    }
+}
+
 Telemetry::Result TelemetryImpl::telemetry_result_from_command_result(
     MavlinkCommands::Result command_result)
 {
@@ -312,18 +756,20 @@ void TelemetryImpl::command_result_callback(MavlinkCommands::Result command_resu
     callback(action_result);
 }
 
-void TelemetryImpl::process_global_position_int(const mavlink_message_t &message)
+void TelemetryImpl::process_global_position_int(const MavlinkMessageView &view)
 {
-    mavlink_global_position_int_t global_position_int;
-    mavlink_msg_global_position_int_decode(&message, &global_position_int);
-    set_position(Telemetry::Position({global_position_int.lat * 1e-7,
-                                      global_position_int.lon * 1e-7,
-                                      global_position_int.alt * 1e-3f,
-                                      global_position_int.relative_alt * 1e-3f
+    stamp(Telemetry::Stream::POSITION,
+          uint64_t(view.get(&mavlink_global_position_int_t::time_boot_ms)) * 1000);
+
+    typedef mavlink_global_position_int_t msg_t;
+    set_position(Telemetry::Position({view.get(&msg_t::lat) * 1e-7,
+                                      view.get(&msg_t::lon) * 1e-7,
+                                      view.get(&msg_t::alt) * 1e-3f,
+                                      view.get(&msg_t::relative_alt) * 1e-3f
                                      }));
-    set_ground_speed_ned({global_position_int.vx * 1e-2f,
-                          global_position_int.vy * 1e-2f,
-                          global_position_int.vz * 1e-2f
+    set_ground_speed_ned({view.get(&msg_t::vx) * 1e-2f,
+                          view.get(&msg_t::vy) * 1e-2f,
+                          view.get(&msg_t::vz) * 1e-2f
                          });
 
     if (_position_subscription) {
@@ -335,13 +781,15 @@ void TelemetryImpl::process_global_position_int(const mavlink_message_t &message
     }
 }
 
-void TelemetryImpl::process_home_position(const mavlink_message_t &message)
+void TelemetryImpl::process_home_position(const MavlinkMessageView &view)
 {
-    mavlink_home_position_t home_position;
-    mavlink_msg_home_position_decode(&message, &home_position);
-    set_home_position(Telemetry::Position({home_position.latitude * 1e-7,
-                                           home_position.longitude * 1e-7,
-                                           home_position.altitude * 1e-3f,
+    stamp(Telemetry::Stream::HOME_POSITION,
+          TelemetryTiming::boot_time_us(view.get(&mavlink_home_position_t::time_usec)));
+
+    typedef mavlink_home_position_t msg_t;
+    set_home_position(Telemetry::Position({view.get(&msg_t::latitude) * 1e-7,
+                                           view.get(&msg_t::longitude) * 1e-7,
+                                           view.get(&msg_t::altitude) * 1e-3f,
                                            // the relative altitude of home is 0 by definition.
                                            0.0f
                                           }));
@@ -353,16 +801,17 @@ void TelemetryImpl::process_home_position(const mavlink_message_t &message)
     }
 }
 
-void TelemetryImpl::process_attitude_quaternion(const mavlink_message_t &message)
+void TelemetryImpl::process_attitude_quaternion(const MavlinkMessageView &view)
 {
-    mavlink_attitude_quaternion_t attitude_quaternion;
-    mavlink_msg_attitude_quaternion_decode(&message, &attitude_quaternion);
+    stamp(Telemetry::Stream::ATTITUDE,
+          uint64_t(view.get(&mavlink_attitude_quaternion_t::time_boot_ms)) * 1000);
 
+    typedef mavlink_attitude_quaternion_t msg_t;
     Telemetry::Quaternion quaternion {
-        attitude_quaternion.q1,
-        attitude_quaternion.q2,
-        attitude_quaternion.q3,
-        attitude_quaternion.q4
+        view.get(&msg_t::q1),
+        view.get(&msg_t::q2),
+        view.get(&msg_t::q3),
+        view.get(&msg_t::q4)
     };
 
     set_attitude_quaternion(quaternion);
@@ -376,15 +825,16 @@ void TelemetryImpl::process_attitude_quaternion(const mavlink_message_t &message
     }
 }
 
-void TelemetryImpl::process_mount_orientation(const mavlink_message_t &message)
+void TelemetryImpl::process_mount_orientation(const MavlinkMessageView &view)
 {
-    mavlink_mount_orientation_t mount_orientation;
-    mavlink_msg_mount_orientation_decode(&message, &mount_orientation);
+    stamp(Telemetry::Stream::CAMERA_ATTITUDE,
+          uint64_t(view.get(&mavlink_mount_orientation_t::time_boot_ms)) * 1000);
 
+    typedef mavlink_mount_orientation_t msg_t;
     Telemetry::EulerAngle euler_angle {
-        mount_orientation.roll,
-        mount_orientation.pitch,
-        mount_orientation.yaw
+        view.get(&msg_t::roll),
+        view.get(&msg_t::pitch),
+        view.get(&msg_t::yaw)
     };
 
     set_camera_attitude_euler_angle(euler_angle);
@@ -398,18 +848,21 @@ void TelemetryImpl::process_mount_orientation(const mavlink_message_t &message)
     }
 }
 
-void TelemetryImpl::process_gps_raw_int(const mavlink_message_t &message)
+void TelemetryImpl::process_gps_raw_int(const MavlinkMessageView &view)
 {
-    mavlink_gps_raw_int_t gps_raw_int;
-    mavlink_msg_gps_raw_int_decode(&message, &gps_raw_int);
-    set_gps_info({gps_raw_int.satellites_visible,
-                  gps_raw_int.fix_type
+    stamp(Telemetry::Stream::GPS_INFO,
+          TelemetryTiming::boot_time_us(view.get(&mavlink_gps_raw_int_t::time_usec)));
+
+    const uint8_t satellites_visible = view.get(&mavlink_gps_raw_int_t::satellites_visible);
+    const uint8_t fix_type = view.get(&mavlink_gps_raw_int_t::fix_type);
+    set_gps_info({satellites_visible,
+                  fix_type
                  });
 
     // TODO: This is just an interim hack, we will have to look at
     //       estimator flags in order to decide if the position
     //       estimate is good enough.
-    const bool gps_ok = ((gps_raw_int.fix_type >= 3) && (gps_raw_int.satellites_visible >= 8));
+    const bool gps_ok = ((fix_type >= 3) && (satellites_visible >= 8));
 
     set_health_global_position(gps_ok);
     // Local is not different from global for now until things like flow are in place.
@@ -420,14 +873,15 @@ void TelemetryImpl::process_gps_raw_int(const mavlink_message_t &message)
     }
 }
 
-void TelemetryImpl::process_extended_sys_state(const mavlink_message_t &message)
+void TelemetryImpl::process_extended_sys_state(const MavlinkMessageView &view)
 {
-    mavlink_extended_sys_state_t extended_sys_state;
-    mavlink_msg_extended_sys_state_decode(&message, &extended_sys_state);
+    stamp(Telemetry::Stream::IN_AIR, 0);
 
-    if (extended_sys_state.landed_state == MAV_LANDED_STATE_IN_AIR) {
+    const uint8_t landed_state = view.get(&mavlink_extended_sys_state_t::landed_state);
+
+    if (landed_state == MAV_LANDED_STATE_IN_AIR) {
         set_in_air(true);
-    } else if (extended_sys_state.landed_state == MAV_LANDED_STATE_ON_GROUND) {
+    } else if (landed_state == MAV_LANDED_STATE_ON_GROUND) {
         set_in_air(false);
     }
     // If landed_state is undefined, we use what we have received last.
@@ -438,13 +892,14 @@ void TelemetryImpl::process_extended_sys_state(const mavlink_message_t &message)
 
 }
 
-void TelemetryImpl::process_sys_status(const mavlink_message_t &message)
+void TelemetryImpl::process_sys_status(const MavlinkMessageView &view)
 {
-    mavlink_sys_status_t sys_status;
-    mavlink_msg_sys_status_decode(&message, &sys_status);
-    set_battery(Telemetry::Battery({sys_status.voltage_battery * 1e-3f,
+    stamp(Telemetry::Stream::BATTERY, 0);
+
+    typedef mavlink_sys_status_t msg_t;
+    set_battery(Telemetry::Battery({view.get(&msg_t::voltage_battery) * 1e-3f,
                                     // FIXME: it is strange calling it percent when the range goes from 0 to 1.
-                                    sys_status.battery_remaining * 1e-2f
+                                    view.get(&msg_t::battery_remaining) * 1e-2f
                                    }));
 
     if (_battery_subscription) {
@@ -452,20 +907,20 @@ void TelemetryImpl::process_sys_status(const mavlink_message_t &message)
     }
 }
 
-void TelemetryImpl::process_heartbeat(const mavlink_message_t &message)
+void TelemetryImpl::process_heartbeat(const MavlinkMessageView &view)
 {
-    mavlink_heartbeat_t heartbeat;
-    mavlink_msg_heartbeat_decode(&message, &heartbeat);
+    const uint8_t base_mode = view.get(&mavlink_heartbeat_t::base_mode);
 
-    set_armed(((heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false));
+    set_armed(((base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false));
 
     if (_armed_subscription) {
         _armed_subscription(armed());
     }
 
-    if (heartbeat.base_mode & MAV_MODE_FLAG_CUSTOM_MODE_ENABLED) {
+    if (base_mode & MAV_MODE_FLAG_CUSTOM_MODE_ENABLED) {
 
-        Telemetry::FlightMode flight_mode = to_flight_mode_from_custom_mode(heartbeat.custom_mode);
+        Telemetry::FlightMode flight_mode =
+            to_flight_mode_from_custom_mode(view.get(&mavlink_heartbeat_t::custom_mode));
         set_flight_mode(flight_mode);
 
         if (_flight_mode_subscription) {
@@ -481,13 +936,13 @@ void TelemetryImpl::process_heartbeat(const mavlink_message_t &message)
     }
 }
 
-void TelemetryImpl::process_rc_channels(const mavlink_message_t &message)
+void TelemetryImpl::process_rc_channels(const MavlinkMessageView &view)
 {
-    mavlink_rc_channels_t rc_channels;
-    mavlink_msg_rc_channels_decode(&message, &rc_channels);
+    stamp(Telemetry::Stream::RC_STATUS,
+          uint64_t(view.get(&mavlink_rc_channels_t::time_boot_ms)) * 1000);
 
-    bool rc_ok = (rc_channels.chancount > 0);
-    set_rc_status(rc_ok, rc_channels.rssi);
+    bool rc_ok = (view.get(&mavlink_rc_channels_t::chancount) > 0);
+    set_rc_status(rc_ok, view.get(&mavlink_rc_channels_t::rssi));
 
     if (_rc_status_subscription) {
         _rc_status_subscription(get_rc_status());
@@ -582,6 +1037,7 @@ void TelemetryImpl::receive_rc_channels_timeout()
 
 Telemetry::Position TelemetryImpl::get_position() const
 {
+    touch(Telemetry::Stream::POSITION);
     std::lock_guard<std::mutex> lock(_position_mutex);
     return _position;
 }
@@ -594,6 +1050,7 @@ void TelemetryImpl::set_position(Telemetry::Position position)
 
 Telemetry::Position TelemetryImpl::get_home_position() const
 {
+    touch(Telemetry::Stream::HOME_POSITION);
     std::lock_guard<std::mutex> lock(_home_position_mutex);
     return _home_position;
 }
@@ -606,6 +1063,7 @@ void TelemetryImpl::set_home_position(Telemetry::Position home_position)
 
 bool TelemetryImpl::in_air() const
 {
+    touch(Telemetry::Stream::IN_AIR);
     return _in_air;
 }
 
@@ -626,12 +1084,14 @@ void TelemetryImpl::set_armed(bool armed_new)
 
 Telemetry::Quaternion TelemetryImpl::get_attitude_quaternion() const
 {
+    touch(Telemetry::Stream::ATTITUDE);
     std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
     return _attitude_quaternion;
 }
 
 Telemetry::EulerAngle TelemetryImpl::get_attitude_euler_angle() const
 {
+    touch(Telemetry::Stream::ATTITUDE);
     std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
     Telemetry::EulerAngle euler = to_euler_angle_from_quaternion(_attitude_quaternion);
 
@@ -646,6 +1106,7 @@ void TelemetryImpl::set_attitude_quaternion(Telemetry::Quaternion quaternion)
 
 Telemetry::Quaternion TelemetryImpl::get_camera_attitude_quaternion() const
 {
+    touch(Telemetry::Stream::CAMERA_ATTITUDE);
     std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
     Telemetry::Quaternion quaternion
         = to_quaternion_from_euler_angle(_camera_attitude_euler_angle);
@@ -655,6 +1116,7 @@ Telemetry::Quaternion TelemetryImpl::get_camera_attitude_quaternion() const
 
 Telemetry::EulerAngle TelemetryImpl::get_camera_attitude_euler_angle() const
 {
+    touch(Telemetry::Stream::CAMERA_ATTITUDE);
     std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
 
     return _camera_attitude_euler_angle;
@@ -668,6 +1130,7 @@ void TelemetryImpl::set_camera_attitude_euler_angle(Telemetry::EulerAngle euler_
 
 Telemetry::GroundSpeedNED TelemetryImpl::get_ground_speed_ned() const
 {
+    touch(Telemetry::Stream::POSITION);
     std::lock_guard<std::mutex> lock(_ground_speed_ned_mutex);
     return _ground_speed_ned;
 }
@@ -680,6 +1143,7 @@ void TelemetryImpl::set_ground_speed_ned(Telemetry::GroundSpeedNED ground_speed_
 
 Telemetry::GPSInfo TelemetryImpl::get_gps_info() const
 {
+    touch(Telemetry::Stream::GPS_INFO);
     std::lock_guard<std::mutex> lock(_gps_info_mutex);
     return _gps_info;
 }
@@ -692,6 +1156,7 @@ void TelemetryImpl::set_gps_info(Telemetry::GPSInfo gps_info)
 
 Telemetry::Battery TelemetryImpl::get_battery() const
 {
+    touch(Telemetry::Stream::BATTERY);
     std::lock_guard<std::mutex> lock(_battery_mutex);
     return _battery;
 }
@@ -716,12 +1181,16 @@ void TelemetryImpl::set_flight_mode(Telemetry::FlightMode flight_mode)
 
 Telemetry::Health TelemetryImpl::get_health() const
 {
+    touch(Telemetry::Stream::GPS_INFO);
+    touch(Telemetry::Stream::HOME_POSITION);
     std::lock_guard<std::mutex> lock(_health_mutex);
     return _health;
 }
 
 bool TelemetryImpl::get_health_all_ok() const
 {
+    touch(Telemetry::Stream::GPS_INFO);
+    touch(Telemetry::Stream::HOME_POSITION);
     std::lock_guard<std::mutex> lock(_health_mutex);
     if (_health.gyrometer_calibration_ok &&
         _health.accelerometer_calibration_ok &&
@@ -738,6 +1207,7 @@ bool TelemetryImpl::get_health_all_ok() const
 
 Telemetry::RCStatus TelemetryImpl::get_rc_status() const
 {
+    touch(Telemetry::Stream::RC_STATUS);
     std::lock_guard<std::mutex> lock(_rc_status_mutex);
     return _rc_status;
 }
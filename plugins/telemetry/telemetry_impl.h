@@ -1,6 +1,10 @@
 #pragma once
 
 #include "telemetry.h"
+#include "telemetry_demand.h"
+#include "telemetry_rate_profiles.h"
+#include "telemetry_rate_controller.h"
+#include "telemetry_timing.h"
 #include "plugin_impl_base.h"
 #include "device_impl.h"
 #include "mavlink_include.h"
@@ -47,6 +51,24 @@ public:
     void set_rate_battery_async(double rate_hz, Telemetry::result_callback_t callback);
     void set_rate_rc_status_async(double rate_hz, Telemetry::result_callback_t callback);
 
+    Telemetry::DemandConfig get_demand_config() const;
+    bool set_demand_config(const Telemetry::DemandConfig &config);
+    void set_stream_policy(Telemetry::Stream stream, Telemetry::StreamPolicy policy);
+    Telemetry::DemandStats get_demand_stats() const;
+
+    bool set_rate_profile(const std::string &name,
+                          const std::vector<Telemetry::StreamRate> &rates);
+    Telemetry::Result apply_rate_profile(const std::string &name);
+    void apply_rate_profile_async(const std::string &name, Telemetry::result_callback_t callback);
+    Telemetry::RateProfileStatus get_rate_profile_status() const;
+
+    Telemetry::AdaptiveRateConfig get_adaptive_rate_config() const;
+    bool set_adaptive_rate_config(const Telemetry::AdaptiveRateConfig &config);
+    void set_stream_priority(Telemetry::Stream stream, unsigned priority, double min_rate_hz);
+    Telemetry::AdaptiveRateStats get_adaptive_rate_stats() const;
+
+    Telemetry::TimingStats get_timing_stats() const;
+
     Telemetry::Position get_position() const;
     Telemetry::Position get_home_position() const;
     bool in_air() const;
@@ -99,15 +121,15 @@ private:
     void set_health_level_calibration(bool ok);
     void set_rc_status(bool available, float signal_strength_percent);
 
-    void process_global_position_int(const mavlink_message_t &message);
-    void process_home_position(const mavlink_message_t &message);
-    void process_attitude_quaternion(const mavlink_message_t &message);
-    void process_mount_orientation(const mavlink_message_t &message);
-    void process_gps_raw_int(const mavlink_message_t &message);
-    void process_extended_sys_state(const mavlink_message_t &message);
-    void process_sys_status(const mavlink_message_t &message);
-    void process_heartbeat(const mavlink_message_t &message);
-    void process_rc_channels(const mavlink_message_t &message);
+    void process_global_position_int(const MavlinkMessageView &view);
+    void process_home_position(const MavlinkMessageView &view);
+    void process_attitude_quaternion(const MavlinkMessageView &view);
+    void process_mount_orientation(const MavlinkMessageView &view);
+    void process_gps_raw_int(const MavlinkMessageView &view);
+    void process_extended_sys_state(const MavlinkMessageView &view);
+    void process_sys_status(const MavlinkMessageView &view);
+    void process_heartbeat(const MavlinkMessageView &view);
+    void process_rc_channels(const MavlinkMessageView &view);
 
     void receive_param_cal_gyro(bool success, int value);
     void receive_param_cal_accel(bool success, int value);
@@ -118,6 +140,19 @@ private:
 
     void receive_rc_channels_timeout();
 
+    void set_requested_rate(Telemetry::Stream stream, double rate_hz);
+    void update_stream_rates();
+    void update_adaptive_rates();
+    void observe_streams();
+    bool is_subscribed(Telemetry::Stream stream) const;
+    void touch(Telemetry::Stream stream) const;
+    void stamp(Telemetry::Stream stream, uint64_t vehicle_time_us);
+    static uint16_t message_id(Telemetry::Stream stream);
+
+    void send_rate_profile();
+    void update_rate_profile();
+    void count_messages(uint64_t messages[TelemetryRateProfiles::NUM_STREAMS]) const;
+
 
     static Telemetry::Result telemetry_result_from_command_result(
         MavlinkCommands::Result command_result);
@@ -186,6 +221,34 @@ private:
     double _position_rate_hz;
 
     void *_timeout_cookie = nullptr;
+
+    // Getters are const but still count as a use of their stream.
+    mutable TelemetryDemand _demand {};
+    mutable Time _time {};
+    void *_demand_cookie = nullptr;
+
+    // How often the demand is checked.
+    static constexpr float DEMAND_INTERVAL_S = 1.0f;
+
+    TelemetryRateProfiles _rate_profiles {};
+    // Taken while the profile being applied changes, so that its callback
+    // stays with it.
+    std::mutex _rate_profile_mutex {};
+    Telemetry::result_callback_t _rate_profile_callback {};
+    void *_rate_profile_cookie = nullptr;
+
+    // How often the rates of a profile being applied are checked.
+    static constexpr float RATE_PROFILE_INTERVAL_S = 0.25f;
+
+    TelemetryRateController _rate_controller {};
+    void *_adaptive_cookie = nullptr;
+
+    // How often the link is checked, as often as the link stats change.
+    static constexpr float ADAPTIVE_INTERVAL_S = 1.0f;
+    // A radio which stopped reporting is not taken into account.
+    static constexpr double RADIO_STATUS_TIMEOUT_S = 5.0;
+
+    TelemetryTiming _timing {};
 };
 
 } // namespace dronecore
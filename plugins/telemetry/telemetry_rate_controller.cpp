@@ -0,0 +1,268 @@
+#include "telemetry_rate_controller.h"
+#include <algorithm>
+
+namespace dronecore {
+
+constexpr unsigned TelemetryRateController::NUM_STREAMS;
+constexpr double TelemetryRateController::DECREASE_FACTOR;
+constexpr double TelemetryRateController::INCREASE_FACTOR;
+constexpr double TelemetryRateController::MIN_DECREASE_INTERVAL_S;
+constexpr double TelemetryRateController::RATE_HYSTERESIS;
+
+TelemetryRateController::TelemetryRateController()
+{
+    // What is needed to know where the vehicle is and whether it is fine.
+    set_priority(Telemetry::Stream::POSITION, 2, 1.0);
+    set_priority(Telemetry::Stream::IN_AIR, 2, 1.0);
+    set_priority(Telemetry::Stream::BATTERY, 2, 1.0);
+    set_priority(Telemetry::Stream::ATTITUDE, 1, 0.0);
+    set_priority(Telemetry::Stream::GPS_INFO, 1, 0.0);
+    set_priority(Telemetry::Stream::RC_STATUS, 1, 0.0);
+}
+
+Telemetry::AdaptiveRateConfig TelemetryRateController::get_config() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _config;
+}
+
+void TelemetryRateController::set_config(const Telemetry::AdaptiveRateConfig &config)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _config = config;
+}
+
+void TelemetryRateController::set_priority(Telemetry::Stream stream, unsigned priority,
+                                           double min_rate_hz)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    state(stream).priority = priority;
+    state(stream).min_rate_hz = min_rate_hz;
+}
+
+void TelemetryRateController::set_requested_rate(Telemetry::Stream stream, double rate_hz)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    State &s = state(stream);
+    s.requested_rate_hz = rate_hz;
+    // The rate has just been set, scaling starts over from there.
+    s.scaled = false;
+    s.failed = false;
+}
+
+void TelemetryRateController::set_observed(Telemetry::Stream stream, double rate_hz,
+                                           double bytes_per_message)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    state(stream).observed_rate_hz = rate_hz;
+    state(stream).bytes_per_message = bytes_per_message;
+}
+
+void TelemetryRateController::set_managed(Telemetry::Stream stream, bool managed)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    State &s = state(stream);
+    s.managed = managed;
+    if (!managed) {
+        s.scaled = false;
+        s.failed = false;
+    }
+}
+
+bool TelemetryRateController::is_active() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_config.enabled) {
+        return true;
+    }
+    // Streams still scaled down have to be raised.
+    for (const auto &s : _states) {
+        if (s.scaled) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<TelemetryRateController::Change> TelemetryRateController::update(double time_s,
+                                                                           const Link &link)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _link = link;
+    _congested = _config.enabled && is_congested(link);
+
+    double scalable_bytes_s = 0.0;
+    double nominal_bytes_s = 0.0;
+    for (auto &s : _states) {
+        // What arrives of a congested link is less than what is sent, so
+        // the rates are only taken as nominal while the link is fine.
+        if (!s.scaled && !_congested && std::isinf(_budget_bytes_s)) {
+            s.unscaled_rate_hz = s.observed_rate_hz;
+        }
+        if (is_scalable(s)) {
+            scalable_bytes_s += s.observed_rate_hz * s.bytes_per_message;
+            nominal_bytes_s += nominal_rate_hz(s) * s.bytes_per_message;
+        }
+    }
+
+    // Heartbeats and whatever else the streams are not.
+    const double other_bytes_s = std::max(0.0, link.throughput_bytes_s - scalable_bytes_s);
+
+    if (_config.enabled) {
+        update_budget(time_s, link, other_bytes_s + nominal_bytes_s);
+    } else {
+        _budget_bytes_s = double(INFINITY);
+    }
+
+    double rates_hz[NUM_STREAMS] {};
+    if (!std::isinf(_budget_bytes_s)) {
+        allocate(_budget_bytes_s - other_bytes_s, rates_hz);
+    }
+
+    std::vector<Change> changes;
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        State &s = _states[i];
+        if (!is_scalable(s)) {
+            continue;
+        }
+
+        const double nominal_hz = nominal_rate_hz(s);
+        const double target_hz = std::isinf(_budget_bytes_s) ? nominal_hz : rates_hz[i];
+        const double current_hz = s.scaled ? s.rate_hz : nominal_hz;
+
+        if (target_hz * RATE_HYSTERESIS >= nominal_hz) {
+            if (s.scaled || s.failed) {
+                changes.push_back(Change {Telemetry::Stream(i), nominal_hz});
+            }
+            s.scaled = false;
+
+        } else if (!s.scaled || s.failed ||
+                   target_hz * RATE_HYSTERESIS < current_hz ||
+                   target_hz > current_hz * RATE_HYSTERESIS) {
+            changes.push_back(Change {Telemetry::Stream(i), target_hz});
+            s.scaled = true;
+            s.rate_hz = target_hz;
+        }
+        s.failed = false;
+    }
+    return changes;
+}
+
+void TelemetryRateController::revert(Telemetry::Stream stream)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    state(stream).failed = true;
+}
+
+Telemetry::AdaptiveRateStats TelemetryRateController::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Telemetry::AdaptiveRateStats stats {};
+    stats.congested = _congested;
+    stats.budget_bytes_s = _budget_bytes_s;
+    stats.throughput_bytes_s = _link.throughput_bytes_s;
+    stats.loss_rate = _link.loss_rate;
+    stats.radio_txbuf_percent = _link.radio_txbuf_percent;
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        if (_states[i].scaled) {
+            stats.scaled_streams.push_back(
+                Telemetry::StreamRate {Telemetry::Stream(i), _states[i].rate_hz});
+        }
+    }
+    return stats;
+}
+
+double TelemetryRateController::nominal_rate_hz(const State &s) const
+{
+    return std::isnan(s.requested_rate_hz) ? s.unscaled_rate_hz : s.requested_rate_hz;
+}
+
+bool TelemetryRateController::is_scalable(const State &s) const
+{
+    return s.managed && s.bytes_per_message > 0.0 && nominal_rate_hz(s) > 0.0;
+}
+
+bool TelemetryRateController::is_congested(const Link &link) const
+{
+    // Without a radio, its buffer is NAN and never too full.
+    return link.loss_rate > _config.max_loss_rate ||
+           link.radio_txbuf_percent < _config.min_radio_txbuf_percent;
+}
+
+void TelemetryRateController::update_budget(double time_s, const Link &link,
+                                            double nominal_bytes_s)
+{
+    if (_congested) {
+        _last_congested_s = time_s;
+        if (std::isnan(_last_decrease_s) || time_s - _last_decrease_s >= MIN_DECREASE_INTERVAL_S) {
+            _budget_bytes_s = std::min(_budget_bytes_s, link.throughput_bytes_s) * DECREASE_FACTOR;
+            _last_decrease_s = time_s;
+        }
+
+    } else if (!std::isinf(_budget_bytes_s) && time_s - _last_congested_s >= _config.recovery_s) {
+        // The link carried more than the budget if the streams were scaled
+        // down less than asked, so that is where to carry on from.
+        _budget_bytes_s = std::max(_budget_bytes_s, link.throughput_bytes_s) * INCREASE_FACTOR;
+        if (_budget_bytes_s >= nominal_bytes_s) {
+            _budget_bytes_s = double(INFINITY);
+        }
+    }
+}
+
+void TelemetryRateController::allocate(double available_bytes_s,
+                                       double rates_hz[NUM_STREAMS]) const
+{
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        const State &s = _states[i];
+        if (is_scalable(s)) {
+            rates_hz[i] = std::min(s.min_rate_hz, nominal_rate_hz(s));
+            available_bytes_s -= rates_hz[i] * s.bytes_per_message;
+        }
+    }
+
+    // One priority after the other, from the highest down.
+    bool has_upper = false;
+    unsigned upper = 0;
+    while (true) {
+        bool found = false;
+        unsigned priority = 0;
+        for (const auto &s : _states) {
+            if (is_scalable(s) && (!has_upper || s.priority < upper) &&
+                (!found || s.priority > priority)) {
+                priority = s.priority;
+                found = true;
+            }
+        }
+        if (!found) {
+            break;
+        }
+
+        double wanted_bytes_s = 0.0;
+        for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+            const State &s = _states[i];
+            if (is_scalable(s) && s.priority == priority) {
+                wanted_bytes_s += (nominal_rate_hz(s) - rates_hz[i]) * s.bytes_per_message;
+            }
+        }
+
+        double fraction = 1.0;
+        if (wanted_bytes_s > 0.0) {
+            fraction = std::min(1.0, std::max(0.0, available_bytes_s / wanted_bytes_s));
+        }
+        for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+            const State &s = _states[i];
+            if (is_scalable(s) && s.priority == priority) {
+                rates_hz[i] += fraction * (nominal_rate_hz(s) - rates_hz[i]);
+            }
+        }
+        available_bytes_s -= fraction * wanted_bytes_s;
+
+        has_upper = true;
+        upper = priority;
+    }
+}
+
+} // namespace dronecore
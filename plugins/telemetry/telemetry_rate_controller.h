@@ -0,0 +1,119 @@
+#pragma once
+
+#include "telemetry.h"
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace dronecore {
+
+// Scales the telemetry streams to what the link can carry.
+//
+// While the link is congested, the bandwidth allowed for everything received
+// from the vehicle, the budget, is lowered to a fraction of what the link
+// carried. The streams get the budget by priority: first each its minimum
+// rate, then the streams of the highest priority up to their nominal rate,
+// then the next priority and so on, streams of the same priority scaled by
+// the same fraction. Without congestion for config.recovery_s, the budget is
+// raised a step every update until all streams are back at their nominal rate.
+//
+// The nominal rate of a stream is the rate the app or a profile set, or
+// otherwise the rate it was received at while the link was last fine.
+//
+// All methods can be called from any thread.
+class TelemetryRateController
+{
+public:
+    static constexpr unsigned NUM_STREAMS = unsigned(Telemetry::Stream::RC_STATUS) + 1;
+
+    struct Link {
+        double throughput_bytes_s;
+        double loss_rate;
+        // NAN without a radio.
+        double radio_txbuf_percent;
+    };
+
+    struct Change {
+        Telemetry::Stream stream;
+        double rate_hz;
+    };
+
+    TelemetryRateController();
+    ~TelemetryRateController() = default;
+
+    // delete copy and move constructors and assign operators
+    TelemetryRateController(TelemetryRateController const &) = delete;            // Copy construct
+    TelemetryRateController(TelemetryRateController &&) = delete;                 // Move construct
+    TelemetryRateController &operator=(TelemetryRateController const &) = delete; // Copy assign
+    TelemetryRateController &operator=(TelemetryRateController &&) = delete;      // Move assign
+
+    Telemetry::AdaptiveRateConfig get_config() const;
+    void set_config(const Telemetry::AdaptiveRateConfig &config);
+
+    void set_priority(Telemetry::Stream stream, unsigned priority, double min_rate_hz);
+
+    // The app or a profile set the rate, it becomes the nominal rate.
+    void set_requested_rate(Telemetry::Stream stream, double rate_hz);
+
+    // What is currently received of the stream.
+    void set_observed(Telemetry::Stream stream, double rate_hz, double bytes_per_message);
+
+    // A stream which is not managed, e.g. because it is lowered as nobody
+    // uses it, is left alone and forgotten if it was scaled down.
+    void set_managed(Telemetry::Stream stream, bool managed);
+
+    // Whether update() needs to be called.
+    bool is_active() const;
+
+    // Adapts the budget to the link and returns the rates to set.
+    std::vector<Change> update(double time_s, const Link &link);
+
+    // Setting the rate of the change failed, so it is set again next time.
+    void revert(Telemetry::Stream stream);
+
+    Telemetry::AdaptiveRateStats get_stats() const;
+
+    // The budget while congested, relative to what the link carried.
+    static constexpr double DECREASE_FACTOR = 0.7;
+    // Step by which the budget is raised again.
+    static constexpr double INCREASE_FACTOR = 1.2;
+    // The budget is not lowered again before the last decrease shows.
+    static constexpr double MIN_DECREASE_INTERVAL_S = 2.0;
+    // Rates closer than this ratio to the one set are not changed.
+    static constexpr double RATE_HYSTERESIS = 1.1;
+
+private:
+    struct State {
+        unsigned priority = 0;
+        double min_rate_hz = 0.0;
+        bool managed = true;
+        // NAN as long as the app did not set a rate.
+        double requested_rate_hz = double(NAN);
+        // Rate received while not scaled down.
+        double unscaled_rate_hz = 0.0;
+        double observed_rate_hz = 0.0;
+        double bytes_per_message = 0.0;
+        bool scaled = false;
+        double rate_hz = 0.0;
+        bool failed = false;
+    };
+
+    double nominal_rate_hz(const State &state) const;
+    bool is_scalable(const State &state) const;
+    bool is_congested(const Link &link) const;
+    void update_budget(double time_s, const Link &link, double nominal_bytes_s);
+    void allocate(double available_bytes_s, double rates_hz[NUM_STREAMS]) const;
+    State &state(Telemetry::Stream stream) { return _states[unsigned(stream)]; }
+
+    mutable std::mutex _mutex {};
+    Telemetry::AdaptiveRateConfig _config {};
+    State _states[NUM_STREAMS] {};
+
+    double _budget_bytes_s = double(INFINITY);
+    bool _congested = false;
+    double _last_congested_s = double(NAN);
+    double _last_decrease_s = double(NAN);
+    Link _link {0.0, 0.0, double(NAN)};
+};
+
+} // namespace dronecore
@@ -0,0 +1,256 @@
+#include "telemetry_rate_controller.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace dronecore;
+
+namespace {
+
+const unsigned NUM_STREAMS = TelemetryRateController::NUM_STREAMS;
+
+// A vehicle streaming over a link which carries capacity_bytes_s and loses
+// everything beyond.
+struct Simulation {
+    double rates_hz[NUM_STREAMS];
+    double bytes_per_message[NUM_STREAMS];
+    double other_bytes_s;
+    double capacity_bytes_s;
+    double radio_txbuf_percent;
+    double time_s;
+    unsigned num_changes;
+
+    double loss_rate() const
+    {
+        const double offered_bytes_s = offered();
+        return std::max(0.0, 1.0 - capacity_bytes_s / offered_bytes_s);
+    }
+
+    double offered() const
+    {
+        double offered_bytes_s = other_bytes_s;
+        for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+            offered_bytes_s += rates_hz[i] * bytes_per_message[i];
+        }
+        return offered_bytes_s;
+    }
+
+    // Once a second like the timer.
+    void run(TelemetryRateController &controller, double duration_s)
+    {
+        for (double end_s = time_s + duration_s; time_s < end_s; time_s += 1.0) {
+            const double delivered = 1.0 - loss_rate();
+            for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+                controller.set_observed(Telemetry::Stream(i), rates_hz[i] * delivered,
+                                        bytes_per_message[i]);
+            }
+
+            const TelemetryRateController::Link link {
+                std::min(offered(), capacity_bytes_s), loss_rate(), radio_txbuf_percent};
+
+            for (const auto &change : controller.update(time_s, link)) {
+                rates_hz[unsigned(change.stream)] = change.rate_hz;
+                ++num_changes;
+            }
+        }
+    }
+
+    double rate(Telemetry::Stream stream) const { return rates_hz[unsigned(stream)]; }
+};
+
+// About what PX4 streams over a radio, 4.8 kB/s in total.
+Simulation simulation()
+{
+    Simulation simulation {};
+    const struct {
+        Telemetry::Stream stream;
+        double rate_hz;
+        double bytes_per_message;
+    } streams[] = {
+        {Telemetry::Stream::POSITION, 50.0, 36.0},
+        {Telemetry::Stream::HOME_POSITION, 1.0, 68.0},
+        {Telemetry::Stream::IN_AIR, 2.0, 10.0},
+        {Telemetry::Stream::ATTITUDE, 50.0, 40.0},
+        {Telemetry::Stream::CAMERA_ATTITUDE, 10.0, 24.0},
+        {Telemetry::Stream::GPS_INFO, 5.0, 60.0},
+        {Telemetry::Stream::BATTERY, 2.0, 39.0},
+        {Telemetry::Stream::RC_STATUS, 5.0, 50.0}
+    };
+    for (const auto &stream : streams) {
+        simulation.rates_hz[unsigned(stream.stream)] = stream.rate_hz;
+        simulation.bytes_per_message[unsigned(stream.stream)] = stream.bytes_per_message;
+    }
+    simulation.other_bytes_s = 100.0;
+    simulation.capacity_bytes_s = 100000.0;
+    simulation.radio_txbuf_percent = double(NAN);
+    return simulation;
+}
+
+Telemetry::AdaptiveRateConfig enabled_config()
+{
+    Telemetry::AdaptiveRateConfig config;
+    config.enabled = true;
+    return config;
+}
+
+} // namespace
+
+TEST(TelemetryRateController, LeavesStreamsAloneOnGoodLink)
+{
+    TelemetryRateController controller;
+    Simulation sim = simulation();
+
+    // Nothing happens either while disabled.
+    sim.capacity_bytes_s = 1000.0;
+    EXPECT_FALSE(controller.is_active());
+    sim.run(controller, 10.0);
+    EXPECT_EQ(sim.num_changes, 0u);
+
+    controller.set_config(enabled_config());
+    EXPECT_TRUE(controller.is_active());
+    sim.capacity_bytes_s = 100000.0;
+    sim.run(controller, 30.0);
+    EXPECT_EQ(sim.num_changes, 0u);
+
+    const Telemetry::AdaptiveRateStats stats = controller.get_stats();
+    EXPECT_FALSE(stats.congested);
+    EXPECT_TRUE(std::isinf(stats.budget_bytes_s));
+    EXPECT_TRUE(stats.scaled_streams.empty());
+}
+
+TEST(TelemetryRateController, ScalesLowPriorityFirst)
+{
+    TelemetryRateController controller;
+    controller.set_config(enabled_config());
+    Simulation sim = simulation();
+    sim.run(controller, 5.0);
+
+    sim.capacity_bytes_s = 2500.0;
+    sim.run(controller, 10.0);
+
+    EXPECT_LT(sim.offered(), 2500.0);
+    // The position has the highest priority and mostly fits.
+    EXPECT_GT(sim.rate(Telemetry::Stream::POSITION), 25.0);
+    EXPECT_GE(sim.rate(Telemetry::Stream::IN_AIR), 1.0);
+    EXPECT_GE(sim.rate(Telemetry::Stream::BATTERY), 1.0);
+    // Then nothing is left for the rest.
+    EXPECT_LT(sim.rate(Telemetry::Stream::ATTITUDE), 1.0);
+    EXPECT_LT(sim.rate(Telemetry::Stream::CAMERA_ATTITUDE), 1.0);
+    EXPECT_LT(sim.rate(Telemetry::Stream::HOME_POSITION), 1.0);
+
+    const Telemetry::AdaptiveRateStats stats = controller.get_stats();
+    EXPECT_FALSE(std::isinf(stats.budget_bytes_s));
+    EXPECT_FALSE(stats.scaled_streams.empty());
+}
+
+TEST(TelemetryRateController, KeepsMinimumRates)
+{
+    TelemetryRateController controller;
+    controller.set_config(enabled_config());
+    controller.set_priority(Telemetry::Stream::CAMERA_ATTITUDE, 0, 2.0);
+    Simulation sim = simulation();
+    sim.run(controller, 5.0);
+
+    // Not even the minimum rates fit.
+    sim.capacity_bytes_s = 150.0;
+    sim.run(controller, 20.0);
+
+    EXPECT_DOUBLE_EQ(sim.rate(Telemetry::Stream::POSITION), 1.0);
+    EXPECT_DOUBLE_EQ(sim.rate(Telemetry::Stream::BATTERY), 1.0);
+    EXPECT_DOUBLE_EQ(sim.rate(Telemetry::Stream::CAMERA_ATTITUDE), 2.0);
+    EXPECT_DOUBLE_EQ(sim.rate(Telemetry::Stream::ATTITUDE), 0.0);
+}
+
+TEST(TelemetryRateController, RestoresWhenLinkRecovers)
+{
+    TelemetryRateController controller;
+    controller.set_config(enabled_config());
+    Simulation sim = simulation();
+    const Simulation nominal = sim;
+    sim.run(controller, 5.0);
+
+    sim.capacity_bytes_s = 2000.0;
+    sim.run(controller, 20.0);
+    ASSERT_LT(sim.rate(Telemetry::Stream::ATTITUDE), 1.0);
+
+    sim.capacity_bytes_s = 100000.0;
+    sim.run(controller, 30.0);
+
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        EXPECT_DOUBLE_EQ(sim.rates_hz[i], nominal.rates_hz[i]);
+    }
+    EXPECT_TRUE(std::isinf(controller.get_stats().budget_bytes_s));
+    EXPECT_TRUE(controller.get_stats().scaled_streams.empty());
+}
+
+TEST(TelemetryRateController, RadioBufferMeansCongestion)
+{
+    TelemetryRateController controller;
+    controller.set_config(enabled_config());
+    Simulation sim = simulation();
+    sim.run(controller, 5.0);
+
+    // Nothing is lost yet, but the radio is filling up.
+    sim.radio_txbuf_percent = 10.0;
+    sim.run(controller, 1.0);
+    EXPECT_TRUE(controller.get_stats().congested);
+    EXPECT_DOUBLE_EQ(controller.get_stats().radio_txbuf_percent, 10.0);
+    EXPECT_LT(sim.offered(), 0.8 * simulation().offered());
+}
+
+TEST(TelemetryRateController, DisablingRestores)
+{
+    TelemetryRateController controller;
+    controller.set_config(enabled_config());
+    Simulation sim = simulation();
+    const Simulation nominal = sim;
+    sim.run(controller, 5.0);
+
+    sim.capacity_bytes_s = 2000.0;
+    sim.run(controller, 5.0);
+
+    controller.set_config(Telemetry::AdaptiveRateConfig {});
+    ASSERT_TRUE(controller.is_active());
+    sim.run(controller, 1.0);
+
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        EXPECT_DOUBLE_EQ(sim.rates_hz[i], nominal.rates_hz[i]);
+    }
+    EXPECT_FALSE(controller.is_active());
+}
+
+TEST(TelemetryRateController, RequestedRateIsNominal)
+{
+    TelemetryRateController controller;
+    controller.set_config(enabled_config());
+    Simulation sim = simulation();
+    sim.run(controller, 5.0);
+
+    sim.capacity_bytes_s = 2000.0;
+    sim.run(controller, 10.0);
+
+    // The app lowers the attitude itself while the link is congested.
+    controller.set_requested_rate(Telemetry::Stream::ATTITUDE, 10.0);
+    sim.rates_hz[unsigned(Telemetry::Stream::ATTITUDE)] = 10.0;
+
+    sim.capacity_bytes_s = 100000.0;
+    sim.run(controller, 30.0);
+    EXPECT_DOUBLE_EQ(sim.rate(Telemetry::Stream::ATTITUDE), 10.0);
+    EXPECT_DOUBLE_EQ(sim.rate(Telemetry::Stream::POSITION), 50.0);
+}
+
+TEST(TelemetryRateController, UnmanagedStreamsAreLeftAlone)
+{
+    TelemetryRateController controller;
+    controller.set_config(enabled_config());
+    Simulation sim = simulation();
+    sim.run(controller, 5.0);
+
+    controller.set_managed(Telemetry::Stream::ATTITUDE, false);
+    sim.capacity_bytes_s = 2500.0;
+    sim.run(controller, 10.0);
+
+    EXPECT_DOUBLE_EQ(sim.rate(Telemetry::Stream::ATTITUDE), 50.0);
+    // Everything else is scaled down all the more.
+    EXPECT_LT(sim.rate(Telemetry::Stream::POSITION), 25.0);
+}
@@ -0,0 +1,225 @@
+#include "telemetry_rate_profiles.h"
+#include <algorithm>
+#include <cmath>
+
+namespace dronecore {
+
+constexpr unsigned TelemetryRateProfiles::NUM_STREAMS;
+constexpr double TelemetryRateProfiles::SETTLE_S;
+constexpr double TelemetryRateProfiles::MIN_WINDOW_S;
+constexpr double TelemetryRateProfiles::MAX_WINDOW_S;
+constexpr double TelemetryRateProfiles::MIN_MESSAGES;
+constexpr double TelemetryRateProfiles::RATE_TOLERANCE;
+constexpr unsigned TelemetryRateProfiles::MAX_ROUNDS;
+
+TelemetryRateProfiles::TelemetryRateProfiles()
+{
+    // What a companion computer closing a control loop over the link needs.
+    set_profile("control-loop", {
+        {Telemetry::Stream::POSITION, 50.0},
+        {Telemetry::Stream::ATTITUDE, 50.0},
+        {Telemetry::Stream::IN_AIR, 5.0},
+        {Telemetry::Stream::GPS_INFO, 5.0},
+        {Telemetry::Stream::BATTERY, 2.0},
+        {Telemetry::Stream::RC_STATUS, 5.0}
+    });
+
+    // Enough to keep an eye on the vehicle over a slow radio link.
+    set_profile("low-bandwidth", {
+        {Telemetry::Stream::POSITION, 1.0},
+        {Telemetry::Stream::ATTITUDE, 1.0},
+        {Telemetry::Stream::IN_AIR, 0.5},
+        {Telemetry::Stream::GPS_INFO, 0.5},
+        {Telemetry::Stream::BATTERY, 0.5},
+        {Telemetry::Stream::RC_STATUS, 0.5}
+    });
+}
+
+bool TelemetryRateProfiles::set_profile(const std::string &name,
+                                        const std::vector<Telemetry::StreamRate> &rates)
+{
+    if (name.empty()) {
+        return false;
+    }
+
+    bool seen[NUM_STREAMS] {};
+    for (const auto &rate : rates) {
+        const unsigned i = unsigned(rate.stream);
+        if (i >= NUM_STREAMS || seen[i] || !(rate.rate_hz >= 0.0) || std::isinf(rate.rate_hz)) {
+            return false;
+        }
+        seen[i] = true;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _profiles[name] = rates;
+    return true;
+}
+
+bool TelemetryRateProfiles::get_profile(const std::string &name,
+                                        std::vector<Telemetry::StreamRate> &rates) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _profiles.find(name);
+    if (it == _profiles.end()) {
+        return false;
+    }
+    rates = it->second;
+    return true;
+}
+
+bool TelemetryRateProfiles::start(const std::string &name, double time_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _profiles.find(name);
+    if (it == _profiles.end()) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        _streams[i] = StreamState {};
+    }
+    for (const auto &rate : it->second) {
+        StreamState &stream = _streams[unsigned(rate.stream)];
+        stream.in_profile = true;
+        stream.rate_hz = rate.rate_hz;
+    }
+
+    _name = name;
+    _phase = Phase::SETTLING;
+    _round = 1;
+    _phase_start_s = time_s;
+    _succeeded = false;
+    return true;
+}
+
+bool TelemetryRateProfiles::cancel()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const bool was_applying = (_phase != Phase::IDLE);
+    _phase = Phase::IDLE;
+    return was_applying;
+}
+
+bool TelemetryRateProfiles::is_applying() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _phase != Phase::IDLE;
+}
+
+std::vector<Telemetry::StreamRate> TelemetryRateProfiles::get_rates_to_send() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Telemetry::StreamRate> rates;
+    if (_phase == Phase::IDLE) {
+        return rates;
+    }
+
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        if (_streams[i].in_profile && !_streams[i].verified) {
+            rates.push_back(Telemetry::StreamRate {Telemetry::Stream(i), _streams[i].rate_hz});
+        }
+    }
+    return rates;
+}
+
+TelemetryRateProfiles::Step TelemetryRateProfiles::update(double time_s,
+                                                          const uint64_t messages[NUM_STREAMS])
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const double elapsed_s = time_s - _phase_start_s;
+
+    switch (_phase) {
+        case Phase::IDLE:
+            return Step::WAIT;
+
+        case Phase::SETTLING:
+            if (elapsed_s >= SETTLE_S) {
+                std::copy(messages, messages + NUM_STREAMS, _messages_before);
+                _phase = Phase::COUNTING;
+                _phase_start_s = time_s;
+            }
+            return Step::WAIT;
+
+        case Phase::COUNTING:
+        default:
+            break;
+    }
+
+    if (elapsed_s < window_s()) {
+        return Step::WAIT;
+    }
+
+    bool all_verified = true;
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        StreamState &stream = _streams[i];
+        if (!stream.in_profile || stream.verified) {
+            continue;
+        }
+        stream.observed_rate_hz = double(messages[i] - _messages_before[i]) / elapsed_s;
+        stream.verified = matches(stream.rate_hz, stream.observed_rate_hz, elapsed_s);
+        all_verified = all_verified && stream.verified;
+    }
+
+    if (all_verified || _round >= MAX_ROUNDS) {
+        _phase = Phase::IDLE;
+        _succeeded = all_verified;
+        return Step::DONE;
+    }
+
+    ++_round;
+    _phase = Phase::SETTLING;
+    _phase_start_s = time_s;
+    return Step::SEND;
+}
+
+bool TelemetryRateProfiles::succeeded() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _succeeded;
+}
+
+Telemetry::RateProfileStatus TelemetryRateProfiles::get_status() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Telemetry::RateProfileStatus status {};
+    status.name = _name;
+    status.applying = (_phase != Phase::IDLE);
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        const StreamState &stream = _streams[i];
+        if (stream.in_profile) {
+            status.streams.push_back(Telemetry::StreamRateStatus {
+                Telemetry::Stream(i), stream.rate_hz, stream.observed_rate_hz, stream.verified});
+        }
+    }
+    return status;
+}
+
+bool TelemetryRateProfiles::matches(double rate_hz, double observed_rate_hz, double counted_s)
+{
+    // A message more or less within the window is down to when counting
+    // started, not to a wrong rate. This is also what lets a stopped stream
+    // have one last message in flight.
+    const double tolerance_hz = std::max(rate_hz * RATE_TOLERANCE, 1.5 / counted_s);
+    return std::fabs(observed_rate_hz - rate_hz) <= tolerance_hz;
+}
+
+double TelemetryRateProfiles::window_s() const
+{
+    double slowest_s = MIN_WINDOW_S;
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        const StreamState &stream = _streams[i];
+        if (stream.in_profile && !stream.verified && stream.rate_hz > 0.0) {
+            slowest_s = std::max(slowest_s, MIN_MESSAGES / stream.rate_hz);
+        }
+    }
+    return std::min(slowest_s, MAX_WINDOW_S);
+}
+
+} // namespace dronecore
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "telemetry.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dronecore {
+
+// Named sets of stream rates, and the verification of the one being applied.
+//
+// All rates of a profile are requested at once. The acks of the commands
+// cannot be told apart, so instead the messages received of each stream are
+// counted once the vehicle had time to change the rates. Streams which do
+// not match are requested again, up to MAX_ROUNDS times overall.
+//
+// All methods can be called from any thread.
+class TelemetryRateProfiles
+{
+public:
+    static constexpr unsigned NUM_STREAMS = unsigned(Telemetry::Stream::RC_STATUS) + 1;
+
+    enum class Step {
+        WAIT,
+        SEND,
+        DONE
+    };
+
+    // Comes with the profiles "control-loop" and "low-bandwidth".
+    TelemetryRateProfiles();
+    ~TelemetryRateProfiles() = default;
+
+    // delete copy and move constructors and assign operators
+    TelemetryRateProfiles(TelemetryRateProfiles const &) = delete;            // Copy construct
+    TelemetryRateProfiles(TelemetryRateProfiles &&) = delete;                 // Move construct
+    TelemetryRateProfiles &operator=(TelemetryRateProfiles const &) = delete; // Copy assign
+    TelemetryRateProfiles &operator=(TelemetryRateProfiles &&) = delete;      // Move assign
+
+    // Adds or replaces a profile. Fails for an empty name, a negative rate, or a stream
+    // which is in there twice.
+    bool set_profile(const std::string &name, const std::vector<Telemetry::StreamRate> &rates);
+    bool get_profile(const std::string &name, std::vector<Telemetry::StreamRate> &rates) const;
+
+    // Starts applying a profile, the rates of which have to be sent right after. A profile
+    // still being applied is given up. Fails if there is no profile of that name.
+    bool start(const std::string &name, double time_s);
+
+    // Gives up the profile being applied, returns whether there was one.
+    bool cancel();
+
+    bool is_applying() const;
+
+    // The rates which have to be sent: all of them at the start, then those which did not
+    // match.
+    std::vector<Telemetry::StreamRate> get_rates_to_send() const;
+
+    // messages is how many were received of each stream so far. Says whether the rates
+    // have to be sent again or whether the profile is done.
+    Step update(double time_s, const uint64_t messages[NUM_STREAMS]);
+
+    // Whether all rates of the last profile which is done matched.
+    bool succeeded() const;
+
+    Telemetry::RateProfileStatus get_status() const;
+
+    // Time for the vehicle to change the rates before counting starts.
+    static constexpr double SETTLE_S = 0.5;
+    // Messages are counted long enough to see MIN_MESSAGES of the slowest stream, but within
+    // these bounds.
+    static constexpr double MIN_WINDOW_S = 2.0;
+    static constexpr double MAX_WINDOW_S = 10.0;
+    static constexpr double MIN_MESSAGES = 5.0;
+    // How far off the observed rate can be, relative to the rate asked for.
+    static constexpr double RATE_TOLERANCE = 0.2;
+    static constexpr unsigned MAX_ROUNDS = 3;
+
+private:
+    enum class Phase {
+        IDLE,
+        SETTLING,
+        COUNTING
+    };
+
+    struct StreamState {
+        bool in_profile = false;
+        double rate_hz = 0.0;
+        double observed_rate_hz = 0.0;
+        bool verified = false;
+    };
+
+    static bool matches(double rate_hz, double observed_rate_hz, double counted_s);
+    double window_s() const;
+
+    mutable std::mutex _mutex {};
+    std::map<std::string, std::vector<Telemetry::StreamRate>> _profiles {};
+
+    std::string _name {};
+    Phase _phase = Phase::IDLE;
+    unsigned _round = 0;
+    double _phase_start_s = 0.0;
+    bool _succeeded = false;
+    uint64_t _messages_before[NUM_STREAMS] {};
+    StreamState _streams[NUM_STREAMS] {};
+};
+
+} // namespace dronecore
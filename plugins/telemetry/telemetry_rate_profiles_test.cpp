@@ -0,0 +1,216 @@
+#include "telemetry_rate_profiles.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace dronecore;
+
+namespace {
+
+const unsigned NUM_STREAMS = TelemetryRateProfiles::NUM_STREAMS;
+
+// Counts the messages of streams sent at the given rates, stepping like the
+// timer would. Returns the step at which the profiles stopped waiting.
+struct Vehicle {
+    double rates_hz[NUM_STREAMS];
+    double counts[NUM_STREAMS];
+
+    TelemetryRateProfiles::Step run(TelemetryRateProfiles &profiles, double &time_s)
+    {
+        const double step_s = 0.25;
+        for (unsigned i = 0; i < 200; ++i) {
+            time_s += step_s;
+
+            uint64_t messages[NUM_STREAMS] {};
+            for (unsigned j = 0; j < NUM_STREAMS; ++j) {
+                counts[j] += rates_hz[j] * step_s;
+                messages[j] = uint64_t(std::floor(counts[j]));
+            }
+
+            const TelemetryRateProfiles::Step step = profiles.update(time_s, messages);
+            if (step != TelemetryRateProfiles::Step::WAIT) {
+                return step;
+            }
+        }
+        return TelemetryRateProfiles::Step::WAIT;
+    }
+
+    // What the vehicle does when it gets the commands.
+    void apply(const std::vector<Telemetry::StreamRate> &rates)
+    {
+        for (const auto &rate : rates) {
+            rates_hz[unsigned(rate.stream)] = rate.rate_hz;
+        }
+    }
+};
+
+Vehicle vehicle_at(double rate_hz)
+{
+    Vehicle vehicle {};
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        vehicle.rates_hz[i] = rate_hz;
+    }
+    return vehicle;
+}
+
+} // namespace
+
+TEST(TelemetryRateProfiles, ComesWithProfiles)
+{
+    TelemetryRateProfiles profiles;
+    std::vector<Telemetry::StreamRate> rates;
+
+    ASSERT_TRUE(profiles.get_profile("control-loop", rates));
+    EXPECT_FALSE(rates.empty());
+    ASSERT_TRUE(profiles.get_profile("low-bandwidth", rates));
+    EXPECT_FALSE(rates.empty());
+
+    EXPECT_FALSE(profiles.get_profile("nonexistent", rates));
+    EXPECT_FALSE(profiles.start("nonexistent", 0.0));
+    EXPECT_FALSE(profiles.is_applying());
+    EXPECT_TRUE(profiles.get_status().name.empty());
+}
+
+TEST(TelemetryRateProfiles, RejectsInvalidProfiles)
+{
+    TelemetryRateProfiles profiles;
+
+    EXPECT_FALSE(profiles.set_profile("", {{Telemetry::Stream::POSITION, 1.0}}));
+    EXPECT_FALSE(profiles.set_profile("negative", {{Telemetry::Stream::POSITION, -1.0}}));
+    EXPECT_FALSE(profiles.set_profile("nan", {{Telemetry::Stream::POSITION, double(NAN)}}));
+    EXPECT_FALSE(profiles.set_profile("twice", {
+        {Telemetry::Stream::POSITION, 1.0},
+        {Telemetry::Stream::POSITION, 2.0}
+    }));
+
+    EXPECT_TRUE(profiles.set_profile("control-loop", {{Telemetry::Stream::ATTITUDE, 100.0}}));
+    std::vector<Telemetry::StreamRate> rates;
+    ASSERT_TRUE(profiles.get_profile("control-loop", rates));
+    ASSERT_EQ(rates.size(), 1u);
+    EXPECT_EQ(rates[0].stream, Telemetry::Stream::ATTITUDE);
+    EXPECT_DOUBLE_EQ(rates[0].rate_hz, 100.0);
+}
+
+TEST(TelemetryRateProfiles, VerifiesObservedRates)
+{
+    TelemetryRateProfiles profiles;
+    ASSERT_TRUE(profiles.set_profile("test", {
+        {Telemetry::Stream::POSITION, 50.0},
+        {Telemetry::Stream::BATTERY, 1.0},
+        {Telemetry::Stream::CAMERA_ATTITUDE, 0.0}
+    }));
+
+    Vehicle vehicle = vehicle_at(4.0);
+    double time_s = 0.0;
+    ASSERT_TRUE(profiles.start("test", time_s));
+    EXPECT_TRUE(profiles.is_applying());
+
+    const std::vector<Telemetry::StreamRate> rates = profiles.get_rates_to_send();
+    EXPECT_EQ(rates.size(), 3u);
+    vehicle.apply(rates);
+
+    EXPECT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::DONE);
+    EXPECT_TRUE(profiles.succeeded());
+    EXPECT_FALSE(profiles.is_applying());
+    // Long enough to count a few messages of the 1 Hz stream.
+    EXPECT_GE(time_s, TelemetryRateProfiles::SETTLE_S + 5.0);
+
+    const Telemetry::RateProfileStatus status = profiles.get_status();
+    EXPECT_EQ(status.name, "test");
+    EXPECT_FALSE(status.applying);
+    ASSERT_EQ(status.streams.size(), 3u);
+    for (const auto &stream : status.streams) {
+        EXPECT_TRUE(stream.verified);
+        EXPECT_NEAR(stream.observed_rate_hz, stream.rate_hz, 0.2 * stream.rate_hz + 0.3);
+    }
+}
+
+TEST(TelemetryRateProfiles, SendsRatesWhichDoNotMatchAgain)
+{
+    TelemetryRateProfiles profiles;
+    ASSERT_TRUE(profiles.set_profile("test", {
+        {Telemetry::Stream::POSITION, 10.0},
+        {Telemetry::Stream::ATTITUDE, 10.0}
+    }));
+
+    Vehicle vehicle = vehicle_at(4.0);
+    double time_s = 0.0;
+    ASSERT_TRUE(profiles.start("test", time_s));
+
+    // The command for the attitude got lost.
+    vehicle.apply({{Telemetry::Stream::POSITION, 10.0}});
+    ASSERT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::SEND);
+
+    const std::vector<Telemetry::StreamRate> rates = profiles.get_rates_to_send();
+    ASSERT_EQ(rates.size(), 1u);
+    EXPECT_EQ(rates[0].stream, Telemetry::Stream::ATTITUDE);
+
+    vehicle.apply(rates);
+    EXPECT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::DONE);
+    EXPECT_TRUE(profiles.succeeded());
+}
+
+TEST(TelemetryRateProfiles, GivesUpAfterMaxRounds)
+{
+    TelemetryRateProfiles profiles;
+    ASSERT_TRUE(profiles.set_profile("test", {
+        {Telemetry::Stream::POSITION, 10.0},
+        {Telemetry::Stream::HOME_POSITION, 1.0}
+    }));
+
+    // The vehicle does not send the home position at a rate.
+    Vehicle vehicle = vehicle_at(0.0);
+    double time_s = 0.0;
+    ASSERT_TRUE(profiles.start("test", time_s));
+    vehicle.apply({{Telemetry::Stream::POSITION, 10.0}});
+
+    for (unsigned round = 1; round < TelemetryRateProfiles::MAX_ROUNDS; ++round) {
+        ASSERT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::SEND);
+        EXPECT_EQ(profiles.get_rates_to_send().size(), 1u);
+    }
+    EXPECT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::DONE);
+    EXPECT_FALSE(profiles.succeeded());
+
+    const Telemetry::RateProfileStatus status = profiles.get_status();
+    ASSERT_EQ(status.streams.size(), 2u);
+    EXPECT_TRUE(status.streams[0].verified);
+    EXPECT_FALSE(status.streams[1].verified);
+    EXPECT_DOUBLE_EQ(status.streams[1].observed_rate_hz, 0.0);
+}
+
+TEST(TelemetryRateProfiles, StreamStillSentIsNotStopped)
+{
+    TelemetryRateProfiles profiles;
+    ASSERT_TRUE(profiles.set_profile("test", {{Telemetry::Stream::RC_STATUS, 0.0}}));
+
+    Vehicle vehicle = vehicle_at(1.0);
+    double time_s = 0.0;
+    ASSERT_TRUE(profiles.start("test", time_s));
+
+    EXPECT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::SEND);
+    vehicle.apply(profiles.get_rates_to_send());
+    EXPECT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::DONE);
+    EXPECT_TRUE(profiles.succeeded());
+}
+
+TEST(TelemetryRateProfiles, StartingAnotherProfileGivesUpTheFirst)
+{
+    TelemetryRateProfiles profiles;
+    Vehicle vehicle = vehicle_at(0.0);
+    double time_s = 0.0;
+
+    ASSERT_TRUE(profiles.start("control-loop", time_s));
+    ASSERT_TRUE(profiles.start("low-bandwidth", time_s));
+    vehicle.apply(profiles.get_rates_to_send());
+
+    EXPECT_EQ(vehicle.run(profiles, time_s), TelemetryRateProfiles::Step::DONE);
+    EXPECT_TRUE(profiles.succeeded());
+    EXPECT_EQ(profiles.get_status().name, "low-bandwidth");
+
+    EXPECT_FALSE(profiles.cancel());
+    ASSERT_TRUE(profiles.start("control-loop", time_s));
+    EXPECT_TRUE(profiles.cancel());
+    EXPECT_FALSE(profiles.is_applying());
+    EXPECT_TRUE(profiles.get_rates_to_send().empty());
+}
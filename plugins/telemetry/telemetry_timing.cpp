@@ -0,0 +1,57 @@
+#include "telemetry_timing.h"
+#include <algorithm>
+
+namespace dronecore {
+
+constexpr unsigned TelemetryTiming::NUM_STREAMS;
+constexpr double TelemetryTiming::LATENCY_ALPHA;
+constexpr uint64_t TelemetryTiming::MAX_BOOT_TIME_US;
+
+void TelemetryTiming::record(Telemetry::Stream stream, uint64_t vehicle_time_us,
+                             double receive_time_s, double sample_time_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    State &s = _states[unsigned(stream)];
+    s.received = true;
+    s.vehicle_time_us = vehicle_time_us;
+    s.receive_time_s = receive_time_s;
+    s.sample_time_s = sample_time_s;
+
+    if (std::isnan(sample_time_s)) {
+        return;
+    }
+    const double latency_s = receive_time_s - sample_time_s;
+    if (std::isnan(s.latency_s)) {
+        s.latency_s = latency_s;
+        s.max_latency_s = latency_s;
+    } else {
+        s.latency_s += LATENCY_ALPHA * (latency_s - s.latency_s);
+        s.max_latency_s = std::max(s.max_latency_s, latency_s);
+    }
+}
+
+std::vector<Telemetry::StreamTiming> TelemetryTiming::get_stats(double time_s) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Telemetry::StreamTiming> stats;
+    for (unsigned i = 0; i < NUM_STREAMS; ++i) {
+        const State &s = _states[i];
+        if (!s.received) {
+            continue;
+        }
+        const double taken_s = std::isnan(s.sample_time_s) ? s.receive_time_s : s.sample_time_s;
+        stats.push_back(Telemetry::StreamTiming {
+            Telemetry::Stream(i), s.vehicle_time_us, s.receive_time_s, s.sample_time_s,
+            time_s - taken_s, s.latency_s * 1e3, s.max_latency_s * 1e3});
+    }
+    return stats;
+}
+
+uint64_t TelemetryTiming::boot_time_us(uint64_t time_usec)
+{
+    return time_usec < MAX_BOOT_TIME_US ? time_usec : 0;
+}
+
+} // namespace dronecore
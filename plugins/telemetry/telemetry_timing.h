@@ -0,0 +1,62 @@
+#pragma once
+
+#include "telemetry.h"
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace dronecore {
+
+// Keeps when the last sample of every stream was taken and received, and how
+// long the samples took to arrive.
+//
+// record() is called from the receive thread and does not allocate,
+// get_stats() is called from anywhere.
+class TelemetryTiming
+{
+public:
+    static constexpr unsigned NUM_STREAMS = unsigned(Telemetry::Stream::RC_STATUS) + 1;
+
+    TelemetryTiming() = default;
+    ~TelemetryTiming() = default;
+
+    // delete copy and move constructors and assign operators
+    TelemetryTiming(TelemetryTiming const &) = delete;            // Copy construct
+    TelemetryTiming(TelemetryTiming &&) = delete;                 // Move construct
+    TelemetryTiming &operator=(TelemetryTiming const &) = delete; // Copy assign
+    TelemetryTiming &operator=(TelemetryTiming &&) = delete;      // Move assign
+
+    // The sample time is the host time the vehicle took the sample at, NAN
+    // if that is not known.
+    void record(Telemetry::Stream stream, uint64_t vehicle_time_us, double receive_time_s,
+                double sample_time_s);
+
+    // Streams received so far.
+    std::vector<Telemetry::StreamTiming> get_stats(double time_s) const;
+
+    // The time_usec of some messages is the UNIX time once the vehicle has a
+    // GPS fix. Returns 0 for those, as it is not the time since boot.
+    static uint64_t boot_time_us(uint64_t time_usec);
+
+    // Gain of the mean latency.
+    static constexpr double LATENCY_ALPHA = 0.1;
+    // About 31 years, no vehicle runs that long but the UNIX time is beyond.
+    static constexpr uint64_t MAX_BOOT_TIME_US = 1000000000000000ULL;
+
+private:
+    struct State {
+        bool received = false;
+        uint64_t vehicle_time_us = 0;
+        double receive_time_s = 0.0;
+        double sample_time_s = double(NAN);
+        // NAN as long as no sample time was known.
+        double latency_s = double(NAN);
+        double max_latency_s = double(NAN);
+    };
+
+    mutable std::mutex _mutex {};
+    State _states[NUM_STREAMS] {};
+};
+
+} // namespace dronecore
@@ -0,0 +1,54 @@
+#include "telemetry_timing.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace dronecore;
+
+TEST(TelemetryTiming, OnlyStreamsReceived)
+{
+    TelemetryTiming timing;
+    EXPECT_TRUE(timing.get_stats(10.0).empty());
+
+    timing.record(Telemetry::Stream::BATTERY, 0, 10.0, double(NAN));
+    const std::vector<Telemetry::StreamTiming> stats = timing.get_stats(12.5);
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].stream, Telemetry::Stream::BATTERY);
+    EXPECT_EQ(stats[0].vehicle_time_us, 0u);
+    EXPECT_DOUBLE_EQ(stats[0].receive_time_s, 10.0);
+    EXPECT_TRUE(std::isnan(stats[0].sample_time_s));
+    // Without a sample time, the age is since it was received.
+    EXPECT_DOUBLE_EQ(stats[0].age_s, 2.5);
+    EXPECT_TRUE(std::isnan(stats[0].latency_ms));
+    EXPECT_TRUE(std::isnan(stats[0].max_latency_ms));
+}
+
+TEST(TelemetryTiming, MeasuresLatency)
+{
+    TelemetryTiming timing;
+
+    // Taken every 20 ms, arriving 30 ms later, one of them 100 ms late.
+    for (unsigned i = 0; i < 100; ++i) {
+        const double sample_time_s = 100.0 + 0.02 * i;
+        const double latency_s = (i == 50) ? 0.1 : 0.03;
+        timing.record(Telemetry::Stream::POSITION, 5000000 + 20000 * i,
+                      sample_time_s + latency_s, sample_time_s);
+    }
+
+    const std::vector<Telemetry::StreamTiming> stats = timing.get_stats(102.5);
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].stream, Telemetry::Stream::POSITION);
+    EXPECT_EQ(stats[0].vehicle_time_us, 5000000u + 20000u * 99u);
+    EXPECT_DOUBLE_EQ(stats[0].sample_time_s, 101.98);
+    EXPECT_NEAR(stats[0].age_s, 0.52, 1e-9);
+    EXPECT_NEAR(stats[0].latency_ms, 30.0, 0.1);
+    EXPECT_NEAR(stats[0].max_latency_ms, 100.0, 1e-6);
+}
+
+TEST(TelemetryTiming, UnixTimeIsNotBootTime)
+{
+    EXPECT_EQ(TelemetryTiming::boot_time_us(0), 0u);
+    EXPECT_EQ(TelemetryTiming::boot_time_us(123456789), 123456789u);
+    // 2018-01-01 in microseconds.
+    EXPECT_EQ(TelemetryTiming::boot_time_us(1514764800000000ULL), 0u);
+}